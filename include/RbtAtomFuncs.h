@@ -44,6 +44,19 @@ RbtAtomList FindRing(RbtAtomPtr spAtom, RbtBondList& bondList);
 
 // 30 Oct 2000 (DM) - Find all rings, standalone version
 void FindRings(RbtAtomList& atomList, RbtBondList& bondList, RbtAtomListList& ringList);
+
+// Finds the maximum common connected substructure of two atom lists (e.g. the heavy atoms of two molecules).
+// Atoms match if they have the same atomic number, and the substructures must have identical bonding
+// between the matched atoms (bond orders are ignored). Only bonds between atoms in each list are considered.
+// The backtracking search gives up after maxSteps extensions, returning the best match found so far.
+// On return matched1[i] is matched to matched2[i]. Returns the number of matched atoms.
+RbtUInt FindMaxCommonSubstructure(
+    const RbtAtomList& atomList1,
+    const RbtAtomList& atomList2,
+    RbtAtomList& matched1,
+    RbtAtomList& matched2,
+    RbtUInt maxSteps = 100000
+);
 }  // namespace Rbt
 
 #endif  //_RBTATOMFUNCS_H_
@@ -149,6 +149,11 @@ class RbtBaseGrid {
     // Returns list of real-world coordinates for given set of iXYZ indices
     RbtCoordList GetCoordList(const RbtUIntSet& iXYZSet) const;
 
+    // Returns true if every grid point of grid coincides with a grid point of this grid's lattice (this grid
+    // extended indefinitely), within tol grid steps along each axis. Grid values can only be copied between grids
+    // point by point if this is true. Note the test is not symmetric: a grid with twice the grid step passes.
+    RbtBool isOnLattice(const RbtBaseGrid& grid, RbtDouble tol = 1e-3) const;
+
     // DM 17 May 1999 - returns the set of valid grid points within a sphere of a given center and radius
     // DM 17 Jul 2000 - use vector<RbtUInt> and return by reference, for performance boost
     void GetSphereIndices(const RbtCoord& c, RbtDouble radius, RbtUIntList& sIndices) const;
@@ -20,6 +20,7 @@
 #include "RbtInteractionGrid.h"
 #include "RbtNonBondedGrid.h"
 #include "RbtNonBondedHHSGrid.h"
+#include "RbtSolventEnergyMap.h"
 
 class RbtBaseIdxSF: public virtual RbtBaseSF {
  public:
@@ -28,6 +29,10 @@ class RbtBaseIdxSF: public virtual RbtBaseSF {
     // Parameter names
     static RbtString _GRIDSTEP;
     static RbtString _BORDER;
+    // Precomputed receptor-solvent energy maps (for fixed/tethered solvent, rigid receptor only)
+    static RbtString _SOLVENT_MAP;          // Enable/disable solvent energy maps (default = false)
+    static RbtString _SOLVENT_MAP_STEP;     // Translational grid step for the maps (A)
+    static RbtString _SOLVENT_MAP_NORIENT;  // Max number of orientations tabulated per solvent model
 
     ////////////////////////////////////////
     // Constructors/destructors
@@ -40,6 +45,7 @@ class RbtBaseIdxSF: public virtual RbtBaseSF {
     void SetGridStep(RbtDouble step);
     RbtDouble GetBorder() const;
     void SetBorder(RbtDouble border);
+    RbtBool isSolventMapEnabled() const;
 
  protected:
     ////////////////////////////////////////
@@ -57,6 +63,20 @@ class RbtBaseIdxSF: public virtual RbtBaseSF {
     // This should be used by subclasses for selecting the receptor atoms to index
     // GetCorrectedRange() = GetRange() + GetMaxError() + GetBorder()
     RbtDouble GetCorrectedRange() const;
+    // Creates an (unpopulated) energy map for each solvent model, using the SOLVENT_MAP_STEP and
+    // SOLVENT_MAP_NORIENT parameters. Entries are null for models which can not be mapped.
+    // Subclasses are responsible for populating the maps with their own receptor-solvent energies
+    RbtSolventEnergyMapList CreateSolventEnergyMaps(const RbtModelList& solventList) const;
+    // True if the named parameter changes the receptor-solvent energy, and so the solvent energy maps.
+    // Subclasses should add their own energy parameters to the base class list (grid and map parameters, RANGE)
+    virtual RbtBool isSolventMapParameter(const RbtString& strName) const;
+    // The solvent energy maps are cached for each set of values of the solvent map parameters, so that
+    // switching back and forth between parameter sets (e.g. the stages of a docking protocol) only builds
+    // each set of maps once. Returns false if there are no cached maps for the current parameter values
+    RbtBool GetCachedSolventEnergyMaps(RbtSolventEnergyMapList& maps) const;
+    void CacheSolventEnergyMaps(const RbtSolventEnergyMapList& maps) const;
+    // Should be called whenever the receptor or solvent changes
+    void ClearSolventEnergyMapCache();
 
     // As this has a virtual base class we need a separate OwnParameterUpdated
     // which can be called by concrete subclass ParameterUpdated methods
@@ -67,6 +87,8 @@ class RbtBaseIdxSF: public virtual RbtBaseSF {
     ////////////////////////////////////////
     // Private methods
     /////////////////
+    // Cache key for the current values of the solvent map parameters
+    RbtString GetSolventMapKey() const;
 
  protected:
     ////////////////////////////////////////
@@ -79,6 +101,8 @@ class RbtBaseIdxSF: public virtual RbtBaseSF {
     //////////////
     RbtDouble m_gridStep;
     RbtDouble m_border;
+    RbtBool m_bSolventMap;
+    mutable std::map<RbtString, RbtSolventEnergyMapList> m_solventMapCache;
 };
 
 #endif  //_RBTBASEIDXSF_H_
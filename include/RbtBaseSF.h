@@ -54,6 +54,14 @@ class RbtBaseSF: public RbtBaseObject {
 
     // Main public method - returns current weighted score
     RbtDouble Score() const;
+    // Bounded version of Score, for use in acceptance tests.
+    // Returns the current weighted score if it is <= maxScore. Otherwise evaluation may be
+    // abandoned as soon as the score is proven to exceed maxScore, in which case the value
+    // returned is a lower bound on the true score (still > maxScore).
+    RbtDouble BoundedScore(RbtDouble maxScore) const;
+    // Gets a lower bound on the weighted score for any ligand pose.
+    // Returns false if no bound is available.
+    RbtBool ScoreLowerBound(RbtDouble& lowerBound) const;
     // Returns all child component scores as a string-variant map
     // Key = fully qualified component name, value = weighted score
     //(for saving in a Model's data fields)
@@ -76,6 +84,10 @@ class RbtBaseSF: public RbtBaseObject {
     RbtBaseSF();
     // PURE VIRTUAL - DERIVED CLASSES MUST OVERRIDE
     virtual RbtDouble RawScore() const = 0;
+    // Bounded raw score - see BoundedScore. Default implementation returns RawScore
+    virtual RbtDouble BoundedRawScore(RbtDouble maxRawScore) const;
+    // Lower bound on the raw score. Default implementation returns false (no bound available)
+    virtual RbtBool RawScoreLowerBound(RbtDouble& lowerBound) const;
     // DM 25 Oct 2000 - track changes to parameter values in local data members
     // ParameterUpdated is invoked by RbtParamHandler::SetParameter
     void ParameterUpdated(const RbtString& strName);
@@ -108,4 +120,16 @@ typedef vector<RbtBaseSF*> RbtBaseSFList;  // Vector of smart pointers
 typedef RbtBaseSFList::iterator RbtBaseSFListIter;
 typedef RbtBaseSFList::const_iterator RbtBaseSFListConstIter;
 
+namespace Rbt {
+// Returns the first scoring function of type T found in the scoring function tree rooted at pSF, or NULL
+template <class T>
+T* FindSF(RbtBaseSF* pSF) {
+    T* pFoundSF = dynamic_cast<T*>(pSF);
+    for (RbtUInt i = 0; (pFoundSF == NULL) && (i < pSF->GetNumSF()); i++) {
+        pFoundSF = FindSF<T>(pSF->GetSF(i));
+    }
+    return pFoundSF;
+}
+}  // namespace Rbt
+
 #endif  //_RBTBASESF_H_
@@ -163,6 +163,17 @@ class isBondToOH: public RbtBondUnaryPredicate {
     RbtBool operator()(RbtBond* pBond) const;
 };
 
+// Is bond to a locally symmetric terminal group (e.g. CF3, tert-butyl, CH3 with explicit hydrogens)?
+// i.e. one end of the bond bears three or more topologically equivalent acyclic substituents,
+// so that rotation about the bond does little to change the molecule.
+// Terminal groups of polar hydrogens (e.g. NH3+) are not included, as their rotation changes
+// the hydrogen bonding geometry.
+class isBondSymmetricRotor: public RbtBondUnaryPredicate {
+ public:
+    explicit isBondSymmetricRotor() {}
+    RbtBool operator()(RbtBond* pBond) const;
+};
+
 // DM 1 April 1999
 // Is bond2 equal to bond1 (checks if underlying regular pointers match)
 // Note: this is a binary rather than unary predicate
@@ -11,6 +11,7 @@
  ***********************************************************************/
 
 // Penalty function for keeping ligand and solvent within the docking volume
+// GRID_LEVEL selects a coarser copy of the docking site distance grid (grid step multiplied by 2^GRID_LEVEL)
 #ifndef _RBTCAVITYGRIDSF_H_
 #define _RBTCAVITYGRIDSF_H_
 
@@ -39,7 +40,8 @@ class RbtCavityGridSF: public RbtBaseInterSF {
     static RbtString _CT;
     // Parameter names
     static RbtString _RMAX;
-    static RbtString _QUADRATIC;  // True = quadratic penalty function; false = linear
+    static RbtString _QUADRATIC;   // True = quadratic penalty function; false = linear
+    static RbtString _GRID_LEVEL;  // Grid resolution level (0 = docking site grid, n = grid step x 2^n)
 
     RbtCavityGridSF(const RbtString& strName = "CAVITY");
     virtual ~RbtCavityGridSF();
@@ -50,16 +52,27 @@ class RbtCavityGridSF: public RbtBaseInterSF {
     virtual void SetupSolvent();
     virtual void SetupScore();
     virtual RbtDouble RawScore() const;
+    // Penalty is never negative
+    virtual RbtBool RawScoreLowerBound(RbtDouble& lowerBound) const {
+        lowerBound = 0.0;
+        return true;
+    }
     // DM 25 Oct 2000 - track changes to parameter values in local data members
     // ParameterUpdated is invoked by RbtParamHandler::SetParameter
     void ParameterUpdated(const RbtString& strName);
 
  private:
-    RbtRealGridPtr m_spGrid;
-    RbtDouble m_maxDist;      // Max distance of any grid point from the cavity
-    RbtAtomRList m_atomList;  // combined list of all movable heavy atoms
+    // Updates m_spGrid for the current grid level, creating the coarse grid as required
+    void SelectGridLevel();
+
+    RbtRealGridPtr m_spGrid;        // Grid used for scoring (docking site grid, or coarse grid)
+    RbtRealGridPtr m_spFineGrid;    // Docking site grid
+    RbtRealGridList m_coarseGrids;  // Coarse grids for each level > 0, created on first use
+    RbtDouble m_maxDist;            // Max distance of any grid point from the cavity
+    RbtAtomRList m_atomList;        // combined list of all movable heavy atoms
     RbtDouble m_rMax;
     RbtBool m_bQuadratic;  // synchronised with QUADRATIC named parameter
+    RbtInt m_gridLevel;    // synchronised with GRID_LEVEL named parameter
 };
 
 #endif  //_RBTCAVITYGRIDSF_H_
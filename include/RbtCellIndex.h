@@ -0,0 +1,67 @@
+/***********************************************************************
+ * The rDock program was developed from 1998 - 2006 by the software team
+ * at RiboTargets (subsequently Vernalis (R&D) Ltd).
+ * In 2006, the software was licensed to the University of York for
+ * maintenance and distribution.
+ * In 2012, Vernalis and the University of York agreed to release the
+ * program as Open Source software.
+ * This version is licensed under GNU-LGPL version 3.0 with support from
+ * the University of Barcelona.
+ * http://rdock.sourceforge.net/
+ ***********************************************************************/
+
+// Lightweight, unbounded spatial index (cell list) for sets of moving points.
+// Intended to be rebuilt once per score evaluation for the (small) sets of atoms
+// whose coordinates are not known in advance (ligand atoms, free solvent).
+// Points are identified by an integer index supplied by the caller (typically
+// the position of the atom/interaction center in an SF-owned list).
+// Queries return all points in the 3x3x3 block of cells surrounding a coordinate,
+// so the cell size must be at least as large as the maximum interaction range.
+
+#ifndef _RBTCELLINDEX_H_
+#define _RBTCELLINDEX_H_
+
+#include "RbtCoord.h"
+
+class RbtCellIndex {
+ public:
+    // Class type string
+    static RbtString _CT;
+
+    RbtCellIndex(RbtDouble cellSize = 1.0);
+    virtual ~RbtCellIndex();
+
+    // Set the cell size (clears the index)
+    void SetCellSize(RbtDouble cellSize);
+    RbtDouble GetCellSize() const { return m_cellSize; }
+
+    // Remove all points (retains the allocated storage)
+    void Clear();
+    // Add a point with the given caller-defined index
+    void Add(const RbtCoord& c, RbtInt id);
+    // Must be called after the last Add and before the first query
+    void Build();
+
+    RbtUInt GetNumPoints() const { return m_entries.size(); }
+
+    // Appends the indices of all points in the cells neighbouring c to ids
+    // Indices are returned in ascending order of cell, not of index
+    void GetNeighbours(const RbtCoord& c, RbtIntList& ids) const;
+
+ private:
+    typedef unsigned long long RbtCellKey;
+    typedef std::pair<RbtCellKey, RbtInt> RbtCellEntry;
+    typedef vector<RbtCellEntry> RbtCellEntryList;
+    typedef RbtCellEntryList::const_iterator RbtCellEntryListConstIter;
+
+    // Packs the (x,y,z) cell indices into a single sortable key
+    // z occupies the least significant bits, so that cells z-1,z,z+1 are contiguous
+    RbtCellKey GetKey(RbtInt ix, RbtInt iy, RbtInt iz) const;
+    RbtInt GetCell(RbtDouble x) const;
+
+    RbtDouble m_cellSize;
+    RbtDouble m_rCellSize;  // 1/m_cellSize
+    RbtCellEntryList m_entries;
+};
+
+#endif  //_RBTCELLINDEX_H_
@@ -47,6 +47,7 @@ class RbtChrom: public RbtChromElement {
     virtual void SetVector(const RbtXOverList& v, RbtInt& i);
     virtual void GetStepVector(RbtDoubleList& v) const;
     virtual RbtDouble CompareVector(const RbtDoubleList& v, RbtInt& i) const;
+    virtual void GetGeneSegments(RbtGeneSegmentList& segments) const;
     virtual void Print(ostream& s) const;
 
     // Aggregate methods
@@ -54,6 +55,7 @@ class RbtChrom: public RbtChromElement {
     // RbtChrom destructor is responsible for deleting the new element
     // Null operation if pChromElement is NULL
     virtual void Add(RbtChromElement* pChromElement);
+    virtual void GetLeafElements(RbtChromElementList& leafList);
 
  protected:
  private:
@@ -32,8 +32,11 @@ class RbtChromDihedralElement: public RbtChromElement {
         RbtAtomList tetheredAtoms,                            // Tethered atom list
         RbtDouble stepSize,                                   // maximum mutation step size (degrees)
         RbtChromElement::eMode mode = RbtChromElement::FREE,  // sampling mode
-        RbtDouble maxDihedral = 0.0
-    );  // max deviation from reference (tethered mode only)
+        RbtDouble maxDihedral = 0.0,                          // max deviation from reference (tethered mode only)
+        RbtDouble rotamerStep = 0.0
+    );  // rotamer spacing (degrees), 0 = continuous
+    // If rotamerStep > 0, the phenotype is restricted to the nearest discrete rotamer
+    // (see RbtChromDihedralRefData). The genotype remains continuous.
 
     virtual ~RbtChromDihedralElement();
     virtual void Reset();
@@ -50,7 +53,10 @@ class RbtChromDihedralElement: public RbtChromElement {
     virtual void SetVector(const RbtXOverList& v, RbtInt& i);
     virtual void GetStepVector(RbtDoubleList& v) const;
     virtual RbtDouble CompareVector(const RbtDoubleList& v, RbtInt& i) const;
+    virtual void GetGeneSegments(RbtGeneSegmentList& segments) const;
     virtual void Print(ostream& s) const;
+    // Gets the reference data for the rotatable bond
+    RbtChromDihedralRefDataPtr GetRefData() const { return m_spRefData; }
 
     // Returns a standardised dihedral angle in the range [-180, +180}
     // This function operates in degrees
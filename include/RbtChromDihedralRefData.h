@@ -35,8 +35,9 @@ class RbtChromDihedralRefData {
         RbtAtomList tetheredAtoms,                            // Tethered atom list
         RbtDouble stepSize,                                   // maximum mutation step size (degrees)
         RbtChromElement::eMode mode = RbtChromElement::FREE,  // sampling mode
-        RbtDouble maxDihedral = 0.0
-    );  // max deviation from reference (tethered mode only)
+        RbtDouble maxDihedral = 0.0,                          // max deviation from reference (tethered mode only)
+        RbtDouble rotamerStep = 0.0
+    );  // rotamer spacing (degrees), 0 = continuous
     virtual ~RbtChromDihedralRefData();
 
     // Gets the maximum step size for this bond
@@ -54,6 +55,20 @@ class RbtChromDihedralRefData {
     // Gets the initial dihedral angle for this bond
     //(initialised from model coords in RbtChromDihedralRefData constructor)
     RbtDouble GetInitialValue() const { return m_initialValue; }
+    // Gets the atoms rotated by this bond
+    const RbtAtomRList& GetRotAtoms() const { return m_rotAtoms; }
+    // Gets the atoms of the rotatable bond (atom 3 is on the rotated side)
+    RbtAtom* GetAtom2() const { return m_atom2; }
+    RbtAtom* GetAtom3() const { return m_atom3; }
+
+    // Discrete rotamer support
+    // Rotamers are spaced evenly around 360 deg, starting at 180 deg (anti)
+    // Returns the number of rotamers (0 = continuous sampling)
+    RbtInt GetNumRotamers() const { return m_nRotamers; }
+    // Returns the dihedral angle for rotamer i (0 <= i < GetNumRotamers())
+    RbtDouble GetRotamerValue(RbtInt i) const;
+    // Returns the index of the rotamer nearest to the given dihedral angle
+    RbtInt GetNearestRotamer(RbtDouble dihedralAngle) const;
 
  private:
     // Sets up the movable atom list for this bond
@@ -67,6 +82,7 @@ class RbtChromDihedralRefData {
     RbtDouble m_initialValue;
     RbtChromElement::eMode m_mode;
     RbtDouble m_maxDihedral;  // max deviation from reference (tethered mode only)
+    RbtInt m_nRotamers;       // number of discrete rotamers (0 = continuous)
 };
 
 typedef SmartPtr<RbtChromDihedralRefData> RbtChromDihedralRefDataPtr;  // Smart pointer
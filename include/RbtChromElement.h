@@ -30,6 +30,23 @@ typedef vector<RbtXOverElement> RbtXOverList;
 typedef RbtXOverList::iterator RbtXOverListIter;
 typedef RbtXOverList::const_iterator RbtXOverListConstIter;
 
+// Describes one crossover element within the flat vector of doubles returned by
+// GetVector(RbtDoubleList&), so that two flat vectors can be compared without
+// recourse to the chromosome element itself (see RbtGeneLayout)
+struct RbtGeneSegment {
+    enum eCompareType {
+        LINEAR = 0,    // absolute difference
+        DIHEDRAL = 1,  // absolute difference of cyclic angle (degrees)
+        COM = 2,       // distance between two (x,y,z) vectors
+        EULER = 3,     // rotation angle between two (heading,attitude,bank) orientations
+        QUAT = 4       // rotation angle between two (s,x,y,z) unit quaternion orientations
+    };
+    eCompareType type;
+    RbtUInt length;      // number of double values
+    RbtDouble stepSize;  // differences are normalised by the step size (ignored if zero)
+};
+typedef vector<RbtGeneSegment> RbtGeneSegmentList;
+
 class RbtChromElement {
  public:
     // Class type string
@@ -100,11 +117,23 @@ class RbtChromElement {
     // that are difficult to compare by simple numerical differences. e.g.
     // Dihedral angles are cyclical, therefore -180 and + 179 only differ by 1 deg.
     virtual RbtDouble CompareVector(const RbtDoubleList& v, RbtInt& i) const = 0;
+    // Appends one RbtGeneSegment per crossover element.
+    // The segments must describe the same values, in the same order, as GetVector(RbtDoubleList&)
+    // and must compare them in the same way as CompareVector.
+    virtual void GetGeneSegments(RbtGeneSegmentList& segments) const = 0;
     //
     // IMPLEMENTED VIRTUAL METHODS
     //
     // Invalid operation in base class
     virtual void Add(RbtChromElement* pChromElement);
+    // Appends the non-aggregate elements to leafList (just this element in base class)
+    virtual void GetLeafElements(vector<RbtChromElement*>& leafList) { leafList.push_back(this); }
+    // Number of independent move types that can be applied with MutateMoveType,
+    // for samplers that mutate one gene at a time.
+    // Base class has a single move type (Mutate), or none if the element has zero length
+    virtual RbtInt GetNumMoveTypes() const { return (GetLength() > 0) ? 1 : 0; }
+    // Mutates only the degrees of freedom for move type iMoveType (0 <= iMoveType < GetNumMoveTypes())
+    virtual void MutateMoveType(RbtInt iMoveType, RbtDouble relStepSize) { Mutate(relStepSize); }
     // Prints details of element to stream (null implementation in base class)
     virtual void Print(ostream& s) const {};
     //
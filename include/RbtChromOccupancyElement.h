@@ -40,6 +40,7 @@ class RbtChromOccupancyElement: public RbtChromElement {
     virtual void SetVector(const RbtXOverList& v, RbtInt& i);
     virtual void GetStepVector(RbtDoubleList& v) const;
     virtual RbtDouble CompareVector(const RbtDoubleList& v, RbtInt& i) const;
+    virtual void GetGeneSegments(RbtGeneSegmentList& segments) const;
     virtual void Print(ostream& s) const;
 
     // Returns a standardised occupancy value in the range [0,1]
@@ -31,8 +31,9 @@ class RbtChromPositionElement: public RbtChromElement {
         RbtChromElement::eMode transMode = RbtChromElement::FREE,
         RbtChromElement::eMode rotMode = RbtChromElement::FREE,
         RbtDouble maxTrans = 0.0,  // Angstroms
-        RbtDouble maxRot = 0.0
-    );  // radians
+        RbtDouble maxRot = 0.0,    // radians
+        RbtChromPositionRefData::eOrientationRepr orientationRepr = RbtChromPositionRefData::EULER
+    );
     virtual ~RbtChromPositionElement();
     virtual void Reset();
     virtual void Randomise();
@@ -48,7 +49,11 @@ class RbtChromPositionElement: public RbtChromElement {
     virtual void SetVector(const RbtXOverList& v, RbtInt& i);
     virtual void GetStepVector(RbtDoubleList& v) const;
     virtual RbtDouble CompareVector(const RbtDoubleList& v, RbtInt& i) const;
+    virtual void GetGeneSegments(RbtGeneSegmentList& segments) const;
     virtual void Print(ostream& s) const;
+    // Translation and rotation are separate move types (unless fixed)
+    virtual RbtInt GetNumMoveTypes() const;
+    virtual void MutateMoveType(RbtInt iMoveType, RbtDouble relStepSize);
 
     // Returns a standardised rotation angle in the range [-M_PI, +M_PI}
     // This function operates in radians
@@ -56,7 +61,9 @@ class RbtChromPositionElement: public RbtChromElement {
 
  protected:
     // For use by clone()
-    RbtChromPositionElement(RbtChromPositionRefDataPtr spRefData, const RbtCoord& com, const RbtEuler& orientation);
+    RbtChromPositionElement(
+        RbtChromPositionRefDataPtr spRefData, const RbtCoord& com, const RbtEuler& orientation, const RbtQuat& quat
+    );
     RbtChromPositionElement();
     void RandomiseCOM();
     void RandomiseOrientation();
@@ -64,11 +71,23 @@ class RbtChromPositionElement: public RbtChromElement {
     void MutateOrientation(RbtDouble relStepSize);
     void CorrectTetheredCOM();
     void CorrectTetheredOrientation();
+    RbtBool isQuatRepr() const { return m_spRefData->GetOrientationRepr() == RbtChromPositionRefData::QUAT; }
+    // Appends the orientation genotype value to v, in the selected representation
+    void GetOrientationVector(RbtDoubleList& v) const;
+    // Orientation genotype value as a quaternion, in either representation
+    RbtQuat GetOrientationQuat() const;
+    // Rotates the orientation genotype value by theta radians about axis, in the selected representation
+    void RotateOrientation(const RbtVector& axis, RbtDouble theta);
+    // Converts four quaternion gene values to a unit quaternion, with s >= 0
+    static RbtQuat ToQuat(const RbtDouble* v);
+    // Returns the unit quaternion equivalent to q, with s >= 0
+    static RbtQuat Canonical(const RbtQuat& q);
 
  private:
     RbtChromPositionRefDataPtr m_spRefData;  // Fixed reference data
     RbtCoord m_com;                          // Centre of mass genotype value
-    RbtEuler m_orientation;                  // Euler angle orientation genotype value
+    RbtEuler m_orientation;                  // Euler angle orientation genotype value (EULER representation)
+    RbtQuat m_quat;                          // Quaternion orientation genotype value (QUAT representation, s >= 0)
 };
 
 #endif /*RBTCHROMPOSITIONELEMENT_H_*/
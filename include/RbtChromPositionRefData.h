@@ -11,7 +11,7 @@
  ***********************************************************************/
 
 // Manages the fixed reference data for a position chromosome element
-// Also provides methods to map the genotype (COM and Euler angles) onto the
+// Also provides methods to map the genotype (COM and orientation) onto the
 // phenotype (model coords)
 // A single instance is designed to be shared between all clones of a given element
 #ifndef RBTCHROMPOSITIONREFDATA_H_
@@ -28,6 +28,13 @@ class RbtChromPositionRefData {
     static RbtString _CT;
     // Reference Cartesian axes
     static const RbtPrincipalAxes CARTESIAN_AXES;
+    // Orientation genotype representation.
+    // EULER = heading, attitude and bank angles (3 values)
+    // QUAT = unit quaternion (4 values), with uniform random orientations and geodesic comparisons
+    enum eOrientationRepr { EULER = 0, QUAT = 1 };
+    // Static methods to convert from representation enum to string and vice versa
+    static eOrientationRepr StrToOrientationRepr(const RbtString& reprStr);  // case insensitive
+    static RbtString OrientationReprToStr(eOrientationRepr repr);            // returns "EULER" or "QUAT"
     RbtChromPositionRefData(
         const RbtModel* pModel,
         const RbtDockingSite* pDockSite,
@@ -36,8 +43,9 @@ class RbtChromPositionRefData {
         RbtChromElement::eMode transMode = RbtChromElement::FREE,
         RbtChromElement::eMode rotMode = RbtChromElement::FREE,
         RbtDouble maxTrans = 0.0,  // Angstroms
-        RbtDouble maxRot = 0.0
-    );  // radians
+        RbtDouble maxRot = 0.0,    // radians
+        eOrientationRepr orientationRepr = EULER
+    );
     virtual ~RbtChromPositionRefData();
 
     RbtUInt GetNumStartCoords() const { return m_startCoords.size(); }
@@ -46,7 +54,10 @@ class RbtChromPositionRefData {
     RbtDouble GetRotStepSize() const { return m_rotStepSize; }
     RbtChromElement::eMode GetTransMode() const { return m_transMode; }
     RbtChromElement::eMode GetRotMode() const { return m_rotMode; }
-    // Chromosome length, excluding FIXED modes (0, 3 or 6)
+    eOrientationRepr GetOrientationRepr() const { return m_orientationRepr; }
+    // Number of values used to represent the orientation (3 for EULER, 4 for QUAT)
+    RbtUInt GetOrientationLength() const { return (m_orientationRepr == QUAT) ? 4u : 3u; }
+    // Chromosome length, excluding FIXED modes (0, 3, 4, 6 or 7)
     RbtUInt GetLength() const { return m_length; }
     // Chromosome length for crossover, excluding FIXED modes (0, 1 or 2)
     RbtUInt GetXOverLength() const { return m_xOverLength; }
@@ -58,8 +69,8 @@ class RbtChromPositionRefData {
     const RbtEuler& GetInitialOrientation() const { return m_initialOrientation; }
     const RbtQuat& GetInitialQuat() const { return m_initialQuat; }
 
-    void GetModelValue(RbtCoord& com, RbtEuler& orientation) const;
-    void SetModelValue(const RbtCoord& com, const RbtEuler& orientation);
+    void GetModelValue(RbtCoord& com, RbtQuat& orientation) const;
+    void SetModelValue(const RbtCoord& com, const RbtQuat& orientation);
 
  private:
     RbtAtomList m_refAtoms;
@@ -72,6 +83,7 @@ class RbtChromPositionRefData {
     RbtQuat m_initialQuat;
     RbtChromElement::eMode m_transMode;
     RbtChromElement::eMode m_rotMode;
+    eOrientationRepr m_orientationRepr;
     RbtUInt m_length;
     RbtUInt m_xOverLength;
     // Max distance allowed from starting coord
@@ -35,6 +35,11 @@ class RbtConstSF: public RbtBaseInterSF {
     virtual void SetupLigand(){};
     virtual void SetupScore(){};
     virtual RbtDouble RawScore() const;
+    // Score is independent of the ligand pose, so is its own lower bound
+    virtual RbtBool RawScoreLowerBound(RbtDouble& lowerBound) const {
+        lowerBound = RawScore();
+        return true;
+    }
     void ParameterUpdated(const RbtString& strName);
 
  private:
@@ -42,6 +42,8 @@ class RbtConstraint {
 
     RbtCoord GetCoords() const { return coord; };
     RbtDouble GetTolerance() const { return tolerance; };
+    // Ligand atoms (or pseudoatoms) matching this constraint, as set by AddAtomList
+    const RbtAtomList& GetAtomList() const { return m_atomList; };
     virtual void AddAtomList(RbtModelPtr, RbtBool bCheck = true) = 0;
     RbtDouble Score() const;
 
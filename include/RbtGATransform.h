@@ -42,6 +42,13 @@ class RbtGATransform: public RbtBaseBiMolTransform {
     static RbtString _NCONVERGENCE;
     // Output the best pose every _HISTORY_FREQ cycles.
     static RbtString _HISTORY_FREQ;
+    // Comma-separated list of scoring function terms (fully qualified names, e.g. SCORE.INTER.VDW1)
+    // used as a cheap surrogate to pre-screen new individuals. Empty = no pre-screening
+    // The terms should be grid-based (e.g. the RbtVdwGridSF terms of RbtInterGridSF.prm, as in
+    // dock_grid_prescreen.prm); an indexed term such as SCORE.INTER.VDW in dock.prm saves little
+    static RbtString _SURROGATE_SF;
+    // Approximate fraction of new individuals, ranked by surrogate score, that are fully scored each cycle
+    static RbtString _SURROGATE_FRACTION;
 
     struct Config {
         RbtDouble population_size_fraction_as_new_individuals_per_cycle{0.5};
@@ -53,6 +60,8 @@ class RbtGATransform: public RbtBaseBiMolTransform {
         RbtInt max_cycles{100};
         RbtInt num_convergence_cycles{6};
         RbtInt history_frequency{0};
+        RbtString surrogate_sf{""};
+        RbtDouble surrogate_fraction{1.0};
     };
 
     static const Config DEFAULT_CONFIG;
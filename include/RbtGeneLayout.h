@@ -0,0 +1,89 @@
+/***********************************************************************
+ * The rDock program was developed from 1998 - 2006 by the software team
+ * at RiboTargets (subsequently Vernalis (R&D) Ltd).
+ * In 2006, the software was licensed to the University of York for
+ * maintenance and distribution.
+ * In 2012, Vernalis and the University of York agreed to release the
+ * program as Open Source software.
+ * This version is licensed under GNU-LGPL version 3.0 with support from
+ * the University of Barcelona.
+ * http://rdock.sourceforge.net/
+ ***********************************************************************/
+
+// Shared, read-only description of the flat gene vector of a chromosome,
+// as returned by RbtChromElement::GetVector(RbtDoubleList&).
+// Genomes store their chromosome values as a flat gene vector and share a single
+// layout, so that copying, crossover and equality tests work directly on the
+// contiguous values without cloning or visiting the chromosome element tree.
+// The layout also owns a decoder chromosome, which is loaded with a genome's values
+// whenever the element-specific operations (mutation, randomisation, syncing to the
+// model) are required.
+
+#ifndef _RBTGENELAYOUT_H_
+#define _RBTGENELAYOUT_H_
+
+#include "RbtChromElement.h"
+
+class RbtGeneLayout {
+ public:
+    // Class type string
+    static RbtString _CT;
+
+    // The decoder chromosome is a clone of pChr
+    RbtGeneLayout(const RbtChromElement* pChr);
+    virtual ~RbtGeneLayout();
+
+    // Number of double values in the flat gene vector
+    RbtUInt GetLength() const { return m_length; }
+    // Number of crossover elements
+    RbtUInt GetXOverLength() const { return m_segments.size(); }
+    // Index of the first double value of crossover element iXOver.
+    // GetXOverOffset(GetXOverLength()) returns GetLength()
+    RbtUInt GetXOverOffset(RbtUInt iXOver) const { return m_offsets[iXOver]; }
+
+    // Returns the maximum relative difference between two flat gene vectors,
+    // with the same result as RbtChromElement::CompareVector
+    RbtDouble Compare(const RbtDouble* genes1, const RbtDouble* genes2) const;
+    // Returns the hash keys of the pose-space cell occupied by a flat gene vector (first), and of its neighbouring
+    // cells. Cells are binned over up to three hash dimensions: the centre of mass if the chromosome has one,
+    // otherwise the first linear or dihedral genes. Each dimension is binned with a cell width of at least
+    // cellSize step sizes, so every gene vector that Compares as less than cellSize apart from genes is in
+    // one of the returned cells.
+    void GetNeighbourKeys(const RbtDouble* genes, RbtDouble cellSize, vector<std::size_t>& keys) const;
+
+    // Loads the decoder chromosome with the values in genes and returns it.
+    // The decoder is shared by all genomes with this layout, so is only valid
+    // until the next call to Decode.
+    RbtChromElement* Decode(const RbtDoubleList& genes) const;
+    // Stores the current decoder chromosome values in genes
+    void Encode(RbtDoubleList& genes) const;
+
+ private:
+    RbtGeneLayout(const RbtGeneLayout&);             // Copy constructor disabled by default
+    RbtGeneLayout& operator=(const RbtGeneLayout&);  // Copy assignment disabled by default
+
+    // A gene used to bin gene vectors into cells
+    struct HashDim {
+        RbtUInt offset;      // Index of the gene in the flat gene vector
+        RbtDouble stepSize;  // Step size of the gene's segment
+        RbtBool isCyclic;    // True for dihedral genes, which wrap at +/-180 degrees
+    };
+
+    // Returns the number of cells along hash dimension dim (zero if unbounded)
+    RbtInt GetNumCells(const HashDim& dim, RbtDouble cellSize) const;
+    // Returns the index of the cell occupied by genes along hash dimension dim
+    long GetCellIndex(const HashDim& dim, const RbtDouble* genes, RbtDouble cellSize) const;
+    // Returns the hash of a list of cell indices
+    static std::size_t CombineCellIndices(const vector<long>& indices);
+
+    RbtChromElement* m_chrom;  // Decoder chromosome
+    RbtGeneSegmentList m_segments;
+    vector<HashDim> m_hashDims;
+    vector<RbtUInt> m_offsets;
+    RbtUInt m_length;
+};
+
+// Useful typedefs
+typedef SmartPtr<RbtGeneLayout> RbtGeneLayoutPtr;  // Smart pointer
+
+#endif  //_RBTGENELAYOUT_H_
@@ -11,31 +11,58 @@
  ***********************************************************************/
 
 // Genome for roulette wheel selection.
-// Manages a chromosome element, an associated raw score from a scoring function
-// and a scaled fitness value for roulette wheel selection
+// Manages the chromosome values (as a flat gene vector with a shared RbtGeneLayout),
+// an associated raw score from a scoring function and a scaled fitness value
+// for roulette wheel selection
 #ifndef _RBT_GENOME_H_
 #define _RBT_GENOME_H_
 
 #include "RbtChromElement.h"
+#include "RbtGeneLayout.h"
 
 class RbtBaseSF;
+class RbtGenome;
+
+namespace Rbt {
+// 2-point crossover of the gene vectors of pG1 and pG2, stored in pG3 and pG4.
+// Crossover points are restricted to crossover element boundaries.
+// pG3 and pG4 must share the layout of pG1 and pG2, and must not alias pG2 and pG1 respectively.
+void Crossover(const RbtGenome* pG1, const RbtGenome* pG2, RbtGenome* pG3, RbtGenome* pG4);
+}  // namespace Rbt
 
 class RbtGenome {
  public:
     static RbtString _CT;
-    // Sole constructor accepting an existing chromosome.
-    // A clone of the existing chromosome is stored,
-    // and is deleted in the RbtGenome destructor
+    // Constructor accepting an existing chromosome.
+    // The current chromosome values are stored, with a new gene layout
     RbtGenome(RbtChromElement* pChr);
+    // Constructor accepting an existing gene layout.
+    // The current values of the layout's decoder chromosome are stored.
+    // Genomes that share a layout can be copied and compared without reference to the chromosome.
+    RbtGenome(RbtGeneLayoutPtr spLayout);
     // Copy constructor and Assignment operator.
-    // The underlying chromosome is cloned during the copy.
+    // The gene vector is copied and the layout is shared.
     RbtGenome(const RbtGenome&);
     RbtGenome& operator=(const RbtGenome&);
     RbtGenome* clone() const;
     virtual ~RbtGenome();
 
-    // Gets the underlying chromosome
-    RbtChromElement* GetChrom() const { return m_chrom; }
+    // Loads the values of this genome into the layout's decoder chromosome, and returns it.
+    // The chromosome is borrowed: it is owned by the layout and shared by all genomes with the same layout,
+    // so must not be deleted, and is only valid until the next call to Decode (or any other genome operation).
+    // Changes to it are not stored in this genome. Use clone() to keep a copy.
+    RbtChromElement* Decode() const { return m_spLayout->Decode(m_genes); }
+    RbtGeneLayoutPtr GetLayout() const { return m_spLayout; }
+    const RbtDoubleList& GetGenes() const { return m_genes; }
+    // Replaces the gene vector (must match the layout length)
+    void SetGenes(const RbtDoubleList& genes);
+
+    // Chromosome operations, applied to the gene vector via the layout's decoder chromosome
+    void Randomise();
+    void Mutate(RbtDouble relStepSize);
+    void CauchyMutate(RbtDouble mean, RbtDouble variance);
+    // Updates the model coords to match the gene vector
+    void SyncToModel() const { Decode()->SyncToModel(); }
 
     // Sets the raw score from the scoring function.
     // Model coordinates are updated to reflect the current chromosome element values.
@@ -43,6 +70,8 @@ class RbtGenome {
     // pSF is a pointer to a scoring function object.
     // If pSF is null, a zero score is set.
     void SetScore(RbtBaseSF* pSF);
+    // As SetScore, but the model coords must already have been updated by SyncToModel
+    void SetScoreFromModel(RbtBaseSF* pSF);
     // Gets the stored raw score (without re-evaluation of the scoring function).
     RbtDouble GetScore() const { return m_score; }
 
@@ -66,13 +95,14 @@ class RbtGenome {
 
     // Tests equality based on chromosome element values.
     // Does not take score into account.
-    RbtBool Equals(const RbtGenome& g, RbtDouble threshold) const { return m_chrom->Equals(*(g.m_chrom), threshold); }
+    RbtBool Equals(const RbtGenome& g, RbtDouble threshold) const;
     friend bool operator==(const RbtGenome& g1, const RbtGenome& g2) {
         return g1.Equals(g2, RbtChromElement::_THRESHOLD);
     }
 
     void Print(ostream&) const;
     friend ostream& operator<<(ostream& s, const RbtGenome& g);
+    friend void Rbt::Crossover(const RbtGenome* pG1, const RbtGenome* pG2, RbtGenome* pG3, RbtGenome* pG4);
 
  private:
     RbtGenome();  // Default constructor disabled
@@ -81,7 +111,8 @@ class RbtGenome {
     /////////////////////
     // Private data
     /////////////////////
-    RbtChromElement* m_chrom;
+    RbtGeneLayoutPtr m_spLayout;  // shared description of m_genes
+    RbtDoubleList m_genes;        // flat chromosome values
     RbtDouble m_score;      // raw value of the scoring function
     RbtDouble m_RWFitness;  // scaled value of the raw score suitable for use
                             // with roulette wheel selection
@@ -38,6 +38,11 @@ class RbtLigandFlexData: public RbtFlexData {
     // Max allowed dihedral rotation from initial dihedrals
     //(for tethered dihedrals only)
     static const RbtString& _MAX_DIHEDRAL;
+    // Whole-body orientation representation (EULER or QUAT)
+    static const RbtString& _ROT_REPR;
+    // If true, rotatable bonds to locally symmetric terminal groups (e.g. CF3, tert-butyl)
+    // are excluded from the chromosome (see Rbt::isBondSymmetricRotor). Off by default
+    static const RbtString& _PRUNE_SYM_ROTORS;
     RbtLigandFlexData(RbtDockingSite* pDockSite);
     virtual void Accept(RbtFlexDataVisitor& v) { v.VisitLigandFlexData(this); }
 
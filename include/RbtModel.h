@@ -45,6 +45,8 @@ class RbtModel {
     //////////////////////////
     // DM 30 Jul 2001 - allow access to atom list by helper class for flexible models
     friend class RbtModelMutator;
+    // Allow fast save and restore of the model state (e.g. the best pose of a conformer ensemble)
+    friend class RbtModelSnapshot;
 
     //////////////////////
     // Public accessor functions
@@ -0,0 +1,51 @@
+/***********************************************************************
+ * The rDock program was developed from 1998 - 2006 by the software team
+ * at RiboTargets (subsequently Vernalis (R&D) Ltd).
+ * In 2006, the software was licensed to the University of York for
+ * maintenance and distribution.
+ * In 2012, Vernalis and the University of York agreed to release the
+ * program as Open Source software.
+ * This version is licensed under GNU-LGPL version 3.0 with support from
+ * the University of Barcelona.
+ * http://rdock.sourceforge.net/
+ ***********************************************************************/
+
+// Flat copy of the atom and pseudoatom coords, and occupancy state, of the flexible
+// models (those with flexibility data) in a model list.
+// Used to restore the complete state of the docked system (ligand, flexible receptor and
+// solvent) at a later point, e.g. the best pose of a conformer ensemble in rbdock.
+// Storage is reused between calls to Save.
+
+#ifndef _RBTMODELSNAPSHOT_H_
+#define _RBTMODELSNAPSHOT_H_
+
+#include "RbtModel.h"
+
+class RbtModelSnapshot {
+ public:
+    // Class type string
+    static RbtString _CT;
+
+    RbtModelSnapshot();
+    virtual ~RbtModelSnapshot();
+
+    // Saves the current state of the flexible models in modelList
+    void Save(const RbtModelList& modelList);
+    // Restores the models to the state at the last call to Save
+    void Restore() const;
+    // Discards the saved state
+    void Clear();
+    // True if no state has been saved since construction or the last call to Clear
+    RbtBool isEmpty() const { return m_models.empty(); }
+
+ private:
+    RbtModelSnapshot(const RbtModelSnapshot&);             // Copy constructor disabled by default
+    RbtModelSnapshot& operator=(const RbtModelSnapshot&);  // Copy assignment disabled by default
+
+    vector<RbtModel*> m_models;
+    RbtCoordList m_coords;  // Atom coords, then pseudoatom coords, for each model in turn
+    RbtDoubleList m_occupancies;
+    vector<RbtBool> m_enabled;
+};
+
+#endif  //_RBTMODELSNAPSHOT_H_
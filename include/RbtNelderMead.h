@@ -0,0 +1,96 @@
+/***********************************************************************
+ * The rDock program was developed from 1998 - 2006 by the software team
+ * at RiboTargets (subsequently Vernalis (R&D) Ltd).
+ * In 2006, the software was licensed to the University of York for
+ * maintenance and distribution.
+ * In 2012, Vernalis and the University of York agreed to release the
+ * program as Open Source software.
+ * This version is licensed under GNU-LGPL version 3.0 with support from
+ * the University of Barcelona.
+ * http://rdock.sourceforge.net/
+ ***********************************************************************/
+
+// Nelder-Mead simplex minimiser.
+// Follows the same moves and stopping criteria as the NMSearch class in import/simplex,
+// but the vertex and trial point storage is owned by the minimiser and reused from one
+// search to the next, so that a long-lived instance (e.g. one per RbtSimplexTransform)
+// does not allocate once it has seen a search of the highest dimension.
+// The function to minimise is supplied through the RbtNelderMead::Objective interface.
+#ifndef _RBTNELDERMEAD_H_
+#define _RBTNELDERMEAD_H_
+
+#include "RbtChromElement.h"
+
+class RbtBaseSF;
+
+class RbtNelderMead {
+ public:
+    // Function to be minimised
+    class Objective {
+     public:
+        virtual ~Objective() {}
+        virtual RbtDouble Evaluate(const RbtDoubleList& x) = 0;
+    };
+
+    RbtNelderMead(RbtDouble alpha = 1.0, RbtDouble beta = 0.5, RbtDouble gamma = 2.0, RbtDouble sigma = 0.5);
+
+    // Maximum number of function evaluations per search (-1 = unlimited)
+    void SetMaxCalls(RbtInt maxCalls) { m_maxCalls = maxCalls; }
+    // Search stops once the standard deviation of the vertex values falls below this value
+    void SetStoppingLength(RbtDouble stoppingLength) { m_stoppingLength = stoppingLength; }
+
+    // Sets up a right-angled simplex with basePoint at one vertex and an edge of length
+    // edgeLengths[i] along each coordinate axis i, and evaluates all the vertices.
+    // Resets the function call count.
+    void InitRightSimplex(const RbtDoubleList& basePoint, const RbtDoubleList& edgeLengths, Objective& objective);
+    // Runs the simplex search from the current simplex until the stopping criteria are met
+    void Minimise(Objective& objective);
+
+    const RbtDoubleList& GetMinPoint() const { return m_vertices[m_minIndex]; }
+    RbtDouble GetMinVal() const { return m_values[m_minIndex]; }
+    RbtInt GetFunctionCalls() const { return m_calls; }
+    RbtInt GetDimensions() const { return m_dimensions; }
+
+ private:
+    void Resize(RbtInt nDimensions);
+    RbtDouble Evaluate(Objective& objective, const RbtDoubleList& x);
+    RbtBool BudgetExhausted() const { return (m_maxCalls > -1) && (m_calls >= m_maxCalls); }
+    RbtBool Stop() const;
+    void FindMinMaxIndices();
+    RbtInt SecondHighestIndex() const;
+    void FindCentroid();
+    // Sets x = (1 - coeff) * centroid + coeff * p
+    void Extrapolate(const RbtDoubleList& p, RbtDouble coeff, RbtDoubleList& x) const;
+    void ShrinkSimplex(Objective& objective);
+
+    RbtDouble m_alpha;  // reflection coefficient
+    RbtDouble m_beta;   // contraction coefficient
+    RbtDouble m_gamma;  // expansion coefficient
+    RbtDouble m_sigma;  // shrinking coefficient
+    RbtInt m_maxCalls;
+    RbtDouble m_stoppingLength;
+
+    RbtInt m_dimensions;
+    RbtInt m_calls;
+    RbtInt m_minIndex;
+    RbtInt m_maxIndex;
+    vector<RbtDoubleList> m_vertices;  // dimensions + 1 vertices
+    RbtDoubleList m_values;            // objective value at each vertex
+    RbtDoubleList m_centroid;          // centroid of all vertices apart from the highest
+    RbtDoubleList m_reflection;
+    RbtDoubleList m_expansion;
+    RbtDoubleList m_contraction;
+};
+
+// Scores a chromosome with a scoring function, for use as a simplex objective
+class RbtChromSFObjective: public RbtNelderMead::Objective {
+ public:
+    RbtChromSFObjective(RbtChromElement* pChrom, RbtBaseSF* pSF): m_pChrom(pChrom), m_pSF(pSF) {}
+    virtual RbtDouble Evaluate(const RbtDoubleList& x);
+
+ private:
+    RbtChromElement* m_pChrom;
+    RbtBaseSF* m_pSF;
+};
+
+#endif  //_RBTNELDERMEAD_H_
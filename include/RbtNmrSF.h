@@ -35,17 +35,44 @@ class RbtNmrSF: public RbtBaseInterSF, public RbtBaseIdxSF {
     virtual void SetupLigand();
     virtual void SetupScore();
     virtual RbtDouble RawScore() const;
+    // Restraint penalties are never negative
+    virtual RbtBool RawScoreLowerBound(RbtDouble& lowerBound) const {
+        lowerBound = 0.0;
+        return true;
+    }
     void ParameterUpdated(const RbtString& strName);
 
  private:
-    RbtDouble NoeDistance(const RbtNoeRestraintAtoms& noe) const;
-    RbtDouble StdDistance(const RbtStdRestraintAtoms& std) const;
+    // Compiles the NOE and STD restraints into the flat arrays below
+    void CompileRestraints(const RbtNoeRestraintAtomsList& noeList, const RbtStdRestraintAtomsList& stdList);
+    // Adds a restraint end to the flat arrays, returns the end index
+    RbtUInt AddRestraintEnd(const RbtNoeEndAtoms& end);
+    // Fills coords with the coords of restraint end iEnd (single center of mass for NOE_MEAN ends)
+    void GetEndCoords(RbtUInt iEnd, RbtCoordList& coords) const;
+    RbtDouble NoeDistance(RbtUInt iRestr) const;
+    RbtDouble StdDistance(RbtUInt iRestr) const;
 
     RbtBool m_bQuadratic;  // synchronised with QUADRATIC named parameter
     RbtNonBondedGridPtr m_spGrid;
-    RbtAtomList m_ligAtomList;           // All ligand atoms
-    RbtNoeRestraintAtomsList m_noeList;  // List of all NOE interactions
-    RbtStdRestraintAtomsList m_stdList;  // List of all STD interactions
+    RbtAtomList m_ligAtomList;  // All ligand atoms
+
+    // Restraints are compiled at SetupScore time into flat arrays,
+    // so that RawScore does not have to allocate or walk the restraint definitions
+    // Restraint ends: atoms of end i are m_endAtoms[m_endStart[i]] to m_endAtoms[m_endStart[i+1]-1]
+    RbtAtomRList m_endAtoms;
+    RbtDoubleList m_endMasses;  // Atomic mass of each atom in m_endAtoms
+    RbtUIntList m_endStart;
+    vector<Rbt::eNoeType> m_endTypes;
+    RbtDoubleList m_endTotalMasses;
+    // Restraints: NOE restraints first, then STD restraints (which have no "to" end)
+    RbtUIntList m_restrFrom;
+    RbtUIntList m_restrTo;
+    RbtDoubleList m_restrMaxDist;
+    vector<RbtBool> m_restrSimple;  // True for unambiguous NOEs (single atom at each end)
+    RbtUInt m_nNoe;                 // Number of NOE restraints
+    // Preallocated scratch coord lists for RawScore
+    mutable RbtCoordList m_fromCoords;
+    mutable RbtCoordList m_toCoords;
 };
 
 #endif  //_RBTNMRSF_H_
@@ -34,6 +34,7 @@ class RbtPRMFactory {
     static const RbtString& _REC_NUM_COORD_FILES;
     static const RbtString& _REC_FLEX_DISTANCE;
     static const RbtString& _REC_DIHEDRAL_STEP;
+    static const RbtString& _REC_ROTAMER_STEP;
 
     // Ligand parameters
     static const RbtString& _LIG_SECTION;
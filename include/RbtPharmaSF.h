@@ -28,27 +28,42 @@ class RbtPharmaSF: public RbtBaseInterSF {
     static RbtString _OPTIONAL_FILE;
     static RbtString _NOPT;
     static RbtString _WRITE_ERRORS;
+    // If true, ligands whose topology can not span the distances between the mandatory
+    // constraints are rejected at setup time (default = true)
+    static RbtString _CHECK_DISTANCES;
 
     RbtPharmaSF(const RbtString& strName = "PHARMA");
     virtual ~RbtPharmaSF();
     // Override RbtBaseSF::ScoreMap to provide additional raw descriptors
     virtual void ScoreMap(RbtStringVariantMap& scoreMap) const;
+    // Mandatory constraints, with matching ligand atom lists once the ligand has been set up
+    const RbtConstraintList& GetMandatoryConstraints() const { return m_constrList; }
 
  protected:
     virtual void SetupReceptor();
     virtual void SetupLigand();
     virtual void SetupScore();
     virtual RbtDouble RawScore() const;
+    // Constraint penalties are never negative
+    virtual RbtBool RawScoreLowerBound(RbtDouble& lowerBound) const {
+        lowerBound = 0.0;
+        return true;
+    }
     // DM 25 Oct 2000 - track changes to parameter values in local data members
     // ParameterUpdated is invoked by RbtParamHandler::SetParameter
     void ParameterUpdated(const RbtString& strName);
 
  private:
+    // Throws an RbtLigandError if any pair of mandatory constraints lies further apart than
+    // the maximum possible separation of the corresponding ligand features
+    void CheckMandatoryDistances() const;
+
     RbtConstraintList m_constrList;
     RbtConstraintList m_optList;
     RbtInt m_nopt;
     RbtMolecularFileSinkPtr m_spErrorFile;
     RbtBool m_bWriteErrors;
+    RbtBool m_bCheckDistances;
     // Keep track of individual constraint scores for ScoreMap
     mutable RbtDoubleList m_conScores;  // Mandatory constraint scores
     mutable RbtDoubleList m_optScores;  // Optional constraint scores
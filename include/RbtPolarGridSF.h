@@ -0,0 +1,109 @@
+/***********************************************************************
+ * The rDock program was developed from 1998 - 2006 by the software team
+ * at RiboTargets (subsequently Vernalis (R&D) Ltd).
+ * In 2006, the software was licensed to the University of York for
+ * maintenance and distribution.
+ * In 2012, Vernalis and the University of York agreed to release the
+ * program as Open Source software.
+ * This version is licensed under GNU-LGPL version 3.0 with support from
+ * the University of Barcelona.
+ * http://rdock.sourceforge.net/
+ ***********************************************************************/
+
+// Precalculated-grid-based intermolecular polar scoring function
+// The grids are calculated by rbcalcgrid -P with the RbtPolarIdxSF scoring functions in a grid SF file
+// (e.g. calcgrid_polar.prm), so the receptor interaction centers and their density and charge scaling are
+// included in the grid values, and the cost of scoring is independent of the receptor.
+// Each grid is for a polar probe: a class of ligand interaction center with a given vdW radius, named
+// e.g. HBA_1.35 (classes are HBD = donor hydrogen, HBA = acceptor, METAL = metal, GUAN = guanidinium carbon).
+// Directional probes have a grid for each of a small set of probe directions (from the HBD/HBA atom to its parent,
+// or normal to the guanidinium plane), and each ligand interaction center is scored from the grid for the
+// direction closest to its own.
+// Ligand acceptors with lone pair geometry (LP_OSP2) are scored from the acceptor grids, i.e. with the angular
+// dependence about the acceptor-parent axis.
+// Of the RbtPolarSF parameters, only INCHBD, INCHBA, INCMETAL and INCGUAN are used, to select the ligand
+// interaction centers; the others are fixed by the grid SF file.
+
+#ifndef _RBTPOLARGRIDSF_H_
+#define _RBTPOLARGRIDSF_H_
+
+#include "RbtBaseInterSF.h"
+#include "RbtPolarSF.h"
+#include "RbtRealGrid.h"
+
+class RbtBiMolWorkSpace;  // forward declaration
+
+class RbtPolarGridSF: public RbtBaseInterSF, public RbtPolarSF {
+ public:
+    // Class type string
+    static RbtString _CT;
+    // Parameter names
+    static RbtString _GRID;      // Suffix for grid filename
+    static RbtString _SMOOTHED;  // Controls whether to smooth the grid values
+
+    // Polar probe classes
+    enum eProbeClass { HBD, HBA, METAL, GUAN };
+
+    RbtPolarGridSF(const RbtString& strName = "POLAR");
+    virtual ~RbtPolarGridSF();
+
+    // Probe name for the given class and vdW radius, e.g. HBA_1.35
+    static RbtString GetProbeName(eProbeClass probeClass, RbtDouble radius);
+    // Splits a probe name into its class and vdW radius. Throws RbtBadArgument if the name is invalid
+    static void ParseProbeName(const RbtString& strProbe, eProbeClass& probeClass, RbtDouble& radius);
+    // True if the score of the probe class depends on its direction with any of the RbtPolarIdxSF scoring
+    // functions registered with pWorkSpace. Non-directional probes (e.g. metals) need just one grid
+    static RbtBool isDirectional(RbtBiMolWorkSpace* pWorkSpace, eProbeClass probeClass);
+    // Returns nDirections approximately evenly distributed unit vectors (spherical Fibonacci lattice)
+    static RbtCoordList CreateProbeDirections(RbtInt nDirections);
+    // Fills grid with the score of the named probe, pointing in the given direction, at each grid point.
+    // The score is the weighted sum of the RbtPolarIdxSF scoring functions registered with pWorkSpace.
+    static void CalculateProbeGrid(
+        RbtBiMolWorkSpace* pWorkSpace, const RbtString& strProbe, const RbtCoord& direction, RbtRealGrid* pGrid
+    );
+
+ protected:
+    virtual void SetupReceptor();
+    virtual void SetupLigand();
+    virtual void SetupSolvent();
+    virtual void SetupScore();
+    virtual RbtDouble RawScore() const;
+    // DM 25 Oct 2000 - track changes to parameter values in local data members
+    // ParameterUpdated is invoked by RbtParamHandler::SetParameter
+    void ParameterUpdated(const RbtString& strName);
+
+ private:
+    // Grids for one probe, one per probe direction
+    struct ProbeGrids {
+        RbtCoordList directions;
+        RbtRealGridList grids;
+        RbtUIntList directionTable;  // Closest probe direction for each cube map cell (empty for one direction)
+    };
+    typedef std::map<RbtString, ProbeGrids> RbtProbeGridsMap;
+
+    // A ligand interaction center, with the atoms which define its direction
+    struct LigandCenter {
+        eProbeClass probeClass;
+        RbtAtom* pAtom;            // Interaction center atom
+        RbtAtom* pAtom2;           // Parent atom (HBD, HBA) or first bonded atom (GUAN)
+        RbtAtom* pAtom3;           // Second bonded atom (GUAN)
+        RbtString strProbe;        // Probe name
+        const ProbeGrids* pGrids;  // Probe grids, assigned by SetupScore
+    };
+
+    // Read grids from input stream
+    void ReadGrids(istream& istr);
+    // Index of the cube map cell containing direction d. The cube map divides each face of the unit cube
+    // into a square of cells, so that the closest probe direction can be looked up rather than searched for
+    static RbtUInt GetCubeMapCell(const RbtVector& d);
+    // Fills the directionTable of probeGrids with the closest probe direction to the center of each cell
+    static void CreateDirectionTable(ProbeGrids& probeGrids);
+    // Index of the probe direction closest to the current direction of the ligand interaction center
+    RbtUInt GetDirectionIndex(const LigandCenter& center) const;
+
+    RbtProbeGridsMap m_probeGrids;
+    vector<LigandCenter> m_ligCenters;
+    RbtBool m_bSmoothed;
+};
+
+#endif  //_RBTPOLARGRIDSF_H_
@@ -16,9 +16,13 @@
 #ifndef _RBTPOLARIDXSF_H_
 #define _RBTPOLARIDXSF_H_
 
+#include <set>
+
 #include "RbtBaseIdxSF.h"
 #include "RbtBaseInterSF.h"
+#include "RbtCellIndex.h"
 #include "RbtPolarSF.h"
+#include "RbtRotamerEnergyTable.h"
 
 class RbtPolarIdxSF: public RbtBaseInterSF, public RbtBaseIdxSF, public RbtPolarSF {
  public:
@@ -37,6 +41,12 @@ class RbtPolarIdxSF: public RbtBaseInterSF, public RbtBaseIdxSF, public RbtPolar
     // Override RbtBaseSF::ScoreMap to provide additional raw descriptors
     virtual void ScoreMap(RbtStringVariantMap& scoreMap) const;
 
+    // Raw score of the given donor (posList) and acceptor (negList) interaction centers with the receptor, as if
+    // they were ligand interaction centers. Used by rbcalcgrid to calculate the grids for RbtPolarGridSF
+    RbtDouble ProbeScore(const RbtInteractionCenterList& posList, const RbtInteractionCenterList& negList) const {
+        return InterScore(posList, negList, false);
+    }
+
  protected:
     virtual void SetupReceptor();
     virtual void SetupLigand();
@@ -55,6 +65,8 @@ class RbtPolarIdxSF: public RbtBaseInterSF, public RbtBaseIdxSF, public RbtPolar
     // DM 25 Oct 2000 - track changes to parameter values in local data members
     // ParameterUpdated is invoked by RbtParamHandler::SetParameter
     void ParameterUpdated(const RbtString& strName);
+    // The polar geometry parameters and INCR change the receptor-solvent energy
+    virtual RbtBool isSolventMapParameter(const RbtString& strName) const;
 
  private:
     RbtDouble ReceptorScore() const;
@@ -66,6 +78,60 @@ class RbtPolarIdxSF: public RbtBaseInterSF, public RbtBaseIdxSF, public RbtPolar
     RbtDouble InterScore(
         const RbtInteractionCenterList& posList, const RbtInteractionCenterList& negList, RbtBool bCount
     ) const;
+    // Solvent-solvent score using the intra-model intn map plus the inter-model neighbours from the solvent cell
+    // indexes (pIndex=NULL => intra-model interactions only)
+    RbtDouble SolventScore(
+        const RbtInteractionCenterList& icList,
+        const RbtCellIndex* pIndex,
+        const RbtInteractionCenterList& indexList,
+        RbtBool bSingleList,
+        const f1prms& Rprms,
+        const f1prms& A1prms,
+        const f1prms& A2prms
+    ) const;
+    // Ligand-solvent score for each solvent interaction center in icList, using the ligand cell index
+    RbtDouble LigandSolventScore(
+        const RbtInteractionCenterList& icList,
+        const RbtCellIndex& index,
+        const RbtInteractionCenterList& indexList,
+        const f1prms& Rprms,
+        const f1prms& A1prms,
+        const f1prms& A2prms
+    ) const;
+    // Rebuilds a cell index of the enabled interaction centers in icList from the current coordinates
+    void IndexInteractionCenters(const RbtInteractionCenterList& icList, RbtCellIndex& index) const;
+    // Returns the cell size required to index the interaction centers in icList
+    RbtDouble GetIndexCellSize(const RbtInteractionCenterList& icList) const;
+    // Populates the receptor-solvent energy maps (if enabled)
+    // Called lazily from ReceptorSolventScore, as the maps must be rebuilt whenever the energy parameters change
+    void BuildSolventMaps() const;
+
+    // A flexible receptor interaction center, and the subset of its partitioned interactions
+    // that contribute to the same rotamer energy table entry
+    struct RbtRotamerTerm {
+        RbtInteractionCenter* pIC;
+        RbtBool bDonor;  // true if pIC is in m_flexRecPosList, false if in m_flexRecNegList
+        RbtInteractionCenterList intns;
+    };
+    typedef vector<RbtRotamerTerm> RbtRotamerTermList;
+
+    // Populates the intra-receptor rotamer energy table (if discrete receptor rotamers are enabled)
+    // Called lazily from ReceptorScore, for the same reason
+    void BuildRotamerTable() const;
+    // Divides the partitioned interactions of each flexible interaction center in icList by the flexible groups
+    // that they move with: one group (selfTerms, indexed by group) or two (pairTerms, indexed by group pair).
+    // Returns false if any interaction depends on more than two groups.
+    RbtBool AddRotamerTerms(
+        const RbtInteractionCenterList& icList,
+        RbtBool bDonor,
+        vector<RbtRotamerTermList>& selfTerms,
+        vector<RbtRotamerTermList>& pairTerms
+    ) const;
+    // Adds the rotamer table groups of the atoms of pIC to groups
+    void GetRotamerGroups(const RbtInteractionCenter* pIC, std::set<RbtInt>& groups) const;
+    // Intra-receptor score of a list of rotamer terms, as in RbtPolarSF::IntraScore
+    RbtDouble RotamerTermScore(const RbtRotamerTermList& terms) const;
+
     RbtInteractionGridPtr m_spPosGrid;
     RbtInteractionGridPtr m_spNegGrid;
     RbtInteractionCenterList m_recepPosList;
@@ -80,7 +146,23 @@ class RbtPolarIdxSF: public RbtBaseInterSF, public RbtBaseIdxSF, public RbtPolar
 
     RbtInteractionCenterList m_solventPosList;
     RbtInteractionCenterList m_solventNegList;
-    RbtInteractionListMap m_solventIntns;
+    RbtInteractionListMap m_solventIntns;  // Intra-model solvent intns only
+    // Solvent interaction centers for each solvent model (not owned - subsets of the lists above)
+    RbtInteractionListMap m_solventModelPosLists;
+    RbtInteractionListMap m_solventModelNegLists;
+    mutable RbtSolventEnergyMapList m_solventMaps;  // Receptor-solvent energy map for each solvent model (may be null)
+    mutable RbtBool m_bSolventMapsDirty;            // Maps need to be rebuilt before next use
+    mutable RbtRotamerEnergyTablePtr m_spRotamerTable;  // Intra-receptor energies for discrete rotamers (may be null)
+    mutable RbtBool m_bRotamerTableDirty;               // Table needs to be rebuilt before next use
+
+    // Dynamic spatial indexes for the ligand and solvent interaction centers, rebuilt on each score call
+    // Indexed by position in the corresponding interaction center list
+    mutable RbtCellIndex m_ligPosIndex;
+    mutable RbtCellIndex m_ligNegIndex;
+    mutable RbtCellIndex m_solventPosIndex;
+    mutable RbtCellIndex m_solventNegIndex;
+    mutable RbtIntList m_nbrIds;                   // Scratch list of neighbour positions
+    mutable RbtInteractionCenterList m_nbrList;  // Scratch list of neighbour interaction centers
 
     RbtBool m_bAttr;
     RbtBool m_bFlexRec;
@@ -23,7 +23,7 @@ class RbtBaseSF;  // forward definition
 class RbtPopulation {
  public:
     static RbtString _CT;
-    // Sole constructor to create a randomised genome population of a fixed size.
+    // Constructor to create a randomised genome population of a fixed size.
     // pChr is the seed chromosome to clone to create each genome.
     // size is the population size to create.
     // pSF is the scoring function used to rank the genomes.
@@ -36,6 +36,9 @@ class RbtPopulation {
     // 5) Model coords are updated to match the fittest chromosome
     // An RbtBadArgument error is thrown if size is <=0, or if pChr or pSF is null.
     RbtPopulation(RbtChromElement* pChr, RbtUInt size, RbtBaseSF* pSF);
+    // As above, but the first genomes in the population are copies of the seed genomes
+    // provided (up to size), and only the remainder are randomised.
+    RbtPopulation(RbtChromElement* pChr, RbtUInt size, RbtBaseSF* pSF, const RbtGenomeList& seeds);
     virtual ~RbtPopulation();
 
     // Gets the maximum size of the population as defined in the constructor.
@@ -60,6 +63,19 @@ class RbtPopulation {
     // An RbtBadArgument error is thrown if pSF is null.
     // Model coords are updated to match the fittest chromosome
     void SetSF(RbtBaseSF* pSF);
+    // Sets the cheap surrogate scoring functions used to pre-screen the new genomes created by GAstep.
+    // Only new genomes whose surrogate score (the sum of the surrogate scores) is among the best fraction
+    // are scored with the full scoring function and considered for merging into the population (see PreScreen).
+    // An empty list, or fraction >= 1, disables pre-screening.
+    void SetSurrogateSF(const vector<RbtBaseSF*>& surrogateSFs, RbtDouble fraction);
+
+    // Copies the genomes in sortedPop (in score order) to uniquePop, up to maxSize genomes, skipping any genome
+    // that is equal (within equalityThreshold) to a genome already copied. Equal genomes are found by hashing
+    // the copied genomes into pose-space cells (see RbtGeneLayout::GetNeighbourKeys), so the cost is linear
+    // in the population size. If equalityThreshold <= 0, no genomes are skipped.
+    static void RemoveDuplicates(
+        const RbtGenomeList& sortedPop, RbtDouble equalityThreshold, RbtUInt maxSize, RbtGenomeList& uniquePop
+    );
 
     // Main method for performing a GA iteration
     void GAstep(
@@ -77,19 +93,29 @@ class RbtPopulation {
 
  private:
     // Merges the new individuals created into the main population
-    // Duplicate genomes are removed (based on equality of chromosome elements, not scores)
+    // Duplicate genomes are removed (based on equality of chromosome elements, not scores),
+    // see RemoveDuplicates
     void MergeNewPop(RbtGenomeList& newPop, RbtDouble equalityThreshold);
+    // Scores the genomes in newPop that pass pre-screening, and removes the others from newPop.
+    // Each genome is synced to the model once, for both the surrogate and the full score.
+    // A genome passes if its surrogate score is no worse than m_surrogateCutoff, which is then updated to the
+    // surrogate score that would have passed the best m_surrogateFraction of newPop. The fraction that passes
+    // is therefore approximate, and all genomes pass in the first GA iteration after SetSF or SetSurrogateSF.
+    void PreScreen(RbtGenomeList& newPop);
     void EvaluateRWFitness();
     RbtPopulation(const RbtPopulation&);             // Disable
     RbtPopulation& operator=(const RbtPopulation&);  // Disable
 
-    RbtGenomeList m_pop;        // The population of genomes
-    RbtUInt m_size;             // The maximum size of the population
-    RbtDouble m_c;              // Sigma Truncation Multiplier
-    RbtBaseSF* m_pSF;           // The scoring function
-    RbtRand& m_rand;            // reference to the singleton random number generator
-    RbtDouble m_scoreMean;      // the average raw score across all genomes
-    RbtDouble m_scoreVariance;  // the variance of raw scores across all genomes
+    RbtGenomeList m_pop;                // The population of genomes
+    RbtUInt m_size;                     // The maximum size of the population
+    RbtDouble m_c;                      // Sigma Truncation Multiplier
+    RbtBaseSF* m_pSF;                   // The scoring function
+    vector<RbtBaseSF*> m_surrogateSFs;  // Surrogate scoring functions for pre-screening new genomes
+    RbtDouble m_surrogateFraction;      // Fraction of new genomes that pass pre-screening
+    RbtDouble m_surrogateCutoff;        // Highest surrogate score that passes pre-screening
+    RbtRand& m_rand;                    // reference to the singleton random number generator
+    RbtDouble m_scoreMean;              // the average raw score across all genomes
+    RbtDouble m_scoreVariance;          // the variance of raw scores across all genomes
 };
 
 typedef SmartPtr<RbtPopulation> RbtPopulationPtr;
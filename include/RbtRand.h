@@ -20,6 +20,7 @@
 #include "RandInt.h"
 
 #include "RbtCoord.h"
+#include "RbtQuat.h"
 #include "RbtTypes.h"
 
 class RbtRand {
@@ -42,10 +43,18 @@ class RbtRand {
     RbtInt GetSeed();
     // Get a random double between 0 and 1 (inlined)
     RbtDouble GetRandom01() { return m_rand.fdraw(); };
+    // Get the random double between 0 and 1 that the next call to GetRandom01 will return,
+    // without advancing the generator (inlined)
+    RbtDouble PeekRandom01() const { return Randint(m_rand).fdraw(); };
     // Get a random integer between 0 and nMax-1
     RbtInt GetRandomInt(RbtInt nMax);
     // Get a random unit vector distributed evenly over the surface of a sphere
     RbtVector GetRandomUnitVector();
+    // Get a random unit quaternion (rotation) distributed evenly over orientation space
+    RbtQuat GetRandomQuat();
+    // Returns the unit quaternion for the uniform deviates u1, u2, u3 (each between 0 and 1), such that evenly
+    // spread deviates give evenly spread orientations (Shoemake's method)
+    static RbtQuat GetUniformQuat(RbtDouble u1, RbtDouble u2, RbtDouble u3);
     RbtDouble GetGaussianRandom(RbtDouble, RbtDouble);
     RbtDouble GetCauchyRandom(RbtDouble, RbtDouble);
 
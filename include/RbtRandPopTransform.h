@@ -16,16 +16,72 @@
 
 #include "RbtBaseBiMolTransform.h"
 #include "RbtChromElement.h"
+#include "RbtConstraint.h"
+#include "RbtGenome.h"
+#include "RbtPopulation.h"
+#include "RbtRand.h"
+
+class RbtVdwGridSF;  // forward declaration
 
 class RbtRandPopTransform: public RbtBaseBiMolTransform {
  public:
     static RbtString _CT;
     static RbtString _POP_SIZE;
     static RbtString _SCALE_CHROM_LENGTH;
+    // Fraction of the population whose ligand pose is seeded by fitting matching ligand atoms
+    // onto the mandatory pharmacophore constraint centres (requires an RbtPharmaSF, default = 0)
+    static RbtString _PHARMA_SEED_FRACTION;
+    // Fraction of the population whose ligand pose is seeded from an exhaustive rigid body scan
+    // of the ligand (in its initial conformation) over the docking site cavity points, scored
+    // with the vdW grid (requires an RbtVdwGridSF, default = 0)
+    static RbtString _SCAN_SEED_FRACTION;
+    // Number of rotations to scan (of the whole ligand for SCAN_SEED_FRACTION, of the anchor fragment for
+    // GROW_SEED_FRACTION)
+    static RbtString _SCAN_NROT;
+    // Fraction of the population whose ligand pose is seeded by incremental construction (anchor and grow,
+    // requires an RbtVdwGridSF, default = 0).
+    // The ligand is split into rigid fragments at the rotatable bonds of its chromosome. The anchor fragment
+    // (the one with the most ring atoms) is placed by the same rigid body scan as for SCAN_SEED_FRACTION.
+    // The remaining fragments are then added one rotatable bond at a time in breadth-first order from the anchor,
+    // sampling each dihedral at regular intervals and keeping the best partial poses (beam search).
+    // Partial poses are scored with the vdW grid plus a simple intramolecular clash penalty,
+    // considering only the atoms placed so far.
+    static RbtString _GROW_SEED_FRACTION;
+    static RbtString _GROW_BEAM_WIDTH;     // Number of partial poses kept after each growth step
+    static RbtString _GROW_DIHEDRAL_STEP;  // Dihedral sampling interval (degrees, > 0)
+    static RbtString _GROW_CLASH_DIST;     // Intramolecular heavy atom clash distance (A)
+    static RbtString _GROW_CLASH_WEIGHT;   // Weight of the intramolecular clash penalty
+    // Fraction of the population seeded from the best poses found by earlier runs on the same ligand.
+    // The final pose and the final population of each run are added to an archive of diverse poses,
+    // which is cleared whenever the ligand (or any other model) changes (default = 0)
+    static RbtString _RUN_SEED_FRACTION;
+    // Poses in the archive must differ by at least this threshold, as measured by RbtGenome::Equals
+    // (i.e. in units of the chromosome element step sizes)
+    static RbtString _RUN_SEED_THRESHOLD;
+    // Fraction of the population whose ligand pose is seeded from a reference pose of a related ligand.
+    // The maximum common substructure of the ligand and the reference ligand (heavy atoms only) is
+    // found, and the best of several random ligand conformations is superimposed onto the reference
+    // coords of the matched atoms (requires TEMPLATE_FILE, default = 0)
+    static RbtString _TEMPLATE_SEED_FRACTION;
+    static RbtString _TEMPLATE_FILE;         // SD file containing the reference ligand pose
+    static RbtString _TEMPLATE_MIN_MATCHED;  // Minimum number of matched atoms needed for seeding
 
     struct Config {
         RbtInt population_size{50};
         RbtBool scale_chromosome_length{true};
+        RbtDouble pharma_seed_fraction{0.0};
+        RbtDouble scan_seed_fraction{0.0};
+        RbtInt scan_num_rotations{500};
+        RbtDouble grow_seed_fraction{0.0};
+        RbtInt grow_beam_width{20};
+        RbtDouble grow_dihedral_step{30.0};
+        RbtDouble grow_clash_dist{3.0};
+        RbtDouble grow_clash_weight{1.0};
+        RbtDouble run_seed_fraction{0.0};
+        RbtDouble run_seed_threshold{1.0};
+        RbtDouble template_seed_fraction{0.0};
+        RbtString template_file{""};
+        RbtInt template_min_matched{3};
     };
 
     static const Config DEFAULT_CONFIG;
@@ -48,11 +104,77 @@ class RbtRandPopTransform: public RbtBaseBiMolTransform {
     virtual void Execute();
 
  private:
+    // A rigid body placement: coords are transformed by q.Rotate(coord - centre) + translation
+    struct RigidPose {
+        RbtDouble score;
+        RbtQuat q;
+        RbtCoord translation;
+        bool operator<(const RigidPose& p) const { return score < p.score; }
+    };
+    // A rotatable bond in the order in which the torsion tree is grown
+    struct GrowthStep {
+        RbtUInt proximalAtom;     // Bond atom on the anchor side
+        RbtUInt distalAtom;       // Bond atom on the far side
+        RbtUIntList movedAtoms;   // All atoms beyond the bond (rotated when sampling the dihedral)
+        RbtUIntList placedAtoms;  // Atoms of the fragment added by this step
+    };
+    // A partially (or fully) built ligand pose
+    struct PartialPose {
+        RbtDouble score;
+        RbtCoordList coords;
+        bool operator<(const PartialPose& p) const { return score < p.score; }
+    };
+
     ////////////////////////////////////////
     // Private methods
     /////////////////
     RbtRandPopTransform(const RbtRandPopTransform&);             // Copy constructor disabled by default
     RbtRandPopTransform& operator=(const RbtRandPopTransform&);  // Copy assignment disabled by default
+    // Creates nSeeds genomes whose ligand poses satisfy (as far as possible) the mandatory constraints.
+    // Each genome is randomised, then the ligand is superimposed rigidly so that a randomly chosen
+    // matching atom for each of up to three randomly chosen constraints lies on the constraint centre.
+    void CreatePharmaSeeds(const RbtConstraintList& constrList, RbtInt nSeeds, RbtGenomeList& seeds);
+    // Creates up to nSeeds genomes from the best-scoring rigid body placements of the ligand.
+    void CreateScanSeeds(const RbtVdwGridSF* pVdwSF, RbtInt nSeeds, RbtGenomeList& seeds);
+    // Rigid body scan of the ligand atoms with the given indices over the docking site cavity points, scored
+    // with the vdW grid. The atoms are at coords, and are rotated about centre. The best translation is found
+    // for each of scan_num_rotations random rotations, and the best nPoses rotations are returned in poses,
+    // in ascending order of score.
+    void ScanRigidBody(
+        const RbtVdwGridSF* pVdwSF,
+        const RbtCoordList& coords,
+        const RbtUIntList& atoms,
+        const RbtCoord& centre,
+        RbtInt nPoses,
+        vector<RigidPose>& poses
+    );
+    // Creates up to nSeeds genomes from the ligand poses grown from the best anchor placements
+    void CreateGrowSeeds(const RbtVdwGridSF* pVdwSF, RbtInt nSeeds, RbtGenomeList& seeds);
+    // Splits the ligand into rigid fragments and determines the anchor and the growth steps
+    void SetupFragments();
+    // Adds the fragment of one growth step to each pose in the beam, keeping the best grow_beam_width poses.
+    // placed flags the atoms placed by the anchor and the previous growth steps
+    void Grow(
+        const RbtVdwGridSF* pVdwSF, const GrowthStep& step, const vector<RbtBool>& placed, vector<PartialPose>& beam
+    ) const;
+    // Clash penalty between the atoms in newAtoms and the atoms in placed (flagged by index)
+    RbtDouble ClashScore(const RbtCoordList& coords, const RbtUIntList& newAtoms, const vector<RbtBool>& placed)
+        const;
+    // Creates a genome with the ligand atoms at coords, randomising everything else
+    RbtGenome* CreateLigandPoseGenome(RbtChromElement* pChrom, RbtAtomList& ligAtomList, const RbtCoordList& coords);
+    // Adds the final pose and population of the previous run to the archive of diverse poses,
+    // which is rescored with pSF and trimmed to the best nSeeds
+    void UpdateRunArchive(RbtBaseSF* pSF, RbtInt nSeeds);
+    // Matches the ligand to the reference ligand in the template file (once per ligand)
+    void MatchTemplate();
+    // Creates nSeeds genomes whose ligand poses are superimposed onto the matched template atoms
+    void CreateTemplateSeeds(RbtInt nSeeds, RbtGenomeList& seeds);
+    // Index of pAtom in the matched ligand atoms (-1 if not matched)
+    RbtInt FindTemplateAtom(RbtAtom* pAtom) const;
+    // Index of the first matched ligand atom bonded to pAtom, other than pExcludedAtom (-1 if none)
+    RbtInt FindTemplateNeighbour(RbtAtom* pAtom, RbtAtom* pExcludedAtom) const;
+    // Sets the dihedrals of the matched rotatable bonds in the ligand model to the template dihedrals
+    void SetTemplateTorsions();
 
  protected:
     ////////////////////////////////////////
@@ -63,7 +185,31 @@ class RbtRandPopTransform: public RbtBaseBiMolTransform {
     ////////////////////////////////////////
     // Private data
     //////////////
+    // A rotatable ligand bond whose dihedral (atom 1 - bond atom 1 - bond atom 2 - atom 4) is defined
+    // by matched atoms, with the dihedral of the matched template atoms
+    struct TemplateTorsion {
+        RbtBondPtr spBond;
+        RbtAtomPtr spAtom1;
+        RbtAtomPtr spAtom4;
+        RbtDouble dihedral;  // degrees
+    };
+
     RbtChromElementPtr m_chrom;
+    RbtPopulationPtr m_spLastPop;   // Population created by the previous run (evolved in place by the GA)
+    RbtGenomeList m_runArchive;     // Diverse best poses from previous runs, in descending order of score
+    RbtModelPtr m_spTemplate;       // Reference ligand read from the template file
+    RbtBool m_bTemplateMatched;     // True if the current ligand has been matched to the reference ligand
+    RbtAtomList m_templateAtoms;    // Matched ligand atoms
+    RbtCoordList m_templateCoords;  // Reference coords of the matched ligand atoms
+    // Matched rotatable bonds sampled by the chromosome, which take the template dihedrals
+    vector<TemplateTorsion> m_templateTorsions;
+    RbtBool m_bFragmentsSetup;         // True if the current ligand has been split into fragments
+    RbtUIntList m_anchorAtoms;         // Atoms of the anchor fragment (ligand atom list indices)
+    vector<GrowthStep> m_growthSteps;  // Growth steps, in breadth-first order from the anchor
+    vector<RbtBool> m_isHeavy;         // True for ligand heavy atoms
+    // True for ligand atom pairs separated by up to three bonds (excluded from the clash penalty)
+    vector<vector<RbtBool> > m_isNear;
+    RbtRand& m_rand;  // keep a reference to the singleton random number generator
 
     const Config config;
 };
@@ -11,6 +11,10 @@
  ***********************************************************************/
 
 // Manages an array of floats representing a 3-D lattice of grid points
+// The grid values can be stored either in iXYZ order (LINEAR) or in bricks of 4x4x4 grid points (BRICKED).
+// In the bricked layout the 8 grid points used by GetSmoothedValue usually share one or two cache lines,
+// which reduces cache misses when scoring with large grids. The layout only affects the in-memory storage:
+// grid values are still accessed, and written to streams, by iX,iY,iZ or iXYZ index.
 
 #ifndef _RBTREALGRID_H_
 #define _RBTREALGRID_H_
@@ -22,6 +26,9 @@ class RbtRealGrid: public RbtBaseGrid {
     // Class type string
     static RbtString _CT;
 
+    // Storage order of the grid values
+    enum eLayout { LINEAR = 0, BRICKED = 1 };
+
     ////////////////////////////////////////
     // Constructors/destructors
     // Construct a NXxNYxNZ grid running from gridMin at gridStep resolution
@@ -29,8 +36,8 @@ class RbtRealGrid: public RbtBaseGrid {
         const RbtCoord& gridMin, const RbtCoord& gridStep, RbtUInt NX, RbtUInt NY, RbtUInt NZ, RbtUInt NPad = 0
     );
 
-    // Constructor reading all params from binary stream
-    RbtRealGrid(istream& istr);
+    // Constructor reading all params from binary stream, storing the grid values in the given layout
+    RbtRealGrid(istream& istr, eLayout layout = LINEAR);
 
     ~RbtRealGrid();  // Default destructor
 
@@ -62,7 +69,11 @@ class RbtRealGrid: public RbtBaseGrid {
     /////////////////////////
     // Get attribute functions
     /////////////////////////
+    // Raw grid values, in the storage order given by GetLayout() (iXYZ order for LINEAR grids)
     float* GetGridData() const { return m_data; }
+    eLayout GetLayout() const { return m_layout; }
+    // Rearranges the grid values in memory. Grid values are unchanged
+    void SetLayout(eLayout layout);
 
     /////////////////////////
     // Get/Set value functions
@@ -73,24 +84,26 @@ class RbtRealGrid: public RbtBaseGrid {
     void SetTolerance(RbtDouble tol) { m_tol = tol; }
 
     // Get/Set single grid point value with bounds checking
-    RbtDouble GetValue(const RbtCoord& c) const { return isValid(c) ? m_grid[GetIX(c)][GetIY(c)][GetIZ(c)] : 0.0; }
+    RbtDouble GetValue(const RbtCoord& c) const {
+        return isValid(c) ? m_data[DataIndex(GetIX(c), GetIY(c), GetIZ(c))] : 0.0;
+    }
     RbtDouble GetValue(RbtUInt iX, RbtUInt iY, RbtUInt iZ) const {
-        return isValid(iX, iY, iZ) ? m_grid[iX][iY][iZ] : 0.0;
+        return isValid(iX, iY, iZ) ? m_data[DataIndex(iX, iY, iZ)] : 0.0;
     }
-    RbtDouble GetValue(RbtUInt iXYZ) const { return isValid(iXYZ) ? m_data[iXYZ] : 0.0; }
+    RbtDouble GetValue(RbtUInt iXYZ) const { return isValid(iXYZ) ? m_data[DataIndex(iXYZ)] : 0.0; }
 
     // DM 20 Jul 2000 - get values smoothed by trilinear interpolation
     // D. Oberlin and H.A. Scheraga, J. Comp. Chem. (1998) 19, 71.
     RbtDouble GetSmoothedValue(const RbtCoord& c) const;
 
     void SetValue(const RbtCoord& c, RbtDouble val) {
-        if (isValid(c)) m_grid[GetIX(c)][GetIY(c)][GetIZ(c)] = val;
+        if (isValid(c)) m_data[DataIndex(GetIX(c), GetIY(c), GetIZ(c))] = val;
     }
     void SetValue(RbtUInt iX, RbtUInt iY, RbtUInt iZ, RbtDouble val) {
-        if (isValid(iX, iY, iZ)) m_grid[iX][iY][iZ] = val;
+        if (isValid(iX, iY, iZ)) m_data[DataIndex(iX, iY, iZ)] = val;
     }
     void SetValue(RbtUInt iXYZ, RbtDouble val) {
-        if (isValid(iXYZ)) m_data[iXYZ] = val;
+        if (isValid(iXYZ)) m_data[DataIndex(iXYZ)] = val;
     }
 
     // Set all grid points to the given value
@@ -130,6 +143,9 @@ class RbtRealGrid: public RbtBaseGrid {
     void SetAccessible(
         RbtDouble radius, RbtDouble oldVal, RbtDouble adjVal, RbtDouble newVal, RbtBool bCenterOnly = true
     );
+    // Squared distance (in grid steps) from each grid point (by iXYZ index) to the nearest grid point in iXYZList.
+    // Exact (Euclidean) distance transform, with cost linear in the number of grid points
+    void GetSquaredDistances(const RbtUIntList& iXYZList, RbtDoubleList& dist2) const;
 
     /////////////////////////
     // Statistical functions
@@ -147,6 +163,14 @@ class RbtRealGrid: public RbtBaseGrid {
     RbtUInt FindMinValue() const;  // iXYZ index of grid point with minimum value
     RbtUInt FindMaxValue() const;  // iXYZ index of grid point with maximum value
 
+    // Returns a new grid covering the same region with a grid step factor times larger.
+    // Each coarse grid point takes the minimum value of the grid points of this grid that lie within the coarse
+    // grid cells around it (i.e. within factor - 1 grid steps along each axis), rather than the value at the
+    // coinciding grid point. Attractive wells narrower than the coarse grid step are therefore kept, and a wall
+    // never spreads into the pocket next to it. Narrow walls may be lost, so at the coarse grid points the
+    // coarse grid values are lower bounds of the values of this grid.
+    RbtRealGrid* CreateCoarseGrid(RbtUInt factor) const;
+
     /////////////////////////
     // I/O functions
     /////////////////////////
@@ -171,6 +195,14 @@ class RbtRealGrid: public RbtBaseGrid {
     /////////////////
     RbtRealGrid();  // Disable default constructor
 
+    // Position in m_data of the value for the given grid point. No bounds checking
+    RbtUInt DataIndex(RbtUInt iX, RbtUInt iY, RbtUInt iZ) const {
+        return m_xOffset[iX] + m_yOffset[iY] + m_zOffset[iZ];
+    }
+    RbtUInt DataIndex(RbtUInt iXYZ) const {
+        return (m_layout == LINEAR) ? iXYZ : DataIndex(GetIX(iXYZ), GetIY(iXYZ), GetIZ(iXYZ));
+    }
+
     // DM 17 Jul 2000 - analogous to isValueWithinSphere but iterates over arbitrary set
     // of IXYZ indices. Private method as there is no error checking on iXYZ values out of bounds
     RbtBool isValueWithinList(const RbtUIntList& iXYZList, RbtDouble val);
@@ -179,6 +211,12 @@ class RbtRealGrid: public RbtBaseGrid {
     // If bOverwrite is false, does not replace non-zero values
     // If bOverwrite is true, all grid points are set the new value
     void SetValues(const RbtUIntList& iXYZList, RbtDouble val, RbtBool bOverwrite = true);
+    // Squared distance (in grid steps) from each grid point (by iXYZ index) to the nearest grid point within the
+    // pad region with value val (+/- tolerance). Grid points with no such grid point are given a very large value
+    void GetSquaredDistances(RbtDouble val, RbtDoubleList& dist2) const;
+    // Exact squared distance transform of dist2 (indexed by iXYZ), which on entry contains zero at the grid points
+    // to measure from and a very large value elsewhere
+    void TransformSquaredDistances(RbtDoubleList& dist2) const;
 
     void CreateArrays();
     void ClearArrays();
@@ -195,9 +233,14 @@ class RbtRealGrid: public RbtBaseGrid {
     ////////////////////////////////////////
     // Private data
     //////////////
-    float*** m_grid;  // 3-D array, accessed as m_grid[i][j][k], indicies from 1
-    float* m_data;    // 1-D view of same 3-D array, accessed as m_data[i], index from 0
-    RbtDouble m_tol;  // Tolerance for comparing grid values;
+    eLayout m_layout;
+    float* m_store;         // Allocated storage
+    float* m_data;          // Grid values (m_store aligned to a cache line), accessed as m_data[DataIndex(...)]
+    RbtUInt m_size;         // Number of values in m_data, including any unused values at the edges of bricks
+    RbtUIntList m_xOffset;  // Offset in m_data of each iX index, from 1
+    RbtUIntList m_yOffset;  // Offset in m_data of each iY index, from 1
+    RbtUIntList m_zOffset;  // Offset in m_data of each iZ index, from 1
+    RbtDouble m_tol;        // Tolerance for comparing grid values;
 };
 
 // Useful typedefs
@@ -22,6 +22,9 @@ class RbtReceptorFlexData: public RbtFlexData {
     static const RbtString& _FLEX_DISTANCE;
     // Dihedral mutation step length (deg)
     static const RbtString& _DIHEDRAL_STEP;
+    // Spacing of discrete OH/NH3+ rotamers (deg). 0 = continuous sampling (default)
+    // Discrete rotamers allow the scoring functions to precompute the intra-receptor energies
+    static const RbtString& _ROTAMER_STEP;
     RbtReceptorFlexData(RbtDockingSite* pDockSite);
     virtual void Accept(RbtFlexDataVisitor& v) { v.VisitReceptorFlexData(this); }
 
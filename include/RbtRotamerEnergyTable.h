@@ -0,0 +1,94 @@
+/***********************************************************************
+ * The rDock program was developed from 1998 - 2006 by the software team
+ * at RiboTargets (subsequently Vernalis (R&D) Ltd).
+ * In 2006, the software was licensed to the University of York for
+ * maintenance and distribution.
+ * In 2012, Vernalis and the University of York agreed to release the
+ * program as Open Source software.
+ * This version is licensed under GNU-LGPL version 3.0 with support from
+ * the University of Barcelona.
+ * http://rdock.sourceforge.net/
+ ***********************************************************************/
+
+// Precomputed intra-receptor energies for a receptor whose flexible groups
+// (OH/NH3+ rotors) are restricted to discrete rotamers.
+// Each flexible bond defines a group (the atoms rotated by that bond).
+// The table stores:
+//   a) a self energy for each rotamer of each group
+//      (group atoms vs rigid receptor, and vs other atoms in the same group)
+//   b) a pair energy for each rotamer combination of each pair of interacting groups
+// The energy for the current receptor conformation is then a sum of table lookups.
+//
+// As with RbtSolventEnergyMap, the table does not know how to calculate energies.
+// The owning scoring function populates it by placing the groups in each rotamer in turn
+// (PlaceRotamer), scoring them and storing the values (SetSelfEnergy, SetPairEnergy).
+// RbtVdwIdxSF and RbtPolarIdxSF each keep their own table.
+
+#ifndef _RBTROTAMERENERGYTABLE_H_
+#define _RBTROTAMERENERGYTABLE_H_
+
+#include <map>
+
+#include "RbtChromDihedralRefData.h"
+#include "RbtModel.h"
+
+class RbtRotamerEnergyTable {
+ public:
+    // Class type string
+    static RbtString _CT;
+
+    // pModel must be a flexible model. rotamerStep = rotamer spacing (deg)
+    RbtRotamerEnergyTable(RbtModel* pModel, RbtDouble rotamerStep);
+    virtual ~RbtRotamerEnergyTable();
+
+    RbtUInt GetNumGroups() const { return m_groups.size(); }
+    RbtInt GetNumRotamers(RbtUInt iGroup) const { return m_groups[iGroup]->GetNumRotamers(); }
+    const RbtAtomRList& GetGroupAtoms(RbtUInt iGroup) const { return m_groups[iGroup]->GetRotAtoms(); }
+    // Returns the group index for the atom, or -1 if the atom is not in a flexible group
+    RbtInt GetGroup(RbtAtom* pAtom) const;
+
+    ////////////////////////////////////////
+    // Table construction
+    // Moves group iGroup to rotamer iRot
+    void PlaceRotamer(RbtUInt iGroup, RbtInt iRot);
+    void SetSelfEnergy(RbtUInt iGroup, RbtInt iRot, RbtDouble val);
+    // Returns the index of the interacting pair of groups iGroup and jGroup (in either order),
+    // registering the pair first if needed. New pairs are numbered consecutively from zero
+    RbtUInt GetPairIndex(RbtUInt iGroup, RbtUInt jGroup);
+    RbtUInt GetNumPairs() const { return m_pairs.size(); }
+    void GetPair(RbtUInt iPair, RbtUInt& iGroup, RbtUInt& jGroup) const;
+    void SetPairEnergy(RbtUInt iPair, RbtInt iRot, RbtInt jRot, RbtDouble val);
+    // Restores the model coords to those at the time of construction
+    void RestoreModel();
+
+    ////////////////////////////////////////
+    // Table lookup
+    // Returns false if any group is not at one of its tabulated rotamers,
+    // in which case the caller should calculate the energy explicitly
+    RbtBool GetEnergy(RbtDouble& energy) const;
+
+ private:
+    RbtRotamerEnergyTable();                                         // Disable default constructor
+    RbtRotamerEnergyTable(const RbtRotamerEnergyTable&);             // Copy constructor disabled by default
+    RbtRotamerEnergyTable& operator=(const RbtRotamerEnergyTable&);  // Copy assignment disabled by default
+
+    struct RbtRotamerPair {
+        RbtUInt iGroup;
+        RbtUInt jGroup;
+        RbtDoubleList energies;  // iRot * nRot(jGroup) + jRot
+    };
+
+    RbtModel* m_pModel;
+    vector<RbtChromDihedralRefDataPtr> m_groups;  // Dihedral definition and rotated atoms for each group
+    RbtIntList m_atomGroups;                      // Group index for each model atom (indexed by atom ID - 1)
+    RbtCoordList m_initialCoords;                 // Model coords at the time of construction
+    vector<RbtDoubleList> m_selfEnergies;         // Self energy for each rotamer of each group
+    vector<RbtRotamerPair> m_pairs;
+    std::map<std::pair<RbtUInt, RbtUInt>, RbtUInt> m_pairIndex;  // Pair index for each (iGroup < jGroup)
+    mutable RbtIntList m_currentRotamers;  // Scratch list for GetEnergy
+};
+
+// Useful typedefs
+typedef SmartPtr<RbtRotamerEnergyTable> RbtRotamerEnergyTablePtr;  // Smart pointer
+
+#endif  //_RBTROTAMERENERGYTABLE_H_
@@ -18,6 +18,7 @@
 #include "RbtAnnotationHandler.h"
 #include "RbtBaseIdxSF.h"
 #include "RbtBaseInterSF.h"
+#include "RbtCellIndex.h"
 #include "RbtNonBondedHHSGrid.h"
 #include "RbtParameterFileSource.h"
 #include "RbtSATypes.h"
@@ -71,6 +72,8 @@ class RbtSAIdxSF: public RbtBaseInterSF, public RbtBaseIdxSF, public RbtAnnotati
     // Sum the surface energies (ASP*area) for the list of solvation interaction centers
     RbtDouble TotalEnergy(const HHS_SolvationRList& intnCenters) const;
     void Partition(HHS_SolvationRList& intnCenters, RbtDouble dist = 0.0);
+    // Rebuilds the cell index of the enabled solvent interaction centers from the current coordinates
+    void IndexSolvent() const;
 
     HHS_SolvationRList theLSPList;   // All ligand solvation interaction centers
     HHS_SolvationRList theRSPList;   // All rigid receptor solvation interaction centers
@@ -82,6 +85,10 @@ class RbtSAIdxSF: public RbtBaseInterSF, public RbtBaseIdxSF, public RbtAnnotati
     // before updating the overlap of the flexible atoms
     HHS_SolvationRList thePeriphList;
     HHS_SolvationRList theSolventList;  // DM 21 Dec 2005 - explicit solvent interaction centers
+    // Dynamic spatial index of the solvent interaction centers (positions in theSolventList),
+    // rebuilt on each score call. Used for the ligand-solvent and inter-model solvent-solvent interactions
+    mutable RbtCellIndex m_solventIndex;
+    mutable RbtIntList m_nbrIds;  // Scratch list of neighbour positions returned by the index
     RbtNonBondedHHSGridPtr theIdxGrid;
     RbtSolvTable m_solvTable;
     RbtParameterFileSourcePtr m_spSolvSource;  // File source for solvation params
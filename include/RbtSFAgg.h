@@ -79,6 +79,12 @@ class RbtSFAgg: public RbtBaseSF {
     // Protected methods
     ///////////////////
     virtual RbtDouble RawScore() const;
+    // Child terms without a lower bound are evaluated first, then the bounded terms in order.
+    // Evaluation stops as soon as the score so far, plus the lower bounds of the remaining terms,
+    // exceeds maxRawScore
+    virtual RbtDouble BoundedRawScore(RbtDouble maxRawScore) const;
+    // Sum of the child lower bounds (false if any child has no bound)
+    virtual RbtBool RawScoreLowerBound(RbtDouble& lowerBound) const;
 
  private:
     ////////////////////////////////////////
@@ -97,6 +103,10 @@ class RbtSFAgg: public RbtBaseSF {
     // Private data
     //////////////
     RbtBaseSFList m_sf;
+    // Scratch lists for BoundedRawScore
+    mutable RbtDoubleList m_termScores;
+    mutable RbtIntList m_boundedTerms;
+    mutable RbtDoubleList m_remainingBounds;
     RbtInt m_nNonHLigandAtoms;  // for normalised scores (score / non-H ligand atoms)
 };
 
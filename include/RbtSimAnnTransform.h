@@ -43,6 +43,17 @@ class RbtMCStats {
 };
 typedef SmartPtr<RbtMCStats> RbtMCStatsPtr;  // Smart pointer
 
+// Single-gene Monte Carlo move, with its own adaptive step size and selection weight
+struct RbtMCMove {
+    RbtChromElement* pElement;  // Chromosome element to mutate
+    RbtInt iMoveType;           // Move type within the element (see RbtChromElement::MutateMoveType)
+    RbtDouble stepSize;         // Relative step size
+    RbtDouble weight;           // Running average of the acceptance rate, for move selection
+    RbtInt nTrials;             // Trials in the current block
+    RbtInt nAccepted;           // Accepted trials in the current block
+};
+typedef vector<RbtMCMove> RbtMCMoveList;
+
 class RbtSimAnnTransform: public RbtBaseBiMolTransform {
  public:
     // Static data member for class type
@@ -58,6 +69,14 @@ class RbtSimAnnTransform: public RbtBaseBiMolTransform {
     static RbtString _PARTITION_DIST;
     static RbtString _PARTITION_FREQ;
     static RbtString _HISTORY_FREQ;
+    // If true, each trial mutates a single gene (move type), chosen with a probability weighted by
+    // its recent acceptance rate, and each gene has its own step size, adjusted after each block
+    // towards the target acceptance rate. The global step size halving (MIN_ACC_RATE) is not used.
+    static RbtString _ADAPTIVE_MOVES;
+    static RbtString _TARGET_ACC_RATE;
+    // If true, the score of each trial is evaluated with RbtBaseSF::BoundedScore, so that evaluation can be
+    // abandoned as soon as the trial is certain to fail the Metropolis test. The acceptance is the same either way
+    static RbtString _EARLY_STOPPING;
 
     struct Config {
         RbtDouble initial_temp{1000.0};
@@ -70,6 +89,9 @@ class RbtSimAnnTransform: public RbtBaseBiMolTransform {
         RbtDouble partition_distance{0.0};
         RbtInt partition_frequency{0};
         RbtInt history_frequency{0};
+        RbtBool adaptive_moves{false};
+        RbtDouble target_acceptance_rate{0.4};
+        RbtBool early_stopping{true};
     };
 
     static const Config DEFAULT_CONFIG;
@@ -100,6 +122,10 @@ class RbtSimAnnTransform: public RbtBaseBiMolTransform {
     /////////////////
     RbtSimAnnTransform(const RbtSimAnnTransform&);             // Copy constructor disabled by default
     RbtSimAnnTransform& operator=(const RbtSimAnnTransform&);  // Copy assignment disabled by default
+    // Selects a single-gene move by roulette wheel on the move weights
+    RbtMCMove& SelectMove();
+    // Adjusts the step size of each move according to its acceptance rate in the last block
+    void AdaptMoves();
 
  protected:
     ////////////////////////////////////////
@@ -116,6 +142,7 @@ class RbtSimAnnTransform: public RbtBaseBiMolTransform {
     RbtChromElementPtr m_chrom;      // Current chromosome
     RbtDoubleList m_minVector;       // Chromosome vector corresponding to overall minimum score
     RbtDoubleList m_lastGoodVector;  // Saved chromosome before each MC mutation (to allow revert)
+    RbtMCMoveList m_moves;           // Single-gene moves (adaptive mode only)
 
     const Config config;
 };
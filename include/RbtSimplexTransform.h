@@ -16,6 +16,7 @@
 
 #include "RbtBaseBiMolTransform.h"
 #include "RbtChromElement.h"
+#include "RbtNelderMead.h"
 
 class RbtSimplexTransform: public RbtBaseBiMolTransform {
  public:
@@ -75,6 +76,10 @@ class RbtSimplexTransform: public RbtBaseBiMolTransform {
     // Private data
     //////////////
     RbtChromElementPtr m_chrom;
+    // The minimiser and its working vectors persist across cycles and ligands
+    RbtNelderMead m_simplex;
+    RbtDoubleList m_steps;
+    RbtDoubleList m_startPoint;
 
     const Config config;
 };
@@ -0,0 +1,117 @@
+/***********************************************************************
+ * The rDock program was developed from 1998 - 2006 by the software team
+ * at RiboTargets (subsequently Vernalis (R&D) Ltd).
+ * In 2006, the software was licensed to the University of York for
+ * maintenance and distribution.
+ * In 2012, Vernalis and the University of York agreed to release the
+ * program as Open Source software.
+ * This version is licensed under GNU-LGPL version 3.0 with support from
+ * the University of Barcelona.
+ * http://rdock.sourceforge.net/
+ ***********************************************************************/
+
+// Precomputed interaction energy of a single rigid solvent model (e.g. water)
+// with a rigid receptor, tabulated as a function of position (center of mass)
+// and orientation.
+// Positions are stored on a regular grid covering the tethered translation range,
+// orientations as a discrete set covering the tethered (or free) rotation range.
+// Both ranges are centred on the reference pose of the model (the pose which its chromosome is
+// tethered to, i.e. the pose in the docking site), whatever the current pose of the model when
+// the map is constructed.
+// The energy for the current pose is interpolated (trilinear) on the grid of the
+// nearest tabulated orientation.
+//
+// The map does not know how to calculate energies. The owning scoring function
+// populates it by placing the model at each grid point/orientation in turn
+// (PlaceModel), scoring it, and storing the value (SetValue).
+// Models with free translation, rotatable bonds, or fewer than three non-collinear
+// atoms can not be mapped (isValid() returns false).
+
+#ifndef _RBTSOLVENTENERGYMAP_H_
+#define _RBTSOLVENTENERGYMAP_H_
+
+#include "RbtChromElement.h"
+#include "RbtFlexDataVisitor.h"
+#include "RbtModel.h"
+#include "RbtQuat.h"
+#include "RbtRealGrid.h"
+
+class RbtSolventEnergyMap: public RbtFlexDataVisitor {
+ public:
+    // Class type string
+    static RbtString _CT;
+
+    // gridStep = translational grid spacing (A)
+    // nOrientations = max number of orientations to tabulate (tethered or free rotation only)
+    RbtSolventEnergyMap(RbtModel* pModel, RbtDouble gridStep, RbtInt nOrientations);
+    virtual ~RbtSolventEnergyMap();
+
+    RbtModel* GetModel() const { return m_pModel; }
+    RbtBool isValid() const { return m_bValid; }
+    RbtUInt GetNumOrientations() const { return m_orientations.size(); }
+    // Number of tabulated positions per orientation
+    RbtUInt GetNumPositions() const;
+
+    ////////////////////////////////////////
+    // Map construction
+    // Moves the model to the given orientation and grid point (pseudoatoms are updated)
+    // The model is enabled, regardless of its occupancy, until RestoreModel is called
+    void PlaceModel(RbtUInt iOrient, RbtUInt iXYZ);
+    void SetValue(RbtUInt iOrient, RbtUInt iXYZ, RbtDouble val);
+    // Restores the model coords, occupancy and enabled state to those at the time of construction
+    void RestoreModel();
+
+    ////////////////////////////////////////
+    // Map lookup
+    // Returns false if the current pose of the model lies outside the tabulated range,
+    // in which case the caller should calculate the energy explicitly
+    RbtBool GetEnergy(RbtDouble& energy) const;
+
+    // Flexibility data visitor methods, for retrieving the sampling modes and tethered ranges
+    virtual void VisitReceptorFlexData(RbtReceptorFlexData* pFlexData);
+    virtual void VisitLigandFlexData(RbtLigandFlexData* pFlexData);
+    virtual void VisitSolventFlexData(RbtSolventFlexData* pFlexData);
+
+ private:
+    RbtSolventEnergyMap();                                       // Disable default constructor
+    RbtSolventEnergyMap(const RbtSolventEnergyMap&);             // Copy constructor disabled by default
+    RbtSolventEnergyMap& operator=(const RbtSolventEnergyMap&);  // Copy assignment disabled by default
+
+    RbtCoord GetCenterOfMass() const;
+    // Moves the model to its reference pose, by resetting a copy of its chromosome
+    void ResetModel();
+    // Orthonormal frame defined by the first three atoms (returns false if collinear)
+    RbtBool GetFrame(RbtVector& ax, RbtVector& ay, RbtVector& az) const;
+    void CreateOrientations(RbtInt nOrientations);
+
+    RbtModel* m_pModel;
+    RbtAtomRList m_atomList;
+    RbtDoubleList m_masses;
+    RbtDouble m_totalMass;
+    RbtCoordList m_savedCoords;    // Atom coords at the time of construction
+    RbtDouble m_savedOccupancy;    // Occupancy at the time of construction
+    RbtCoordList m_initialCoords;  // Atom coords of the reference pose
+    RbtCoord m_initialCOM;         // Center of mass of the reference pose
+    RbtBool m_bInitialEnabled;
+    RbtBool m_bValid;
+    RbtChromElement::eMode m_transMode;
+    RbtChromElement::eMode m_rotMode;
+    RbtDouble m_maxTrans;            // Tethered translation range (A)
+    RbtDouble m_maxRot;              // Tethered rotation range (radians)
+    RbtBool m_bFixedTrans;           // If true, a single position (the initial COM) is tabulated
+    RbtQuatList m_orientations;      // Rotations relative to the initial orientation
+    RbtCoordList m_orientFrames;     // Frame axes for each orientation (3 per orientation)
+    RbtDouble m_cosMaxOrientError;   // cos of the max allowed angle between the model and the nearest orientation
+    RbtRealGridList m_grids;         // One grid per orientation
+    RbtCoord m_minCoord;             // Range of positions which can be interpolated
+    RbtCoord m_maxCoord;
+    RbtDoubleList m_fixedValues;  // One value per orientation, for fixed translation
+};
+
+// Useful typedefs
+typedef SmartPtr<RbtSolventEnergyMap> RbtSolventEnergyMapPtr;  // Smart pointer
+typedef vector<RbtSolventEnergyMapPtr> RbtSolventEnergyMapList;
+typedef RbtSolventEnergyMapList::iterator RbtSolventEnergyMapListIter;
+typedef RbtSolventEnergyMapList::const_iterator RbtSolventEnergyMapListConstIter;
+
+#endif  //_RBTSOLVENTENERGYMAP_H_
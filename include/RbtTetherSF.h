@@ -32,6 +32,11 @@ class RbtTetherSF: public RbtBaseInterSF {
     virtual void SetupLigand();
     virtual void SetupScore();
     virtual RbtDouble RawScore() const;
+    // Sum of squared displacements is never negative
+    virtual RbtBool RawScoreLowerBound(RbtDouble& lowerBound) const {
+        lowerBound = 0.0;
+        return true;
+    }
     // DM 25 Oct 2000 - track changes to parameter values in local data members
     // ParameterUpdated is invoked by RbtParamHandler::SetParameter
     void ParameterUpdated(const RbtString& strName);
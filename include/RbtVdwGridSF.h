@@ -11,6 +11,15 @@
  ***********************************************************************/
 
 // Precalculated-grid-based intermolecular vdw scoring function
+// If GRID_SF is defined, grids for ligand atom types missing from the grid file are calculated
+// on first use, with the scoring function in GRID_SF (e.g. calcgrid_vdw1.prm, as used by rbcalcgrid).
+// The grid file itself may then be missing. If SAVE_GRIDS is true, the augmented grid set is
+// written back to the grid file, or to the current directory if the grid file's directory is not writable.
+// GRID_LEVEL selects a coarser copy of the grids for scoring (grid step multiplied by 2^GRID_LEVEL),
+// so that early protocol stages can trade accuracy for memory traffic, e.g. GRID_LEVEL@SCORE.INTER.VDW
+// in an RbtNullTransform section. Coarse grids are created from the grids read on first use.
+// BRICKED_GRIDS stores the grids in cache-blocked order (see RbtRealGrid), which speeds up scoring
+// with large grids. It does not change the scores or the grid file format.
 
 #ifndef _RBTVDWGRIDSF_H_
 #define _RBTVDWGRIDSF_H_
@@ -18,23 +27,48 @@
 #include "RbtBaseInterSF.h"
 #include "RbtRealGrid.h"
 
+class RbtBiMolWorkSpace;  // forward declaration
+
 class RbtVdwGridSF: public RbtBaseInterSF {
  public:
     // Class type string
     static RbtString _CT;
     // Parameter names
-    static RbtString _GRID;      // Suffix for grid filename
-    static RbtString _SMOOTHED;  // Controls whether to smooth the grid values
+    static RbtString _GRID;           // Suffix for grid filename
+    static RbtString _SMOOTHED;       // Controls whether to smooth the grid values
+    static RbtString _GRID_SF;        // Scoring function file for calculating missing grids (empty = disabled)
+    static RbtString _SAVE_GRIDS;     // Controls whether calculated grids are written back to the grid file
+    static RbtString _GRID_STEP;      // Grid step, if there is no grid file
+    static RbtString _GRID_BORDER;    // Grid border around the docking site, if there is no grid file
+    static RbtString _GRID_LEVEL;     // Grid resolution level (0 = as read, n = grid step x 2^n)
+    static RbtString _BRICKED_GRIDS;  // Controls whether the grids are stored in bricked layout
 
     RbtVdwGridSF(const RbtString& strName = "VDW");
     virtual ~RbtVdwGridSF();
 
+    // Raw score for the ligand atoms placed at ligCoords (in ligand atom list order)
+    // rather than at their current coords. Allows rigid body scans without moving the ligand.
+    RbtDouble RawScore(const RbtCoordList& ligCoords) const;
+    // As above, but only the ligand atoms with the given indices are scored (e.g. for partially built poses)
+    RbtDouble RawScore(const RbtCoordList& ligCoords, const RbtUIntList& atomIndices) const;
+
+    // Creates a single atom probe model of the given atom type
+    static RbtModelPtr CreateProbe(RbtTriposAtomType::eType aType);
+    // Fills grid with the score of the probe at each grid point, using the scoring function registered with
+    // pWorkSpace. The probe is registered with pWorkSpace as the ligand.
+    static void CalculateProbeGrid(RbtBiMolWorkSpace* pWorkSpace, RbtModelPtr spProbe, RbtRealGrid* pGrid);
+
  protected:
     virtual void SetupReceptor();
     virtual void SetupLigand();
     virtual void SetupSolvent();
     virtual void SetupScore();
     virtual RbtDouble RawScore() const;
+    // Sum over ligand atoms of the minimum value in the corresponding grid
+    virtual RbtBool RawScoreLowerBound(RbtDouble& lowerBound) const {
+        lowerBound = m_lowerBound;
+        return true;
+    }
     // DM 25 Oct 2000 - track changes to parameter values in local data members
     // ParameterUpdated is invoked by RbtParamHandler::SetParameter
     void ParameterUpdated(const RbtString& strName);
@@ -42,11 +76,33 @@ class RbtVdwGridSF: public RbtBaseInterSF {
  private:
     // Read grids from input stream
     void ReadGrids(istream& istr);
+    // Write grids to output stream, in the format read by ReadGrids
+    void WriteGrids(ostream& ostr) const;
+    // Calculates the grids for the given atom types with the GRID_SF scoring function
+    void CalculateGrids(const RbtTriposAtomTypeList& atomTypes);
+    // Writes the grids to the grid file, or to the current directory if that fails
+    void SaveGrids() const;
+    // Writes the grids to a uniquely named temporary file in the same directory as strFile, which then
+    // replaces strFile. Returns false if the temporary file could not be created or renamed
+    RbtBool WriteGridFile(const RbtString& strFile) const;
+    // Returns an empty grid with the same dimensions as the existing grids,
+    // or covering the docking site if there are none
+    RbtRealGridPtr CreateEmptyGrid() const;
+    // Updates m_activeGrids for the current grid level, creating the coarse grids as required
+    void SelectGridLevel();
+    // Storage layout for the grids, as given by BRICKED_GRIDS
+    RbtRealGrid::eLayout GetGridLayout() const;
 
-    RbtRealGridList m_grids;
+    RbtRealGridList m_grids;                // Grids at the resolution read (or calculated)
+    vector<RbtRealGridList> m_coarseGrids;  // Coarse grids for each level > 0, created on first use
+    RbtRealGridList m_activeGrids;          // Grids used for scoring (m_grids, or coarse grids)
+    RbtInt m_gridLevel;                     // synchronised with GRID_LEVEL named parameter
+    RbtDoubleList m_gridMinValues;  // Min value in each grid (or zero if greater), for the lower bound
+    RbtDouble m_lowerBound;
     RbtAtomRList m_ligAtomList;
     RbtTriposAtomTypeList m_ligAtomTypes;
     RbtBool m_bSmoothed;
+    RbtString m_strGridFile;  // Grid file read by SetupReceptor (and written by SaveGrids)
 };
 
 #endif  //_RBTVDWGRIDSF_H_
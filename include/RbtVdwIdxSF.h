@@ -16,6 +16,8 @@
 
 #include "RbtBaseIdxSF.h"
 #include "RbtBaseInterSF.h"
+#include "RbtCellIndex.h"
+#include "RbtRotamerEnergyTable.h"
 #include "RbtVdwSF.h"
 
 class RbtVdwIdxSF: public RbtBaseInterSF, public RbtBaseIdxSF, public RbtVdwSF {
@@ -57,9 +59,22 @@ class RbtVdwIdxSF: public RbtBaseInterSF, public RbtBaseIdxSF, public RbtVdwSF {
     // DM 25 Oct 2000 - track changes to parameter values in local data members
     // ParameterUpdated is invoked by RbtParamHandler::SetParameter
     void ParameterUpdated(const RbtString& strName);
+    // The vdW potential parameters change the receptor-solvent energy
+    virtual RbtBool isSolventMapParameter(const RbtString& strName) const;
 
  private:
     void RenderAnnotationsByResidue(RbtStringList& retVal) const;
+    // Rebuild the dynamic cell indexes from the current coordinates
+    void IndexLigand() const;
+    void IndexFreeSolvent() const;
+    // Receptor-solvent score for a single solvent model (no check on enabled state)
+    RbtDouble ReceptorSolventScore(const RbtAtomRList& atomList) const;
+    // Populates the receptor-solvent energy maps (if enabled)
+    // Called lazily from ReceptorSolventScore, as the maps must be rebuilt whenever the energy parameters change
+    void BuildSolventMaps() const;
+    // Populates the intra-receptor rotamer energy table (if discrete receptor rotamers are enabled)
+    // Called lazily from ReceptorScore, for the same reason
+    void BuildRotamerTable() const;
 
     RbtNonBondedGridPtr m_spGrid;         // Indexing grid for receptor
     RbtNonBondedGridPtr m_spSolventGrid;  // Indexing grid for fixed/tethered solvent
@@ -75,6 +90,16 @@ class RbtVdwIdxSF: public RbtBaseInterSF, public RbtBaseIdxSF, public RbtVdwSF {
     RbtAtomRListList m_solventFixTethIntns;     // Intra-solvent intns between fixed/tethered atoms
     RbtAtomRListList m_solventFixTethPrtIntns;  // Partitioned intns between fixed/tethered solvent
     RbtAtomRListList m_solventFreeIntns;        // Intra-solvent intns between free solvent atoms
+    RbtAtomRListList m_solventModelAtomLists;   // Solvent atoms for each solvent model
+    mutable RbtSolventEnergyMapList m_solventMaps;  // Receptor-solvent energy map for each solvent model (may be null)
+    mutable RbtBool m_bSolventMapsDirty;            // Maps need to be rebuilt before next use
+    mutable RbtRotamerEnergyTablePtr m_spRotamerTable;  // Intra-receptor energies for discrete rotamers (may be null)
+    mutable RbtBool m_bRotamerTableDirty;               // Table needs to be rebuilt before next use
+    // Dynamic spatial indexes for the free solvent and ligand atoms, rebuilt on each score call
+    mutable RbtCellIndex m_ligIndex;          // Ligand atoms (positions in m_ligAtomList)
+    mutable RbtCellIndex m_solventFreeIndex;  // Enabled free solvent atoms (positions in m_solventFreeAtomList)
+    mutable RbtIntList m_nbrIds;              // Scratch list of neighbour positions returned by the indexes
+    mutable RbtAtomRList m_nbrAtoms;          // Scratch list of neighbour atoms passed to VdwScore
     // DM 12 Jun 2002 - keep track of number of ligand atoms involved in non-zero vdW interactions
     mutable RbtInt m_nAttr;  //#atoms with net attractive (-ve) vdw scores
     mutable RbtInt m_nRep;   //#atoms with net repulsive (+ve) vdw scores
@@ -10,26 +10,32 @@
  * http://rdock.sourceforge.net/
  ***********************************************************************/
 
-// Calculates vdW grids for use by RbtVdwGridSF scoring function class
+// Calculates vdW grids for use by RbtVdwGridSF scoring function class,
+// or polar grids for use by RbtPolarGridSF scoring function class (-P)
 
+#include <algorithm>
 #include <cstring>
 #include <fstream>
 #include <iomanip>
 
 #include "RbtBiMolWorkSpace.h"
+#include "RbtFileError.h"
 #include "RbtPRMFactory.h"
 #include "RbtParameterFileSource.h"
+#include "RbtPolarGridSF.h"
 #include "RbtRealGrid.h"
 #include "RbtSFFactory.h"
 #include "RbtTriposAtomType.h"
+#include "RbtVdwGridSF.h"
 #include "RbtVersion.h"
 
 const RbtString EXEVERSION = RBT_VERSION;
 const RbtString _ROOT_SF = "SCORE";
 
 // Creates list of probe models
+// If strTypes is not empty, only the (comma-separated) atom types listed are included
 // NOTE: MUST BE IN ORDER OF ASCENDING RADII
-RbtModelList CreateProbes() {
+RbtModelList CreateProbes(const RbtString& strTypes) {
     RbtModelList probes;
     RbtTriposAtomTypeList atomTypes;
     atomTypes.push_back(RbtTriposAtomType::UNDEFINED);
@@ -66,18 +72,198 @@ RbtModelList CreateProbes() {
     atomTypes.push_back(RbtTriposAtomType::S_3);
     atomTypes.push_back(RbtTriposAtomType::S_o);
     atomTypes.push_back(RbtTriposAtomType::S_o2);
+    RbtStringList typeNames = Rbt::ConvertDelimitedStringToList(strTypes, ",");
+    RbtTriposAtomType triposType;
+    for (RbtStringListConstIter iter = typeNames.begin(); iter != typeNames.end(); iter++) {
+        RbtTriposAtomType::eType aType = triposType.Str2Type(*iter);
+        if (std::find(atomTypes.begin(), atomTypes.end(), aType) == atomTypes.end()
+            || (triposType.Type2Str(aType) != *iter)) {
+            throw RbtBadArgument(_WHERE_, "Unknown probe atom type: " + *iter);
+        }
+    }
     for (RbtTriposAtomTypeListConstIter iter = atomTypes.begin(); iter != atomTypes.end(); iter++) {
-        RbtAtomList atomList;
-        RbtBondList bondList;
-        RbtAtomPtr spAtom(new RbtAtom(1));
-        spAtom->SetTriposType(*iter);
-        spAtom->SetAtomicMass(12.0);  // Mass is irrelevant as we are not rotating models around COM
-        atomList.push_back(spAtom);
-        probes.push_back(new RbtModel(atomList, bondList));
+        if (typeNames.empty()
+            || (std::find(typeNames.begin(), typeNames.end(), triposType.Type2Str(*iter)) != typeNames.end())) {
+            probes.push_back(RbtVdwGridSF::CreateProbe(*iter));
+        }
     }
     return probes;
 }
 
+// Creates list of polar probe names
+// If strTypes is not empty, only the (comma-separated) probes listed are included
+RbtStringList CreatePolarProbes(const RbtString& strTypes) {
+    RbtStringList probeNames;
+    if (strTypes.empty()) {
+        // Ligand polar hydrogen, acceptor (O, N, sp3 O and N with implicit H, S), guanidinium carbon and
+        // metal (Zn, Mg, Ca, Na/K) vdW radii
+        probeNames.push_back(RbtPolarGridSF::GetProbeName(RbtPolarGridSF::HBD, 0.5));
+        probeNames.push_back(RbtPolarGridSF::GetProbeName(RbtPolarGridSF::HBA, 1.35));
+        probeNames.push_back(RbtPolarGridSF::GetProbeName(RbtPolarGridSF::HBA, 1.4));
+        probeNames.push_back(RbtPolarGridSF::GetProbeName(RbtPolarGridSF::HBA, 1.65));
+        probeNames.push_back(RbtPolarGridSF::GetProbeName(RbtPolarGridSF::HBA, 1.7));
+        probeNames.push_back(RbtPolarGridSF::GetProbeName(RbtPolarGridSF::HBA, 1.81));
+        probeNames.push_back(RbtPolarGridSF::GetProbeName(RbtPolarGridSF::GUAN, 1.55));
+        probeNames.push_back(RbtPolarGridSF::GetProbeName(RbtPolarGridSF::METAL, 0.7));
+        probeNames.push_back(RbtPolarGridSF::GetProbeName(RbtPolarGridSF::METAL, 0.74));
+        probeNames.push_back(RbtPolarGridSF::GetProbeName(RbtPolarGridSF::METAL, 1.09));
+        probeNames.push_back(RbtPolarGridSF::GetProbeName(RbtPolarGridSF::METAL, 1.2));
+        return probeNames;
+    }
+    // Convert each probe name to the standard form (e.g. HBA_1.4 to HBA_1.40), as used by RbtPolarGridSF
+    RbtStringList typeNames = Rbt::ConvertDelimitedStringToList(strTypes, ",");
+    for (RbtStringListConstIter iter = typeNames.begin(); iter != typeNames.end(); iter++) {
+        RbtPolarGridSF::eProbeClass probeClass;
+        RbtDouble radius;
+        RbtPolarGridSF::ParseProbeName(*iter, probeClass, radius);
+        probeNames.push_back(RbtPolarGridSF::GetProbeName(probeClass, radius));
+    }
+    return probeNames;
+}
+
+// Creates the receptor model from the file names in a receptor parameter file
+RbtModelPtr CreateReceptor(const RbtString& strReceptorPrmFile) {
+    RbtParameterFileSourcePtr spRecepPrmSource(
+        new RbtParameterFileSource(Rbt::GetRbtFileName("data/receptors", strReceptorPrmFile))
+    );
+    spRecepPrmSource->SetSection();
+    RbtPRMFactory prmFactory(spRecepPrmSource);
+    return prmFactory.CreateReceptor();
+}
+
+// Reads a grid file written by rbcalcgrid, returning the grids indexed by atom type
+RbtRealGridList ReadGrids(const RbtString& strGridFile) {
+    ifstream istr(strGridFile.c_str(), ios_base::in | ios_base::binary);
+    if (!istr) {
+        throw RbtFileReadError(_WHERE_, "Unable to open " + strGridFile);
+    }
+    RbtInt length;
+    Rbt::ReadWithThrow(istr, (char*)&length, sizeof(length));
+    RbtString header(length, ' ');
+    Rbt::ReadWithThrow(istr, &header[0], length);
+    if (header != RbtVdwGridSF::_CT) {
+        throw RbtFileParseError(_WHERE_, "Invalid title string in " + strGridFile);
+    }
+    RbtInt nGrids;
+    Rbt::ReadWithThrow(istr, (char*)&nGrids, sizeof(nGrids));
+    RbtRealGridList grids(RbtTriposAtomType::MAXTYPES);
+    RbtTriposAtomType triposType;
+    for (RbtInt i = 0; i < nGrids; i++) {
+        Rbt::ReadWithThrow(istr, (char*)&length, sizeof(length));
+        RbtString strType(length, ' ');
+        Rbt::ReadWithThrow(istr, &strType[0], length);
+        grids[triposType.Str2Type(strType)] = new RbtRealGrid(istr);
+    }
+    return grids;
+}
+
+// Returns the longest interaction range of the scoring functions in an aggregate
+RbtDouble GetMaxRange(RbtBaseSF* pSF) {
+    if (!pSF->isAgg()) {
+        return pSF->GetRange();
+    }
+    RbtDouble range = 0.0;
+    for (RbtUInt i = 0; i < pSF->GetNumSF(); i++) {
+        range = std::max(range, GetMaxRange(pSF->GetSF(i)));
+    }
+    return range;
+}
+
+// Returns a grid of the same dimensions as grid, set to 1 at the grid points whose scores may differ between the
+// receptor and reference receptor conformations (those within range of any receptor atom that has moved by more
+// than tolerance, in either conformation) and 0 elsewhere
+RbtRealGridPtr FindChangedRegion(
+    const RbtBaseGrid& grid, RbtModelPtr spReceptor, RbtModelPtr spRefReceptor, RbtDouble tolerance, RbtDouble range
+) {
+    RbtAtomList atomList = spReceptor->GetAtomList();
+    RbtAtomList refAtomList = spRefReceptor->GetAtomList();
+    if (atomList.size() != refAtomList.size()) {
+        throw RbtBadArgument(_WHERE_, "Receptor and reference receptor have different numbers of atoms");
+    }
+    // Atoms are matched by their position in the atom lists, so the atoms (segment, residue and atom names)
+    // must be listed in the same order
+    for (RbtUInt i = 0; i < atomList.size(); i++) {
+        RbtString strAtom = atomList[i]->GetFullAtomName();
+        RbtString strRefAtom = refAtomList[i]->GetFullAtomName();
+        if (strAtom != strRefAtom) {
+            throw RbtBadArgument(
+                _WHERE_, "Receptor atom " + strAtom + " does not match reference receptor atom " + strRefAtom
+            );
+        }
+    }
+    RbtRealGridPtr spChanged(new RbtRealGrid(grid));
+    RbtInt nMoved = 0;
+    for (RbtUInt i = 0; i < atomList.size(); i++) {
+        const RbtCoord& c = atomList[i]->GetCoords();
+        const RbtCoord& refC = refAtomList[i]->GetCoords();
+        if (Rbt::Length(c, refC) > tolerance) {
+            spChanged->SetSphere(c, range, 1.0);
+            spChanged->SetSphere(refC, range, 1.0);
+            nMoved++;
+        }
+    }
+    cout << nMoved << " receptor atoms moved by more than " << tolerance << " A; " << spChanged->Count(1.0)
+         << " grid points to recalculate" << endl;
+    return spChanged;
+}
+
+// Copies the reference grid values for grid points outside the changed region,
+// and calculates the values for the remaining grid points
+void UpdateProbeGrid(
+    RbtBiMolWorkSpace* pWorkSpace, RbtModelPtr spProbe, RbtRealGrid* pGrid, const RbtRealGrid* pRefGrid,
+    const RbtRealGrid* pChanged
+) {
+    pWorkSpace->SetLigand(spProbe);
+    RbtBaseSF* pSF = pWorkSpace->GetSF();
+    RbtAtom* pAtom = spProbe->GetAtomList().front();
+    for (RbtUInt i = 0; i < pGrid->GetN(); i++) {
+        RbtCoord c = pGrid->GetCoord(i);
+        if ((pChanged->GetValue(i) == 0.0) && pRefGrid->isValid(c)) {
+            pGrid->SetValue(i, pRefGrid->GetValue(c));
+        } else {
+            pAtom->SetCoords(c);
+            pGrid->SetValue(i, pSF->Score());
+        }
+    }
+}
+
+// Calculates the polar grids for each probe and writes them to ostr, in the format read by RbtPolarGridSF.
+// Directional probes have a grid for each of nDirections probe directions
+void WritePolarGrids(
+    RbtBiMolWorkSpace* pWorkSpace, const RbtStringList& probeNames, RbtInt nDirections, RbtRealGrid* pGrid,
+    ostream& ostr
+) {
+    // Write header string (RbtPolarGridSF)
+    RbtInt length = RbtPolarGridSF::_CT.size();
+    Rbt::WriteWithThrow(ostr, (const char*)&length, sizeof(length));
+    Rbt::WriteWithThrow(ostr, RbtPolarGridSF::_CT.c_str(), length);
+    // Write number of probes
+    RbtInt nProbes = probeNames.size();
+    Rbt::WriteWithThrow(ostr, (const char*)&nProbes, sizeof(nProbes));
+
+    RbtCoordList directions = RbtPolarGridSF::CreateProbeDirections(nDirections);
+    RbtCoordList noDirections(1, RbtCoord(0.0, 0.0, 1.0));
+    for (RbtStringListConstIter iter = probeNames.begin(); iter != probeNames.end(); iter++) {
+        RbtPolarGridSF::eProbeClass probeClass;
+        RbtDouble radius;
+        RbtPolarGridSF::ParseProbeName(*iter, probeClass, radius);
+        const RbtCoordList& probeDirections =
+            RbtPolarGridSF::isDirectional(pWorkSpace, probeClass) ? directions : noDirections;
+        cout << "Probe=" << *iter << " (" << probeDirections.size() << " directions)" << endl;
+        // Write the probe name and number of directions, then the direction and grid for each direction
+        RbtInt l = iter->size();
+        Rbt::WriteWithThrow(ostr, (const char*)&l, sizeof(l));
+        Rbt::WriteWithThrow(ostr, iter->c_str(), l);
+        RbtInt n = probeDirections.size();
+        Rbt::WriteWithThrow(ostr, (const char*)&n, sizeof(n));
+        for (RbtCoordListConstIter dIter = probeDirections.begin(); dIter != probeDirections.end(); dIter++) {
+            RbtPolarGridSF::CalculateProbeGrid(pWorkSpace, *iter, *dIter, pGrid);
+            dIter->Write(ostr);
+            pGrid->Write(ostr);
+        }
+    }
+}
+
 /////////////////////////////////////////////////////////////////////
 // MAIN PROGRAM STARTS HERE
 /////////////////////////////////////////////////////////////////////
@@ -96,13 +282,18 @@ int main(int argc, char* argv[]) {
     // Command line arguments and default values
     RbtString strSuffix(".grd");
     RbtString strReceptorPrmFile;              // Receptor param file
-    RbtString strSFFile("calcgrid_attr.prm");  // Scoring function file
+    RbtString strSFFile;                       // Scoring function file (empty = default for vdW or polar grids)
     RbtDouble gs(0.5);                         // grid step
     RbtDouble border(1.0);                     // grid border around docking site
+    RbtString strTypes;                        // probe atom types to calculate (empty = all)
+    RbtString strRefPrmFile;                   // Reference receptor param file (empty = calculate all grid points)
+    RbtDouble tolerance(0.1);                  // Receptor atom displacement tolerance for incremental mode
+    RbtBool bPolar(false);                     // Calculate polar grids for RbtPolarGridSF instead of vdW grids
+    RbtInt nDirections(32);                    // Number of probe directions for directional polar probes
 
     // Brief help message
     if (argc == 1) {
-        cout << endl << "rbcalcgrid - calculates vdw grids for each atom type" << endl;
+        cout << endl << "rbcalcgrid - calculates vdw grids for each atom type, or polar grids (-P)" << endl;
         cout << endl << "Usage:\trbcalcgrid -o<OutputRoot> -r<ReceptorPrmFile> -p<SFPrmFile> [-g<GridStep>]" << endl;
         cout << endl << "Options:\t-o<OutputSuffix> - suffix for grid (.grd IS required)" << endl;
         cout << "\t\t-r<ReceptorPrmFile> - receptor param file (contains active site params)" << endl;
@@ -110,6 +301,14 @@ int main(int argc, char* argv[]) {
              << endl;
         cout << "\t\t-g<GridStep> - grid step (default=0.5A)" << endl;
         cout << "\t\t-b<Border> - grid border around docking site (default=1.0A)" << endl;
+        cout << "\t\t-t<Types> - comma-separated list of atom types to calculate (default=all)" << endl;
+        cout << "\t\t-R<RefReceptorPrmFile> - reference conformation of the same receptor. Grid values are copied"
+             << endl;
+        cout << "\t\t\tfrom the reference grids, and only recalculated near receptor atoms that have moved" << endl;
+        cout << "\t\t-d<Tolerance> - receptor atom displacement tolerance for -R (default=0.1A)" << endl;
+        cout << "\t\t-P - calculate polar grids for RbtPolarGridSF (default SF file calcgrid_polar.prm)" << endl;
+        cout << "\t\t\t-t<Types> is then a list of probes, e.g. HBD_0.50,HBA_1.35,METAL_0.70,GUAN_1.55" << endl;
+        cout << "\t\t-n<NumDirections> - number of directions for directional polar probes (default=32)" << endl;
         return 1;
     }
 
@@ -130,6 +329,18 @@ int main(int argc, char* argv[]) {
         } else if (strArg.find("-b") == 0) {
             RbtString strBorder = strArg.substr(2);
             border = atof(strBorder.c_str());
+        } else if (strArg.find("-t") == 0) {
+            strTypes = strArg.substr(2);
+        } else if (strArg.find("-R") == 0) {
+            strRefPrmFile = strArg.substr(2);
+        } else if (strArg.find("-d") == 0) {
+            RbtString strTolerance = strArg.substr(2);
+            tolerance = atof(strTolerance.c_str());
+        } else if (strArg == "-P") {
+            bPolar = true;
+        } else if (strArg.find("-n") == 0) {
+            RbtString strDirections = strArg.substr(2);
+            nDirections = atoi(strDirections.c_str());
         } else {
             cout << " ** INVALID ARGUMENT" << endl;
             return 1;
@@ -139,7 +350,18 @@ int main(int argc, char* argv[]) {
 
     cout << endl;
 
+    if (strSFFile.empty()) {
+        strSFFile = (bPolar) ? "calcgrid_polar.prm" : "calcgrid_attr.prm";
+    }
+
     try {
+        if (bPolar && !strRefPrmFile.empty()) {
+            throw RbtBadArgument(_WHERE_, "Incremental mode (-R) is not supported for polar grids (-P)");
+        }
+        if (bPolar && (nDirections < 1)) {
+            throw RbtBadArgument(_WHERE_, "Number of probe directions (-n) must be at least 1");
+        }
+
         // Create a bimolecular workspace
         RbtBiMolWorkSpacePtr spWS(new RbtBiMolWorkSpace());
         // Set the workspace name to the root of the receptor .prm filename
@@ -204,10 +426,6 @@ int main(int argc, char* argv[]) {
         RbtUInt nZ = int(recepExtent.z / gridStep.z) + 1;
         cout << "Constructing grid of size " << nX << " x " << nY << " x " << nZ << endl;
         RbtRealGridPtr spGrid(new RbtRealGrid(minCoord, gridStep, nX, nY, nZ));
-        float* gridData = spGrid->GetGridData();
-
-        // Create probes
-        RbtModelList probes = CreateProbes();
 
         // Open output file
         RbtString strOutputFile(spWS->GetName() + strSuffix);
@@ -216,40 +434,62 @@ int main(int argc, char* argv[]) {
 #else
         ofstream ostr(strOutputFile.c_str(), ios_base::out | ios_base::binary | ios_base::trunc);
 #endif
-        // Write header string (RbtVdwGridSF)
-        const char* const header = "RbtVdwGridSF";
-        RbtInt length = strlen(header);
-        Rbt::WriteWithThrow(ostr, (const char*)&length, sizeof(length));
-        Rbt::WriteWithThrow(ostr, header, length);
-        // Write number of grids
-        RbtInt nGrids = probes.size();
-        Rbt::WriteWithThrow(ostr, (const char*)&nGrids, sizeof(nGrids));
-
-        // Store regular pointers to avoid smart pointer dereferencing overheads
-        RbtRealGrid* pGrid(spGrid);
-        RbtSFAgg* pSF(spSF);
-        RbtTriposAtomType triposType;
-        // Main loop over each probe model
-        for (RbtModelListConstIter mIter = probes.begin(); mIter != probes.end(); mIter++) {
-            RbtModelPtr spLigand(*mIter);
-            RbtAtom* pAtom = spLigand->GetAtomList().front();
-            RbtTriposAtomType::eType atomType = pAtom->GetTriposType();
-            RbtString strType = triposType.Type2Str(atomType);
-            cout << "Atom type=" << strType << endl;
-            // Register ligand with workspace
-            spWS->SetLigand(spLigand);
-            pGrid->SetAllValues(0.0);
-            // Loop over all grid coords and calculate the score at each position
-            for (RbtUInt i = 0; i < spGrid->GetN(); i++) {
-                pAtom->SetCoords(pGrid->GetCoord(i));
-                gridData[i] = pSF->Score();
+
+        if (bPolar) {
+            // Polar mode: calculate the grids for RbtPolarGridSF
+            WritePolarGrids(spWS, CreatePolarProbes(strTypes), nDirections, spGrid, ostr);
+        } else {
+            // Create probes
+            RbtModelList probes = CreateProbes(strTypes);
+
+            // Incremental mode: read the grids calculated for the reference receptor conformation,
+            // and find the grid points that need to be recalculated
+            RbtRealGridList refGrids;
+            RbtRealGridPtr spChanged;
+            if (!strRefPrmFile.empty()) {
+                RbtString refName = Rbt::ConvertDelimitedStringToList(strRefPrmFile, ".").front();
+                RbtString strRefGridFile = Rbt::GetRbtFileName("data/grids", refName + strSuffix);
+                cout << endl << "REFERENCE GRIDS:" << endl << strRefGridFile << endl;
+                refGrids = ReadGrids(strRefGridFile);
+                RbtModelPtr spRefReceptor = CreateReceptor(strRefPrmFile);
+                spChanged = FindChangedRegion(*spGrid, spReceptor, spRefReceptor, tolerance, GetMaxRange(spSF));
+            }
+
+            // Write header string (RbtVdwGridSF)
+            const char* const header = "RbtVdwGridSF";
+            RbtInt length = strlen(header);
+            Rbt::WriteWithThrow(ostr, (const char*)&length, sizeof(length));
+            Rbt::WriteWithThrow(ostr, header, length);
+            // Write number of grids
+            RbtInt nGrids = probes.size();
+            Rbt::WriteWithThrow(ostr, (const char*)&nGrids, sizeof(nGrids));
+
+            // Store regular pointers to avoid smart pointer dereferencing overheads
+            RbtRealGrid* pGrid(spGrid);
+            RbtTriposAtomType triposType;
+            // Main loop over each probe model
+            for (RbtModelListConstIter mIter = probes.begin(); mIter != probes.end(); mIter++) {
+                RbtModelPtr spLigand(*mIter);
+                RbtTriposAtomType::eType atomType = spLigand->GetAtomList().front()->GetTriposType();
+                RbtString strType = triposType.Type2Str(atomType);
+                cout << "Atom type=" << strType << endl;
+                // Only reuse a reference grid whose lattice contains all the grid points
+                RbtRealGridPtr spRefGrid = refGrids.empty() ? RbtRealGridPtr() : refGrids[atomType];
+                if (!spRefGrid.Null() && spRefGrid->isOnLattice(*pGrid)) {
+                    UpdateProbeGrid(spWS, spLigand, pGrid, spRefGrid, spChanged);
+                } else {
+                    if (!spRefGrid.Null()) {
+                        cout << "Reference grid is on a different lattice; calculating all grid points" << endl;
+                    }
+                    RbtVdwGridSF::CalculateProbeGrid(spWS, spLigand, pGrid);
+                }
+                // Write the atom type string to the grid file, before the grid itself
+                const char* const szType = strType.c_str();
+                RbtInt l = strlen(szType);
+                Rbt::WriteWithThrow(ostr, (const char*)&l, sizeof(l));
+                Rbt::WriteWithThrow(ostr, szType, l);
+                pGrid->Write(ostr);
             }
-            // Write the atom type string to the grid file, before the grid itself
-            const char* const szType = strType.c_str();
-            RbtInt l = strlen(szType);
-            Rbt::WriteWithThrow(ostr, (const char*)&l, sizeof(l));
-            Rbt::WriteWithThrow(ostr, szType, l);
-            pGrid->Write(ostr);
         }
         ostr.close();
     } catch (RbtError& e) {
@@ -23,8 +23,10 @@ using std::setw;
 #include "RbtFileError.h"
 #include "RbtFilter.h"
 #include "RbtLigandError.h"
+#include "RbtLigandFlexData.h"
 #include "RbtMdlFileSink.h"
 #include "RbtMdlFileSource.h"
+#include "RbtModelSnapshot.h"
 #include "RbtModelError.h"
 #include "RbtPRMFactory.h"
 #include "RbtParameterFileSource.h"
@@ -44,7 +46,7 @@ void PrintUsage(void) {
     cout << endl << "Usage:" << endl;
     cout << "rbdock -i <sdFile> -o <outputRoot> -r <recepPrmFile> -p <protoPrmFile> [-n <nRuns>] [-ap] [-an] [-allH]"
          << endl;
-    cout << "       [-t <targetScore|targetFilterFile>] [-c] [-T <traceLevel>] [-s <rndSeed>]" << endl;
+    cout << "       [-t <targetScore|targetFilterFile>] [-c] [-e] [-T <traceLevel>] [-s <rndSeed>]" << endl;
     cout << endl << "Options:\t-i <sdFile> - input ligand SD file" << endl;
     cout << "\t\t-o <outputRoot> - root name for output file(s)" << endl;
     cout << "\t\t-r <recepPrmFile> - receptor parameter file " << endl;
@@ -56,10 +58,35 @@ void PrintUsage(void) {
     cout << "\t\t-t - score threshold OR filter file name" << endl;
     cout << "\t\t-c - continue if score threshold is met (use with -t <targetScore>, default=terminate ligand)"
          << endl;
+    cout << "\t\t-e - conformer ensemble mode: consecutive records with the same title are docked as rigid" << endl;
+    cout << "\t\t     conformers of one molecule, and only the best pose per molecule is written (default=disabled)"
+         << endl;
     cout << "\t\t-T <traceLevel> - controls output level for debugging (0 = minimal, >0 = more verbose)" << endl;
     cout << "\t\t-s <rndSeed> - random number seed (default=from sys clock)" << endl;
 }
 
+// Returns true if the atoms in the current record of the source match those of the ligand model,
+// so that the record can be treated as another conformer of the same ligand
+RbtBool isSameLigandTopology(RbtModelPtr spLigand, RbtMolecularFileSourcePtr spMdlFileSource) {
+    RbtAtomList ligAtomList = spLigand->GetAtomList();
+    RbtAtomList srcAtomList = spMdlFileSource->GetAtomList();
+    if (ligAtomList.size() != srcAtomList.size()) {
+        return false;
+    }
+    return std::equal(ligAtomList.begin(), ligAtomList.end(), srcAtomList.begin(), Rbt::isAtom_eq());
+}
+
+// Restores the best pose found for a conformer ensemble and saves it to the workspace sink.
+// The whole system state is restored, so that the saved scores and chromosome records are consistent
+// with the pose when the receptor or solvent is flexible
+void SaveBestEnsemblePose(RbtBiMolWorkSpacePtr spWS, const RbtModelSnapshot &bestState) {
+    if (bestState.isEmpty()) {
+        return;
+    }
+    bestState.Restore();
+    spWS->Save();
+}
+
 /////////////////////////////////////////////////////////////////////
 // MAIN PROGRAM STARTS HERE
 /////////////////////////////////////////////////////////////////////
@@ -90,6 +117,7 @@ int main(int argc, const char *argv[]) {
     RbtBool bDockingRuns(false);  // is argument -n present?
     RbtDouble dTargetScore(0.0);
     RbtBool bFilter(false);
+    RbtBool bEnsemble(false);  // if true, dock consecutive records with the same title as rigid conformers
 
     RbtBool bPosIonise(false);
     RbtBool bNegIonise(false);
@@ -122,6 +150,7 @@ int main(int argc, const char *argv[]) {
         {"allH", 'H', POPT_ARG_NONE | POPT_ARGFLAG_ONEDASH, 0, 'H', "read all Hs"},
         {"target", 't', POPT_ARG_STRING | POPT_ARGFLAG_ONEDASH, &strTargetScr, 't', "target score"},
         {"cont", 'C', POPT_ARG_NONE | POPT_ARGFLAG_ONEDASH, 0, 'C', "continue even if target met"},
+        {"ensemble", 'e', POPT_ARG_NONE | POPT_ARGFLAG_ONEDASH, 0, 'e', "rigid conformer ensemble mode"},
         POPT_AUTOHELP{NULL, 0, 0, NULL, 0}};
 
     optCon = poptGetContext(NULL, argc, argv, optionsTable, 0);
@@ -146,6 +175,9 @@ int main(int argc, const char *argv[]) {
             case 'C':
                 bStop = false;
                 break;
+            case 'e':
+                bEnsemble = true;
+                break;
             case 't':
                 // If str can be translated to an integer, I assume is a
                 // threshold. Otherwise, I assume is the filter file name
@@ -219,6 +251,8 @@ int main(int argc, const char *argv[]) {
     if (!bStop)  // stop after target
         cout << " -cont " << endl;
     if (bTarget) cout << " -t " << dTargetScore << endl;
+    if (bEnsemble)  // conformer ensemble mode
+        cout << " -e " << endl;
 
     // BGD 26 Feb 2003 - Create filters to simulate old rbdock
     // behaviour
@@ -427,6 +461,12 @@ int main(int argc, const char *argv[]) {
         RbtMolecularFileSourcePtr spMdlFileSource(
             new RbtMdlFileSource(strLigandMdlFile, bPosIonise, bNegIonise, bImplH)
         );
+        // Conformer ensemble mode: the current molecule title, its ligand model (shared by all conformers),
+        // and the best pose found so far
+        RbtString strEnsembleTitle;
+        RbtModelPtr spEnsembleLigand;
+        RbtModelSnapshot bestEnsembleState;
+        RbtDouble bestEnsembleScore(0.0);
         for (RbtInt nRec = 1; spMdlFileSource->FileStatusOK(); spMdlFileSource->NextRecord(), nRec++) {
             cout.setf(ios_base::left, ios_base::adjustfield);
             cout << endl << "**************************************************" << endl << "RECORD #" << nRec << endl;
@@ -449,21 +489,57 @@ int main(int argc, const char *argv[]) {
                     cout << "REG_Num:" << spMdlFileSource->GetDataValue("REG_Number") << endl;
                 cout << setw(30) << "RANDOM_NUMBER_SEED:" << theRand.GetSeed() << endl;
 
-                // Create and register the ligand model
-                RbtModelPtr spLigand = prmFactory.CreateLigand(spMdlFileSource);
+                RbtModelPtr spLigand;
+                RbtStringList titleList = spMdlFileSource->GetTitleList();
+                RbtString strTitle = titleList.empty() ? "" : titleList.front();
+                if (bEnsemble && !spEnsembleLigand.Null() && (strTitle == strEnsembleTitle)
+                    && isSameLigandTopology(spEnsembleLigand, spMdlFileSource)) {
+                    // Another conformer of the current molecule. Only the ligand coords are updated, so the
+                    // scoring function and transform setup for the ligand is shared by all conformers
+                    spLigand = spEnsembleLigand;
+                    RbtAtomList ligAtomList = spLigand->GetAtomList();
+                    RbtAtomList srcAtomList = spMdlFileSource->GetAtomList();
+                    for (RbtUInt iAtom = 0; iAtom < ligAtomList.size(); iAtom++) {
+                        ligAtomList[iAtom]->SetCoords(srcAtomList[iAtom]->GetCoords());
+                    }
+                    spLigand->UpdatePseudoAtoms();
+                    // Notify the workspace observers that the ligand coords have changed, so that the transforms
+                    // rebuild their chromosomes from the new conformer and discard any per-ligand state
+                    // (e.g. the archive of poses from earlier runs, which are not valid for this conformer)
+                    spWS->Notify();
+                    // Reset the run counter of the filter, as for a new ligand
+                    spfilter->SetupLigand();
+                } else {
+                    if (bEnsemble && !spEnsembleLigand.Null() && bOutput) {
+                        SaveBestEnsemblePose(spWS, bestEnsembleState);
+                    }
+                    // Create and register the ligand model
+                    spLigand = prmFactory.CreateLigand(spMdlFileSource);
+                    if (bEnsemble) {
+                        // Conformers are docked rigidly (no dihedral chromosome elements)
+                        RbtFlexData *pFlexData = spLigand->GetFlexData();
+                        pFlexData->SetParameter(
+                            RbtLigandFlexData::_DIHEDRAL_MODE, RbtChromElement::ModeToStr(RbtChromElement::FIXED)
+                        );
+                        spLigand->SetFlexData(pFlexData);
+                        spEnsembleLigand = spLigand;
+                        strEnsembleTitle = strTitle;
+                        bestEnsembleState.Clear();
+                    }
+                    spWS->SetLigand(spLigand);
+                    // Update any model coords from embedded chromosomes in the ligand file
+                    spWS->UpdateModelCoordsFromChromRecords(spMdlFileSource, iTrace);
+
+                    // DM 18 May 1999 - store run info in model data
+                    // Clear any previous Rbt.* data fields
+                    spLigand->ClearAllDataFields("Rbt.");
+                    spLigand->SetDataValue("Rbt.Library", vLib);
+                    spLigand->SetDataValue("Rbt.Executable", vExe);
+                    spLigand->SetDataValue("Rbt.Receptor", vRecep);
+                    spLigand->SetDataValue("Rbt.Parameter_File", vPrm);
+                    spLigand->SetDataValue("Rbt.Current_Directory", vDir);
+                }
                 RbtString strMolName = spLigand->GetName();
-                spWS->SetLigand(spLigand);
-                // Update any model coords from embedded chromosomes in the ligand file
-                spWS->UpdateModelCoordsFromChromRecords(spMdlFileSource, iTrace);
-
-                // DM 18 May 1999 - store run info in model data
-                // Clear any previous Rbt.* data fields
-                spLigand->ClearAllDataFields("Rbt.");
-                spLigand->SetDataValue("Rbt.Library", vLib);
-                spLigand->SetDataValue("Rbt.Executable", vExe);
-                spLigand->SetDataValue("Rbt.Receptor", vRecep);
-                spLigand->SetDataValue("Rbt.Parameter_File", vPrm);
-                spLigand->SetDataValue("Rbt.Current_Directory", vDir);
 
                 // DM 10 Dec 1999 - if in target mode, loop until target score is reached
                 RbtBool bTargetMet = false;
@@ -490,7 +566,15 @@ int main(int argc, const char *argv[]) {
                         RbtBool bterm = spfilter->Terminate();
                         RbtBool bwrite = spfilter->Write();
                         if (bterm) bTargetMet = true;
-                        if (bOutput && bwrite) {
+                        if (bEnsemble) {
+                            // Remember the best pose of the molecule, to be saved once all conformers are docked
+                            RbtDouble score = spSF->Score();
+                            if (bwrite && (bestEnsembleState.isEmpty() || (score < bestEnsembleScore))) {
+                                bestEnsembleScore = score;
+                                bestEnsembleState.Save(spWS->GetModels());
+                                spLigand->SetDataValue("Rbt.Conformer", nRec);
+                            }
+                        } else if (bOutput && bwrite) {
                             spWS->Save();
                         }
                         iRun++;
@@ -508,6 +592,9 @@ int main(int argc, const char *argv[]) {
         }
         // END OF MAIN LOOP OVER LIGAND RECORDS
         ////////////////////////////////////////////////////
+        if (bEnsemble && !spEnsembleLigand.Null() && bOutput) {
+            SaveBestEnsemblePose(spWS, bestEnsembleState);
+        }
         cout << endl << "END OF RUN" << endl;
         //    if (bOutput && flexRec) {
         //      RbtMolecularFileSinkPtr spRecepSink(new RbtCrdFileSink(strRunName+".crd",spReceptor));
@@ -12,6 +12,9 @@
 
 #include "RbtAtomFuncs.h"
 
+#include <algorithm>
+#include <map>
+
 // DM 31 Oct 2000
 // Given a bond, determines if it is in a ring (cutdown version of ToSpin)
 RbtBool Rbt::FindCyclic(RbtBondPtr spBond, RbtAtomList& atomList, RbtBondList& bondList) {
@@ -285,3 +288,177 @@ void Rbt::FindRings(RbtAtomList& atomList, RbtBondList& bondList, RbtAtomListLis
         }
     }
 }
+
+// State of the backtracking search used by Rbt::FindMaxCommonSubstructure
+class RbtMCSSearch {
+ public:
+    RbtMCSSearch(const RbtAtomList& atomList1, const RbtAtomList& atomList2, RbtUInt maxSteps):
+        m_n1(atomList1.size()),
+        m_n2(atomList2.size()),
+        m_maxSteps(maxSteps),
+        m_nSteps(0),
+        m_nMapped(0),
+        m_map1(m_n1, -1),
+        m_used2(m_n2, false),
+        m_excluded1(m_n1, false) {
+        GetAdjacency(atomList1, m_adj1);
+        GetAdjacency(atomList2, m_adj2);
+        for (RbtInt i = 0; i < m_n1; i++) {
+            vector<RbtInt> matches;
+            for (RbtInt j = 0; j < m_n2; j++) {
+                if (atomList1[i]->GetAtomicNo() == atomList2[j]->GetAtomicNo()) {
+                    matches.push_back(j);
+                }
+            }
+            m_matches.push_back(matches);
+        }
+    }
+
+    // Tries each pair of matching atoms as the root of the common substructure
+    void Search() {
+        RbtInt maxPossible = std::min(m_n1, m_n2);
+        for (RbtInt i = 0; (i < m_n1) && (RbtInt(m_bestMap1.size()) < maxPossible) && !OutOfSteps(); i++) {
+            for (vector<RbtInt>::const_iterator jIter = m_matches[i].begin(); jIter != m_matches[i].end(); ++jIter) {
+                Map(i, *jIter);
+                Extend();
+                Unmap(i, *jIter);
+            }
+            // No later root needs to consider atom i
+            m_excluded1[i] = true;
+        }
+    }
+
+    // Index pairs of the best match found
+    const vector<std::pair<RbtInt, RbtInt> >& GetBestMatch() const { return m_bestMap1; }
+
+ private:
+    static void GetAdjacency(const RbtAtomList& atomList, vector<vector<RbtBool> >& adj) {
+        RbtInt n = atomList.size();
+        adj.assign(n, vector<RbtBool>(n, false));
+        std::map<const RbtAtom*, RbtInt> indexMap;
+        for (RbtInt i = 0; i < n; i++) {
+            indexMap[atomList[i]] = i;
+        }
+        for (RbtInt i = 0; i < n; i++) {
+            const RbtBondMap& bondMap = atomList[i]->GetBondMap();
+            for (RbtBondMapConstIter bIter = bondMap.begin(); bIter != bondMap.end(); bIter++) {
+                RbtBond* pBnd = (*bIter).first;
+                const RbtAtom* pPartner = ((*bIter).second) ? pBnd->GetAtom2Ptr() : pBnd->GetAtom1Ptr();
+                std::map<const RbtAtom*, RbtInt>::const_iterator found = indexMap.find(pPartner);
+                if (found != indexMap.end()) {
+                    adj[i][found->second] = true;
+                }
+            }
+        }
+    }
+
+    RbtBool OutOfSteps() const { return m_nSteps >= m_maxSteps; }
+
+    void Map(RbtInt i, RbtInt j) {
+        m_map1[i] = j;
+        m_used2[j] = true;
+        m_nMapped++;
+    }
+
+    void Unmap(RbtInt i, RbtInt j) {
+        m_map1[i] = -1;
+        m_used2[j] = false;
+        m_nMapped--;
+    }
+
+    // True if mapping atom i onto atom j preserves the bonding to all atoms mapped so far,
+    // and j is bonded to the image of at least one of them
+    RbtBool IsConsistent(RbtInt i, RbtInt j) const {
+        RbtBool bConnected(false);
+        for (RbtInt k = 0; k < m_n1; k++) {
+            RbtInt l = m_map1[k];
+            if (l < 0) {
+                continue;
+            }
+            if (m_adj1[i][k] != m_adj2[j][l]) {
+                return false;
+            }
+            bConnected = bConnected || m_adj1[i][k];
+        }
+        return bConnected;
+    }
+
+    void Extend() {
+        m_nSteps++;
+        if (m_nMapped > RbtInt(m_bestMap1.size())) {
+            m_bestMap1.clear();
+            for (RbtInt k = 0; k < m_n1; k++) {
+                if (m_map1[k] >= 0) {
+                    m_bestMap1.push_back(std::make_pair(k, m_map1[k]));
+                }
+            }
+        }
+        if (OutOfSteps()) {
+            return;
+        }
+        // Find the next unmapped atom bonded to the current substructure,
+        // and count the atoms that could still be added
+        RbtInt iNext = -1;
+        RbtInt nAvailable = 0;
+        for (RbtInt k = 0; k < m_n1; k++) {
+            if ((m_map1[k] >= 0) || m_excluded1[k]) {
+                continue;
+            }
+            nAvailable++;
+            for (RbtInt l = 0; (iNext < 0) && (l < m_n1); l++) {
+                if ((m_map1[l] >= 0) && m_adj1[k][l]) {
+                    iNext = k;
+                }
+            }
+        }
+        if ((iNext < 0) || (m_nMapped + nAvailable <= RbtInt(m_bestMap1.size()))) {
+            return;
+        }
+        // Either map iNext onto a consistent atom...
+        for (vector<RbtInt>::const_iterator jIter = m_matches[iNext].begin(); jIter != m_matches[iNext].end();
+             ++jIter) {
+            if (!m_used2[*jIter] && IsConsistent(iNext, *jIter)) {
+                Map(iNext, *jIter);
+                Extend();
+                Unmap(iNext, *jIter);
+            }
+        }
+        // ...or leave it out of the substructure
+        m_excluded1[iNext] = true;
+        Extend();
+        m_excluded1[iNext] = false;
+    }
+
+    RbtInt m_n1;
+    RbtInt m_n2;
+    RbtUInt m_maxSteps;
+    RbtUInt m_nSteps;
+    RbtInt m_nMapped;
+    vector<vector<RbtBool> > m_adj1;
+    vector<vector<RbtBool> > m_adj2;
+    vector<vector<RbtInt> > m_matches;  // Candidate atoms in list 2 for each atom in list 1
+    vector<RbtInt> m_map1;              // Index of the atom in list 2 matched to each atom in list 1 (or -1)
+    vector<RbtBool> m_used2;
+    vector<RbtBool> m_excluded1;  // Atoms in list 1 excluded from the current branch of the search
+    vector<std::pair<RbtInt, RbtInt> > m_bestMap1;
+};
+
+RbtUInt Rbt::FindMaxCommonSubstructure(
+    const RbtAtomList& atomList1,
+    const RbtAtomList& atomList2,
+    RbtAtomList& matched1,
+    RbtAtomList& matched2,
+    RbtUInt maxSteps
+) {
+    matched1.clear();
+    matched2.clear();
+    RbtMCSSearch search(atomList1, atomList2, maxSteps);
+    search.Search();
+    const vector<std::pair<RbtInt, RbtInt> >& bestMatch = search.GetBestMatch();
+    for (vector<std::pair<RbtInt, RbtInt> >::const_iterator iter = bestMatch.begin(); iter != bestMatch.end();
+         ++iter) {
+        matched1.push_back(atomList1[iter->first]);
+        matched2.push_back(atomList2[iter->second]);
+    }
+    return matched1.size();
+}
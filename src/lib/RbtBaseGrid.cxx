@@ -140,6 +140,35 @@ void RbtBaseGrid::SetPad(RbtUInt NPad) {
     m_padMax = m_max - m_step * m_NPad;
 }
 
+// Returns true if x lies on the lattice of points at origin + n * step (for integral n), within tol steps
+static RbtBool isLatticePoint(RbtDouble x, RbtDouble origin, RbtDouble step, RbtDouble tol) {
+    RbtDouble n = (x - origin) / step;
+    return fabs(n - floor(n + 0.5)) <= tol;
+}
+
+RbtBool RbtBaseGrid::isOnLattice(const RbtBaseGrid& grid, RbtDouble tol) const {
+    RbtDouble origin[3] = {GetXCoord(1), GetYCoord(1), GetZCoord(1)};
+    RbtDouble step[3] = {m_step.x, m_step.y, m_step.z};
+    RbtDouble gridOrigin[3] = {grid.GetXCoord(1), grid.GetYCoord(1), grid.GetZCoord(1)};
+    RbtDouble gridStep[3] = {grid.GetGridStep().x, grid.GetGridStep().y, grid.GetGridStep().z};
+    RbtUInt gridN[3] = {grid.GetNX(), grid.GetNY(), grid.GetNZ()};
+    for (RbtInt i = 0; i < 3; i++) {
+        // The grid points along each axis are evenly spaced, so their deviations from the lattice vary linearly.
+        // Checking the first two grid points ensures the grid step is a whole number of lattice steps, and
+        // checking the last one ensures the accumulated deviation stays within tol
+        RbtDouble x1 = gridOrigin[i];
+        RbtDouble x2 = gridOrigin[i] + gridStep[i];
+        RbtDouble xN = gridOrigin[i] + (gridN[i] - 1) * gridStep[i];
+        if (!isLatticePoint(x1, origin[i], step[i], tol) || !isLatticePoint(xN, origin[i], step[i], tol)) {
+            return false;
+        }
+        if ((gridN[i] > 1) && !isLatticePoint(x2, origin[i], step[i], tol)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 // Returns list of real-world coordinates for given set of iXYZ indices
 RbtCoordList RbtBaseGrid::GetCoordList(const RbtUIntSet& iXYZSet) const {
     RbtCoordList coordList;
@@ -18,14 +18,20 @@
 RbtString RbtBaseIdxSF::_CT("RbtBaseIdxSF");
 RbtString RbtBaseIdxSF::_GRIDSTEP("GRIDSTEP");
 RbtString RbtBaseIdxSF::_BORDER("BORDER");
+RbtString RbtBaseIdxSF::_SOLVENT_MAP("SOLVENT_MAP");
+RbtString RbtBaseIdxSF::_SOLVENT_MAP_STEP("SOLVENT_MAP_STEP");
+RbtString RbtBaseIdxSF::_SOLVENT_MAP_NORIENT("SOLVENT_MAP_NORIENT");
 
-RbtBaseIdxSF::RbtBaseIdxSF(): m_gridStep(0.5), m_border(1.0) {
+RbtBaseIdxSF::RbtBaseIdxSF(): m_gridStep(0.5), m_border(1.0), m_bSolventMap(false) {
 #ifdef _DEBUG
     cout << _CT << " default constructor" << endl;
 #endif  //_DEBUG
     // Add parameters
     AddParameter(_GRIDSTEP, m_gridStep);
     AddParameter(_BORDER, m_border);
+    AddParameter(_SOLVENT_MAP, m_bSolventMap);
+    AddParameter(_SOLVENT_MAP_STEP, 0.25);
+    AddParameter(_SOLVENT_MAP_NORIENT, 100);
     _RBTOBJECTCOUNTER_CONSTR_(_CT);
 }
 
@@ -39,6 +45,8 @@ RbtDouble RbtBaseIdxSF::GetBorder() const { return m_border; }
 
 void RbtBaseIdxSF::SetBorder(RbtDouble border) { SetParameter(_BORDER, border); }
 
+RbtBool RbtBaseIdxSF::isSolventMapEnabled() const { return m_bSolventMap; }
+
 // DM 10 Apr 2002
 // I know, I know, grids should be templated to avoid the need for two different CreateGrid methods...
 RbtInteractionGridPtr RbtBaseIdxSF::CreateInteractionGrid() const {
@@ -107,6 +115,51 @@ RbtDouble RbtBaseIdxSF::GetMaxError() const {
 // GetCorrectedRange() = GetRange() + GetMaxError() + GetBorder()
 RbtDouble RbtBaseIdxSF::GetCorrectedRange() const { return GetRange() + GetMaxError() + m_border; }
 
+RbtSolventEnergyMapList RbtBaseIdxSF::CreateSolventEnergyMaps(const RbtModelList& solventList) const {
+    RbtSolventEnergyMapList retVal;
+    RbtDouble step = GetParameter(_SOLVENT_MAP_STEP);
+    RbtInt nOrient = GetParameter(_SOLVENT_MAP_NORIENT);
+    for (RbtModelListConstIter iter = solventList.begin(); iter != solventList.end(); ++iter) {
+        RbtSolventEnergyMapPtr spMap(new RbtSolventEnergyMap(*iter, step, nOrient));
+        if (!spMap->isValid()) {
+            spMap = RbtSolventEnergyMapPtr();
+        }
+        retVal.push_back(spMap);
+    }
+    return retVal;
+}
+
+RbtBool RbtBaseIdxSF::isSolventMapParameter(const RbtString& strName) const {
+    return (strName == _GRIDSTEP) || (strName == _BORDER) || (strName == _SOLVENT_MAP) || (strName == _SOLVENT_MAP_STEP)
+           || (strName == _SOLVENT_MAP_NORIENT) || (strName == RbtBaseSF::_RANGE);
+}
+
+RbtBool RbtBaseIdxSF::GetCachedSolventEnergyMaps(RbtSolventEnergyMapList& maps) const {
+    std::map<RbtString, RbtSolventEnergyMapList>::const_iterator iter = m_solventMapCache.find(GetSolventMapKey());
+    if (iter == m_solventMapCache.end()) {
+        return false;
+    }
+    maps = iter->second;
+    return true;
+}
+
+void RbtBaseIdxSF::CacheSolventEnergyMaps(const RbtSolventEnergyMapList& maps) const {
+    m_solventMapCache[GetSolventMapKey()] = maps;
+}
+
+void RbtBaseIdxSF::ClearSolventEnergyMapCache() { m_solventMapCache.clear(); }
+
+RbtString RbtBaseIdxSF::GetSolventMapKey() const {
+    ostringstream ostr;
+    RbtStringVariantMap params = GetParameters();
+    for (RbtStringVariantMapConstIter iter = params.begin(); iter != params.end(); ++iter) {
+        if (isSolventMapParameter(iter->first)) {
+            ostr << iter->first << "=" << iter->second.String() << ";";
+        }
+    }
+    return ostr.str();
+}
+
 // As this has a virtual base class we need a separate OwnParameterUpdated
 // which can be called by concrete subclass ParameterUpdated methods
 // See Stroustrup C++ 3rd edition, p395, on programming virtual base classes
@@ -115,5 +168,7 @@ void RbtBaseIdxSF::OwnParameterUpdated(const RbtString& strName) {
         m_gridStep = GetParameter(_GRIDSTEP);
     } else if (strName == _BORDER) {
         m_border = GetParameter(_BORDER);
+    } else if (strName == _SOLVENT_MAP) {
+        m_bSolventMap = GetParameter(_SOLVENT_MAP);
     }
 }
@@ -74,6 +74,28 @@ void RbtBaseSF::SetRange(RbtDouble range) { SetParameter(_RANGE, range); }
 // Returns weighted score if scoring function is enabled, else returns zero
 RbtDouble RbtBaseSF::Score() const { return isEnabled() ? GetWeight() * RawScore() : 0.0; }
 
+// Terms with negative weights can not be bounded, as we only track lower bounds
+RbtDouble RbtBaseSF::BoundedScore(RbtDouble maxScore) const {
+    if (!isEnabled()) {
+        return 0.0;
+    }
+    RbtDouble w = GetWeight();
+    return (w > 0.0) ? w * BoundedRawScore(maxScore / w) : w * RawScore();
+}
+
+RbtBool RbtBaseSF::ScoreLowerBound(RbtDouble& lowerBound) const {
+    if (!isEnabled() || (GetWeight() == 0.0)) {
+        lowerBound = 0.0;
+        return true;
+    }
+    RbtDouble rawLowerBound;
+    if ((GetWeight() < 0.0) || !RawScoreLowerBound(rawLowerBound)) {
+        return false;
+    }
+    lowerBound = GetWeight() * rawLowerBound;
+    return true;
+}
+
 // Returns all child component scores as a string-variant map
 // Key = fully qualified component name, value = weighted score
 //(for saving in a Model's data fields)
@@ -108,6 +130,10 @@ void RbtBaseSF::AddToParentMapEntry(RbtStringVariantMap& scoreMap, RbtDouble rs)
     }
 }
 
+RbtDouble RbtBaseSF::BoundedRawScore(RbtDouble maxRawScore) const { return RawScore(); }
+
+RbtBool RbtBaseSF::RawScoreLowerBound(RbtDouble& lowerBound) const { return false; }
+
 // Aggregate handling (virtual) methods
 // Base class throws an InvalidRequest error
 
@@ -226,6 +226,64 @@ RbtBool Rbt::isBondToOH::operator()(RbtBond* pBond) const {
         return false;
 }
 
+// Canonical signature of the acyclic branch rooted at pAtom, reached from pParent.
+// Returns an empty string if the branch contains any ring atoms
+static RbtString BranchSignature(RbtAtom* pAtom, RbtAtom* pParent) {
+    if (pAtom->GetCyclicFlag()) {
+        return "";
+    }
+    RbtStringList childSignatures;
+    RbtAtomList bondedAtomList = Rbt::GetBondedAtomList(pAtom);
+    for (RbtAtomListConstIter iter = bondedAtomList.begin(); iter != bondedAtomList.end(); ++iter) {
+        if ((*iter).Ptr() != pParent) {
+            RbtString childSignature = BranchSignature(*iter, pAtom);
+            if (childSignature.empty()) {
+                return "";
+            }
+            childSignatures.push_back(childSignature);
+        }
+    }
+    std::sort(childSignatures.begin(), childSignatures.end());
+    ostringstream ostr;
+    ostr << pAtom->GetAtomicNo() << ":" << pAtom->GetFFType() << ":" << pAtom->GetFormalCharge() << ":"
+         << pAtom->GetNumImplicitHydrogens() << "(";
+    for (RbtStringListConstIter iter = childSignatures.begin(); iter != childSignatures.end(); ++iter) {
+        ostr << *iter << ",";
+    }
+    ostr << ")";
+    return ostr.str();
+}
+
+// Returns true if pCentre bears three or more equivalent substituents in addition to pPartner, and no others
+static RbtBool isSymmetricTerminalGroup(RbtAtom* pCentre, RbtAtom* pPartner) {
+    RbtAtomList bondedAtomList = Rbt::GetBondedAtomList(pCentre);
+    if ((pCentre->GetNumImplicitHydrogens() > 0) || (bondedAtomList.size() < 4)) {
+        return false;
+    }
+    RbtString refSignature;
+    RbtBool bAllHydrogens(true);
+    for (RbtAtomListConstIter iter = bondedAtomList.begin(); iter != bondedAtomList.end(); ++iter) {
+        if ((*iter).Ptr() == pPartner) {
+            continue;
+        }
+        RbtString signature = BranchSignature(*iter, pCentre);
+        if (signature.empty() || (!refSignature.empty() && (signature != refSignature))) {
+            return false;
+        }
+        refSignature = signature;
+        bAllHydrogens = bAllHydrogens && ((*iter)->GetAtomicNo() == 1);
+    }
+    // Keep rotors of polar hydrogens
+    RbtInt nCentre = pCentre->GetAtomicNo();
+    return !(bAllHydrogens && ((nCentre == 7) || (nCentre == 8)));
+}
+
+RbtBool Rbt::isBondSymmetricRotor::operator()(RbtBond* pBond) const {
+    RbtAtom* pAtom1 = pBond->GetAtom1Ptr();
+    RbtAtom* pAtom2 = pBond->GetAtom2Ptr();
+    return isSymmetricTerminalGroup(pAtom1, pAtom2) || isSymmetricTerminalGroup(pAtom2, pAtom1);
+}
+
 // DM 7 June 1999
 // Is bond an amide bond?
 RbtBool Rbt::isBondAmide::operator()(RbtBond* pBond) const {
@@ -22,6 +22,7 @@
 RbtString RbtCavityGridSF::_CT("RbtCavityGridSF");
 RbtString RbtCavityGridSF::_RMAX("RMAX");
 RbtString RbtCavityGridSF::_QUADRATIC("QUADRATIC");
+RbtString RbtCavityGridSF::_GRID_LEVEL("GRID_LEVEL");
 
 // NB - Virtual base class constructor (RbtBaseSF) gets called first,
 // implicit constructor for RbtBaseInterSF is called second
@@ -29,10 +30,12 @@ RbtCavityGridSF::RbtCavityGridSF(const RbtString& strName):
     RbtBaseSF(_CT, strName),
     m_maxDist(0.0),
     m_rMax(0.1),
-    m_bQuadratic(false) {
+    m_bQuadratic(false),
+    m_gridLevel(0) {
     // Add parameters
     AddParameter(_RMAX, m_rMax);
     AddParameter(_QUADRATIC, m_bQuadratic);
+    AddParameter(_GRID_LEVEL, m_gridLevel);
 #ifdef _DEBUG
     cout << _CT << " parameterised constructor" << endl;
 #endif  //_DEBUG
@@ -49,11 +52,14 @@ RbtCavityGridSF::~RbtCavityGridSF() {
 void RbtCavityGridSF::SetupReceptor() {
     // DM 09 Apr 2002 - we can reuse the precalculated distance grid directly from the docking site
     m_spGrid = RbtRealGridPtr();
+    m_spFineGrid = RbtRealGridPtr();
+    m_coarseGrids.clear();
     RbtDockingSitePtr spDS = GetWorkSpace()->GetDockingSite();
     if (spDS.Null()) return;
-    m_spGrid = spDS->GetGrid();
-    if (m_spGrid.Null()) return;
-    m_maxDist = m_spGrid->MaxValue();
+    m_spFineGrid = spDS->GetGrid();
+    if (m_spFineGrid.Null()) return;
+    m_maxDist = m_spFineGrid->MaxValue();
+    SelectGridLevel();
 }
 
 void RbtCavityGridSF::SetupLigand() {}
@@ -109,11 +115,29 @@ void RbtCavityGridSF::ParameterUpdated(const RbtString& strName) {
         m_rMax = GetParameter(_RMAX);
     } else if (strName == _QUADRATIC) {
         m_bQuadratic = GetParameter(_QUADRATIC);
+    } else if (strName == _GRID_LEVEL) {
+        m_gridLevel = GetParameter(_GRID_LEVEL);
+        SelectGridLevel();
     } else {
         RbtBaseSF::ParameterUpdated(strName);
     }
 }
 
+void RbtCavityGridSF::SelectGridLevel() {
+    if ((m_gridLevel <= 0) || m_spFineGrid.Null()) {
+        m_spGrid = m_spFineGrid;
+        return;
+    }
+    if (m_coarseGrids.size() < RbtUInt(m_gridLevel)) {
+        m_coarseGrids.resize(m_gridLevel);
+    }
+    RbtRealGridPtr& spCoarseGrid = m_coarseGrids[m_gridLevel - 1];
+    if (spCoarseGrid.Null()) {
+        spCoarseGrid = m_spFineGrid->CreateCoarseGrid(1 << m_gridLevel);
+    }
+    m_spGrid = spCoarseGrid;
+}
+
 RbtCavityGridSF::HeavyAtomFactory::HeavyAtomFactory(RbtModelList modelList) {
     for (RbtModelListConstIter iter = modelList.begin(); iter != modelList.end(); iter++) {
         if ((*iter).Ptr() != NULL) {
@@ -0,0 +1,73 @@
+/***********************************************************************
+ * The rDock program was developed from 1998 - 2006 by the software team
+ * at RiboTargets (subsequently Vernalis (R&D) Ltd).
+ * In 2006, the software was licensed to the University of York for
+ * maintenance and distribution.
+ * In 2012, Vernalis and the University of York agreed to release the
+ * program as Open Source software.
+ * This version is licensed under GNU-LGPL version 3.0 with support from
+ * the University of Barcelona.
+ * http://rdock.sourceforge.net/
+ ***********************************************************************/
+
+#include "RbtCellIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Static data members
+RbtString RbtCellIndex::_CT("RbtCellIndex");
+
+// Number of bits used to store each of the x,y,z cell indices in the packed key
+// and the offset applied to make the cell indices non-negative
+const RbtInt CELL_BITS = 21;
+const RbtInt CELL_OFFSET = 1 << (CELL_BITS - 1);
+
+RbtCellIndex::RbtCellIndex(RbtDouble cellSize) {
+    SetCellSize(cellSize);
+    _RBTOBJECTCOUNTER_CONSTR_(_CT);
+}
+
+RbtCellIndex::~RbtCellIndex() { _RBTOBJECTCOUNTER_DESTR_(_CT); }
+
+void RbtCellIndex::SetCellSize(RbtDouble cellSize) {
+    m_cellSize = std::max(cellSize, 0.1);
+    m_rCellSize = 1.0 / m_cellSize;
+    Clear();
+}
+
+void RbtCellIndex::Clear() { m_entries.clear(); }
+
+void RbtCellIndex::Add(const RbtCoord& c, RbtInt id) {
+    m_entries.push_back(RbtCellEntry(GetKey(GetCell(c.x), GetCell(c.y), GetCell(c.z)), id));
+}
+
+void RbtCellIndex::Build() { std::sort(m_entries.begin(), m_entries.end()); }
+
+void RbtCellIndex::GetNeighbours(const RbtCoord& c, RbtIntList& ids) const {
+    if (m_entries.empty()) {
+        return;
+    }
+    RbtInt ix = GetCell(c.x);
+    RbtInt iy = GetCell(c.y);
+    RbtInt iz = GetCell(c.z);
+    // For each of the 9 (x,y) columns, cells z-1 to z+1 form a contiguous range of keys
+    for (RbtInt x = ix - 1; x <= ix + 1; x++) {
+        for (RbtInt y = iy - 1; y <= iy + 1; y++) {
+            RbtCellEntryListConstIter first =
+                std::lower_bound(m_entries.begin(), m_entries.end(), RbtCellEntry(GetKey(x, y, iz - 1), -1));
+            RbtCellKey lastKey = GetKey(x, y, iz + 1);
+            for (RbtCellEntryListConstIter iter = first; (iter != m_entries.end()) && (iter->first <= lastKey);
+                 iter++) {
+                ids.push_back(iter->second);
+            }
+        }
+    }
+}
+
+RbtCellIndex::RbtCellKey RbtCellIndex::GetKey(RbtInt ix, RbtInt iy, RbtInt iz) const {
+    return (RbtCellKey(ix + CELL_OFFSET) << (2 * CELL_BITS)) | (RbtCellKey(iy + CELL_OFFSET) << CELL_BITS)
+           | RbtCellKey(iz + CELL_OFFSET);
+}
+
+RbtInt RbtCellIndex::GetCell(RbtDouble x) const { return RbtInt(std::floor(x * m_rCellSize)); }
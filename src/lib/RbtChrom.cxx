@@ -81,6 +81,12 @@ void RbtChrom::Add(RbtChromElement* pChromElement) {
     }
 }
 
+void RbtChrom::GetLeafElements(RbtChromElementList& leafList) {
+    for (RbtChromElementListIter iter = m_elementList.begin(); iter != m_elementList.end(); ++iter) {
+        (*iter)->GetLeafElements(leafList);
+    }
+}
+
 RbtUInt RbtChrom::GetLength() const {
     RbtInt retVal(0);
     for (RbtChromElementListConstIter iter = m_elementList.begin(); iter != m_elementList.end(); ++iter) {
@@ -153,6 +159,12 @@ RbtDouble RbtChrom::CompareVector(const RbtDoubleList& v, RbtInt& i) const {
     return retVal;
 }
 
+void RbtChrom::GetGeneSegments(RbtGeneSegmentList& segments) const {
+    for (RbtChromElementListConstIter iter = m_elementList.begin(); iter != m_elementList.end(); ++iter) {
+        (*iter)->GetGeneSegments(segments);
+    }
+}
+
 void RbtChrom::Print(ostream& s) const {
     s << "CHROM" << endl;
     RbtInt i(0);
@@ -19,10 +19,11 @@ RbtChromDihedralElement::RbtChromDihedralElement(
     RbtAtomList tetheredAtoms,
     RbtDouble stepSize,
     RbtChromElement::eMode mode,
-    RbtDouble maxDihedral
+    RbtDouble maxDihedral,
+    RbtDouble rotamerStep
 ):
     m_value(0.0) {
-    m_spRefData = new RbtChromDihedralRefData(spBond, tetheredAtoms, stepSize, mode, maxDihedral);
+    m_spRefData = new RbtChromDihedralRefData(spBond, tetheredAtoms, stepSize, mode, maxDihedral, rotamerStep);
     // Set the initial genotype to match the current phenotype
     SyncFromModel();
     _RBTOBJECTCOUNTER_CONSTR_(_CT);
@@ -58,6 +59,11 @@ void RbtChromDihedralElement::Randomise() {
 void RbtChromDihedralElement::Mutate(RbtDouble relStepSize) {
     RbtDouble absStepSize = relStepSize * m_spRefData->GetStepSize();
     RbtDouble delta;
+    // For discrete rotamers, make sure the mutation is large enough to reach the neighbouring rotamers
+    RbtInt nRotamers = m_spRefData->GetNumRotamers();
+    if ((nRotamers > 0) && (absStepSize > 0)) {
+        absStepSize = std::max(absStepSize, 360.0 / nRotamers);
+    }
     if (absStepSize > 0) {
         switch (m_spRefData->GetMode()) {
             case RbtChromElement::TETHERED:
@@ -77,7 +83,13 @@ void RbtChromDihedralElement::Mutate(RbtDouble relStepSize) {
 
 void RbtChromDihedralElement::SyncFromModel() { m_value = m_spRefData->GetModelValue(); }
 
-void RbtChromDihedralElement::SyncToModel() { m_spRefData->SetModelValue(m_value); }
+void RbtChromDihedralElement::SyncToModel() {
+    if (m_spRefData->GetNumRotamers() > 0) {
+        m_spRefData->SetModelValue(m_spRefData->GetRotamerValue(m_spRefData->GetNearestRotamer(m_value)));
+    } else {
+        m_spRefData->SetModelValue(m_value);
+    }
+}
 
 RbtChromElement* RbtChromDihedralElement::clone() const { return new RbtChromDihedralElement(m_spRefData, m_value); }
 
@@ -127,6 +139,11 @@ RbtDouble RbtChromDihedralElement::CompareVector(const RbtDoubleList& v, RbtInt&
     return retVal;
 }
 
+void RbtChromDihedralElement::GetGeneSegments(RbtGeneSegmentList& segments) const {
+    RbtGeneSegment segment = {RbtGeneSegment::DIHEDRAL, 1u, m_spRefData->GetStepSize()};
+    segments.push_back(segment);
+}
+
 void RbtChromDihedralElement::Print(ostream& s) const { s << "DIHEDRAL " << m_value << endl; }
 
 RbtDouble RbtChromDihedralElement::StandardisedValue(RbtDouble dihedralAngle) {
@@ -22,11 +22,17 @@ RbtChromDihedralRefData::RbtChromDihedralRefData(
     RbtAtomList tetheredAtoms,
     RbtDouble stepSize,
     RbtChromElement::eMode mode,
-    RbtDouble maxDihedral
+    RbtDouble maxDihedral,
+    RbtDouble rotamerStep
 ):
     m_stepSize(stepSize),
     m_mode(mode),
-    m_maxDihedral(maxDihedral) {
+    m_maxDihedral(maxDihedral),
+    m_nRotamers(0) {
+    // Round the rotamer step so that the rotamers are evenly spaced around the full circle
+    if (rotamerStep > 0.0) {
+        m_nRotamers = std::max(1, int(360.0 / rotamerStep + 0.5));
+    }
     Setup(spBond, tetheredAtoms);
     m_initialValue = GetModelValue();
     _RBTOBJECTCOUNTER_CONSTR_(_CT);
@@ -38,6 +44,22 @@ RbtDouble RbtChromDihedralRefData::GetModelValue() const {
     return Rbt::BondDihedral(m_atom1, m_atom2, m_atom3, m_atom4);
 }
 
+RbtDouble RbtChromDihedralRefData::GetRotamerValue(RbtInt i) const {
+    RbtDouble dihedralAngle = 180.0 + i * 360.0 / m_nRotamers;
+    return (dihedralAngle > 180.0) ? dihedralAngle - 360.0 : dihedralAngle;
+}
+
+RbtInt RbtChromDihedralRefData::GetNearestRotamer(RbtDouble dihedralAngle) const {
+    if (m_nRotamers < 1) {
+        return 0;
+    }
+    RbtDouble delta = fmod(dihedralAngle - 180.0, 360.0);
+    if (delta < 0.0) {
+        delta += 360.0;
+    }
+    return int(delta * m_nRotamers / 360.0 + 0.5) % m_nRotamers;
+}
+
 void RbtChromDihedralRefData::SetModelValue(RbtDouble dihedralAngle) {
     RbtDouble delta = dihedralAngle - GetModelValue();
     // Only rotate if delta is non-zero
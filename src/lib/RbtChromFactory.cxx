@@ -31,6 +31,7 @@ void RbtChromFactory::VisitReceptorFlexData(RbtReceptorFlexData* pFlexData) {
     if (pModel && pDockSite) {
         RbtDouble flexDistance = pFlexData->GetParameter(RbtReceptorFlexData::_FLEX_DISTANCE);
         RbtDouble dihedralStepSize = pFlexData->GetParameter(RbtReceptorFlexData::_DIHEDRAL_STEP);
+        RbtDouble rotamerStep = pFlexData->GetParameter(RbtReceptorFlexData::_ROTAMER_STEP);
         // Trap the combination of flexible OH/NH3 AND multiple receptor conformations
         // We do not support both of these simultaneously
         if (pModel->GetNumSavedCoords() > 1) {
@@ -53,7 +54,9 @@ void RbtChromFactory::VisitReceptorFlexData(RbtReceptorFlexData* pFlexData) {
                 RbtAtom* pAtom1 = (*iter)->GetAtom1Ptr();
                 RbtAtom* pAtom2 = (*iter)->GetAtom2Ptr();
                 if (bIsInRange(pAtom1) && bIsInRange(pAtom2)) {
-                    m_pChrom->Add(new RbtChromDihedralElement(*iter, noTetheredAtoms, dihedralStepSize));
+                    m_pChrom->Add(new RbtChromDihedralElement(
+                        *iter, noTetheredAtoms, dihedralStepSize, RbtChromElement::FREE, 0.0, rotamerStep
+                    ));
                     modelMutatorBondList.push_back(*iter);
                 }
             }
@@ -81,14 +84,22 @@ void RbtChromFactory::VisitLigandFlexData(RbtLigandFlexData* pFlexData) {
         RbtDouble maxTrans = pFlexData->GetParameter(RbtLigandFlexData::_MAX_TRANS);
         RbtDouble maxRot = pFlexData->GetParameter(RbtLigandFlexData::_MAX_ROT);
         RbtDouble maxDihedral = pFlexData->GetParameter(RbtLigandFlexData::_MAX_DIHEDRAL);
+        RbtString rotReprStr = pFlexData->GetParameter(RbtLigandFlexData::_ROT_REPR);
 
         // Convert from sampling mode strings to enum values
         RbtChromElement::eMode transMode = RbtChromElement::StrToMode(transModeStr);
         RbtChromElement::eMode rotMode = RbtChromElement::StrToMode(rotModeStr);
         RbtChromElement::eMode dihedralMode = RbtChromElement::StrToMode(dihedralModeStr);
+        RbtChromPositionRefData::eOrientationRepr rotRepr = RbtChromPositionRefData::StrToOrientationRepr(rotReprStr);
 
         RbtAtomList tetheredAtoms = pModel->GetTetheredAtomList();
         RbtBondList rotBondList = Rbt::GetBondList(pModel->GetBondList(), Rbt::isBondRotatable());
+        // Rotating a symmetric terminal group barely changes the molecule, so exclude these bonds from the search
+        RbtBool bPruneSymRotors = pFlexData->GetParameter(RbtLigandFlexData::_PRUNE_SYM_ROTORS);
+        if (bPruneSymRotors) {
+            RbtBondListIter end = std::remove_if(rotBondList.begin(), rotBondList.end(), Rbt::isBondSymmetricRotor());
+            rotBondList.erase(end, rotBondList.end());
+        }
 
         // If we are in tethered mode, ensure the step size is not larger than the tethered range
         if ((transMode == RbtChromElement::TETHERED) && (transStepSize > maxTrans)) {
@@ -126,7 +137,8 @@ void RbtChromFactory::VisitLigandFlexData(RbtLigandFlexData* pFlexData) {
                 transMode,
                 rotMode,
                 maxTrans,
-                maxRot * M_PI / 180.0
+                maxRot * M_PI / 180.0,
+                rotRepr
             ));
         }
         // Create the legacy ModelMutator object
@@ -95,6 +95,11 @@ RbtDouble RbtChromOccupancyElement::CompareVector(const RbtDoubleList& v, RbtInt
     return retVal;
 }
 
+void RbtChromOccupancyElement::GetGeneSegments(RbtGeneSegmentList& segments) const {
+    RbtGeneSegment segment = {RbtGeneSegment::LINEAR, 1u, m_spRefData->GetStepSize()};
+    segments.push_back(segment);
+}
+
 void RbtChromOccupancyElement::Print(ostream& s) const { s << "OCCUPANCY " << m_value << endl; }
 
 RbtDouble RbtChromOccupancyElement::StandardisedValue(RbtDouble occupancy) {
@@ -22,21 +22,23 @@ RbtChromPositionElement::RbtChromPositionElement(
     RbtChromElement::eMode transMode,
     RbtChromElement::eMode rotMode,
     RbtDouble maxTrans,
-    RbtDouble maxRot
+    RbtDouble maxRot,
+    RbtChromPositionRefData::eOrientationRepr orientationRepr
 ) {
     m_spRefData = new RbtChromPositionRefData(
-        pModel, pDockSite, transStepSize, rotStepSize, transMode, rotMode, maxTrans, maxRot
+        pModel, pDockSite, transStepSize, rotStepSize, transMode, rotMode, maxTrans, maxRot, orientationRepr
     );
     SyncFromModel();
     _RBTOBJECTCOUNTER_CONSTR_(_CT);
 }
 
 RbtChromPositionElement::RbtChromPositionElement(
-    RbtChromPositionRefDataPtr spRefData, const RbtCoord& com, const RbtEuler& orientation
+    RbtChromPositionRefDataPtr spRefData, const RbtCoord& com, const RbtEuler& orientation, const RbtQuat& quat
 ):
     m_spRefData(spRefData),
     m_com(com),
-    m_orientation(orientation) {
+    m_orientation(orientation),
+    m_quat(quat) {
     _RBTOBJECTCOUNTER_CONSTR_(_CT);
 }
 
@@ -45,6 +47,7 @@ RbtChromPositionElement::~RbtChromPositionElement() { _RBTOBJECTCOUNTER_DESTR_(_
 void RbtChromPositionElement::Reset() {
     m_com = m_spRefData->GetInitialCOM();
     m_orientation = m_spRefData->GetInitialOrientation();
+    m_quat = Canonical(m_spRefData->GetInitialQuat());
 }
 
 void RbtChromPositionElement::Randomise() {
@@ -87,20 +90,27 @@ void RbtChromPositionElement::RandomiseOrientation() {
             // up to the maximum permitted
         case RbtChromElement::TETHERED:
             m_orientation = m_spRefData->GetInitialOrientation();
+            m_quat = Canonical(m_spRefData->GetInitialQuat());
             theta = m_spRefData->GetMaxRot() * GetRand().GetRandom01();
             axis = GetRand().GetRandomUnitVector();
-            m_orientation.Rotate(axis, theta);
+            RotateOrientation(axis, theta);
             break;
         // FREE: completely scramble the initial orientation
         case RbtChromElement::FREE:
-            heading = 2.0 * M_PI * GetRand().GetRandom01() - M_PI;
-            attitude = M_PI * GetRand().GetRandom01() - 0.5 * M_PI;
-            bank = 2.0 * M_PI * GetRand().GetRandom01() - M_PI;
-            m_orientation = RbtEuler(heading, attitude, bank);
+            if (isQuatRepr()) {
+                // Uniformly distributed over orientation space
+                m_quat = Canonical(GetRand().GetRandomQuat());
+            } else {
+                heading = 2.0 * M_PI * GetRand().GetRandom01() - M_PI;
+                attitude = M_PI * GetRand().GetRandom01() - 0.5 * M_PI;
+                bank = 2.0 * M_PI * GetRand().GetRandom01() - M_PI;
+                m_orientation = RbtEuler(heading, attitude, bank);
+            }
             break;
         // FIXED: Revert to initial orientation
         default:
             m_orientation = m_spRefData->GetInitialOrientation();
+            m_quat = Canonical(m_spRefData->GetInitialQuat());
             break;
     }
 }
@@ -110,6 +120,19 @@ void RbtChromPositionElement::Mutate(RbtDouble relStepSize) {
     MutateOrientation(relStepSize);
 }
 
+RbtInt RbtChromPositionElement::GetNumMoveTypes() const {
+    return (m_spRefData->IsTransFixed() ? 0 : 1) + (m_spRefData->IsRotFixed() ? 0 : 1);
+}
+
+// Move type 0 is translation, unless translation is fixed
+void RbtChromPositionElement::MutateMoveType(RbtInt iMoveType, RbtDouble relStepSize) {
+    if ((iMoveType == 0) && !m_spRefData->IsTransFixed()) {
+        MutateCOM(relStepSize);
+    } else {
+        MutateOrientation(relStepSize);
+    }
+}
+
 void RbtChromPositionElement::MutateCOM(RbtDouble relStepSize) {
     RbtDouble absTransStepSize;
     RbtDouble dist;
@@ -148,7 +171,7 @@ void RbtChromPositionElement::MutateOrientation(RbtDouble relStepSize) {
             if (absRotStepSize > 0) {
                 theta = absRotStepSize * GetRand().GetRandom01();
                 axis = GetRand().GetRandomUnitVector();
-                m_orientation.Rotate(axis, theta);
+                RotateOrientation(axis, theta);
                 CorrectTetheredOrientation();
             }
             break;
@@ -157,7 +180,7 @@ void RbtChromPositionElement::MutateOrientation(RbtDouble relStepSize) {
             if (absRotStepSize > 0) {
                 theta = absRotStepSize * GetRand().GetRandom01();
                 axis = GetRand().GetRandomUnitVector();
-                m_orientation.Rotate(axis, theta);
+                RotateOrientation(axis, theta);
             }
             break;
         // FIXED: Do nothing
@@ -166,12 +189,20 @@ void RbtChromPositionElement::MutateOrientation(RbtDouble relStepSize) {
     }
 }
 
-void RbtChromPositionElement::SyncFromModel() { m_spRefData->GetModelValue(m_com, m_orientation); }
+void RbtChromPositionElement::SyncFromModel() {
+    RbtQuat q;
+    m_spRefData->GetModelValue(m_com, q);
+    if (isQuatRepr()) {
+        m_quat = Canonical(q);
+    } else {
+        m_orientation.FromQuat(q);
+    }
+}
 
-void RbtChromPositionElement::SyncToModel() { m_spRefData->SetModelValue(m_com, m_orientation); }
+void RbtChromPositionElement::SyncToModel() { m_spRefData->SetModelValue(m_com, GetOrientationQuat()); }
 
 RbtChromElement* RbtChromPositionElement::clone() const {
-    return new RbtChromPositionElement(m_spRefData, m_com, m_orientation);
+    return new RbtChromPositionElement(m_spRefData, m_com, m_orientation, m_quat);
 }
 
 void RbtChromPositionElement::GetVector(RbtDoubleList& v) const {
@@ -181,9 +212,7 @@ void RbtChromPositionElement::GetVector(RbtDoubleList& v) const {
         v.push_back(m_com.z);
     }
     if (!m_spRefData->IsRotFixed()) {
-        v.push_back(m_orientation.GetHeading());
-        v.push_back(m_orientation.GetAttitude());
-        v.push_back(m_orientation.GetBank());
+        GetOrientationVector(v);
     }
 }
 
@@ -197,9 +226,7 @@ void RbtChromPositionElement::GetVector(RbtXOverList& v) const {
     }
     if (!m_spRefData->IsRotFixed()) {
         RbtXOverElement orientationElement;
-        orientationElement.push_back(m_orientation.GetHeading());
-        orientationElement.push_back(m_orientation.GetAttitude());
-        orientationElement.push_back(m_orientation.GetBank());
+        GetOrientationVector(orientationElement);
         v.push_back(orientationElement);
     }
 }
@@ -217,15 +244,20 @@ void RbtChromPositionElement::SetVector(const RbtDoubleList& v, RbtInt& i) {
             m_com = RbtCoord(x, y, z);
         }
         if (!m_spRefData->IsRotFixed()) {
-            // 2013Nov26 (DM) Bug fix to unsafe code.
-            // We cannot assume that the multiple increments will be processed left->right.
-            // This assumption is broken in g++ 4. Safer to break into separate statements.
-            // m_orientation = RbtEuler(v[i++], v[i++], v[i++]);
-            RbtDouble heading(v[i++]);
-            RbtDouble attitude(v[i++]);
-            RbtDouble bank(v[i++]);
-            m_orientation = RbtEuler(heading, attitude, bank);
-            m_orientation.Standardise();
+            if (isQuatRepr()) {
+                m_quat = ToQuat(&v[i]);
+                i += 4;
+            } else {
+                // 2013Nov26 (DM) Bug fix to unsafe code.
+                // We cannot assume that the multiple increments will be processed left->right.
+                // This assumption is broken in g++ 4. Safer to break into separate statements.
+                // m_orientation = RbtEuler(v[i++], v[i++], v[i++]);
+                RbtDouble heading(v[i++]);
+                RbtDouble attitude(v[i++]);
+                RbtDouble bank(v[i++]);
+                m_orientation = RbtEuler(heading, attitude, bank);
+                m_orientation.Standardise();
+            }
         }
     } else {
         throw RbtBadArgument(_WHERE_, "Index out of range or insufficient elements remaining");
@@ -246,10 +278,14 @@ void RbtChromPositionElement::SetVector(const RbtXOverList& v, RbtInt& i) {
         }
         if (!m_spRefData->IsRotFixed()) {
             RbtXOverElement orientationElement(v[i++]);
-            if (orientationElement.size() == 3) {
+            if (orientationElement.size() == m_spRefData->GetOrientationLength()) {
                 // As we crossover an intact orientation vector there should be no need to check
                 // for tethered bounds
-                m_orientation = RbtEuler(orientationElement[0], orientationElement[1], orientationElement[2]);
+                if (isQuatRepr()) {
+                    m_quat = ToQuat(&orientationElement[0]);
+                } else {
+                    m_orientation = RbtEuler(orientationElement[0], orientationElement[1], orientationElement[2]);
+                }
             } else {
                 throw RbtBadArgument(_WHERE_, "orientationElement vector is of incorrect length");
             }
@@ -267,8 +303,12 @@ void RbtChromPositionElement::GetStepVector(RbtDoubleList& v) const {
         }
     }
     if (!m_spRefData->IsRotFixed()) {
+        // Quaternion components change by approximately half the rotation angle
         RbtDouble rotStepSize = m_spRefData->GetRotStepSize();
-        for (RbtInt i = 0; i < 3; ++i) {
+        if (isQuatRepr()) {
+            rotStepSize *= 0.5;
+        }
+        for (RbtUInt i = 0; i < m_spRefData->GetOrientationLength(); ++i) {
             v.push_back(rotStepSize);
         }
     }
@@ -295,21 +335,27 @@ RbtDouble RbtChromPositionElement::CompareVector(const RbtDoubleList& v, RbtInt&
             }
         }
         if (!m_spRefData->IsRotFixed()) {
-            // 2013Nov26 (DM) Bug fix to unsafe code.
-            // We cannot assume that the multiple increments will be processed left->right.
-            // This assumption is broken in g++ 4. Safer to break into separate statements.
-            // RbtEuler otherOrientation = RbtEuler(v[i++], v[i++], v[i++]);
-            RbtDouble heading(v[i++]);
-            RbtDouble attitude(v[i++]);
-            RbtDouble bank(v[i++]);
-            RbtEuler otherOrientation = RbtEuler(heading, attitude, bank);
+            RbtQuat otherQuat;
+            if (isQuatRepr()) {
+                otherQuat = ToQuat(&v[i]);
+                i += 4;
+            } else {
+                // 2013Nov26 (DM) Bug fix to unsafe code.
+                // We cannot assume that the multiple increments will be processed left->right.
+                // This assumption is broken in g++ 4. Safer to break into separate statements.
+                // RbtEuler otherOrientation = RbtEuler(v[i++], v[i++], v[i++]);
+                RbtDouble heading(v[i++]);
+                RbtDouble attitude(v[i++]);
+                RbtDouble bank(v[i++]);
+                otherQuat = RbtEuler(heading, attitude, bank).ToQuat();
+            }
             RbtDouble rotStepSize = m_spRefData->GetRotStepSize();
             // Compare orientations
             if (rotStepSize > 0.0) {
                 // Determine the difference between the two orientations
                 // in terms of the axis/angle needed to align them
                 // q.s = cos(phi / 2)
-                RbtQuat qAlign = otherOrientation.ToQuat() * m_orientation.ToQuat().Conj();
+                RbtQuat qAlign = otherQuat * GetOrientationQuat().Conj();
                 RbtDouble cosHalfTheta = qAlign.s;
                 if (cosHalfTheta < -1.0) {
                     cosHalfTheta = -1.0;
@@ -327,9 +373,28 @@ RbtDouble RbtChromPositionElement::CompareVector(const RbtDoubleList& v, RbtInt&
     return retVal;
 }
 
+void RbtChromPositionElement::GetGeneSegments(RbtGeneSegmentList& segments) const {
+    if (!m_spRefData->IsTransFixed()) {
+        RbtGeneSegment comSegment = {RbtGeneSegment::COM, 3u, m_spRefData->GetTransStepSize()};
+        segments.push_back(comSegment);
+    }
+    if (!m_spRefData->IsRotFixed()) {
+        RbtGeneSegment orientationSegment = {RbtGeneSegment::EULER, 3u, m_spRefData->GetRotStepSize()};
+        if (isQuatRepr()) {
+            orientationSegment.type = RbtGeneSegment::QUAT;
+            orientationSegment.length = 4u;
+        }
+        segments.push_back(orientationSegment);
+    }
+}
+
 void RbtChromPositionElement::Print(ostream& s) const {
     s << "COM " << m_com << endl;
-    s << "EULER " << m_orientation << endl;
+    if (isQuatRepr()) {
+        s << "QUAT " << m_quat << endl;
+    } else {
+        s << "EULER " << m_orientation << endl;
+    }
 }
 
 RbtDouble RbtChromPositionElement::StandardisedValue(RbtDouble rotationAngle) {
@@ -359,7 +424,7 @@ void RbtChromPositionElement::CorrectTetheredCOM() {
 void RbtChromPositionElement::CorrectTetheredOrientation() {
     // Check for orientation out of bounds
     RbtDouble maxRot = m_spRefData->GetMaxRot();
-    RbtQuat qAlign = m_spRefData->GetInitialQuat() * m_orientation.ToQuat().Conj();
+    RbtQuat qAlign = m_spRefData->GetInitialQuat() * GetOrientationQuat().Conj();
     RbtDouble cosHalfTheta = qAlign.s;
     if (cosHalfTheta < -1.0) {
         cosHalfTheta = -1.0;
@@ -374,11 +439,47 @@ void RbtChromPositionElement::CorrectTetheredOrientation() {
         RbtVector axis = -qAlign.v / sin(theta / 2.0);
         // Adjust theta to bring the orientation just inside the tethered bound
         theta += 0.999 * maxRot;
-        m_orientation.Rotate(axis, theta);
+        RotateOrientation(axis, theta);
     } else if (theta > maxRot) {
         RbtVector axis = qAlign.v / sin(theta / 2.0);
         // Adjust theta to bring the orientation just inside the tethered bound
         theta -= 0.999 * maxRot;
+        RotateOrientation(axis, theta);
+    }
+}
+
+void RbtChromPositionElement::GetOrientationVector(RbtDoubleList& v) const {
+    if (isQuatRepr()) {
+        v.push_back(m_quat.s);
+        v.push_back(m_quat.v.x);
+        v.push_back(m_quat.v.y);
+        v.push_back(m_quat.v.z);
+    } else {
+        v.push_back(m_orientation.GetHeading());
+        v.push_back(m_orientation.GetAttitude());
+        v.push_back(m_orientation.GetBank());
+    }
+}
+
+RbtQuat RbtChromPositionElement::GetOrientationQuat() const {
+    return isQuatRepr() ? m_quat : m_orientation.ToQuat();
+}
+
+void RbtChromPositionElement::RotateOrientation(const RbtVector& axis, RbtDouble theta) {
+    if (isQuatRepr()) {
+        m_quat = Canonical(RbtQuat(axis, theta) * m_quat);
+    } else {
         m_orientation.Rotate(axis, theta);
     }
 }
+
+RbtQuat RbtChromPositionElement::ToQuat(const RbtDouble* v) {
+    // Values need not be normalised (e.g. simplex vertices)
+    RbtQuat q(v[0], v[1], v[2], v[3]);
+    return (q.Length() > 0.0) ? Canonical(q) : RbtQuat();
+}
+
+RbtQuat RbtChromPositionElement::Canonical(const RbtQuat& q) {
+    RbtQuat unitQ = q.Unit();
+    return (unitQ.s < 0.0) ? -unitQ : unitQ;
+}
@@ -15,6 +15,22 @@
 RbtString RbtChromPositionRefData::_CT = "RbtChromPositionRefData";
 const RbtPrincipalAxes RbtChromPositionRefData::CARTESIAN_AXES;
 
+RbtChromPositionRefData::eOrientationRepr RbtChromPositionRefData::StrToOrientationRepr(const RbtString& reprStr) {
+    RbtString reprStrUpper = reprStr;
+    std::transform(reprStrUpper.begin(), reprStrUpper.end(), reprStrUpper.begin(), toupper);
+    if (reprStrUpper == "EULER") {
+        return EULER;
+    } else if (reprStrUpper == "QUAT") {
+        return QUAT;
+    } else {
+        throw RbtBadArgument(_WHERE_, "Unknown orientation representation (" + reprStr + ")");
+    }
+}
+
+RbtString RbtChromPositionRefData::OrientationReprToStr(eOrientationRepr repr) {
+    return (repr == QUAT) ? "QUAT" : "EULER";
+}
+
 RbtChromPositionRefData::RbtChromPositionRefData(
     const RbtModel* pModel,
     const RbtDockingSite* pDockSite,
@@ -23,13 +39,15 @@ RbtChromPositionRefData::RbtChromPositionRefData(
     RbtChromElement::eMode transMode,
     RbtChromElement::eMode rotMode,
     RbtDouble maxTrans,
-    RbtDouble maxRot
+    RbtDouble maxRot,
+    eOrientationRepr orientationRepr
 ):
     m_transStepSize(transStepSize),
     m_rotStepSize(rotStepSize),
     m_transMode(transMode),
     m_rotMode(rotMode),
-    m_length(6),
+    m_orientationRepr(orientationRepr),
+    m_length(3 + GetOrientationLength()),
     m_xOverLength(2),
     m_maxTrans(maxTrans),
     m_maxRot(maxRot) {
@@ -41,8 +59,8 @@ RbtChromPositionRefData::RbtChromPositionRefData(
     m_refAtoms = (tetheredAtomList.empty()) ? atomList : tetheredAtomList;
     // All atoms are movable, but use std::copy to strip off the smart pointers
     std::copy(atomList.begin(), atomList.end(), std::back_inserter(m_movableAtoms));
-    GetModelValue(m_initialCom, m_initialOrientation);
-    m_initialQuat = m_initialOrientation.ToQuat();
+    GetModelValue(m_initialCom, m_initialQuat);
+    m_initialOrientation.FromQuat(m_initialQuat);
     pDockSite->GetCoordList(m_startCoords);
     // Check for zero ranges in TETHERED mode and convert to FIXED
     if ((m_transMode == RbtChromElement::TETHERED) && (m_maxTrans <= 0.0)) {
@@ -59,7 +77,7 @@ RbtChromPositionRefData::RbtChromPositionRefData(
         m_xOverLength--;
     }
     if (IsRotFixed()) {
-        m_length -= 3;
+        m_length -= GetOrientationLength();
         m_xOverLength--;
     }
     _RBTOBJECTCOUNTER_CONSTR_(_CT);
@@ -67,27 +85,24 @@ RbtChromPositionRefData::RbtChromPositionRefData(
 
 RbtChromPositionRefData::~RbtChromPositionRefData() { _RBTOBJECTCOUNTER_DESTR_(_CT); }
 
-void RbtChromPositionRefData::GetModelValue(RbtCoord& com, RbtEuler& orientation) const {
+void RbtChromPositionRefData::GetModelValue(RbtCoord& com, RbtQuat& orientation) const {
     // Determine the principal axes and centre of mass of the reference atoms
     RbtPrincipalAxes prAxes = Rbt::GetPrincipalAxes(m_refAtoms);
     // Determine the quaternion needed to align Cartesian axes with actual
     // molecule principal axes. This represents the absolute orientation of
     // the molecule.
-    RbtQuat q = Rbt::GetQuatFromAlignAxes(CARTESIAN_AXES, prAxes);
-    orientation.FromQuat(q);
+    orientation = Rbt::GetQuatFromAlignAxes(CARTESIAN_AXES, prAxes);
     com = prAxes.com;
 }
 
-void RbtChromPositionRefData::SetModelValue(const RbtCoord& com, const RbtEuler& orientation) {
+void RbtChromPositionRefData::SetModelValue(const RbtCoord& com, const RbtQuat& orientation) {
     // Determine the principal axes and centre of mass of the reference atoms
     RbtPrincipalAxes prAxes = Rbt::GetPrincipalAxes(m_refAtoms);
     // Determine the overall rotation required.
     // 1) Go back to realign with Cartesian axes
     RbtQuat qBack = Rbt::GetQuatFromAlignAxes(prAxes, CARTESIAN_AXES);
-    // 2) Go forward to the desired orientation
-    RbtQuat qForward = orientation.ToQuat();
-    // 3 Combine the two rotations
-    RbtQuat q = qForward * qBack;
+    // 2) Go forward to the desired orientation (combining the two rotations)
+    RbtQuat q = orientation * qBack;
     for (RbtAtomRListIter iter = m_movableAtoms.begin(); iter != m_movableAtoms.end(); ++iter) {
         (*iter)->Translate(-prAxes.com);  // Move to origin
         (*iter)->RotateUsingQuat(q);      // Rotate
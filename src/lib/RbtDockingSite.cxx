@@ -255,6 +255,9 @@ void RbtDockingSite::CreateGrid() {
 
     // Get the total list of cavity coords
     RbtCoordList allCoords;
+    // Grid indices of the cavity coords, and whether all the cavity coords lie directly on a grid point
+    RbtUIntList cavIndices;
+    RbtBool bOnGrid = true;
     for (RbtCavityListConstIter iter = m_cavityList.begin(); iter != m_cavityList.end(); iter++) {
         const RbtCoordList cavCoords = (*iter)->GetCoordList();
         // Reserve enough space for appending the next cavity coord list
@@ -268,6 +271,8 @@ void RbtDockingSite::CreateGrid() {
             RbtUInt i = m_spGrid->GetIXYZ(*cIter);  // Grid index of nearest grid point
             RbtDouble dist2 = Rbt::Length2(*cIter, m_spGrid->GetCoord(i));
             m_spGrid->SetValue(i, dist2);
+            cavIndices.push_back(i);
+            bOnGrid = bOnGrid && (dist2 < 1.0e-6 * gridStep.x * gridStep.x);
         }
         // Sort the coords so we can remove any dups
 
@@ -277,6 +282,17 @@ void RbtDockingSite::CreateGrid() {
         cout << "Cav = " << cavCoords.size() << "; total = " << allCoords.size() << endl;
     }
 
+    // If the cavity coords are all grid points of a cubic grid, the distances can be calculated exactly with a
+    // single distance transform, rather than by comparing every grid point with every cavity coord
+    if (bOnGrid && (gridStep.x == gridStep.y) && (gridStep.x == gridStep.z)) {
+        RbtDoubleList dist2;
+        m_spGrid->GetSquaredDistances(cavIndices, dist2);
+        for (RbtUInt i = 0; i < m_spGrid->GetN(); i++) {
+            m_spGrid->SetValue(i, gridStep.x * sqrt(dist2[i]));
+        }
+        return;
+    }
+
     // Loop over all grid points in the distance grid
     // Can terminate when distance^2 is less than or equal to mindist^2 (shortest length of grid interval)
     RbtDouble mindist2 = std::min(gridStep.x, gridStep.y);
@@ -108,13 +108,12 @@ RbtFFTPeakMap RbtFFTGrid::FindPeaks(RbtDouble threshold, RbtUInt minVol) const {
 
     // First compile a list of all points higher than the threshold
     RbtUIntSet stillToProcess;
-    float* nrData = GetGridData();
 
     // DM 21 Jan 2000 - take account of tolerance when assessing threshold
     threshold -= GetTolerance();
 
     for (RbtUInt i = 0; i < GetN(); i++) {
-        if (nrData[i] > threshold) stillToProcess.insert(i);
+        if (GetValue(i) > threshold) stillToProcess.insert(i);
     }
 
 #ifdef _DEBUG
@@ -132,7 +131,7 @@ RbtFFTPeakMap RbtFFTGrid::FindPeaks(RbtDouble threshold, RbtUInt minVol) const {
         RbtUIntSetIter iter = stillToProcess.begin();
         RbtUInt iXYZ0 = *iter;
         RbtUInt peakPos = iXYZ0;
-        float peakHeight = nrData[peakPos];
+        float peakHeight = GetValue(peakPos);
         toAddToPeak.push(iXYZ0);
         stillToProcess.erase(iter);
 
@@ -149,7 +148,7 @@ RbtFFTPeakMap RbtFFTGrid::FindPeaks(RbtDouble threshold, RbtUInt minVol) const {
             RbtUInt iZ0 = GetIZ(iXYZ0);
             toAddToPeak.pop();
             // Check if new point is higher than the current maximum
-            float f = nrData[iXYZ0];
+            float f = GetValue(iXYZ0);
             if (f > peakHeight) {
                 peakHeight = f;
                 peakPos = iXYZ0;
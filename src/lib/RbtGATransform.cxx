@@ -29,6 +29,19 @@ RbtString RbtGATransform::_EQUALITY_THRESHOLD("EQUALITY_THRESHOLD");
 RbtString RbtGATransform::_NCYCLES("NCYCLES");
 RbtString RbtGATransform::_NCONVERGENCE("NCONVERGENCE");
 RbtString RbtGATransform::_HISTORY_FREQ("HISTORY_FREQ");
+RbtString RbtGATransform::_SURROGATE_SF("SURROGATE_SF");
+RbtString RbtGATransform::_SURROGATE_FRACTION("SURROGATE_FRACTION");
+
+// Appends all scoring functions in the tree with the fully qualified name sfName
+static void FindNamedSFs(RbtBaseSF* pSF, const RbtString& sfName, RbtBaseSFList& sfList) {
+    if (pSF->GetFullName() == sfName) {
+        sfList.push_back(pSF);
+        return;
+    }
+    for (RbtUInt i = 0; i < pSF->GetNumSF(); i++) {
+        FindNamedSFs(pSF->GetSF(i), sfName, sfList);
+    }
+}
 
 const RbtGATransform::Config RbtGATransform::DEFAULT_CONFIG{};  // Empty initializer to fall back to default values
 
@@ -66,6 +79,18 @@ void RbtGATransform::Execute() {
     // This forces the population to rescore all the individuals in case
     // the scoring function has changed
     pop->SetSF(pSF);
+    RbtBaseSFList surrogateSFs;
+    if (!config.surrogate_sf.empty()) {
+        RbtStringList sfNames = Rbt::ConvertDelimitedStringToList(config.surrogate_sf);
+        for (RbtStringListConstIter iter = sfNames.begin(); iter != sfNames.end(); ++iter) {
+            RbtUInt nFound = surrogateSFs.size();
+            FindNamedSFs(pSF, *iter, surrogateSFs);
+            if (surrogateSFs.size() == nFound) {
+                throw RbtBadArgument(_WHERE_, "Surrogate scoring function term not found: " + *iter);
+            }
+        }
+    }
+    pop->SetSurrogateSF(surrogateSFs, config.surrogate_fraction);
 
     RbtInt popsize = pop->GetMaxSize();
     RbtInt nrepl = config.population_size_fraction_as_new_individuals_per_cycle * popsize;
@@ -91,7 +116,7 @@ void RbtGATransform::Execute() {
 
     for (RbtInt iCycle = 0; (iCycle < config.max_cycles) && (iConvergence < config.num_convergence_cycles); ++iCycle) {
         if (bHistory && ((iCycle % config.history_frequency) == 0)) {
-            pop->Best()->GetChrom()->SyncToModel();
+            pop->Best()->SyncToModel();
             pWorkSpace->SaveHistory(true);
         }
         pop->GAstep(
@@ -114,7 +139,7 @@ void RbtGATransform::Execute() {
                  << pop->GetScoreMean() << setw(10) << pop->GetScoreVariance() << endl;
         }
     }
-    pop->Best()->GetChrom()->SyncToModel();
+    pop->Best()->SyncToModel();
     RbtInt ri = GetReceptor()->GetCurrentCoords();
     GetLigand()->SetDataValue("RI", ri);
 }
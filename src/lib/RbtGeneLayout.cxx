@@ -0,0 +1,172 @@
+/***********************************************************************
+ * The rDock program was developed from 1998 - 2006 by the software team
+ * at RiboTargets (subsequently Vernalis (R&D) Ltd).
+ * In 2006, the software was licensed to the University of York for
+ * maintenance and distribution.
+ * In 2012, Vernalis and the University of York agreed to release the
+ * program as Open Source software.
+ * This version is licensed under GNU-LGPL version 3.0 with support from
+ * the University of Barcelona.
+ * http://rdock.sourceforge.net/
+ ***********************************************************************/
+
+#include "RbtGeneLayout.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "RbtChromDihedralElement.h"
+#include "RbtChromPositionElement.h"
+#include "RbtEuler.h"
+
+// Static data members
+RbtString RbtGeneLayout::_CT("RbtGeneLayout");
+
+RbtGeneLayout::RbtGeneLayout(const RbtChromElement* pChr): m_chrom(pChr->clone()), m_length(0) {
+    m_chrom->GetGeneSegments(m_segments);
+    m_offsets.reserve(m_segments.size() + 1);
+    for (RbtGeneSegmentList::const_iterator iter = m_segments.begin(); iter != m_segments.end(); ++iter) {
+        m_offsets.push_back(m_length);
+        m_length += iter->length;
+    }
+    m_offsets.push_back(m_length);
+    // Gene vectors are binned by centre of mass if there is one, otherwise by the first linear or dihedral genes.
+    // Orientations are not binned as their cells have no simple neighbour structure
+    for (RbtUInt i = 0; (i < m_segments.size()) && m_hashDims.empty(); ++i) {
+        if ((m_segments[i].type == RbtGeneSegment::COM) && (m_segments[i].stepSize > 0.0)) {
+            for (RbtUInt j = 0; j < 3; ++j) {
+                HashDim dim = {m_offsets[i] + j, m_segments[i].stepSize, false};
+                m_hashDims.push_back(dim);
+            }
+        }
+    }
+    for (RbtUInt i = 0; (i < m_segments.size()) && (m_hashDims.size() < 3); ++i) {
+        RbtGeneSegment::eCompareType type = m_segments[i].type;
+        RbtBool isBinned = (type == RbtGeneSegment::LINEAR) || (type == RbtGeneSegment::DIHEDRAL);
+        if (isBinned && (m_segments[i].stepSize > 0.0)) {
+            HashDim dim = {m_offsets[i], m_segments[i].stepSize, (type == RbtGeneSegment::DIHEDRAL)};
+            m_hashDims.push_back(dim);
+        }
+    }
+    if (m_length != m_chrom->GetLength()) {
+        delete m_chrom;
+        throw RbtBadArgument(_WHERE_, "Gene segments do not match chromosome length");
+    }
+    _RBTOBJECTCOUNTER_CONSTR_(_CT);
+}
+
+RbtGeneLayout::~RbtGeneLayout() {
+    delete m_chrom;
+    _RBTOBJECTCOUNTER_DESTR_(_CT);
+}
+
+RbtDouble RbtGeneLayout::Compare(const RbtDouble* genes1, const RbtDouble* genes2) const {
+    RbtDouble retVal(0.0);
+    for (RbtGeneSegmentList::const_iterator iter = m_segments.begin(); iter != m_segments.end(); ++iter) {
+        const RbtDouble* v1 = genes1;
+        const RbtDouble* v2 = genes2;
+        genes1 += iter->length;
+        genes2 += iter->length;
+        if (iter->stepSize <= 0.0) {
+            continue;
+        }
+        RbtDouble absDiff(0.0);
+        switch (iter->type) {
+            case RbtGeneSegment::DIHEDRAL:
+                absDiff = fabs(RbtChromDihedralElement::StandardisedValue(v1[0] - v2[0]));
+                break;
+            case RbtGeneSegment::COM:
+                absDiff = Rbt::Length(RbtCoord(v1[0], v1[1], v1[2]), RbtCoord(v2[0], v2[1], v2[2]));
+                break;
+            case RbtGeneSegment::EULER: {
+                // Rotation angle needed to align the two orientations
+                // q.s = cos(phi / 2)
+                RbtQuat q1 = RbtEuler(v1[0], v1[1], v1[2]).ToQuat();
+                RbtQuat q2 = RbtEuler(v2[0], v2[1], v2[2]).ToQuat();
+                RbtQuat qAlign = q2 * q1.Conj();
+                RbtDouble cosHalfTheta = std::min(1.0, std::max(-1.0, qAlign.s));
+                absDiff = fabs(RbtChromPositionElement::StandardisedValue(2.0 * acos(cosHalfTheta)));
+                break;
+            }
+            case RbtGeneSegment::QUAT: {
+                // q and -q are the same orientation
+                RbtQuat q1(v1[0], v1[1], v1[2], v1[3]);
+                RbtQuat q2(v2[0], v2[1], v2[2], v2[3]);
+                absDiff = 2.0 * acos(std::min(1.0, fabs(q1.Dot(q2))));
+                break;
+            }
+            default:
+                absDiff = fabs(v1[0] - v2[0]);
+                break;
+        }
+        retVal = std::max(retVal, absDiff / iter->stepSize);
+    }
+    return retVal;
+}
+
+void RbtGeneLayout::GetNeighbourKeys(const RbtDouble* genes, RbtDouble cellSize, vector<std::size_t>& keys) const {
+    keys.clear();
+    if (cellSize <= 0.0) {
+        keys.push_back(0);
+        return;
+    }
+    RbtUInt nDims = m_hashDims.size();
+    vector<long> centre(nDims);
+    for (RbtUInt i = 0; i < nDims; ++i) {
+        centre[i] = GetCellIndex(m_hashDims[i], genes, cellSize);
+    }
+    // Gene vectors closer than cellSize differ by less than one cell width along each hash dimension,
+    // so visit the 3^nDims cells offset by 0, +1 or -1 cells along each dimension, starting with the centre cell
+    RbtUInt nCells(1);
+    for (RbtUInt i = 0; i < nDims; ++i) {
+        nCells *= 3;
+    }
+    vector<long> indices(nDims);
+    for (RbtUInt n = 0; n < nCells; ++n) {
+        RbtUInt code(n);
+        for (RbtUInt i = 0; i < nDims; ++i, code /= 3) {
+            RbtInt offset = (code % 3 == 2) ? -1 : RbtInt(code % 3);
+            indices[i] = centre[i] + offset;
+            RbtInt nCyclic = GetNumCells(m_hashDims[i], cellSize);
+            if (nCyclic > 0) {
+                indices[i] = (indices[i] + nCyclic) % nCyclic;
+            }
+        }
+        keys.push_back(CombineCellIndices(indices));
+    }
+}
+
+RbtChromElement* RbtGeneLayout::Decode(const RbtDoubleList& genes) const {
+    m_chrom->SetVector(genes);
+    return m_chrom;
+}
+
+void RbtGeneLayout::Encode(RbtDoubleList& genes) const {
+    genes.clear();
+    m_chrom->GetVector(genes);
+}
+
+RbtInt RbtGeneLayout::GetNumCells(const HashDim& dim, RbtDouble cellSize) const {
+    // Dihedral cells have equal widths spanning the full circle, so that the first and last cells are neighbours
+    return dim.isCyclic ? std::max(1, RbtInt(std::floor(360.0 / (cellSize * dim.stepSize)))) : 0;
+}
+
+long RbtGeneLayout::GetCellIndex(const HashDim& dim, const RbtDouble* genes, RbtDouble cellSize) const {
+    RbtDouble value = genes[dim.offset];
+    if (dim.isCyclic) {
+        RbtInt nCyclic = GetNumCells(dim, cellSize);
+        RbtDouble x = (RbtChromDihedralElement::StandardisedValue(value) + 180.0) * nCyclic / 360.0;
+        return std::min(long(nCyclic - 1), std::max(0L, static_cast<long>(std::floor(x))));
+    }
+    return static_cast<long>(std::floor(value / (cellSize * dim.stepSize)));
+}
+
+std::size_t RbtGeneLayout::CombineCellIndices(const vector<long>& indices) {
+    std::size_t key(0);
+    for (vector<long>::const_iterator iter = indices.begin(); iter != indices.end(); ++iter) {
+        // Same mixing as boost::hash_combine
+        std::size_t h = std::hash<long>()(*iter);
+        key ^= h + 0x9e3779b9 + (key << 6) + (key >> 2);
+    }
+    return key;
+}
@@ -17,12 +17,16 @@
 
 RbtString RbtGenome::_CT("RbtGenome");
 
-RbtGenome::RbtGenome(RbtChromElement* pChr): m_chrom(pChr->clone()), m_score(0.0), m_RWFitness(0.0) {
+RbtGenome::RbtGenome(RbtChromElement* pChr): RbtGenome(RbtGeneLayoutPtr(new RbtGeneLayout(pChr))) {}
+
+RbtGenome::RbtGenome(RbtGeneLayoutPtr spLayout): m_spLayout(spLayout), m_score(0.0), m_RWFitness(0.0) {
+    m_spLayout->Encode(m_genes);
     _RBTOBJECTCOUNTER_CONSTR_(_CT);
 }
 
 RbtGenome::RbtGenome(const RbtGenome& g):
-    m_chrom((g.m_chrom)->clone()),
+    m_spLayout(g.m_spLayout),
+    m_genes(g.m_genes),
     m_score(g.m_score),
     m_RWFitness(g.m_RWFitness) {
     _RBTOBJECTCOUNTER_COPYCONSTR_(_CT);
@@ -30,27 +34,49 @@ RbtGenome::RbtGenome(const RbtGenome& g):
 
 RbtGenome& RbtGenome::operator=(const RbtGenome& g) {
     if (&g != this) {
-        m_chrom = (g.m_chrom)->clone();
+        m_spLayout = g.m_spLayout;
+        m_genes = g.m_genes;
         m_score = g.m_score;
         m_RWFitness = g.m_RWFitness;
     }
     return *this;
 }
 
-RbtGenome::~RbtGenome() {
-    delete m_chrom;
-    _RBTOBJECTCOUNTER_DESTR_(_CT);
-}
+RbtGenome::~RbtGenome() { _RBTOBJECTCOUNTER_DESTR_(_CT); }
 
 RbtGenome* RbtGenome::clone() const { return new RbtGenome(*this); }
 
+void RbtGenome::SetGenes(const RbtDoubleList& genes) {
+    if (genes.size() != m_spLayout->GetLength()) {
+        throw RbtBadArgument(_WHERE_, "Gene vector does not match layout length");
+    }
+    m_genes = genes;
+}
+
+void RbtGenome::Randomise() {
+    m_spLayout->Decode(m_genes)->Randomise();
+    m_spLayout->Encode(m_genes);
+}
+
+void RbtGenome::Mutate(RbtDouble relStepSize) {
+    m_spLayout->Decode(m_genes)->Mutate(relStepSize);
+    m_spLayout->Encode(m_genes);
+}
+
+void RbtGenome::CauchyMutate(RbtDouble mean, RbtDouble variance) {
+    m_spLayout->Decode(m_genes)->CauchyMutate(mean, variance);
+    m_spLayout->Encode(m_genes);
+}
+
 void RbtGenome::SetScore(RbtBaseSF* pSF) {
     if (pSF != NULL) {
-        m_chrom->SyncToModel();
-        m_score = -pSF->Score();
-    } else {
-        m_score = 0.0;
+        SyncToModel();
     }
+    SetScoreFromModel(pSF);
+}
+
+void RbtGenome::SetScoreFromModel(RbtBaseSF* pSF) {
+    m_score = (pSF != NULL) ? -pSF->Score() : 0.0;
     SetRWFitness(0.0, 0.0);
 }
 
@@ -69,8 +95,17 @@ void RbtGenome::NormaliseRWFitness(RbtDouble total) {
     }
 }
 
+RbtBool RbtGenome::Equals(const RbtGenome& g, RbtDouble threshold) const {
+    if (m_genes.size() != g.m_genes.size()) {
+        return false;
+    } else if (m_genes.empty()) {
+        return true;
+    }
+    return m_spLayout->Compare(&m_genes[0], &g.m_genes[0]) < threshold;
+}
+
 void RbtGenome::Print(ostream& s) const {
-    s << *m_chrom << endl;
+    s << *Decode() << endl;
     s << "Score: " << GetScore() << "; RWFitness: " << GetRWFitness() << endl;
 }
 
@@ -78,3 +113,26 @@ ostream& operator<<(ostream& s, const RbtGenome& g) {
     g.Print(s);
     return s;
 }
+
+void Rbt::Crossover(const RbtGenome* pG1, const RbtGenome* pG2, RbtGenome* pG3, RbtGenome* pG4) {
+    // Check all genomes have the same layout
+    RbtGeneLayout* pLayout = pG1->GetLayout().Ptr();
+    RbtUInt length = pLayout->GetLength();
+    if ((length != pG2->m_genes.size()) || (length != pG3->m_genes.size()) || (length != pG4->m_genes.size())) {
+        throw RbtBadArgument(_WHERE_, "Crossover: mismatch in genome lengths");
+    }
+    // 2-point crossover
+    // In the spirit of STL, ixbegin is the first gene to crossover, ixend is one after the last gene to crossover
+    RbtUInt xoverLength = pLayout->GetXOverLength();
+    RbtRand& rand = Rbt::GetRbtRand();
+    RbtInt ixbegin = rand.GetRandomInt(xoverLength);
+    // if ixbegin is 0, we need to avoid selecting the whole chromosome
+    RbtInt ixend = (ixbegin == 0) ? rand.GetRandomInt(xoverLength - 1) + 1
+                                  : rand.GetRandomInt(xoverLength - ixbegin) + ixbegin + 1;
+    RbtUInt begin = pLayout->GetXOverOffset(ixbegin);
+    RbtUInt end = pLayout->GetXOverOffset(ixend);
+    // Children start as copies of the parents
+    if (pG3 != pG1) pG3->m_genes = pG1->m_genes;
+    if (pG4 != pG2) pG4->m_genes = pG2->m_genes;
+    std::swap_ranges(pG3->m_genes.begin() + begin, pG3->m_genes.begin() + end, pG4->m_genes.begin() + begin);
+}
@@ -12,7 +12,7 @@
 
 #include "RbtLigandFlexData.h"
 
-#include "RbtChromElement.h"
+#include "RbtChromPositionRefData.h"
 
 const RbtString& RbtLigandFlexData::_TRANS_STEP = "TRANS_STEP";
 const RbtString& RbtLigandFlexData::_ROT_STEP = "ROT_STEP";
@@ -23,6 +23,8 @@ const RbtString& RbtLigandFlexData::_DIHEDRAL_MODE = "DIHEDRAL_MODE";
 const RbtString& RbtLigandFlexData::_MAX_TRANS = "MAX_TRANS";
 const RbtString& RbtLigandFlexData::_MAX_ROT = "MAX_ROT";
 const RbtString& RbtLigandFlexData::_MAX_DIHEDRAL = "MAX_DIHEDRAL";
+const RbtString& RbtLigandFlexData::_ROT_REPR = "ROT_REPR";
+const RbtString& RbtLigandFlexData::_PRUNE_SYM_ROTORS = "PRUNE_SYM_ROTORS";
 
 RbtLigandFlexData::RbtLigandFlexData(RbtDockingSite* pDockSite): RbtFlexData(pDockSite) {
     AddParameter(_TRANS_STEP, 2.0);
@@ -34,4 +36,6 @@ RbtLigandFlexData::RbtLigandFlexData(RbtDockingSite* pDockSite): RbtFlexData(pDo
     AddParameter(_MAX_TRANS, 1.0);
     AddParameter(_MAX_ROT, 30.0);
     AddParameter(_MAX_DIHEDRAL, 30.0);
+    AddParameter(_ROT_REPR, RbtChromPositionRefData::OrientationReprToStr(RbtChromPositionRefData::EULER));
+    AddParameter(_PRUNE_SYM_ROTORS, false);
 }
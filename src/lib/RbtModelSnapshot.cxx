@@ -0,0 +1,64 @@
+/***********************************************************************
+ * The rDock program was developed from 1998 - 2006 by the software team
+ * at RiboTargets (subsequently Vernalis (R&D) Ltd).
+ * In 2006, the software was licensed to the University of York for
+ * maintenance and distribution.
+ * In 2012, Vernalis and the University of York agreed to release the
+ * program as Open Source software.
+ * This version is licensed under GNU-LGPL version 3.0 with support from
+ * the University of Barcelona.
+ * http://rdock.sourceforge.net/
+ ***********************************************************************/
+
+#include "RbtModelSnapshot.h"
+
+// Static data members
+RbtString RbtModelSnapshot::_CT("RbtModelSnapshot");
+
+RbtModelSnapshot::RbtModelSnapshot() { _RBTOBJECTCOUNTER_CONSTR_(_CT); }
+
+RbtModelSnapshot::~RbtModelSnapshot() { _RBTOBJECTCOUNTER_DESTR_(_CT); }
+
+void RbtModelSnapshot::Save(const RbtModelList& modelList) {
+    Clear();
+    for (RbtModelListConstIter mIter = modelList.begin(); mIter != modelList.end(); ++mIter) {
+        RbtModelPtr spModel(*mIter);
+        RbtModel* pModel = spModel.Ptr();
+        if ((pModel == NULL) || (pModel->GetFlexData() == NULL)) {
+            continue;
+        }
+        m_models.push_back(pModel);
+        for (RbtAtomListConstIter iter = pModel->m_atomList.begin(); iter != pModel->m_atomList.end(); ++iter) {
+            m_coords.push_back((*iter)->GetCoords());
+        }
+        for (RbtPseudoAtomListConstIter iter = pModel->m_pseudoAtomList.begin();
+             iter != pModel->m_pseudoAtomList.end(); ++iter) {
+            m_coords.push_back((*iter)->GetCoords());
+        }
+        m_occupancies.push_back(pModel->m_occupancy);
+        m_enabled.push_back(pModel->m_enabled);
+    }
+}
+
+void RbtModelSnapshot::Restore() const {
+    RbtCoordListConstIter cIter = m_coords.begin();
+    for (RbtUInt i = 0; i < m_models.size(); i++) {
+        RbtModel* pModel = m_models[i];
+        for (RbtAtomListIter iter = pModel->m_atomList.begin(); iter != pModel->m_atomList.end(); ++iter, ++cIter) {
+            (*iter)->SetCoords(*cIter);
+        }
+        for (RbtPseudoAtomListIter iter = pModel->m_pseudoAtomList.begin(); iter != pModel->m_pseudoAtomList.end();
+             ++iter, ++cIter) {
+            (*iter)->SetCoords(*cIter);
+        }
+        pModel->m_occupancy = m_occupancies[i];
+        pModel->m_enabled = m_enabled[i];
+    }
+}
+
+void RbtModelSnapshot::Clear() {
+    m_models.clear();
+    m_coords.clear();
+    m_occupancies.clear();
+    m_enabled.clear();
+}
@@ -0,0 +1,230 @@
+/***********************************************************************
+ * The rDock program was developed from 1998 - 2006 by the software team
+ * at RiboTargets (subsequently Vernalis (R&D) Ltd).
+ * In 2006, the software was licensed to the University of York for
+ * maintenance and distribution.
+ * In 2012, Vernalis and the University of York agreed to release the
+ * program as Open Source software.
+ * This version is licensed under GNU-LGPL version 3.0 with support from
+ * the University of Barcelona.
+ * http://rdock.sourceforge.net/
+ ***********************************************************************/
+
+#include "RbtNelderMead.h"
+
+#include "RbtBaseSF.h"
+
+RbtNelderMead::RbtNelderMead(RbtDouble alpha, RbtDouble beta, RbtDouble gamma, RbtDouble sigma):
+    m_alpha(alpha),
+    m_beta(beta),
+    m_gamma(gamma),
+    m_sigma(sigma),
+    m_maxCalls(-1),
+    m_stoppingLength(1e-8),
+    m_dimensions(0),
+    m_calls(0),
+    m_minIndex(0),
+    m_maxIndex(0) {
+    Resize(0);
+}
+
+void RbtNelderMead::InitRightSimplex(
+    const RbtDoubleList& basePoint, const RbtDoubleList& edgeLengths, Objective& objective
+) {
+    RbtInt n = basePoint.size();
+    Resize(n);
+    m_calls = 0;
+    // The base point is the last vertex, vertex i is displaced along axis i
+    for (RbtInt i = 0; i <= n; i++) {
+        std::copy(basePoint.begin(), basePoint.end(), m_vertices[i].begin());
+        if (i < n) {
+            m_vertices[i][i] += edgeLengths[i];
+        }
+    }
+    for (RbtInt i = 0; i <= n; i++) {
+        m_values[i] = Evaluate(objective, m_vertices[i]);
+    }
+    FindMinMaxIndices();
+}
+
+void RbtNelderMead::Minimise(Objective& objective) {
+    if (m_dimensions == 0) {
+        return;
+    }
+    FindMinMaxIndices();
+    do {
+        FindCentroid();
+        RbtDouble secondHighestValue = m_values[SecondHighestIndex()];
+        Extrapolate(m_vertices[m_maxIndex], -m_alpha, m_reflection);
+        RbtDouble reflectionValue = Evaluate(objective, m_reflection);
+
+        // Out of function calls: accept the reflection point and stop
+        if (BudgetExhausted()) {
+            m_vertices[m_maxIndex].swap(m_reflection);
+            m_values[m_maxIndex] = reflectionValue;
+            FindMinMaxIndices();
+            return;
+        }
+
+        if (m_values[m_minIndex] > reflectionValue) {
+            // Better than the best vertex: try to expand further
+            Extrapolate(m_reflection, m_gamma, m_expansion);
+            RbtDouble expansionValue = Evaluate(objective, m_expansion);
+            if (reflectionValue > expansionValue) {
+                m_vertices[m_maxIndex].swap(m_expansion);
+                m_values[m_maxIndex] = expansionValue;
+            } else {
+                m_vertices[m_maxIndex].swap(m_reflection);
+                m_values[m_maxIndex] = reflectionValue;
+            }
+        } else if ((secondHighestValue > reflectionValue) && (reflectionValue >= m_values[m_minIndex])) {
+            m_vertices[m_maxIndex].swap(m_reflection);
+            m_values[m_maxIndex] = reflectionValue;
+        } else if (reflectionValue >= secondHighestValue) {
+            // Contract towards the better of the highest vertex and the reflection point
+            RbtBool bFromHighest = (m_values[m_maxIndex] <= reflectionValue);
+            const RbtDoubleList& maxPrime = bFromHighest ? m_vertices[m_maxIndex] : m_reflection;
+            RbtDouble maxPrimeValue = bFromHighest ? m_values[m_maxIndex] : reflectionValue;
+            Extrapolate(maxPrime, m_beta, m_contraction);
+            RbtDouble contractionValue = Evaluate(objective, m_contraction);
+            RbtBool bShrink = bFromHighest ? (contractionValue >= maxPrimeValue) : (contractionValue > maxPrimeValue);
+            if (bShrink) {
+                ShrinkSimplex(objective);
+            } else {
+                m_vertices[m_maxIndex].swap(m_contraction);
+                m_values[m_maxIndex] = contractionValue;
+            }
+        } else {
+            // Only reachable with undefined (NaN) scores
+            return;
+        }
+        FindMinMaxIndices();
+    } while (!Stop());
+}
+
+////////////////////////////////////////
+// Private methods
+///////////////////
+void RbtNelderMead::Resize(RbtInt nDimensions) {
+    // Shrinking a vector keeps its capacity, so storage is only allocated when the dimension grows
+    m_dimensions = nDimensions;
+    m_vertices.resize(nDimensions + 1);
+    for (vector<RbtDoubleList>::iterator iter = m_vertices.begin(); iter != m_vertices.end(); ++iter) {
+        iter->resize(nDimensions);
+    }
+    m_values.resize(nDimensions + 1);
+    m_centroid.resize(nDimensions);
+    m_reflection.resize(nDimensions);
+    m_expansion.resize(nDimensions);
+    m_contraction.resize(nDimensions);
+    m_minIndex = m_maxIndex = 0;
+}
+
+RbtDouble RbtNelderMead::Evaluate(Objective& objective, const RbtDoubleList& x) {
+    m_calls++;
+    return objective.Evaluate(x);
+}
+
+RbtBool RbtNelderMead::Stop() const {
+    if (BudgetExhausted()) {
+        return true;
+    }
+    // Standard deviation of the vertex values about the mean of all but the lowest
+    RbtDouble mean = 0.0;
+    for (RbtInt i = 0; i <= m_dimensions; i++) {
+        if (i != m_minIndex) {
+            mean += m_values[i];
+        }
+    }
+    mean /= m_dimensions;
+    RbtDouble total = 0.0;
+    for (RbtInt i = 0; i <= m_dimensions; i++) {
+        RbtDouble d = m_values[i] - mean;
+        total += d * d;
+    }
+    total /= (m_dimensions + 1.0);
+    return (sqrt(total) < m_stoppingLength);
+}
+
+void RbtNelderMead::FindMinMaxIndices() {
+    m_minIndex = 0;
+    m_maxIndex = m_dimensions;
+    RbtDouble minValue = m_values[0];
+    RbtDouble maxValue = m_values[m_dimensions];
+    for (RbtInt i = 1; i <= m_dimensions; i++) {
+        if (m_values[i] < minValue) {
+            minValue = m_values[i];
+            m_minIndex = i;
+        }
+        // Scan from the other end so that ties are resolved as in NMSearch
+        if (m_values[m_dimensions - i] > maxValue) {
+            maxValue = m_values[m_dimensions - i];
+            m_maxIndex = m_dimensions - i;
+        }
+    }
+}
+
+RbtInt RbtNelderMead::SecondHighestIndex() const {
+    RbtInt secondIndex = m_minIndex;
+    RbtDouble secondValue = m_values[m_minIndex];
+    for (RbtInt i = 0; i <= m_dimensions; i++) {
+        if ((i != m_maxIndex) && (m_values[i] > secondValue)) {
+            secondValue = m_values[i];
+            secondIndex = i;
+        }
+    }
+    return secondIndex;
+}
+
+void RbtNelderMead::FindCentroid() {
+    std::fill(m_centroid.begin(), m_centroid.end(), 0.0);
+    for (RbtInt i = 0; i <= m_dimensions; i++) {
+        if (i != m_maxIndex) {
+            const RbtDoubleList& vertex = m_vertices[i];
+            for (RbtInt j = 0; j < m_dimensions; j++) {
+                m_centroid[j] += vertex[j];
+            }
+        }
+    }
+    RbtDouble scale = 1.0 / m_dimensions;
+    for (RbtInt j = 0; j < m_dimensions; j++) {
+        m_centroid[j] *= scale;
+    }
+}
+
+void RbtNelderMead::Extrapolate(const RbtDoubleList& p, RbtDouble coeff, RbtDoubleList& x) const {
+    for (RbtInt j = 0; j < m_dimensions; j++) {
+        x[j] = m_centroid[j] * (1.0 - coeff) + coeff * p[j];
+    }
+}
+
+void RbtNelderMead::ShrinkSimplex(Objective& objective) {
+    if (BudgetExhausted()) {
+        return;
+    }
+    const RbtDoubleList& lowest = m_vertices[m_minIndex];
+    for (RbtInt i = 0; i <= m_dimensions; i++) {
+        if (i == m_minIndex) {
+            continue;
+        }
+        RbtDoubleList& vertex = m_vertices[i];
+        for (RbtInt j = 0; j < m_dimensions; j++) {
+            vertex[j] += m_sigma * (lowest[j] - vertex[j]);
+        }
+        m_values[i] = Evaluate(objective, vertex);
+        if (BudgetExhausted()) {
+            return;
+        }
+    }
+}
+
+////////////////////////////////////////
+// RbtChromSFObjective
+///////////////////
+RbtDouble RbtChromSFObjective::Evaluate(const RbtDoubleList& x) {
+    // Some element values may be standardised by SetVector (e.g. angles out of range),
+    // but x itself is left unchanged, as in NMSearch
+    m_pChrom->SetVector(x);
+    m_pChrom->SyncToModel();
+    return m_pSF->Score();
+}
@@ -22,7 +22,7 @@ RbtString RbtNmrSF::_QUADRATIC("QUADRATIC");
 
 // NB - Virtual base class constructor (RbtBaseSF) gets called first,
 // implicit constructors for RbtBaseInterSF is called second
-RbtNmrSF::RbtNmrSF(const RbtString& strName): RbtBaseSF(_CT, strName), m_bQuadratic(true) {
+RbtNmrSF::RbtNmrSF(const RbtString& strName): RbtBaseSF(_CT, strName), m_bQuadratic(true), m_nNoe(0) {
     // Add parameters
     AddParameter(_FILENAME, RbtString("default.noe"));
     AddParameter(_QUADRATIC, m_bQuadratic);
@@ -85,8 +85,9 @@ void RbtNmrSF::SetupLigand() {
 }
 
 void RbtNmrSF::SetupScore() {
-    m_noeList.clear();
-    m_stdList.clear();
+    RbtNoeRestraintAtomsList noeList;  // List of all NOE interactions
+    RbtStdRestraintAtomsList stdList;  // List of all STD interactions
+    CompileRestraints(noeList, stdList);
     if (GetLigand().Null() || GetReceptor().Null()) return;
 
     RbtInt iTrace = GetTrace();
@@ -112,7 +113,7 @@ void RbtNmrSF::SetupScore() {
         }
         // Only store if NOE is OK - i.e. has found the restraint names in the atom list
         if (noe.isOK()) {
-            m_noeList.push_back(noe);
+            noeList.push_back(noe);
         } else {
             cout << "** WARNING - unable to match NOE restraint names to atom list" << endl;
             cout << noe << " not added" << endl;
@@ -136,115 +137,138 @@ void RbtNmrSF::SetupScore() {
             cout << "** Increase the RANGE parameter in " << GetFullName() << endl;
             cout << std << " not added" << endl;
         } else if (std.isOK()) {
-            m_stdList.push_back(std);
+            stdList.push_back(std);
         } else {
             cout << "** WARNING - unable to match STD restraint names to atom list" << endl;
             cout << std << " not added" << endl;
         }
     }
+    CompileRestraints(noeList, stdList);
 }
 
 RbtDouble RbtNmrSF::RawScore() const {
     RbtDouble score(0.0);
-    // QUADRATIC POTENTIAL
-    if (m_bQuadratic) {
-        for (RbtNoeRestraintAtomsListConstIter iter = m_noeList.begin(); iter != m_noeList.end(); iter++) {
-            RbtDouble r = NoeDistance(*iter);
-            RbtDouble dr = r - (*iter).maxDist;  // delta(R)
-            RbtDouble s = (dr > 0.0) ? dr * dr : 0.0;
-            // cout << "(NOE) R,RMAX,DR,S=" << r << "," << (*iter).maxDist << "," << dr << "," << s << endl;
-            score += s;
-        }
-        for (RbtStdRestraintAtomsListConstIter iter = m_stdList.begin(); iter != m_stdList.end(); iter++) {
-            RbtDouble r = StdDistance(*iter);
-            RbtDouble dr = r - (*iter).maxDist;  // delta(R)
-            RbtDouble s = (dr > 0.0) ? dr * dr : 0.0;
-            // cout << "(STD) R,RMAX,DR,S=" << r << "," << (*iter).maxDist << "," << dr << "," << s << endl;
-            score += s;
-        }
+    RbtUInt nRestr = m_restrMaxDist.size();
+    for (RbtUInt i = 0; i < nRestr; i++) {
+        RbtDouble r = (i < m_nNoe) ? NoeDistance(i) : StdDistance(i);
+        RbtDouble dr = std::max(r - m_restrMaxDist[i], 0.0);  // delta(R)
+        // QUADRATIC or LINEAR POTENTIAL
+        score += (m_bQuadratic) ? dr * dr : dr;
+    }
+    return score;
+}
+
+void RbtNmrSF::CompileRestraints(const RbtNoeRestraintAtomsList& noeList, const RbtStdRestraintAtomsList& stdList) {
+    m_endAtoms.clear();
+    m_endMasses.clear();
+    m_endStart.assign(1, 0);
+    m_endTypes.clear();
+    m_endTotalMasses.clear();
+    m_restrFrom.clear();
+    m_restrTo.clear();
+    m_restrMaxDist.clear();
+    m_restrSimple.clear();
+    m_nNoe = noeList.size();
+    for (RbtNoeRestraintAtomsListConstIter iter = noeList.begin(); iter != noeList.end(); iter++) {
+        m_restrFrom.push_back(AddRestraintEnd((*iter).from));
+        m_restrTo.push_back(AddRestraintEnd((*iter).to));
+        m_restrMaxDist.push_back((*iter).maxDist);
+        m_restrSimple.push_back((*iter).isSimple());
     }
-    // LINEAR POTENTIAL
-    else {
-        for (RbtNoeRestraintAtomsListConstIter iter = m_noeList.begin(); iter != m_noeList.end(); iter++) {
-            RbtDouble r = NoeDistance(*iter);
-            RbtDouble dr = r - (*iter).maxDist;  // delta(R)
-            RbtDouble s = (dr > 0.0) ? dr : 0.0;
-            // cout << "(NOE) R,RMAX,DR,S=" << r << "," << (*iter).maxDist << "," << dr << "," << s << endl;
-            score += s;
+    for (RbtStdRestraintAtomsListConstIter iter = stdList.begin(); iter != stdList.end(); iter++) {
+        m_restrFrom.push_back(AddRestraintEnd((*iter).from));
+        m_restrTo.push_back(0);  // Unused
+        m_restrMaxDist.push_back((*iter).maxDist);
+        m_restrSimple.push_back(false);
+    }
+    // Reserve the scratch coord lists for the largest restraint end
+    RbtUInt maxSize = 0;
+    for (RbtUInt i = 0; i < m_endTypes.size(); i++) {
+        maxSize = std::max(maxSize, m_endStart[i + 1] - m_endStart[i]);
+    }
+    m_fromCoords.reserve(maxSize);
+    m_toCoords.reserve(maxSize);
+}
+
+RbtUInt RbtNmrSF::AddRestraintEnd(const RbtNoeEndAtoms& end) {
+    for (RbtAtomListConstIter iter = end.atoms.begin(); iter != end.atoms.end(); iter++) {
+        m_endAtoms.push_back(*iter);
+        m_endMasses.push_back((*iter)->GetAtomicMass());
+    }
+    m_endStart.push_back(m_endAtoms.size());
+    m_endTypes.push_back(end.type);
+    m_endTotalMasses.push_back(Rbt::GetTotalAtomicMass(end.atoms));
+    return m_endTypes.size() - 1;
+}
+
+// If the restraint end is defined of type MEAN, just store the center of mass of
+// the atoms in the list
+// If the restraint end is defined of type OR or AND, store all coords
+void RbtNmrSF::GetEndCoords(RbtUInt iEnd, RbtCoordList& coords) const {
+    coords.clear();
+    RbtUInt iStart = m_endStart[iEnd];
+    RbtUInt iEndStart = m_endStart[iEnd + 1];
+    if (m_endTypes[iEnd] == Rbt::NOE_MEAN) {
+        RbtCoord com;
+        for (RbtUInt i = iStart; i < iEndStart; i++) {
+            com += m_endMasses[i] * m_endAtoms[i]->GetCoords();
         }
-        for (RbtStdRestraintAtomsListConstIter iter = m_stdList.begin(); iter != m_stdList.end(); iter++) {
-            RbtDouble r = StdDistance(*iter);
-            RbtDouble dr = r - (*iter).maxDist;  // delta(R)
-            RbtDouble s = (dr > 0.0) ? dr : 0.0;
-            // cout << "(STD) R,RMAX,DR,S=" << r << "," << (*iter).maxDist << "," << dr << "," << s << endl;
-            score += s;
+        com /= m_endTotalMasses[iEnd];
+        coords.push_back(com);
+    } else {
+        for (RbtUInt i = iStart; i < iEndStart; i++) {
+            coords.push_back(m_endAtoms[i]->GetCoords());
         }
     }
-    return score;
 }
 
-RbtDouble RbtNmrSF::NoeDistance(const RbtNoeRestraintAtoms& noe) const {
+RbtDouble RbtNmrSF::NoeDistance(RbtUInt iRestr) const {
+    RbtUInt iFrom = m_restrFrom[iRestr];
+    RbtUInt iTo = m_restrTo[iRestr];
     // Simple, unambiguous restraint - just return the interatomic distance
-    if (noe.isSimple()) {
-        return Rbt::BondLength(noe.from.atoms.front(), noe.to.atoms.front());
+    if (m_restrSimple[iRestr]) {
+        return Rbt::BondLength(m_endAtoms[m_endStart[iFrom]], m_endAtoms[m_endStart[iTo]]);
     }
     // More complex cases
     // Compile the list of coords at each end
-    // If the restraint end is defined of type MEAN, just store the center of mass of
-    // the atoms in the list
-    // If the restraint end is defined of type OR or AND, store all coords
-    else {
-        RbtCoordList fromCoords;
-        if (noe.from.type == Rbt::NOE_MEAN)
-            fromCoords.push_back(Rbt::GetCenterOfMass(noe.from.atoms));
-        else
-            fromCoords = Rbt::GetCoordList(noe.from.atoms);
+    GetEndCoords(iFrom, m_fromCoords);
+    GetEndCoords(iTo, m_toCoords);
+    RbtBool bFromAnd = (m_endTypes[iFrom] == Rbt::NOE_AND);
+    RbtBool bToAnd = (m_endTypes[iTo] == Rbt::NOE_AND);
 
-        RbtCoordList toCoords;
-        if (noe.to.type == Rbt::NOE_MEAN)
-            toCoords.push_back(Rbt::GetCenterOfMass(noe.to.atoms));
-        else
-            toCoords = Rbt::GetCoordList(noe.to.atoms);
-
-        RbtDouble dist_sq(0.0);  // Keep track of minimum distance**2
-        // Iterate over coords in each list and return the appropriate distance**2 between any of them
-        for (RbtCoordListConstIter fIter = fromCoords.begin(); fIter != fromCoords.end(); fIter++) {
-            // dist1_sq is the appropriate distance**2 between the current "from" coord
-            // and all the coords in the "to" list.
-            // i.e. if to.type==NOE_AND, dist1_sq is the max distance**2 to any atom in the "to" list
-            // else dist1_sq is the min distance**2 to any atom in the "to" list
-            RbtDouble dist1_sq(0.0);
-            for (RbtCoordListConstIter tIter = toCoords.begin(); tIter != toCoords.end(); tIter++) {
-                RbtDouble r12_sq = Rbt::Length2(*fIter, *tIter);
-                dist1_sq = (tIter == toCoords.begin())     ? r12_sq
-                           : (noe.to.type == Rbt::NOE_AND) ? std::max(dist1_sq, r12_sq)
-                                                           : std::min(dist1_sq, r12_sq);
-            }
-            // dist_sq is the appropriate overall distance**2 for all the calculated dist1_sq's
-            // i.e. if from.type==NOE_AND, dist_sq is the max of all the dist1_sq's
-            // else dist_sq is the min of all the dist1_sq's
-            dist_sq = (fIter == fromCoords.begin())     ? dist1_sq
-                      : (noe.from.type == Rbt::NOE_AND) ? std::max(dist_sq, dist1_sq)
-                                                        : std::min(dist_sq, dist1_sq);
+    RbtDouble dist_sq(0.0);  // Keep track of minimum distance**2
+    // Iterate over coords in each list and return the appropriate distance**2 between any of them
+    for (RbtCoordListConstIter fIter = m_fromCoords.begin(); fIter != m_fromCoords.end(); fIter++) {
+        // dist1_sq is the appropriate distance**2 between the current "from" coord
+        // and all the coords in the "to" list.
+        // i.e. if to.type==NOE_AND, dist1_sq is the max distance**2 to any atom in the "to" list
+        // else dist1_sq is the min distance**2 to any atom in the "to" list
+        RbtDouble dist1_sq(0.0);
+        for (RbtCoordListConstIter tIter = m_toCoords.begin(); tIter != m_toCoords.end(); tIter++) {
+            RbtDouble r12_sq = Rbt::Length2(*fIter, *tIter);
+            dist1_sq = (tIter == m_toCoords.begin()) ? r12_sq
+                       : (bToAnd)                    ? std::max(dist1_sq, r12_sq)
+                                                     : std::min(dist1_sq, r12_sq);
         }
-        return sqrt(dist_sq);
+        // dist_sq is the appropriate overall distance**2 for all the calculated dist1_sq's
+        // i.e. if from.type==NOE_AND, dist_sq is the max of all the dist1_sq's
+        // else dist_sq is the min of all the dist1_sq's
+        dist_sq = (fIter == m_fromCoords.begin()) ? dist1_sq
+                  : (bFromAnd)                    ? std::max(dist_sq, dist1_sq)
+                                                  : std::min(dist_sq, dist1_sq);
     }
+    return sqrt(dist_sq);
 }
 
-RbtDouble RbtNmrSF::StdDistance(const RbtStdRestraintAtoms& std) const {
-    // Compile the list of coords at each end
-    // If the restraint end is defined of type MEAN, just store the center of mass of
-    // the atoms in the list
-    // If the restraint end is defined of type OR or AND, store all coords
-    RbtCoordList fromCoords;
-    if (std.from.type == Rbt::NOE_MEAN)
-        fromCoords.push_back(Rbt::GetCenterOfMass(std.from.atoms));
-    else
-        fromCoords = Rbt::GetCoordList(std.from.atoms);
+RbtDouble RbtNmrSF::StdDistance(RbtUInt iRestr) const {
+    RbtUInt iFrom = m_restrFrom[iRestr];
+    // Compile the list of coords at the ligand end
+    GetEndCoords(iFrom, m_fromCoords);
+    RbtBool bFromAnd = (m_endTypes[iFrom] == Rbt::NOE_AND);
 
     RbtDouble dist_sq(999.9);  // Keep track of minimum distance**2
     // Iterate over coords in each list and return the appropriate distance**2 between any of them
-    for (RbtCoordListConstIter fIter = fromCoords.begin(); fIter != fromCoords.end(); fIter++) {
+    for (RbtCoordListConstIter fIter = m_fromCoords.begin(); fIter != m_fromCoords.end(); fIter++) {
         // dist1_sq is the minimum distance**2 between the current "from" coord
         // and all the coords in the "to" list.
         RbtDouble dist1_sq(999.9);
@@ -257,9 +281,9 @@ RbtDouble RbtNmrSF::StdDistance(const RbtStdRestraintAtoms& std) const {
         // dist_sq is the appropriate overall distance**2 for all the calculated dist1_sq's
         // i.e. if from.type==NOE_AND, dist_sq is the max of all the dist1_sq's
         // else dist_sq is the min of all the dist1_sq's
-        dist_sq = (fIter == fromCoords.begin())     ? dist1_sq
-                  : (std.from.type == Rbt::NOE_AND) ? std::max(dist_sq, dist1_sq)
-                                                    : std::min(dist_sq, dist1_sq);
+        dist_sq = (fIter == m_fromCoords.begin()) ? dist1_sq
+                  : (bFromAnd)                    ? std::max(dist_sq, dist1_sq)
+                                                  : std::min(dist_sq, dist1_sq);
     }
     return sqrt(dist_sq);
 }
@@ -60,7 +60,7 @@ void RbtNullTransform::Execute() {
         } else {
             const RbtGenomeList& genList = pop->GetGenomeList();
             for (RbtGenomeListConstIter gIter = genList.begin(); gIter != genList.end(); ++gIter) {
-                (*gIter)->GetChrom()->SyncToModel();
+                (*gIter)->SyncToModel();
                 GetWorkSpace()->SaveHistory(true);
             }
         }
@@ -31,6 +31,7 @@ const RbtString& RbtPRMFactory::_REC_COORD_FILE = "RECEPTOR_COORD_FILE";
 const RbtString& RbtPRMFactory::_REC_NUM_COORD_FILES = "RECEPTOR_NUM_COORD_FILES";
 const RbtString& RbtPRMFactory::_REC_FLEX_DISTANCE = "RECEPTOR_FLEX";
 const RbtString& RbtPRMFactory::_REC_DIHEDRAL_STEP = "RECEPTOR_DIHEDRAL_STEP";
+const RbtString& RbtPRMFactory::_REC_ROTAMER_STEP = "RECEPTOR_ROTAMER_STEP";
 const RbtString& RbtPRMFactory::_LIG_SECTION = "LIGAND";
 const RbtString& RbtPRMFactory::_SOLV_SECTION = "SOLVENT";
 const RbtString& RbtPRMFactory::_SOLV_FILE = "FILE";
@@ -278,6 +279,13 @@ void RbtPRMFactory::AttachReceptorFlexData(RbtModel* pReceptor) {
                 cout << endl << _REC_DIHEDRAL_STEP << " = " << dihedralStepSize << endl;
             }
         }
+        if (m_pParamSource->isParameterPresent(_REC_ROTAMER_STEP)) {
+            RbtDouble rotamerStep = m_pParamSource->GetParameterValue(_REC_ROTAMER_STEP);
+            pFlexData->SetParameter(RbtReceptorFlexData::_ROTAMER_STEP, rotamerStep);
+            if (m_iTrace > 0) {
+                cout << endl << _REC_ROTAMER_STEP << " = " << rotamerStep << endl;
+            }
+        }
         pReceptor->SetFlexData(pFlexData);
         if (m_iTrace > 0) {
             cout << endl << "RECEPTOR FLEXIBILITY PARAMETERS:" << endl << *pFlexData << endl;
@@ -15,6 +15,7 @@
 #include "RbtFileError.h"
 #include "RbtLigandError.h"
 #include "RbtMdlFileSink.h"
+#include "RbtPseudoAtom.h"
 #include "RbtWorkSpace.h"
 
 // Static data members
@@ -23,15 +24,30 @@ RbtString RbtPharmaSF::_CONSTRAINTS_FILE("CONSTRAINTS_FILE");
 RbtString RbtPharmaSF::_OPTIONAL_FILE("OPTIONAL_FILE");
 RbtString RbtPharmaSF::_NOPT("NOPT");
 RbtString RbtPharmaSF::_WRITE_ERRORS("WRITE_ERRORS");
+RbtString RbtPharmaSF::_CHECK_DISTANCES("CHECK_DISTANCES");
+
+// Index of pAtom in the ligand atom list. Throws if pAtom does not belong to the ligand
+static RbtUInt GetLigandAtomIndex(const std::map<RbtAtom*, RbtUInt>& atomIndex, RbtAtom* pAtom) {
+    std::map<RbtAtom*, RbtUInt>::const_iterator iter = atomIndex.find(pAtom);
+    if (iter == atomIndex.end()) {
+        throw RbtLigandError(_WHERE_, pAtom->GetFullAtomName() + " is not in the ligand atom list");
+    }
+    return iter->second;
+}
 
 // NB - Virtual base class constructor (RbtBaseSF) gets called first,
 // implicit constructor for RbtBaseInterSF is called second
-RbtPharmaSF::RbtPharmaSF(const RbtString& strName): RbtBaseSF(_CT, strName), m_nopt(0), m_bWriteErrors(false) {
+RbtPharmaSF::RbtPharmaSF(const RbtString& strName):
+    RbtBaseSF(_CT, strName),
+    m_nopt(0),
+    m_bWriteErrors(false),
+    m_bCheckDistances(true) {
     // Add parameters It gets the right name in SetupReceptor
     AddParameter(_CONSTRAINTS_FILE, ".const");
     AddParameter(_OPTIONAL_FILE, "_opt.const");
     AddParameter(_NOPT, m_nopt);
     AddParameter(_WRITE_ERRORS, m_bWriteErrors);
+    AddParameter(_CHECK_DISTANCES, m_bCheckDistances);
     SetTrace(1);  // Provide a bit of debug output by default
 #ifdef _DEBUG
     cout << _CT << " parameterised constructor" << endl;
@@ -123,6 +139,12 @@ void RbtPharmaSF::SetupLigand() {
         if (GetTrace() > 0) {
             cout << _CT << ": All mandatory features found" << endl;
         }
+        if (m_bCheckDistances) {
+            CheckMandatoryDistances();
+            if (GetTrace() > 0) {
+                cout << _CT << ": All mandatory feature distances are within range of the ligand topology" << endl;
+            }
+        }
     } catch (RbtLigandError& e) {
         if (m_bWriteErrors) {
             m_spErrorFile->SetModel(GetLigand());
@@ -167,11 +189,116 @@ RbtDouble RbtPharmaSF::RawScore() const {
     return total;
 }
 
+// The maximum separation of two ligand atoms in any conformation is bounded by the sum of the bond lengths
+// along the shortest bonded path between them (bond lengths do not change during docking).
+// Ring centroid pseudoatoms are bounded via their constituent ring atoms.
+// For each pair of mandatory constraints, at least one pair of matching ligand features must be able to
+// span the distance between the constraint centers, less the two tolerances.
+// This is a necessary (not sufficient) condition for satisfying all the mandatory constraints.
+void RbtPharmaSF::CheckMandatoryDistances() const {
+    RbtUInt nConstr = m_constrList.size();
+    if (nConstr < 2) return;
+    RbtModelPtr spLigand = GetLigand();
+    RbtAtomList atomList = spLigand->GetAtomList();
+    RbtUInt nAtoms = atomList.size();
+    std::map<RbtAtom*, RbtUInt> atomIndex;
+    for (RbtUInt i = 0; i < nAtoms; i++) {
+        atomIndex[atomList[i]] = i;
+    }
+
+    // Shortest bonded path lengths between all ligand atoms (Floyd-Warshall)
+    const RbtDouble unbounded = std::numeric_limits<RbtDouble>::max();
+    vector<RbtDoubleList> maxDist(nAtoms, RbtDoubleList(nAtoms, unbounded));
+    for (RbtUInt i = 0; i < nAtoms; i++) {
+        maxDist[i][i] = 0.0;
+    }
+    RbtBondList bondList = spLigand->GetBondList();
+    for (RbtBondListConstIter iter = bondList.begin(); iter != bondList.end(); iter++) {
+        RbtUInt i = GetLigandAtomIndex(atomIndex, (*iter)->GetAtom1Ptr());
+        RbtUInt j = GetLigandAtomIndex(atomIndex, (*iter)->GetAtom2Ptr());
+        maxDist[i][j] = maxDist[j][i] = Rbt::BondLength((*iter)->GetAtom1Ptr(), (*iter)->GetAtom2Ptr());
+    }
+    for (RbtUInt k = 0; k < nAtoms; k++) {
+        for (RbtUInt i = 0; i < nAtoms; i++) {
+            if (maxDist[i][k] == unbounded) continue;
+            for (RbtUInt j = 0; j < nAtoms; j++) {
+                if ((maxDist[k][j] != unbounded) && (maxDist[i][k] + maxDist[k][j] < maxDist[i][j])) {
+                    maxDist[i][j] = maxDist[i][k] + maxDist[k][j];
+                }
+            }
+        }
+    }
+
+    // Maximum separation of a pair of features (atoms or ring centroids)
+    // Each feature is expanded to its constituent atoms, with the fixed offset of each atom from the feature
+    vector<RbtUIntList> featureAtoms(nConstr);
+    vector<vector<RbtDoubleList> > featureOffsets(nConstr);
+    for (RbtUInt c = 0; c < nConstr; c++) {
+        const RbtAtomList& features = m_constrList[c]->GetAtomList();
+        featureOffsets[c] = vector<RbtDoubleList>(features.size());
+        for (RbtAtomListConstIter fIter = features.begin(); fIter != features.end(); fIter++) {
+            RbtAtomList constituents;
+            RbtPseudoAtom* pPseudo = dynamic_cast<RbtPseudoAtom*>((RbtAtom*)(*fIter));
+            if (pPseudo) {
+                constituents = pPseudo->GetAtomList();
+            } else {
+                constituents.push_back(*fIter);
+            }
+            RbtDoubleList& offsets = featureOffsets[c][fIter - features.begin()];
+            for (RbtAtomListConstIter aIter = constituents.begin(); aIter != constituents.end(); aIter++) {
+                featureAtoms[c].push_back(GetLigandAtomIndex(atomIndex, *aIter));
+                offsets.push_back(Rbt::Length((*aIter)->GetCoords(), (*fIter)->GetCoords()));
+            }
+        }
+    }
+
+    for (RbtUInt c1 = 0; c1 < nConstr; c1++) {
+        for (RbtUInt c2 = c1 + 1; c2 < nConstr; c2++) {
+            const RbtConstraintPtr& spCon1 = m_constrList[c1];
+            const RbtConstraintPtr& spCon2 = m_constrList[c2];
+            RbtDouble required = Rbt::Length(spCon1->GetCoords(), spCon2->GetCoords()) - spCon1->GetTolerance()
+                                 - spCon2->GetTolerance();
+            if (required <= 0.0) continue;
+            RbtDouble best = 0.0;  // Largest possible separation of any pair of matching features
+            RbtUInt i1 = 0;
+            for (RbtUInt f1 = 0; f1 < featureOffsets[c1].size() && best < required; f1++) {
+                const RbtDoubleList& offsets1 = featureOffsets[c1][f1];
+                RbtUInt i2 = 0;
+                for (RbtUInt f2 = 0; f2 < featureOffsets[c2].size() && best < required; f2++) {
+                    const RbtDoubleList& offsets2 = featureOffsets[c2][f2];
+                    // Bound on feature-feature distance is the tightest bound via any pair of constituent atoms
+                    RbtDouble bound = unbounded;
+                    for (RbtUInt a1 = 0; a1 < offsets1.size(); a1++) {
+                        for (RbtUInt a2 = 0; a2 < offsets2.size(); a2++) {
+                            RbtDouble d = maxDist[featureAtoms[c1][i1 + a1]][featureAtoms[c2][i2 + a2]];
+                            if (d != unbounded) {
+                                bound = std::min(bound, d + offsets1[a1] + offsets2[a2]);
+                            }
+                        }
+                    }
+                    best = std::max(best, bound);
+                    i2 += offsets2.size();
+                }
+                i1 += offsets1.size();
+            }
+            if (best < required) {
+                ostringstream ostr;
+                ostr << "Mandatory ph4 constraints " << c1 + 1 << " and " << c2 + 1 << " require features at least "
+                     << required << " A apart, but the matching ligand features can be at most " << best
+                     << " A apart" << ends;
+                throw RbtLigandError(_WHERE_, ostr.str());
+            }
+        }
+    }
+}
+
 // DM 25 Oct 2000 - track changes to parameter values in local data members
 // ParameterUpdated is invoked by RbtParamHandler::SetParameter
 void RbtPharmaSF::ParameterUpdated(const RbtString& strName) {
     if (strName == _WRITE_ERRORS) {
         m_bWriteErrors = GetParameter(_WRITE_ERRORS);
+    } else if (strName == _CHECK_DISTANCES) {
+        m_bCheckDistances = GetParameter(_CHECK_DISTANCES);
     } else if (strName == _NOPT) {
         m_nopt = GetParameter(_NOPT);
     }
@@ -0,0 +1,466 @@
+/***********************************************************************
+ * The rDock program was developed from 1998 - 2006 by the software team
+ * at RiboTargets (subsequently Vernalis (R&D) Ltd).
+ * In 2006, the software was licensed to the University of York for
+ * maintenance and distribution.
+ * In 2012, Vernalis and the University of York agreed to release the
+ * program as Open Source software.
+ * This version is licensed under GNU-LGPL version 3.0 with support from
+ * the University of Barcelona.
+ * http://rdock.sourceforge.net/
+ ***********************************************************************/
+
+#include "RbtPolarGridSF.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+#include "RbtBiMolWorkSpace.h"
+#include "RbtFileError.h"
+#include "RbtPolarIdxSF.h"
+
+// Static data members
+RbtString RbtPolarGridSF::_CT("RbtPolarGridSF");
+RbtString RbtPolarGridSF::_GRID("GRID");
+RbtString RbtPolarGridSF::_SMOOTHED("SMOOTHED");
+
+// Probe class names, in eProbeClass order
+static const char* const PROBE_CLASS_NAMES[] = {"HBD", "HBA", "METAL", "GUAN"};
+static const RbtInt NUM_PROBE_CLASSES = 4;
+// Number of cube map cells along each edge of a cube face, for looking up the closest probe direction
+static const RbtUInt CUBE_MAP_SIZE = 16;
+
+// Collects all the RbtPolarIdxSF scoring functions in the scoring function tree
+static void GetPolarIdxSFs(RbtBaseSF* pSF, vector<RbtPolarIdxSF*>& polarSFs) {
+    if (pSF == NULL) return;
+    RbtPolarIdxSF* pPolarSF = dynamic_cast<RbtPolarIdxSF*>(pSF);
+    if (pPolarSF != NULL) {
+        polarSFs.push_back(pPolarSF);
+    }
+    for (RbtUInt i = 0; i < pSF->GetNumSF(); i++) {
+        GetPolarIdxSFs(pSF->GetSF(i), polarSFs);
+    }
+}
+
+// True if the polar scoring function scores ligand interaction centers of the given probe class
+static RbtBool isProbeClassIncluded(const RbtPolarIdxSF* pSF, RbtPolarGridSF::eProbeClass probeClass) {
+    switch (probeClass) {
+        case RbtPolarGridSF::HBD:
+            return pSF->GetParameter(RbtPolarSF::_INCHBD);
+        case RbtPolarGridSF::HBA:
+            return pSF->GetParameter(RbtPolarSF::_INCHBA);
+        case RbtPolarGridSF::METAL:
+            return pSF->GetParameter(RbtPolarSF::_INCMETAL);
+        case RbtPolarGridSF::GUAN:
+            return pSF->GetParameter(RbtPolarSF::_INCGUAN);
+        default:
+            return false;
+    }
+}
+
+// NB - Virtual base class constructor (RbtBaseSF) gets called first,
+// implicit constructor for RbtBaseInterSF and RbtPolarSF are called second
+RbtPolarGridSF::RbtPolarGridSF(const RbtString& strName): RbtBaseSF(_CT, strName), m_bSmoothed(true) {
+    // Add parameters
+    AddParameter(_GRID, "_polar.grd");
+    AddParameter(_SMOOTHED, m_bSmoothed);
+#ifdef _DEBUG
+    cout << _CT << " parameterised constructor" << endl;
+#endif  //_DEBUG
+    _RBTOBJECTCOUNTER_CONSTR_(_CT);
+}
+
+RbtPolarGridSF::~RbtPolarGridSF() {
+#ifdef _DEBUG
+    cout << _CT << " destructor" << endl;
+#endif  //_DEBUG
+    _RBTOBJECTCOUNTER_DESTR_(_CT);
+}
+
+RbtString RbtPolarGridSF::GetProbeName(eProbeClass probeClass, RbtDouble radius) {
+    ostringstream ostr;
+    ostr << PROBE_CLASS_NAMES[probeClass] << "_" << std::fixed << std::setprecision(2) << radius;
+    return ostr.str();
+}
+
+void RbtPolarGridSF::ParseProbeName(const RbtString& strProbe, eProbeClass& probeClass, RbtDouble& radius) {
+    RbtString::size_type pos = strProbe.rfind('_');
+    if (pos != RbtString::npos) {
+        RbtString strClass = strProbe.substr(0, pos);
+        istringstream istr(strProbe.substr(pos + 1));
+        RbtDouble r = 0.0;
+        istr >> r;
+        if (!istr.fail() && istr.eof() && (r > 0.0)) {
+            for (RbtInt i = 0; i < NUM_PROBE_CLASSES; i++) {
+                if (strClass == PROBE_CLASS_NAMES[i]) {
+                    probeClass = eProbeClass(i);
+                    radius = r;
+                    return;
+                }
+            }
+        }
+    }
+    throw RbtBadArgument(
+        _WHERE_, "Invalid polar probe name: " + strProbe + " (expected HBD, HBA, METAL or GUAN + _ + vdW radius)"
+    );
+}
+
+RbtBool RbtPolarGridSF::isDirectional(RbtBiMolWorkSpace* pWorkSpace, eProbeClass probeClass) {
+    // Metals always score from the metal atom alone, and guanidinium carbons only have an angular
+    // dependence if the plane of the guanidinium is used
+    if (probeClass == METAL) return false;
+    vector<RbtPolarIdxSF*> polarSFs;
+    GetPolarIdxSFs(pWorkSpace->GetSF(), polarSFs);
+    for (vector<RbtPolarIdxSF*>::const_iterator iter = polarSFs.begin(); iter != polarSFs.end(); iter++) {
+        if (!(*iter)->isEnabled() || !isProbeClassIncluded(*iter, probeClass)) continue;
+        RbtBool bGuanPlane = (*iter)->GetParameter(_GUAN_PLANE);
+        if ((probeClass != GUAN) || bGuanPlane) {
+            return true;
+        }
+    }
+    return false;
+}
+
+RbtCoordList RbtPolarGridSF::CreateProbeDirections(RbtInt nDirections) {
+    RbtCoordList directions;
+    const RbtDouble goldenAngle = M_PI * (3.0 - sqrt(5.0));
+    for (RbtInt i = 0; i < nDirections; i++) {
+        RbtDouble z = 1.0 - (2.0 * i + 1.0) / nDirections;
+        RbtDouble r = sqrt(1.0 - z * z);
+        RbtDouble phi = goldenAngle * i;
+        directions.push_back(RbtCoord(r * cos(phi), r * sin(phi), z));
+    }
+    return directions;
+}
+
+void RbtPolarGridSF::CalculateProbeGrid(
+    RbtBiMolWorkSpace* pWorkSpace, const RbtString& strProbe, const RbtCoord& direction, RbtRealGrid* pGrid
+) {
+    eProbeClass probeClass;
+    RbtDouble radius;
+    ParseProbeName(strProbe, probeClass, radius);
+    vector<RbtPolarIdxSF*> polarSFs;
+    GetPolarIdxSFs(pWorkSpace->GetSF(), polarSFs);
+
+    // The probe is a free-standing interaction center atom, plus two dummy atoms which define its direction,
+    // 1A away. HBD and HBA probes point from the donor H / acceptor to its parent atom, guanidinium probes
+    // have the dummy atoms in the plane normal to the direction. The probe atom user1 value is 1.0, as the
+    // ligand charge and neighbour density scaling is applied when the grid is used
+    RbtAtom probeAtom(1);
+    RbtAtom dummyAtom2(2);
+    RbtAtom dummyAtom3(3);
+    probeAtom.SetVdwRadius(radius);
+    probeAtom.SetUser1Value(1.0);
+    RbtVector d = direction.Unit();
+    RbtVector offset2 = d;
+    RbtVector offset3;
+    if (probeClass == GUAN) {
+        RbtVector axis = (fabs(d.x) < 0.9) ? RbtVector(1.0, 0.0, 0.0) : RbtVector(0.0, 1.0, 0.0);
+        offset2 = Rbt::Cross(d, axis).Unit();
+        offset3 = Rbt::Cross(d, offset2);
+    }
+    RbtInteractionCenter singleIC(&probeAtom);
+    RbtInteractionCenter angleIC(&probeAtom, &dummyAtom2);
+    RbtInteractionCenter planeIC(&probeAtom, &dummyAtom2, &dummyAtom3);
+
+    // Probe interaction center to use with each scoring function (NULL if the probe is not scored)
+    RbtInteractionCenterList probeICs;
+    for (vector<RbtPolarIdxSF*>::const_iterator iter = polarSFs.begin(); iter != polarSFs.end(); iter++) {
+        RbtInteractionCenter* pIC = NULL;
+        if ((*iter)->isEnabled() && isProbeClassIncluded(*iter, probeClass)) {
+            if (probeClass == METAL) {
+                pIC = &singleIC;
+            } else if (probeClass == GUAN) {
+                RbtBool bGuanPlane = (*iter)->GetParameter(_GUAN_PLANE);
+                pIC = (bGuanPlane) ? &planeIC : &singleIC;
+            } else {
+                pIC = &angleIC;
+            }
+        }
+        probeICs.push_back(pIC);
+    }
+
+    RbtBool bAcceptor = (probeClass == HBA);
+    RbtInteractionCenterList probeList(1);
+    RbtInteractionCenterList emptyList;
+    for (RbtUInt iXYZ = 0; iXYZ < pGrid->GetN(); iXYZ++) {
+        RbtCoord c = pGrid->GetCoord(iXYZ);
+        probeAtom.SetCoords(c);
+        dummyAtom2.SetCoords(c + offset2);
+        dummyAtom3.SetCoords(c + offset3);
+        RbtDouble score = 0.0;
+        for (RbtUInt i = 0; i < polarSFs.size(); i++) {
+            if (probeICs[i] == NULL) continue;
+            probeList[0] = probeICs[i];
+            RbtDouble s = (bAcceptor) ? polarSFs[i]->ProbeScore(emptyList, probeList)
+                                      : polarSFs[i]->ProbeScore(probeList, emptyList);
+            score += polarSFs[i]->GetWeight() * s;
+        }
+        pGrid->SetValue(iXYZ, score);
+    }
+}
+
+void RbtPolarGridSF::SetupReceptor() {
+    m_probeGrids.clear();
+    if (GetReceptor().Null()) return;
+
+    // Trap multiple receptor conformations and flexible OH/NH3 here: this SF does not support them yet
+    RbtBool bEnsemble = (GetReceptor()->GetNumSavedCoords() > 1);
+    RbtBool bFlexRec = GetReceptor()->isFlexible();
+    if (bEnsemble || bFlexRec) {
+        RbtString message("Polar grid scoring function does not support multiple receptor conformations\n");
+        message += "or flexible OH/NH3 groups yet";
+        throw RbtInvalidRequest(_WHERE_, message);
+    }
+
+    // Read grids
+    // File names are composed of workspace name + grid suffix
+    RbtString strWSName = GetWorkSpace()->GetName();
+    RbtString strSuffix = GetParameter(_GRID);
+    RbtString strFile = Rbt::GetRbtFileName("data/grids", strWSName + strSuffix);
+#ifdef __sgi
+    ifstream istr(strFile.c_str(), ios_base::in);
+#else
+    ifstream istr(strFile.c_str(), ios_base::in | ios_base::binary);
+#endif
+    if (!istr) {
+        throw RbtFileReadError(_WHERE_, "Unable to open " + strFile);
+    }
+    ReadGrids(istr);
+    istr.close();
+}
+
+void RbtPolarGridSF::SetupLigand() {
+    m_ligCenters.clear();
+    if (GetLigand().Null()) return;
+
+    // The ligand interaction centers are created as for RbtPolarIdxSF, but only their atoms are kept
+    RbtAtomList atomList(GetLigand()->GetAtomList());
+    RbtInteractionCenterList posList = CreateDonorInteractionCenters(atomList);
+    RbtInteractionCenterList negList = CreateAcceptorInteractionCenters(atomList);
+    Rbt::isAtomMetal bIsMetal;
+    Rbt::isAtomGuanidiniumCarbon bIsGuan;
+    for (RbtInteractionCenterListConstIter iter = posList.begin(); iter != posList.end(); iter++) {
+        LigandCenter center;
+        center.pAtom = (*iter)->GetAtom1Ptr();
+        center.pAtom2 = (*iter)->GetAtom2Ptr();
+        center.pAtom3 = NULL;
+        center.pGrids = NULL;
+        if (bIsMetal(center.pAtom)) {
+            center.probeClass = METAL;
+        } else if (bIsGuan(center.pAtom)) {
+            // Always define the guanidinium plane, whether or not the interaction center includes it
+            center.probeClass = GUAN;
+            RbtAtomList bondedList = Rbt::GetBondedAtomList(center.pAtom);
+            if (bondedList.size() >= 2) {
+                center.pAtom2 = bondedList[0];
+                center.pAtom3 = bondedList[1];
+            }
+        } else {
+            center.probeClass = HBD;
+        }
+        center.strProbe = GetProbeName(center.probeClass, center.pAtom->GetVdwRadius());
+        m_ligCenters.push_back(center);
+        delete *iter;
+    }
+    // Acceptors with lone pair geometry are treated as plain acceptor - parent interaction centers
+    for (RbtInteractionCenterListConstIter iter = negList.begin(); iter != negList.end(); iter++) {
+        LigandCenter center;
+        center.probeClass = HBA;
+        center.pAtom = (*iter)->GetAtom1Ptr();
+        center.pAtom2 = (*iter)->GetAtom2Ptr();
+        center.pAtom3 = NULL;
+        center.strProbe = GetProbeName(center.probeClass, center.pAtom->GetVdwRadius());
+        center.pGrids = NULL;
+        m_ligCenters.push_back(center);
+        delete *iter;
+    }
+}
+
+void RbtPolarGridSF::SetupSolvent() {
+    RbtModelList solvent = GetSolvent();
+    if (!solvent.empty()) {
+        RbtString message("Polar grid scoring function does not support explicit solvent yet\n");
+        throw RbtInvalidRequest(_WHERE_, message);
+    }
+}
+
+void RbtPolarGridSF::SetupScore() {
+    // Assign the probe grids to each ligand interaction center
+    // This needs to be in SetupScore as it is dependent on both the ligand and receptor grid data
+    if (m_probeGrids.empty()) return;
+    RbtInt iTrace = GetTrace();
+    for (vector<LigandCenter>::iterator iter = m_ligCenters.begin(); iter != m_ligCenters.end(); iter++) {
+        RbtProbeGridsMap::const_iterator gIter = m_probeGrids.find(iter->strProbe);
+        if (gIter == m_probeGrids.end()) {
+            RbtString strError = "No polar grid available for " + iter->pAtom->GetFullAtomName() + " (probe "
+                                 + iter->strProbe + ")";
+            throw RbtFileError(_WHERE_, strError);
+        }
+        iter->pGrids = &(gIter->second);
+        if (iTrace > 1) {
+            cout << "Using probe " << iter->strProbe << " for " << iter->pAtom->GetFullAtomName() << endl;
+        }
+    }
+}
+
+RbtDouble RbtPolarGridSF::RawScore() const {
+    RbtDouble score = 0.0;
+    for (vector<LigandCenter>::const_iterator iter = m_ligCenters.begin(); iter != m_ligCenters.end(); iter++) {
+        // Check grids are defined
+        if (iter->pGrids == NULL) continue;
+        const RbtRealGridPtr& spGrid = iter->pGrids->grids[GetDirectionIndex(*iter)];
+        const RbtCoord& c = iter->pAtom->GetCoords();
+        RbtDouble s = (m_bSmoothed) ? spGrid->GetSmoothedValue(c) : spGrid->GetValue(c);
+        score += s * iter->pAtom->GetUser1Value();
+    }
+    return score;
+}
+
+// DM 25 Oct 2000 - track changes to parameter values in local data members
+// ParameterUpdated is invoked by RbtParamHandler::SetParameter
+void RbtPolarGridSF::ParameterUpdated(const RbtString& strName) {
+    // DM 25 Oct 2000 - heavily used params
+    if (strName == _SMOOTHED) {
+        m_bSmoothed = GetParameter(_SMOOTHED);
+    } else {
+        RbtPolarSF::OwnParameterUpdated(strName);
+        RbtBaseSF::ParameterUpdated(strName);
+    }
+}
+
+// Read grids from input stream, checking that header string matches RbtPolarGridSF
+void RbtPolarGridSF::ReadGrids(istream& istr) {
+    m_probeGrids.clear();
+    RbtInt iTrace = GetTrace();
+
+    // Read header string
+    RbtInt length;
+    Rbt::ReadWithThrow(istr, (char*)&length, sizeof(length));
+    char* header = new char[length + 1];
+    Rbt::ReadWithThrow(istr, header, length);
+    // Add null character to end of string
+    header[length] = '\0';
+    RbtBool match = (_CT == header);
+    delete[] header;
+    if (!match) {
+        throw RbtFileParseError(_WHERE_, "Invalid title string in " + _CT + "::ReadGrids()");
+    }
+
+    // Now read number of probes
+    RbtInt nProbes;
+    Rbt::ReadWithThrow(istr, (char*)&nProbes, sizeof(nProbes));
+    if (iTrace > 0) {
+        cout << _CT << ": reading grids for " << nProbes << " probes..." << endl;
+    }
+
+    // Each probe is prefixed by the probe name (e.g. HBA_1.35), followed by the number of directions,
+    // then the direction vector and grid for each direction
+    for (RbtInt i = 0; i < nProbes; i++) {
+        Rbt::ReadWithThrow(istr, (char*)&length, sizeof(length));
+        char* szProbe = new char[length + 1];
+        Rbt::ReadWithThrow(istr, szProbe, length);
+        szProbe[length] = '\0';
+        RbtString strProbe(szProbe);
+        delete[] szProbe;
+        RbtInt nDirections;
+        Rbt::ReadWithThrow(istr, (char*)&nDirections, sizeof(nDirections));
+        if (nDirections < 1) {
+            throw RbtFileParseError(_WHERE_, "Invalid number of directions for probe " + strProbe);
+        }
+        ProbeGrids& probeGrids = m_probeGrids[strProbe];
+        for (RbtInt j = 0; j < nDirections; j++) {
+            RbtCoord direction;
+            direction.Read(istr);
+            probeGrids.directions.push_back(direction);
+            probeGrids.grids.push_back(RbtRealGridPtr(new RbtRealGrid(istr)));
+        }
+        CreateDirectionTable(probeGrids);
+        if (iTrace > 0) {
+            cout << "Grid# " << i << "\t"
+                 << "probe=" << strProbe << " (" << nDirections << " directions)" << endl;
+        }
+    }
+}
+
+RbtUInt RbtPolarGridSF::GetCubeMapCell(const RbtVector& d) {
+    // Face is the axis (and sign) of the largest component, (u, v) are the other two components projected
+    // onto that face
+    RbtDouble ax = fabs(d.x);
+    RbtDouble ay = fabs(d.y);
+    RbtDouble az = fabs(d.z);
+    RbtUInt face;
+    RbtDouble m, u, v;
+    if ((ax >= ay) && (ax >= az)) {
+        face = (d.x > 0.0) ? 0 : 1;
+        m = ax;
+        u = d.y;
+        v = d.z;
+    } else if (ay >= az) {
+        face = (d.y > 0.0) ? 2 : 3;
+        m = ay;
+        u = d.x;
+        v = d.z;
+    } else {
+        face = (d.z > 0.0) ? 4 : 5;
+        m = az;
+        u = d.x;
+        v = d.y;
+    }
+    if (m == 0.0) return 0;
+    RbtUInt iU = std::min(CUBE_MAP_SIZE - 1, RbtUInt((u / m + 1.0) * 0.5 * CUBE_MAP_SIZE));
+    RbtUInt iV = std::min(CUBE_MAP_SIZE - 1, RbtUInt((v / m + 1.0) * 0.5 * CUBE_MAP_SIZE));
+    return (face * CUBE_MAP_SIZE + iU) * CUBE_MAP_SIZE + iV;
+}
+
+void RbtPolarGridSF::CreateDirectionTable(ProbeGrids& probeGrids) {
+    const RbtCoordList& directions = probeGrids.directions;
+    probeGrids.directionTable.clear();
+    if (directions.size() < 2) return;
+    probeGrids.directionTable.resize(6 * CUBE_MAP_SIZE * CUBE_MAP_SIZE, 0);
+    for (RbtUInt face = 0; face < 6; face++) {
+        RbtDouble sign = (face % 2 == 0) ? 1.0 : -1.0;
+        for (RbtUInt iU = 0; iU < CUBE_MAP_SIZE; iU++) {
+            RbtDouble u = (iU + 0.5) * 2.0 / CUBE_MAP_SIZE - 1.0;
+            for (RbtUInt iV = 0; iV < CUBE_MAP_SIZE; iV++) {
+                RbtDouble v = (iV + 0.5) * 2.0 / CUBE_MAP_SIZE - 1.0;
+                // Direction of the center of the cell (not normalised, which does not change the closest direction)
+                RbtVector d;
+                if (face < 2) {
+                    d = RbtVector(sign, u, v);
+                } else if (face < 4) {
+                    d = RbtVector(u, sign, v);
+                } else {
+                    d = RbtVector(u, v, sign);
+                }
+                RbtUInt iBest = 0;
+                RbtDouble bestDot = Rbt::Dot(d, directions[0]);
+                for (RbtUInt i = 1; i < directions.size(); i++) {
+                    RbtDouble dot = Rbt::Dot(d, directions[i]);
+                    if (dot > bestDot) {
+                        bestDot = dot;
+                        iBest = i;
+                    }
+                }
+                probeGrids.directionTable[GetCubeMapCell(d)] = iBest;
+            }
+        }
+    }
+}
+
+RbtUInt RbtPolarGridSF::GetDirectionIndex(const LigandCenter& center) const {
+    const ProbeGrids& probeGrids = *center.pGrids;
+    if (probeGrids.directionTable.empty() || (center.pAtom2 == NULL)) return 0;
+    RbtVector d = center.pAtom2->GetCoords() - center.pAtom->GetCoords();
+    if (center.probeClass != GUAN) {
+        return probeGrids.directionTable[GetCubeMapCell(d)];
+    }
+    if (center.pAtom3 == NULL) return 0;
+    d = Rbt::Cross(d, center.pAtom3->GetCoords() - center.pAtom->GetCoords());
+    // The guanidinium plane term depends only on the magnitude of the cosine, so the normal has no sign
+    RbtUInt i1 = probeGrids.directionTable[GetCubeMapCell(d)];
+    RbtUInt i2 = probeGrids.directionTable[GetCubeMapCell(-d)];
+    const RbtCoordList& directions = probeGrids.directions;
+    return (fabs(Rbt::Dot(d, directions[i1])) >= fabs(Rbt::Dot(d, directions[i2]))) ? i1 : i2;
+}
@@ -13,6 +13,7 @@
 #include "RbtPolarIdxSF.h"
 
 #include "RbtPlane.h"
+#include "RbtReceptorFlexData.h"
 #include "RbtWorkSpace.h"
 
 // Static data members
@@ -26,6 +27,8 @@ RbtString RbtPolarIdxSF::_THRESHOLD_NEG("THRESHOLD_NEG");
 // implicit constructor for RbtBaseInterSF is called second
 RbtPolarIdxSF::RbtPolarIdxSF(const RbtString& strName):
     RbtBaseSF(_CT, strName),
+    m_bSolventMapsDirty(false),
+    m_bRotamerTableDirty(false),
     m_bAttr(true),
     m_bFlexRec(false),
     m_bSolvent(false),
@@ -175,6 +178,7 @@ void RbtPolarIdxSF::SetupReceptor() {
             // For grosser receptor flexibility we would have to partition periodically during docking
             RbtDouble partitionDist = GetRange() + flexDist;
             Partition(m_flexRecPosList, m_flexRecNegList, m_flexRecIntns, m_flexRecPrtIntns, partitionDist);
+            m_bRotamerTableDirty = true;
             // Index the flexible interaction centers over a larger radius
             // NOTE: WE ASSUME ONLY -OH and -NH3 rotation here (protons can't move more than 2.0A at most)
             // Grosser rotations will require a different approach
@@ -205,6 +209,7 @@ void RbtPolarIdxSF::SetupReceptor() {
             m_spNegGrid->SetInteractionLists(*iter, rvdw + idxIncr);
         }
     }
+    m_bSolventMapsDirty = true;
 }
 
 void RbtPolarIdxSF::SetupLigand() {
@@ -214,6 +219,8 @@ void RbtPolarIdxSF::SetupLigand() {
     RbtAtomList atomList(GetLigand()->GetAtomList());
     m_ligPosList = CreateDonorInteractionCenters(atomList);
     m_ligNegList = CreateAcceptorInteractionCenters(atomList);
+    m_ligPosIndex.SetCellSize(GetIndexCellSize(m_ligPosList));
+    m_ligNegIndex.SetCellSize(GetIndexCellSize(m_ligNegList));
 }
 
 void RbtPolarIdxSF::SetupSolvent() {
@@ -242,6 +249,41 @@ void RbtPolarIdxSF::SetupSolvent() {
         BuildIntraMap(m_solventPosList, m_solventIntns);
         BuildIntraMap(m_solventNegList, m_solventIntns);
     }
+    // The interactions between different solvent models are retrieved from the solvent cell indexes
+    // on each score call, so only the intra-model interactions need be retained in the map
+    for (RbtInteractionListMapIter iter = m_solventIntns.begin(); iter != m_solventIntns.end(); ++iter) {
+        RbtInteractionCenterList intraIntns;
+        for (RbtInteractionCenterListConstIter jIter = iter->begin(); jIter != iter->end(); ++jIter) {
+            RbtModel* pModel = (*jIter)->GetAtom1Ptr()->GetModelPtr();
+            if (solventAtomList[iter - m_solventIntns.begin()]->GetModelPtr() == pModel) {
+                intraIntns.push_back(*jIter);
+            }
+        }
+        iter->swap(intraIntns);
+    }
+    m_solventPosIndex.SetCellSize(GetIndexCellSize(m_solventPosList));
+    m_solventNegIndex.SetCellSize(GetIndexCellSize(m_solventNegList));
+
+    // Divide the interaction centers by solvent model, for the receptor-solvent energy maps
+    for (RbtModelListConstIter iter = solventList.begin(); iter != solventList.end(); ++iter) {
+        RbtInteractionCenterList posList;
+        RbtInteractionCenterList negList;
+        for (RbtInteractionCenterListConstIter pIter = m_solventPosList.begin(); pIter != m_solventPosList.end();
+             ++pIter) {
+            if ((*pIter)->GetAtom1Ptr()->GetModelPtr() == (*iter)) {
+                posList.push_back(*pIter);
+            }
+        }
+        for (RbtInteractionCenterListConstIter nIter = m_solventNegList.begin(); nIter != m_solventNegList.end();
+             ++nIter) {
+            if ((*nIter)->GetAtom1Ptr()->GetModelPtr() == (*iter)) {
+                negList.push_back(*nIter);
+            }
+        }
+        m_solventModelPosLists.push_back(posList);
+        m_solventModelNegLists.push_back(negList);
+    }
+    m_bSolventMapsDirty = true;
 }
 
 void RbtPolarIdxSF::SetupScore() {
@@ -266,6 +308,10 @@ void RbtPolarIdxSF::ClearReceptor() {
     m_flexRecIntns.clear();
     m_flexRecPrtIntns.clear();
     m_bFlexRec = false;
+    m_spRotamerTable.SetNull();
+    m_bRotamerTableDirty = false;
+    m_solventMaps.clear();
+    ClearSolventEnergyMapCache();
     DeleteList(m_recepPosList);
     DeleteList(m_flexRecPosList);
     DeleteList(m_recepNegList);
@@ -279,6 +325,10 @@ void RbtPolarIdxSF::ClearLigand() {
 
 void RbtPolarIdxSF::ClearSolvent() {
     m_solventIntns.clear();
+    m_solventModelPosLists.clear();
+    m_solventModelNegLists.clear();
+    m_solventMaps.clear();
+    ClearSolventEnergyMapCache();
     m_bSolvent = false;
     DeleteList(m_solventPosList);
     DeleteList(m_solventNegList);
@@ -298,6 +348,7 @@ void RbtPolarIdxSF::ParameterUpdated(const RbtString& strName) {
     // DM 25 Oct 2000 - heavily used params
     if (strName == _ATTR) {
         m_bAttr = GetParameter(_ATTR);
+        m_bRotamerTableDirty = m_bFlexRec;
     } else if (strName == _THRESHOLD_POS) {
         m_posThreshold = GetParameter(_THRESHOLD_POS);
     } else if (strName == _THRESHOLD_NEG) {
@@ -306,17 +357,58 @@ void RbtPolarIdxSF::ParameterUpdated(const RbtString& strName) {
         RbtPolarSF::OwnParameterUpdated(strName);
         RbtBaseIdxSF::OwnParameterUpdated(strName);
         RbtBaseSF::ParameterUpdated(strName);
+        // The receptor-solvent energy maps and the rotamer energy table depend on the energy parameters
+        if (isSolventMapParameter(strName)) {
+            m_bSolventMapsDirty = true;
+            m_bRotamerTableDirty = m_bFlexRec;
+        }
     }
 }
 
+RbtBool RbtPolarIdxSF::isSolventMapParameter(const RbtString& strName) const {
+    return RbtBaseIdxSF::isSolventMapParameter(strName) || (strName == _INCR) || (strName == _R12FACTOR)
+           || (strName == _R12INCR) || (strName == _DR12MIN) || (strName == _DR12MAX) || (strName == _A1)
+           || (strName == _DA1MIN) || (strName == _DA1MAX) || (strName == _A2) || (strName == _DA2MIN)
+           || (strName == _DA2MAX) || (strName == _INCMETAL) || (strName == _INCHBD) || (strName == _INCHBA)
+           || (strName == _INCGUAN) || (strName == _GUAN_PLANE) || (strName == _ABS_DR12) || (strName == _LP_OSP2)
+           || (strName == _LP_PHI) || (strName == _LP_DPHIMIN) || (strName == _LP_DPHIMAX)
+           || (strName == _LP_DTHETAMIN) || (strName == _LP_DTHETAMAX);
+}
+
 // Intra-receptor
 RbtDouble RbtPolarIdxSF::ReceptorScore() const {
-    return (m_bFlexRec) ? IntraScore(m_flexRecPosList, m_flexRecNegList, m_flexRecPrtIntns, m_bAttr) : 0.0;
+    if (!m_bFlexRec) return 0.0;
+    if (m_bRotamerTableDirty) {
+        BuildRotamerTable();
+    }
+    // Use the precomputed rotamer energies if all flexible groups are at a tabulated rotamer
+    RbtDouble score;
+    if (!m_spRotamerTable.Null() && m_spRotamerTable->GetEnergy(score)) {
+        return score;
+    }
+    return IntraScore(m_flexRecPosList, m_flexRecNegList, m_flexRecPrtIntns, m_bAttr);
 }
 
 // Intra-solvent
 RbtDouble RbtPolarIdxSF::SolventScore() const {
-    return (m_bSolvent) ? IntraScore(m_solventPosList, m_solventNegList, m_solventIntns, m_bAttr) : 0.0;
+    RbtDouble score = 0.0;
+    if (!m_bSolvent) return score;
+    RbtPolarSF::f1prms Rprms = GetRprms();    // Distance params
+    RbtPolarSF::f1prms A1prms = GetA1prms();  // Donor angle params
+    RbtPolarSF::f1prms A2prms = GetA2prms();  // Acceptor angle params
+    IndexInteractionCenters(m_solventPosList, m_solventPosIndex);
+    IndexInteractionCenters(m_solventNegList, m_solventNegIndex);
+    if (m_bAttr) {
+        // Pos-neg. As for IntraScore, only the intra-model neg-pos interactions are scored from the neg centers
+        score += SolventScore(m_solventPosList, &m_solventNegIndex, m_solventNegList, false, Rprms, A1prms, A2prms);
+        score += SolventScore(m_solventNegList, NULL, m_solventPosList, false, Rprms, A2prms, A1prms);
+    } else {
+        // pos-pos
+        score += SolventScore(m_solventPosList, &m_solventPosIndex, m_solventPosList, true, Rprms, A1prms, A1prms);
+        // neg-neg
+        score += SolventScore(m_solventNegList, &m_solventNegIndex, m_solventNegList, true, Rprms, A2prms, A2prms);
+    }
+    return score;
 }
 
 // Ligand-receptor
@@ -324,38 +416,292 @@ RbtDouble RbtPolarIdxSF::InterScore() const { return InterScore(m_ligPosList, m_
 
 // Receptor-solvent
 RbtDouble RbtPolarIdxSF::ReceptorSolventScore() const {
-    return (m_bSolvent) ? InterScore(m_solventPosList, m_solventNegList, false) : 0.0;
+    if (!m_bSolvent) return 0.0;
+    if (m_bSolventMapsDirty) {
+        BuildSolventMaps();
+    }
+    if (m_solventMaps.empty()) return InterScore(m_solventPosList, m_solventNegList, false);
+    // Use the precomputed energy map for each solvent model where possible, otherwise score explicitly
+    RbtDouble score = 0.0;
+    for (RbtUInt i = 0; i < m_solventMaps.size(); i++) {
+        const RbtInteractionCenterList& posList = m_solventModelPosLists[i];
+        const RbtInteractionCenterList& negList = m_solventModelNegLists[i];
+        if (posList.empty() && negList.empty()) continue;
+        RbtAtom* pAtom = (posList.empty()) ? negList.front()->GetAtom1Ptr() : posList.front()->GetAtom1Ptr();
+        if (!pAtom->GetEnabled()) continue;
+        RbtDouble s;
+        if (m_solventMaps[i].Null() || !m_solventMaps[i]->GetEnergy(s)) {
+            s = InterScore(posList, negList, false);
+        }
+        score += s;
+    }
+    return score;
 }
 
-// Ligand-solvent score: very inefficient
+// Ligand-solvent score
+// The ligand interaction centers are indexed on each call, so that only the near neighbours of each
+// solvent interaction center are scored
 RbtDouble RbtPolarIdxSF::LigandSolventScore() const {
     RbtDouble score = 0.0;
     if (!m_bSolvent) return score;
     RbtPolarSF::f1prms Rprms = GetRprms();    // Distance params
     RbtPolarSF::f1prms A1prms = GetA1prms();  // Donor angle params
     RbtPolarSF::f1prms A2prms = GetA2prms();  // Acceptor angle params
+    IndexInteractionCenters(m_ligPosList, m_ligPosIndex);
+    IndexInteractionCenters(m_ligNegList, m_ligNegIndex);
     if (m_bAttr) {
         // Pos-neg
-        for (RbtInteractionCenterListConstIter iter = m_solventPosList.begin(); iter != m_solventPosList.end();
-             iter++) {
-            score += (*iter)->GetAtom1Ptr()->GetUser1Value() * PolarScore(*iter, m_ligNegList, Rprms, A1prms, A2prms);
-        }
+        score += LigandSolventScore(m_solventPosList, m_ligNegIndex, m_ligNegList, Rprms, A1prms, A2prms);
         // Neg-pos
-        for (RbtInteractionCenterListConstIter iter = m_solventNegList.begin(); iter != m_solventNegList.end();
-             iter++) {
-            score += (*iter)->GetAtom1Ptr()->GetUser1Value() * PolarScore(*iter, m_ligPosList, Rprms, A2prms, A1prms);
-        }
+        score += LigandSolventScore(m_solventNegList, m_ligPosIndex, m_ligPosList, Rprms, A2prms, A1prms);
     } else {
         // pos-pos
-        for (RbtInteractionCenterListConstIter iter = m_solventPosList.begin(); iter != m_solventPosList.end();
-             iter++) {
-            score += (*iter)->GetAtom1Ptr()->GetUser1Value() * PolarScore(*iter, m_ligPosList, Rprms, A1prms, A1prms);
-        }
+        score += LigandSolventScore(m_solventPosList, m_ligPosIndex, m_ligPosList, Rprms, A1prms, A1prms);
         // neg-neg
-        for (RbtInteractionCenterListConstIter iter = m_solventNegList.begin(); iter != m_solventNegList.end();
-             iter++) {
-            score += (*iter)->GetAtom1Ptr()->GetUser1Value() * PolarScore(*iter, m_ligNegList, Rprms, A2prms, A2prms);
+        score += LigandSolventScore(m_solventNegList, m_ligNegIndex, m_ligNegList, Rprms, A2prms, A2prms);
+    }
+    return score;
+}
+
+RbtDouble RbtPolarIdxSF::SolventScore(
+    const RbtInteractionCenterList& icList,
+    const RbtCellIndex* pIndex,
+    const RbtInteractionCenterList& indexList,
+    RbtBool bSingleList,
+    const f1prms& Rprms,
+    const f1prms& A1prms,
+    const f1prms& A2prms
+) const {
+    RbtDouble score = 0.0;
+    for (RbtUInt i = 0; i < icList.size(); i++) {
+        RbtAtom* pAtom = icList[i]->GetAtom1Ptr();
+        if (!pAtom->GetEnabled()) continue;
+        RbtModel* pModel = pAtom->GetModelPtr();
+        // Intra-model interactions
+        m_nbrList = m_solventIntns[pAtom->GetAtomId() - 1];
+        // Inter-model interactions. For a single list, only score each pair once
+        m_nbrIds.clear();
+        if (pIndex != NULL) {
+            pIndex->GetNeighbours(pAtom->GetCoords(), m_nbrIds);
+        }
+        for (RbtIntListConstIter nIter = m_nbrIds.begin(); nIter != m_nbrIds.end(); nIter++) {
+            RbtInteractionCenter* pNbr = indexList[*nIter];
+            if ((!bSingleList || (RbtUInt(*nIter) > i)) && (pNbr->GetAtom1Ptr()->GetModelPtr() != pModel)) {
+                m_nbrList.push_back(pNbr);
+            }
+        }
+        score += pAtom->GetUser1Value() * PolarScore(icList[i], m_nbrList, Rprms, A1prms, A2prms);
+    }
+    return score;
+}
+
+RbtDouble RbtPolarIdxSF::LigandSolventScore(
+    const RbtInteractionCenterList& icList,
+    const RbtCellIndex& index,
+    const RbtInteractionCenterList& indexList,
+    const f1prms& Rprms,
+    const f1prms& A1prms,
+    const f1prms& A2prms
+) const {
+    RbtDouble score = 0.0;
+    for (RbtInteractionCenterListConstIter iter = icList.begin(); iter != icList.end(); iter++) {
+        RbtAtom* pAtom = (*iter)->GetAtom1Ptr();
+        if (!pAtom->GetEnabled()) continue;
+        m_nbrIds.clear();
+        index.GetNeighbours(pAtom->GetCoords(), m_nbrIds);
+        m_nbrList.clear();
+        for (RbtIntListConstIter nIter = m_nbrIds.begin(); nIter != m_nbrIds.end(); nIter++) {
+            m_nbrList.push_back(indexList[*nIter]);
+        }
+        score += pAtom->GetUser1Value() * PolarScore(*iter, m_nbrList, Rprms, A1prms, A2prms);
+    }
+    return score;
+}
+
+void RbtPolarIdxSF::IndexInteractionCenters(const RbtInteractionCenterList& icList, RbtCellIndex& index) const {
+    index.Clear();
+    for (RbtUInt i = 0; i < icList.size(); i++) {
+        RbtAtom* pAtom = icList[i]->GetAtom1Ptr();
+        if (pAtom->GetEnabled()) {
+            index.Add(pAtom->GetCoords(), i);
+        }
+    }
+    index.Build();
+}
+
+// As for the receptor indexing grids, an interaction center is deemed to be in range of a query point if it
+// lies within (vdW radius + INCR) of it
+RbtDouble RbtPolarIdxSF::GetIndexCellSize(const RbtInteractionCenterList& icList) const {
+    RbtDouble maxRadius = 0.0;
+    for (RbtInteractionCenterListConstIter iter = icList.begin(); iter != icList.end(); iter++) {
+        maxRadius = std::max(maxRadius, (*iter)->GetAtom1Ptr()->GetVdwRadius());
+    }
+    return maxRadius + GetParameter(_INCR).Double();
+}
+
+// Tabulates the receptor-solvent score of each fixed/tethered solvent model over its allowed
+// range of positions and orientations (rigid receptor with a single set of coords only)
+void RbtPolarIdxSF::BuildSolventMaps() const {
+    m_solventMaps.clear();
+    m_bSolventMapsDirty = false;
+    if (!isSolventMapEnabled() || !m_bSolvent || m_spPosGrid.Null() || m_spNegGrid.Null()) return;
+    if (m_bFlexRec || (GetReceptor()->GetNumSavedCoords() > 1)) {
+        if (GetTrace() > 0) {
+            cout << GetFullName() << ": Solvent energy maps disabled for flexible receptor" << endl;
+        }
+        return;
+    }
+    if (GetCachedSolventEnergyMaps(m_solventMaps)) {
+        return;
+    }
+    m_solventMaps = CreateSolventEnergyMaps(GetSolvent());
+    RbtInt nMapped = 0;
+    for (RbtUInt i = 0; i < m_solventMaps.size(); i++) {
+        RbtSolventEnergyMapPtr spMap = m_solventMaps[i];
+        if (spMap.Null()) continue;
+        for (RbtUInt iOrient = 0; iOrient < spMap->GetNumOrientations(); iOrient++) {
+            for (RbtUInt iXYZ = 0; iXYZ < spMap->GetNumPositions(); iXYZ++) {
+                spMap->PlaceModel(iOrient, iXYZ);
+                spMap->SetValue(
+                    iOrient, iXYZ, InterScore(m_solventModelPosLists[i], m_solventModelNegLists[i], false)
+                );
+            }
         }
+        spMap->RestoreModel();
+        nMapped++;
+    }
+    CacheSolventEnergyMaps(m_solventMaps);
+    if (GetTrace() > 0) {
+        cout << GetFullName() << ": Receptor-solvent energy maps created for " << nMapped << " of "
+             << m_solventMaps.size() << " solvent models" << endl;
+    }
+}
+
+// Tabulates the intra-receptor score for each rotamer of each flexible group, and for each rotamer combination
+// of each pair of interacting flexible groups, as in RbtVdwIdxSF::BuildRotamerTable.
+// The sum of the table entries reproduces the partitioned flexible interaction score of ReceptorScore()
+void RbtPolarIdxSF::BuildRotamerTable() const {
+    m_spRotamerTable.SetNull();
+    m_bRotamerTableDirty = false;
+    RbtFlexData* pFlexData = GetReceptor()->GetFlexData();
+    if (!m_bFlexRec || (pFlexData == NULL) || !pFlexData->isParameterValid(RbtReceptorFlexData::_ROTAMER_STEP)) {
+        return;
+    }
+    RbtDouble rotamerStep = pFlexData->GetParameter(RbtReceptorFlexData::_ROTAMER_STEP);
+    if (rotamerStep <= 0.0) return;
+    m_spRotamerTable = new RbtRotamerEnergyTable(GetReceptor(), rotamerStep);
+    RbtUInt nGroups = m_spRotamerTable->GetNumGroups();
+    if (nGroups == 0) {
+        m_spRotamerTable.SetNull();
+        return;
+    }
+
+    vector<RbtRotamerTermList> selfTerms(nGroups, RbtRotamerTermList());
+    vector<RbtRotamerTermList> pairTerms;
+    if (!AddRotamerTerms(m_flexRecPosList, true, selfTerms, pairTerms)
+        || !AddRotamerTerms(m_flexRecNegList, false, selfTerms, pairTerms)) {
+        // Should not happen for OH/NH3+ rotors, but play safe and fall back to the explicit score
+        m_spRotamerTable.SetNull();
+        return;
+    }
+
+    for (RbtUInt i = 0; i < nGroups; i++) {
+        for (RbtInt iRot = 0; iRot < m_spRotamerTable->GetNumRotamers(i); iRot++) {
+            m_spRotamerTable->PlaceRotamer(i, iRot);
+            m_spRotamerTable->SetSelfEnergy(i, iRot, RotamerTermScore(selfTerms[i]));
+        }
+    }
+    for (RbtUInt iPair = 0; iPair < m_spRotamerTable->GetNumPairs(); iPair++) {
+        RbtUInt i, j;
+        m_spRotamerTable->GetPair(iPair, i, j);
+        for (RbtInt iRot = 0; iRot < m_spRotamerTable->GetNumRotamers(i); iRot++) {
+            m_spRotamerTable->PlaceRotamer(i, iRot);
+            for (RbtInt jRot = 0; jRot < m_spRotamerTable->GetNumRotamers(j); jRot++) {
+                m_spRotamerTable->PlaceRotamer(j, jRot);
+                m_spRotamerTable->SetPairEnergy(iPair, iRot, jRot, RotamerTermScore(pairTerms[iPair]));
+            }
+        }
+    }
+    m_spRotamerTable->RestoreModel();
+    if (GetTrace() > 0) {
+        cout << GetFullName() << ": Rotamer energy table created for " << nGroups << " flexible groups and "
+             << m_spRotamerTable->GetNumPairs() << " interacting group pairs" << endl;
+    }
+}
+
+// An interaction between two interaction centers depends on the groups of the atoms of both centers
+// (e.g. a hydroxyl donor moves with the rotor of its H atom)
+RbtBool RbtPolarIdxSF::AddRotamerTerms(
+    const RbtInteractionCenterList& icList,
+    RbtBool bDonor,
+    vector<RbtRotamerTermList>& selfTerms,
+    vector<RbtRotamerTermList>& pairTerms
+) const {
+    for (RbtInteractionCenterListConstIter iter = icList.begin(); iter != icList.end(); iter++) {
+        std::set<RbtInt> icGroups;
+        GetRotamerGroups(*iter, icGroups);
+        const RbtInteractionCenterList& intns = m_flexRecPrtIntns[(*iter)->GetAtom1Ptr()->GetAtomId() - 1];
+        std::map<RbtUInt, RbtInteractionCenterList> selfLists;
+        std::map<RbtUInt, RbtInteractionCenterList> pairLists;
+        for (RbtInteractionCenterListConstIter jIter = intns.begin(); jIter != intns.end(); jIter++) {
+            std::set<RbtInt> groups(icGroups);
+            GetRotamerGroups(*jIter, groups);
+            if (groups.empty()) {
+                // Does not depend on the rotamers (e.g. a hydroxyl O acceptor and a rigid donor), so can be added
+                // to the self energies of any group
+                selfLists[0].push_back(*jIter);
+            } else if (groups.size() == 1) {
+                selfLists[*groups.begin()].push_back(*jIter);
+            } else if (groups.size() == 2) {
+                RbtUInt iPair = m_spRotamerTable->GetPairIndex(*groups.begin(), *groups.rbegin());
+                pairLists[iPair].push_back(*jIter);
+            } else {
+                return false;
+            }
+        }
+        RbtRotamerTerm term;
+        term.pIC = *iter;
+        term.bDonor = bDonor;
+        for (std::map<RbtUInt, RbtInteractionCenterList>::const_iterator sIter = selfLists.begin();
+             sIter != selfLists.end(); ++sIter) {
+            term.intns = sIter->second;
+            selfTerms[sIter->first].push_back(term);
+        }
+        for (std::map<RbtUInt, RbtInteractionCenterList>::const_iterator pIter = pairLists.begin();
+             pIter != pairLists.end(); ++pIter) {
+            if (pIter->first >= pairTerms.size()) {
+                pairTerms.resize(pIter->first + 1, RbtRotamerTermList());
+            }
+            term.intns = pIter->second;
+            pairTerms[pIter->first].push_back(term);
+        }
+    }
+    return true;
+}
+
+void RbtPolarIdxSF::GetRotamerGroups(const RbtInteractionCenter* pIC, std::set<RbtInt>& groups) const {
+    RbtAtom* atoms[] = {pIC->GetAtom1Ptr(), pIC->GetAtom2Ptr(), pIC->GetAtom3Ptr()};
+    for (RbtUInt i = 0; i < 3; i++) {
+        if (atoms[i] != NULL) {
+            RbtInt iGroup = m_spRotamerTable->GetGroup(atoms[i]);
+            if (iGroup >= 0) {
+                groups.insert(iGroup);
+            }
+        }
+    }
+}
+
+// Each term is scored with the same angle parameters as in RbtPolarSF::IntraScore
+RbtDouble RbtPolarIdxSF::RotamerTermScore(const RbtRotamerTermList& terms) const {
+    RbtPolarSF::f1prms Rprms = GetRprms();    // Distance params
+    RbtPolarSF::f1prms A1prms = GetA1prms();  // Donor angle params
+    RbtPolarSF::f1prms A2prms = GetA2prms();  // Acceptor angle params
+    RbtDouble score = 0.0;
+    for (RbtRotamerTermList::const_iterator iter = terms.begin(); iter != terms.end(); ++iter) {
+        const RbtPolarSF::f1prms& prms1 = (iter->bDonor) ? A1prms : A2prms;
+        const RbtPolarSF::f1prms& prms2 = (iter->bDonor == m_bAttr) ? A2prms : A1prms;
+        RbtDouble s = PolarScore(iter->pIC, iter->intns, Rprms, prms1, prms2);
+        score += iter->pIC->GetAtom1Ptr()->GetUser1Value() * s;
     }
     return score;
 }
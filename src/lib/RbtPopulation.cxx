@@ -13,16 +13,24 @@
 #include "RbtPopulation.h"
 
 #include <algorithm>
+#include <limits>
+#include <unordered_map>
 
+#include "RbtBaseSF.h"
 #include "RbtDebug.h"
 #include "RbtDockingError.h"
 
 RbtString RbtPopulation::_CT("RbtPopulation");
 
 RbtPopulation::RbtPopulation(RbtChromElement* pChr, RbtUInt size, RbtBaseSF* pSF):
+    RbtPopulation(pChr, size, pSF, RbtGenomeList()) {}
+
+RbtPopulation::RbtPopulation(RbtChromElement* pChr, RbtUInt size, RbtBaseSF* pSF, const RbtGenomeList& seeds):
     m_size(size),
     m_c(2.0),
     m_pSF(pSF),
+    m_surrogateFraction(1.0),
+    m_surrogateCutoff(std::numeric_limits<RbtDouble>::max()),
     m_rand(Rbt::GetRbtRand()),
     m_scoreMean(0.0),
     m_scoreVariance(0.0) {
@@ -31,12 +39,18 @@ RbtPopulation::RbtPopulation(RbtChromElement* pChr, RbtUInt size, RbtBaseSF* pSF
     } else if (size <= 0) {
         throw RbtBadArgument(_WHERE_, "Population size must be positive (non-zero)");
     }
-    // Create a random population
+    // All genomes share a single gene layout (and decoder chromosome) cloned from pChr
+    RbtGeneLayoutPtr spLayout(new RbtGeneLayout(pChr));
+    // Copy the seed genomes, then fill the rest of the population with random genomes
     m_pop.reserve(m_size);
-    for (RbtUInt i = 0; i < m_size; ++i) {
-        // The RbtGenome constructor clones the chromosome to create an independent copy
-        RbtGenomePtr genome = new RbtGenome(pChr);
-        genome->GetChrom()->Randomise();
+    for (RbtGenomeListConstIter iter = seeds.begin(); (iter != seeds.end()) && (m_pop.size() < m_size); ++iter) {
+        RbtGenomePtr genome = new RbtGenome(spLayout);
+        genome->SetGenes((*iter)->GetGenes());
+        m_pop.push_back(genome);
+    }
+    for (RbtUInt i = m_pop.size(); i < m_size; ++i) {
+        RbtGenomePtr genome = new RbtGenome(spLayout);
+        genome->Randomise();
         m_pop.push_back(genome);
     }
     // Calculate the scores and evaluate roulette wheel fitness
@@ -52,6 +66,7 @@ void RbtPopulation::SetSF(RbtBaseSF* pSF) {
         throw RbtBadArgument(_WHERE_, "Null scoring function passed to SetSF");
     }
     m_pSF = pSF;
+    m_surrogateCutoff = std::numeric_limits<RbtDouble>::max();
     for (RbtGenomeListIter iter = m_pop.begin(); iter != m_pop.end(); ++iter) {
         (*iter)->SetScore(m_pSF);
     }
@@ -59,6 +74,12 @@ void RbtPopulation::SetSF(RbtBaseSF* pSF) {
     EvaluateRWFitness();
 }
 
+void RbtPopulation::SetSurrogateSF(const vector<RbtBaseSF*>& surrogateSFs, RbtDouble fraction) {
+    m_surrogateSFs = surrogateSFs;
+    m_surrogateFraction = fraction;
+    m_surrogateCutoff = std::numeric_limits<RbtDouble>::max();
+}
+
 void RbtPopulation::GAstep(
     RbtInt nReplicates,
     RbtDouble relStepSize,
@@ -89,24 +110,24 @@ void RbtPopulation::GAstep(
         RbtGenomePtr child2 = new RbtGenome(*father);
         // Crossover
         if (m_rand.GetRandom01() < pcross) {
-            Rbt::Crossover(father->GetChrom(), mother->GetChrom(), child1->GetChrom(), child2->GetChrom());
+            Rbt::Crossover(father, mother, child1, child2);
             // Cauchy mutation following crossover
             if (xovermut) {
-                child1->GetChrom()->CauchyMutate(0.0, relStepSize);
-                child2->GetChrom()->CauchyMutate(0.0, relStepSize);
+                child1->CauchyMutate(0.0, relStepSize);
+                child2->CauchyMutate(0.0, relStepSize);
             }
         }
         // Mutation
         else {
             // Cauchy mutation
             if (cmutate) {
-                child1->GetChrom()->CauchyMutate(0.0, relStepSize);
-                child2->GetChrom()->CauchyMutate(0.0, relStepSize);
+                child1->CauchyMutate(0.0, relStepSize);
+                child2->CauchyMutate(0.0, relStepSize);
             }
             // Regular mutation
             else {
-                child1->GetChrom()->Mutate(relStepSize);
-                child2->GetChrom()->Mutate(relStepSize);
+                child1->Mutate(relStepSize);
+                child2->Mutate(relStepSize);
             }
         }
         newPop.push_back(child1);
@@ -116,7 +137,7 @@ void RbtPopulation::GAstep(
     if (nReplicates % 2) {
         RbtGenomePtr mother = RouletteWheelSelect();
         RbtGenomePtr child = new RbtGenome(*mother);
-        child->GetChrom()->CauchyMutate(0.0, relStepSize);
+        child->CauchyMutate(0.0, relStepSize);
         newPop.push_back(child);
     }
     MergeNewPop(newPop, equalityThreshold);
@@ -155,10 +176,84 @@ RbtGenomePtr RbtPopulation::RouletteWheelSelect() const {
     return (m_pop[lower]);
 }
 
+void RbtPopulation::PreScreen(RbtGenomeList& newPop) {
+    if (newPop.empty()) {
+        return;
+    }
+    // The cutoff from the previous iteration is used, so that each passing genome can be fully scored while
+    // its coords are still in the model (surrogate scores are lower = better)
+    RbtDoubleList surrogateScores;
+    surrogateScores.reserve(newPop.size());
+    RbtGenomeList screenedPop;
+    screenedPop.reserve(newPop.size());
+    for (RbtGenomeListIter gIter = newPop.begin(); gIter != newPop.end(); ++gIter) {
+        (*gIter)->SyncToModel();
+        RbtDouble score(0.0);
+        for (RbtBaseSFListConstIter iter = m_surrogateSFs.begin(); iter != m_surrogateSFs.end(); ++iter) {
+            score += (*iter)->Score();
+        }
+        surrogateScores.push_back(score);
+        if (score <= m_surrogateCutoff) {
+            (*gIter)->SetScoreFromModel(m_pSF);
+            screenedPop.push_back(*gIter);
+        }
+    }
+    RbtUInt nKeep = std::max(1, RbtInt(ceil(m_surrogateFraction * surrogateScores.size())));
+    std::nth_element(surrogateScores.begin(), surrogateScores.begin() + (nKeep - 1), surrogateScores.end());
+    m_surrogateCutoff = surrogateScores[nKeep - 1];
+    newPop.swap(screenedPop);
+}
+
+void RbtPopulation::RemoveDuplicates(
+    const RbtGenomeList& sortedPop, RbtDouble equalityThreshold, RbtUInt maxSize, RbtGenomeList& uniquePop
+) {
+    uniquePop.clear();
+    if (equalityThreshold <= 0.0) {
+        RbtGenomeListConstIter end = (sortedPop.size() > maxSize) ? (sortedPop.begin() + maxSize) : sortedPop.end();
+        std::copy(sortedPop.begin(), end, back_inserter(uniquePop));
+        return;
+    }
+    // Each genome need only be compared with the copied genomes in its own and neighbouring cells
+    Rbt::isGenome_eq isEqual(equalityThreshold);
+    std::unordered_map<std::size_t, RbtGenomeList> cells;
+    cells.reserve(sortedPop.size());
+    vector<std::size_t> keys;
+    for (RbtGenomeListConstIter iter = sortedPop.begin(); (iter != sortedPop.end()) && (uniquePop.size() < maxSize);
+         ++iter) {
+        const RbtDoubleList& genes = (*iter)->GetGenes();
+        if (genes.empty()) {
+            keys.assign(1, 0);
+        } else {
+            (*iter)->GetLayout()->GetNeighbourKeys(&genes[0], equalityThreshold, keys);
+        }
+        RbtBool isDuplicate(false);
+        for (vector<std::size_t>::const_iterator kIter = keys.begin(); (kIter != keys.end()) && !isDuplicate;
+             ++kIter) {
+            std::unordered_map<std::size_t, RbtGenomeList>::const_iterator cell = cells.find(*kIter);
+            if (cell == cells.end()) {
+                continue;
+            }
+            for (RbtGenomeListConstIter cIter = cell->second.begin(); (cIter != cell->second.end()) && !isDuplicate;
+                 ++cIter) {
+                isDuplicate = isEqual(*cIter, *iter);
+            }
+        }
+        if (!isDuplicate) {
+            // The first key is the genome's own cell
+            cells[keys.front()].push_back(*iter);
+            uniquePop.push_back(*iter);
+        }
+    }
+}
+
 void RbtPopulation::MergeNewPop(RbtGenomeList& newPop, RbtDouble equalityThreshold) {
     // Assume newPop needs scoring and sorting
-    for (RbtGenomeListIter iter = newPop.begin(); iter != newPop.end(); ++iter) {
-        (*iter)->SetScore(m_pSF);
+    if (!m_surrogateSFs.empty() && (m_surrogateFraction < 1.0)) {
+        PreScreen(newPop);
+    } else {
+        for (RbtGenomeListIter iter = newPop.begin(); iter != newPop.end(); ++iter) {
+            (*iter)->SetScore(m_pSF);
+        }
     }
     std::stable_sort(newPop.begin(), newPop.end(), Rbt::GenomeCmp_Score());
 
@@ -168,12 +263,9 @@ void RbtPopulation::MergeNewPop(RbtGenomeList& newPop, RbtDouble equalityThresho
     std::merge(
         m_pop.begin(), m_pop.end(), newPop.begin(), newPop.end(), std::back_inserter(mergedPop), Rbt::GenomeCmp_Score()
     );
-    // Remove neighbouring duplicates by equality of chromosome element values
-    RbtGenomeListIter end = std::unique(mergedPop.begin(), mergedPop.end(), Rbt::isGenome_eq(equalityThreshold));
-    mergedPop.erase(end, mergedPop.end());
+    // Remove near-duplicates by equality of chromosome element values, keeping the best scoring genome.
     m_pop.clear();
-    end = (mergedPop.size() > m_size) ? (mergedPop.begin() + m_size) : mergedPop.end();
-    std::copy(mergedPop.begin(), end, back_inserter(m_pop));
+    RemoveDuplicates(mergedPop, equalityThreshold, m_size, m_pop);
 }
 
 void RbtPopulation::EvaluateRWFitness() {
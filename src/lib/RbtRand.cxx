@@ -62,6 +62,23 @@ RbtVector RbtRand::GetRandomUnitVector() {
     return RbtVector(x, y, z);
 }
 
+// Get a random unit quaternion distributed evenly over orientation space
+RbtQuat RbtRand::GetRandomQuat() {
+    RbtDouble u1 = GetRandom01();
+    RbtDouble u2 = GetRandom01();
+    RbtDouble u3 = GetRandom01();
+    return GetUniformQuat(u1, u2, u3);
+}
+
+// Shoemake, "Uniform random rotations", Graphics Gems III (1992)
+RbtQuat RbtRand::GetUniformQuat(RbtDouble u1, RbtDouble u2, RbtDouble u3) {
+    RbtDouble r1 = sqrt(1.0 - u1);
+    RbtDouble r2 = sqrt(u1);
+    return RbtQuat(
+        r2 * cos(2.0 * M_PI * u3), r1 * sin(2.0 * M_PI * u2), r1 * cos(2.0 * M_PI * u2), r2 * sin(2.0 * M_PI * u3)
+    );
+}
+
 // Get a random number from the Normal distribution (mean, variance)
 RbtDouble RbtRand::GetGaussianRandom(RbtDouble mean, RbtDouble variance) {
     for (;;) {
@@ -12,19 +12,110 @@
 
 #include "RbtRandPopTransform.h"
 
+#include <algorithm>
+#include <map>
+
+#include "RbtAtomFuncs.h"
 #include "RbtChrom.h"
+#include "RbtChromDihedralElement.h"
+#include "RbtFlexData.h"
+#include "RbtLigandFlexData.h"
+#include "RbtMdlFileSource.h"
+#include "RbtPharmaSF.h"
 #include "RbtPopulation.h"
+#include "RbtVdwGridSF.h"
 #include "RbtWorkSpace.h"
 
+// Template Numerical Toolkit for eigenvalue solver
+#include <jama_eig.h>
+#include <tnt.h>
+
 RbtString RbtRandPopTransform::_CT("RbtRandPopTransform");
 RbtString RbtRandPopTransform::_POP_SIZE("POP_SIZE");
 RbtString RbtRandPopTransform::_SCALE_CHROM_LENGTH("SCALE_CHROM_LENGTH");
+RbtString RbtRandPopTransform::_PHARMA_SEED_FRACTION("PHARMA_SEED_FRACTION");
+RbtString RbtRandPopTransform::_SCAN_SEED_FRACTION("SCAN_SEED_FRACTION");
+RbtString RbtRandPopTransform::_SCAN_NROT("SCAN_NROT");
+RbtString RbtRandPopTransform::_GROW_SEED_FRACTION("GROW_SEED_FRACTION");
+RbtString RbtRandPopTransform::_GROW_BEAM_WIDTH("GROW_BEAM_WIDTH");
+RbtString RbtRandPopTransform::_GROW_DIHEDRAL_STEP("GROW_DIHEDRAL_STEP");
+RbtString RbtRandPopTransform::_GROW_CLASH_DIST("GROW_CLASH_DIST");
+RbtString RbtRandPopTransform::_GROW_CLASH_WEIGHT("GROW_CLASH_WEIGHT");
+RbtString RbtRandPopTransform::_RUN_SEED_FRACTION("RUN_SEED_FRACTION");
+RbtString RbtRandPopTransform::_RUN_SEED_THRESHOLD("RUN_SEED_THRESHOLD");
+RbtString RbtRandPopTransform::_TEMPLATE_SEED_FRACTION("TEMPLATE_SEED_FRACTION");
+RbtString RbtRandPopTransform::_TEMPLATE_FILE("TEMPLATE_FILE");
+RbtString RbtRandPopTransform::_TEMPLATE_MIN_MATCHED("TEMPLATE_MIN_MATCHED");
+
+// Number of random atom assignments to try for each seeded genome
+const RbtInt N_SEED_TRIALS = 10;
+
+// Returns true if genomeList contains a genome equal to pGenome, within threshold
+static RbtBool ContainsGenome(const RbtGenomeList& genomeList, const RbtGenome* pGenome, RbtDouble threshold) {
+    for (RbtGenomeListConstIter iter = genomeList.begin(); iter != genomeList.end(); ++iter) {
+        if ((*iter)->Equals(*pGenome, threshold)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Least squares rotation (Horn's quaternion method) that superimposes the coords
+// in fromList onto those in toList, after both sets have been centred on the origin.
+// Returns the rms deviation of the superimposed coords.
+static RbtDouble FitCoords(const RbtCoordList& fromList, const RbtCoordList& toList, RbtQuat& q) {
+    // Correlation matrix
+    RbtDouble S[3][3] = {{0.0, 0.0, 0.0}, {0.0, 0.0, 0.0}, {0.0, 0.0, 0.0}};
+    for (RbtUInt i = 0; i < fromList.size(); i++) {
+        const RbtCoord& a = fromList[i];
+        const RbtCoord& b = toList[i];
+        S[0][0] += a.x * b.x;
+        S[0][1] += a.x * b.y;
+        S[0][2] += a.x * b.z;
+        S[1][0] += a.y * b.x;
+        S[1][1] += a.y * b.y;
+        S[1][2] += a.y * b.z;
+        S[2][0] += a.z * b.x;
+        S[2][1] += a.z * b.y;
+        S[2][2] += a.z * b.z;
+    }
+    TNT::Array2D<RbtDouble> N(4, 4);
+    N[0][0] = S[0][0] + S[1][1] + S[2][2];
+    N[1][1] = S[0][0] - S[1][1] - S[2][2];
+    N[2][2] = -S[0][0] + S[1][1] - S[2][2];
+    N[3][3] = -S[0][0] - S[1][1] + S[2][2];
+    N[0][1] = N[1][0] = S[1][2] - S[2][1];
+    N[0][2] = N[2][0] = S[2][0] - S[0][2];
+    N[0][3] = N[3][0] = S[0][1] - S[1][0];
+    N[1][2] = N[2][1] = S[0][1] + S[1][0];
+    N[1][3] = N[3][1] = S[2][0] + S[0][2];
+    N[2][3] = N[3][2] = S[1][2] + S[2][1];
+    // The optimal rotation is the eigenvector with the largest eigenvalue
+    JAMA::Eigenvalue<RbtDouble> eigenSolver(N);
+    TNT::Array1D<RbtDouble> eigenValues(4);
+    TNT::Array2D<RbtDouble> eigenVectors(4, 4);
+    eigenSolver.getRealEigenvalues(eigenValues);
+    eigenSolver.getV(eigenVectors);
+    RbtInt iMax = 0;
+    for (RbtInt i = 1; i < 4; i++) {
+        if (eigenValues[i] > eigenValues[iMax]) iMax = i;
+    }
+    q = RbtQuat(eigenVectors[0][iMax], eigenVectors[1][iMax], eigenVectors[2][iMax], eigenVectors[3][iMax]);
+    RbtDouble rmsd = 0.0;
+    for (RbtUInt i = 0; i < fromList.size(); i++) {
+        rmsd += Rbt::Length2(q.Rotate(fromList[i]) - toList[i]);
+    }
+    return std::sqrt(rmsd / fromList.size());
+}
 
 const RbtRandPopTransform::Config
     RbtRandPopTransform::DEFAULT_CONFIG{};  // Empty initializer to fall back to default values
 
 RbtRandPopTransform::RbtRandPopTransform(const RbtString& strName, const Config& config):
     RbtBaseBiMolTransform(_CT, strName),
+    m_bTemplateMatched(false),
+    m_bFragmentsSetup(false),
+    m_rand(Rbt::GetRbtRand()),
     config{config} {
     _RBTOBJECTCOUNTER_CONSTR_(_CT);
 }
@@ -43,6 +134,15 @@ void RbtRandPopTransform::SetupSolvent() {}
 void RbtRandPopTransform::SetupTransform() {
     // Construct the overall chromosome for the system
     m_chrom = new RbtChrom(GetWorkSpace()->GetModels());
+    // Poses from earlier runs are meaningless for the new models
+    m_spLastPop.SetNull();
+    m_runArchive.clear();
+    m_bTemplateMatched = false;
+    m_templateAtoms.clear();
+    m_templateCoords.clear();
+    m_templateTorsions.clear();
+    // The fragments are determined on first use, as the ligand chromosome may not be final yet
+    m_bFragmentsSetup = false;
 }
 
 ////////////////////////////////////////
@@ -64,7 +164,636 @@ void RbtRandPopTransform::Execute() {
         population_size *= chromLength;
     }
     if (GetTrace() > 3) cout << _CT << ": popSize=" << population_size << endl;
-    RbtPopulationPtr pop = new RbtPopulation(m_chrom, population_size, pSF);
-    pop->Best()->GetChrom()->SyncToModel();
+    RbtGenomeList seeds;
+    RbtInt nSeeds = RbtInt(config.pharma_seed_fraction * population_size + 0.5);
+    if ((nSeeds > 0) && !GetLigand().Null()) {
+        RbtPharmaSF* pPharmaSF = Rbt::FindSF<RbtPharmaSF>(pSF);
+        if (pPharmaSF != NULL) {
+            CreatePharmaSeeds(pPharmaSF->GetMandatoryConstraints(), std::min(nSeeds, population_size), seeds);
+        }
+        if (GetTrace() > 3) cout << _CT << ": " << seeds.size() << " ph4 seeded genomes" << endl;
+    }
+    nSeeds = RbtInt(config.scan_seed_fraction * population_size + 0.5);
+    nSeeds = std::min(nSeeds, population_size - RbtInt(seeds.size()));
+    if ((nSeeds > 0) && !GetLigand().Null()) {
+        RbtVdwGridSF* pVdwSF = Rbt::FindSF<RbtVdwGridSF>(pSF);
+        RbtInt nPharmaSeeds = seeds.size();
+        if (pVdwSF != NULL) {
+            CreateScanSeeds(pVdwSF, nSeeds, seeds);
+        }
+        if (GetTrace() > 3) cout << _CT << ": " << seeds.size() - nPharmaSeeds << " scan seeded genomes" << endl;
+    }
+    nSeeds = RbtInt(config.grow_seed_fraction * population_size + 0.5);
+    nSeeds = std::min(nSeeds, population_size - RbtInt(seeds.size()));
+    if ((nSeeds > 0) && !GetLigand().Null()) {
+        RbtVdwGridSF* pVdwSF = Rbt::FindSF<RbtVdwGridSF>(pSF);
+        RbtInt nPrevSeeds = seeds.size();
+        if (pVdwSF != NULL) {
+            CreateGrowSeeds(pVdwSF, nSeeds, seeds);
+        }
+        if (GetTrace() > 3) cout << _CT << ": " << seeds.size() - nPrevSeeds << " grown genomes" << endl;
+    }
+    nSeeds = RbtInt(config.template_seed_fraction * population_size + 0.5);
+    nSeeds = std::min(nSeeds, population_size - RbtInt(seeds.size()));
+    if ((nSeeds > 0) && !GetLigand().Null()) {
+        RbtInt nPrevSeeds = seeds.size();
+        MatchTemplate();
+        CreateTemplateSeeds(nSeeds, seeds);
+        if (GetTrace() > 3) cout << _CT << ": " << seeds.size() - nPrevSeeds << " template seeded genomes" << endl;
+    }
+    nSeeds = RbtInt(config.run_seed_fraction * population_size + 0.5);
+    nSeeds = std::min(nSeeds, population_size - RbtInt(seeds.size()));
+    if (nSeeds > 0) {
+        UpdateRunArchive(pSF, nSeeds);
+        std::copy(m_runArchive.begin(), m_runArchive.end(), std::back_inserter(seeds));
+        if (GetTrace() > 3) cout << _CT << ": " << m_runArchive.size() << " genomes seeded from previous runs" << endl;
+    }
+    RbtPopulationPtr pop = new RbtPopulation(m_chrom, population_size, pSF, seeds);
+    pop->Best()->SyncToModel();
     GetWorkSpace()->SetPopulation(pop);
+    if (nSeeds > 0) {
+        m_spLastPop = pop;
+    }
+}
+
+void RbtRandPopTransform::CreatePharmaSeeds(const RbtConstraintList& constrList, RbtInt nSeeds, RbtGenomeList& seeds) {
+    // Only constraints with at least one matching ligand atom are of any use
+    RbtConstraintList matchedList;
+    for (RbtConstraintListConstIter iter = constrList.begin(); iter != constrList.end(); ++iter) {
+        if (!(*iter)->GetAtomList().empty()) {
+            matchedList.push_back(*iter);
+        }
+    }
+    if (matchedList.empty()) {
+        return;
+    }
+    RbtModelPtr spLigand = GetLigand();
+    RbtAtomList ligAtomList = spLigand->GetAtomList();
+    RbtInt nConstr = std::min(RbtInt(matchedList.size()), 3);
+    RbtChromElementPtr chrom = m_chrom->clone();
+    for (RbtInt iSeed = 0; iSeed < nSeeds; iSeed++) {
+        // Randomise the ligand conformation (and everything else) before fitting
+        chrom->Randomise();
+        chrom->SyncToModel();
+        RbtDouble bestRMSD = 0.0;
+        RbtQuat bestQ;
+        RbtCoord bestFromCOM;
+        RbtCoord bestToCOM;
+        for (RbtInt iTrial = 0; iTrial < N_SEED_TRIALS; iTrial++) {
+            // Random subset of constraints, with a random matching atom for each
+            RbtCoordList fromList;
+            RbtCoordList toList;
+            for (RbtInt i = 0; i < nConstr; i++) {
+                std::swap(matchedList[i], matchedList[i + m_rand.GetRandomInt(matchedList.size() - i)]);
+                const RbtAtomList& atomList = matchedList[i]->GetAtomList();
+                fromList.push_back(atomList[m_rand.GetRandomInt(atomList.size())]->GetCoords());
+                toList.push_back(matchedList[i]->GetCoords());
+            }
+            RbtCoord fromCOM = Rbt::GetCenterOfMass(fromList);
+            RbtCoord toCOM = Rbt::GetCenterOfMass(toList);
+            for (RbtInt i = 0; i < nConstr; i++) {
+                fromList[i] -= fromCOM;
+                toList[i] -= toCOM;
+            }
+            RbtQuat q;
+            RbtDouble rmsd = (nConstr > 1) ? FitCoords(fromList, toList, q) : 0.0;
+            if ((iTrial == 0) || (rmsd < bestRMSD)) {
+                bestRMSD = rmsd;
+                bestQ = q;
+                bestFromCOM = fromCOM;
+                bestToCOM = toCOM;
+            }
+        }
+        // Fewer than three points leave the orientation partly undetermined,
+        // so apply a random rotation about the constraint axis (or point)
+        RbtQuat q = bestQ;
+        if (nConstr < 3) {
+            RbtVector axis = m_rand.GetRandomUnitVector();
+            if (nConstr == 2) {
+                axis = Rbt::Unit(matchedList[0]->GetCoords() - matchedList[1]->GetCoords());
+            }
+            q = RbtQuat(axis, 2.0 * M_PI * m_rand.GetRandom01()) * bestQ;
+        }
+        spLigand->Translate(-bestFromCOM);
+        std::for_each(ligAtomList.begin(), ligAtomList.end(), Rbt::RotateAtomUsingQuat(q));
+        spLigand->Translate(bestToCOM);
+        chrom->SyncFromModel();
+        seeds.push_back(new RbtGenome(chrom.Ptr()));
+        if (GetTrace() > 4) cout << _CT << ": ph4 seed " << iSeed << " fit rmsd=" << bestRMSD << endl;
+    }
+}
+
+void RbtRandPopTransform::CreateScanSeeds(const RbtVdwGridSF* pVdwSF, RbtInt nSeeds, RbtGenomeList& seeds) {
+    RbtModelPtr spLigand = GetLigand();
+    RbtAtomList ligAtomList = spLigand->GetAtomList();
+    RbtCoordList initialCoords;
+    Rbt::GetCoordList(ligAtomList, initialCoords);
+    RbtUIntList allAtoms;
+    for (RbtUInt i = 0; i < ligAtomList.size(); i++) {
+        allAtoms.push_back(i);
+    }
+    RbtCoord com = Rbt::GetCenterOfMass(ligAtomList);
+    vector<RigidPose> poses;
+    ScanRigidBody(pVdwSF, initialCoords, allAtoms, com, nSeeds, poses);
+
+    RbtChromElementPtr chrom = m_chrom->clone();
+    RbtCoordList coords(initialCoords.size());
+    for (RbtUInt iSeed = 0; iSeed < poses.size(); iSeed++) {
+        for (RbtUInt i = 0; i < initialCoords.size(); i++) {
+            coords[i] = poses[iSeed].q.Rotate(initialCoords[i] - com) + poses[iSeed].translation;
+        }
+        seeds.push_back(CreateLigandPoseGenome(chrom.Ptr(), ligAtomList, coords));
+        if (GetTrace() > 4) cout << _CT << ": scan seed " << iSeed << " vdw score=" << poses[iSeed].score << endl;
+    }
+    // Restore the initial ligand coords
+    for (RbtUInt i = 0; i < initialCoords.size(); i++) {
+        ligAtomList[i]->SetCoords(initialCoords[i]);
+    }
+    spLigand->UpdatePseudoAtoms();
+}
+
+void RbtRandPopTransform::ScanRigidBody(
+    const RbtVdwGridSF* pVdwSF,
+    const RbtCoordList& coords,
+    const RbtUIntList& atoms,
+    const RbtCoord& centre,
+    RbtInt nPoses,
+    vector<RigidPose>& poses
+) {
+    poses.clear();
+    RbtDockingSitePtr spDS = GetWorkSpace()->GetDockingSite();
+    if (spDS.Null() || (config.scan_num_rotations <= 0) || (nPoses <= 0)) {
+        return;
+    }
+    RbtCoordList cavityCoords;
+    spDS->GetCoordList(cavityCoords);
+    if (cavityCoords.empty()) {
+        return;
+    }
+    RbtCoordList rotCoords(coords.size());
+    RbtCoordList trialCoords(coords.size());
+    // Best translation for each rotation
+    for (RbtInt iRot = 0; iRot < config.scan_num_rotations; iRot++) {
+        // Uniformly distributed random rotation
+        RigidPose pose;
+        pose.q = m_rand.GetRandomQuat();
+        for (RbtUIntListConstIter iter = atoms.begin(); iter != atoms.end(); ++iter) {
+            rotCoords[*iter] = pose.q.Rotate(coords[*iter] - centre);
+        }
+        for (RbtCoordListConstIter tIter = cavityCoords.begin(); tIter != cavityCoords.end(); ++tIter) {
+            for (RbtUIntListConstIter iter = atoms.begin(); iter != atoms.end(); ++iter) {
+                trialCoords[*iter] = rotCoords[*iter] + *tIter;
+            }
+            RbtDouble score = pVdwSF->RawScore(trialCoords, atoms);
+            if ((tIter == cavityCoords.begin()) || (score < pose.score)) {
+                pose.score = score;
+                pose.translation = *tIter;
+            }
+        }
+        poses.push_back(pose);
+    }
+    // Equal scores stay in rotation order
+    std::stable_sort(poses.begin(), poses.end());
+    poses.resize(std::min(RbtUInt(nPoses), RbtUInt(poses.size())));
+}
+
+void RbtRandPopTransform::CreateGrowSeeds(const RbtVdwGridSF* pVdwSF, RbtInt nSeeds, RbtGenomeList& seeds) {
+    if (!m_bFragmentsSetup) {
+        SetupFragments();
+    }
+    RbtModelPtr spLigand = GetLigand();
+    RbtAtomList ligAtomList = spLigand->GetAtomList();
+    RbtCoordList initialCoords;
+    Rbt::GetCoordList(ligAtomList, initialCoords);
+    RbtCoordList anchorCoords;
+    for (RbtUIntListConstIter iter = m_anchorAtoms.begin(); iter != m_anchorAtoms.end(); ++iter) {
+        anchorCoords.push_back(initialCoords[*iter]);
+    }
+    RbtCoord anchorCom = Rbt::GetCenterOfMass(anchorCoords);
+    vector<RigidPose> anchorPoses;
+    ScanRigidBody(pVdwSF, initialCoords, m_anchorAtoms, anchorCom, config.grow_beam_width, anchorPoses);
+
+    // The whole ligand moves with the anchor, although only the anchor atoms are placed
+    vector<PartialPose> beam(anchorPoses.size());
+    for (RbtUInt iPose = 0; iPose < anchorPoses.size(); iPose++) {
+        const RigidPose& anchorPose = anchorPoses[iPose];
+        beam[iPose].score = anchorPose.score;
+        for (RbtCoordListConstIter iter = initialCoords.begin(); iter != initialCoords.end(); ++iter) {
+            beam[iPose].coords.push_back(anchorPose.q.Rotate(*iter - anchorCom) + anchorPose.translation);
+        }
+    }
+    vector<RbtBool> placed(ligAtomList.size(), false);
+    for (RbtUIntListConstIter iter = m_anchorAtoms.begin(); iter != m_anchorAtoms.end(); ++iter) {
+        placed[*iter] = true;
+    }
+    for (vector<GrowthStep>::const_iterator iter = m_growthSteps.begin(); iter != m_growthSteps.end(); ++iter) {
+        Grow(pVdwSF, *iter, placed, beam);
+        for (RbtUIntListConstIter aIter = iter->placedAtoms.begin(); aIter != iter->placedAtoms.end(); ++aIter) {
+            placed[*aIter] = true;
+        }
+        if ((GetTrace() > 4) && !beam.empty()) {
+            cout << _CT << ": growth step " << (iter - m_growthSteps.begin()) + 1 << " best partial score "
+                 << beam.front().score << endl;
+        }
+    }
+
+    RbtChromElementPtr chrom = m_chrom->clone();
+    nSeeds = std::min(nSeeds, RbtInt(beam.size()));
+    for (RbtInt iSeed = 0; iSeed < nSeeds; iSeed++) {
+        seeds.push_back(CreateLigandPoseGenome(chrom.Ptr(), ligAtomList, beam[iSeed].coords));
+        if (GetTrace() > 4) cout << _CT << ": grown seed " << iSeed << " score=" << beam[iSeed].score << endl;
+    }
+    // Restore the initial ligand coords
+    for (RbtUInt i = 0; i < initialCoords.size(); i++) {
+        ligAtomList[i]->SetCoords(initialCoords[i]);
+    }
+    spLigand->UpdatePseudoAtoms();
+}
+
+void RbtRandPopTransform::SetupFragments() {
+    m_bFragmentsSetup = true;
+    m_anchorAtoms.clear();
+    m_growthSteps.clear();
+    RbtModelPtr spLigand = GetLigand();
+    RbtAtomList ligAtomList = spLigand->GetAtomList();
+    RbtUInt nAtoms = ligAtomList.size();
+    std::map<RbtAtom*, RbtUInt> indexMap;
+    m_isHeavy.assign(nAtoms, false);
+    for (RbtUInt i = 0; i < nAtoms; i++) {
+        indexMap[ligAtomList[i]] = i;
+        m_isHeavy[i] = (ligAtomList[i]->GetAtomicNo() != 1);
+    }
+    // Bonded neighbours, and the rotatable bonds sampled by the ligand chromosome
+    vector<RbtUIntList> neighbours(nAtoms);
+    RbtBondList bondList = spLigand->GetBondList();
+    for (RbtBondListConstIter iter = bondList.begin(); iter != bondList.end(); ++iter) {
+        RbtUInt i1 = indexMap[(*iter)->GetAtom1Ptr()];
+        RbtUInt i2 = indexMap[(*iter)->GetAtom2Ptr()];
+        neighbours[i1].push_back(i2);
+        neighbours[i2].push_back(i1);
+    }
+    vector<vector<RbtBool> > isRotBond(nAtoms, vector<RbtBool>(nAtoms, false));
+    RbtChromElementPtr spLigChrom(spLigand->GetChrom());
+    if (!spLigChrom.Null()) {
+        RbtChromElementList leafList;
+        spLigChrom->GetLeafElements(leafList);
+        for (RbtChromElementListIter iter = leafList.begin(); iter != leafList.end(); ++iter) {
+            RbtChromDihedralElement* pDihedral = dynamic_cast<RbtChromDihedralElement*>(*iter);
+            if (pDihedral != NULL) {
+                RbtUInt i2 = indexMap[pDihedral->GetRefData()->GetAtom2()];
+                RbtUInt i3 = indexMap[pDihedral->GetRefData()->GetAtom3()];
+                isRotBond[i2][i3] = isRotBond[i3][i2] = true;
+            }
+        }
+    }
+    // Atom pairs separated by up to three bonds
+    m_isNear.assign(nAtoms, vector<RbtBool>(nAtoms, false));
+    for (RbtUInt i = 0; i < nAtoms; i++) {
+        RbtUIntList shell(1, i);
+        m_isNear[i][i] = true;
+        for (RbtInt nBonds = 0; nBonds < 3; nBonds++) {
+            RbtUIntList nextShell;
+            for (RbtUIntListConstIter iter = shell.begin(); iter != shell.end(); ++iter) {
+                const RbtUIntList& bonded = neighbours[*iter];
+                for (RbtUIntListConstIter nIter = bonded.begin(); nIter != bonded.end(); ++nIter) {
+                    if (!m_isNear[i][*nIter]) {
+                        m_isNear[i][*nIter] = true;
+                        nextShell.push_back(*nIter);
+                    }
+                }
+            }
+            shell.swap(nextShell);
+        }
+    }
+    // Rigid fragments are the connected components once the rotatable bonds are cut
+    vector<RbtInt> fragment(nAtoms, -1);
+    vector<RbtUIntList> fragAtoms;
+    for (RbtUInt i = 0; i < nAtoms; i++) {
+        if (fragment[i] >= 0) {
+            continue;
+        }
+        RbtInt iFrag = fragAtoms.size();
+        fragAtoms.push_back(RbtUIntList(1, i));
+        fragment[i] = iFrag;
+        for (RbtUInt j = 0; j < fragAtoms[iFrag].size(); j++) {
+            RbtUInt a = fragAtoms[iFrag][j];
+            for (RbtUIntListConstIter nIter = neighbours[a].begin(); nIter != neighbours[a].end(); ++nIter) {
+                if ((fragment[*nIter] < 0) && !isRotBond[a][*nIter]) {
+                    fragment[*nIter] = iFrag;
+                    fragAtoms[iFrag].push_back(*nIter);
+                }
+            }
+        }
+    }
+    // The anchor is the fragment with the most ring atoms (then the most heavy atoms)
+    RbtInt iAnchor = 0;
+    std::pair<RbtInt, RbtInt> bestSize(-1, -1);
+    for (RbtUInt iFrag = 0; iFrag < fragAtoms.size(); iFrag++) {
+        std::pair<RbtInt, RbtInt> size(0, 0);
+        for (RbtUIntListConstIter iter = fragAtoms[iFrag].begin(); iter != fragAtoms[iFrag].end(); ++iter) {
+            if (m_isHeavy[*iter]) {
+                size.second++;
+                if (ligAtomList[*iter]->GetCyclicFlag()) size.first++;
+            }
+        }
+        if (size > bestSize) {
+            bestSize = size;
+            iAnchor = iFrag;
+        }
+    }
+    m_anchorAtoms = fragAtoms[iAnchor];
+    // Breadth-first traversal of the torsion tree from the anchor
+    vector<RbtBool> fragDone(fragAtoms.size(), false);
+    fragDone[iAnchor] = true;
+    vector<RbtInt> fragQueue(1, iAnchor);
+    for (RbtUInt iQueue = 0; iQueue < fragQueue.size(); iQueue++) {
+        const RbtUIntList& atoms = fragAtoms[fragQueue[iQueue]];
+        for (RbtUIntListConstIter iter = atoms.begin(); iter != atoms.end(); ++iter) {
+            for (RbtUIntListConstIter nIter = neighbours[*iter].begin(); nIter != neighbours[*iter].end(); ++nIter) {
+                RbtInt iFrag = fragment[*nIter];
+                if (fragDone[iFrag]) {
+                    continue;
+                }
+                fragDone[iFrag] = true;
+                fragQueue.push_back(iFrag);
+                GrowthStep step;
+                step.proximalAtom = *iter;
+                step.distalAtom = *nIter;
+                step.placedAtoms = fragAtoms[iFrag];
+                // Everything beyond the bond moves with the dihedral
+                vector<RbtBool> moved(nAtoms, false);
+                moved[*iter] = true;
+                moved[*nIter] = true;
+                step.movedAtoms.push_back(*nIter);
+                for (RbtUInt j = 0; j < step.movedAtoms.size(); j++) {
+                    RbtUInt a = step.movedAtoms[j];
+                    for (RbtUIntListConstIter mIter = neighbours[a].begin(); mIter != neighbours[a].end(); ++mIter) {
+                        if (!moved[*mIter]) {
+                            moved[*mIter] = true;
+                            step.movedAtoms.push_back(*mIter);
+                        }
+                    }
+                }
+                m_growthSteps.push_back(step);
+            }
+        }
+    }
+    if (GetTrace() > 3) {
+        cout << _CT << ": anchor fragment has " << m_anchorAtoms.size() << " atoms, " << m_growthSteps.size()
+             << " growth steps" << endl;
+    }
+}
+
+void RbtRandPopTransform::Grow(
+    const RbtVdwGridSF* pVdwSF, const GrowthStep& step, const vector<RbtBool>& placed, vector<PartialPose>& beam
+) const {
+    RbtInt nDihedrals = std::max(1, RbtInt(360.0 / config.grow_dihedral_step + 0.5));
+    RbtDouble dihedralStep = 2.0 * M_PI / nDihedrals;
+    vector<PartialPose> children;
+    children.reserve(beam.size() * nDihedrals);
+    for (vector<PartialPose>::const_iterator iter = beam.begin(); iter != beam.end(); ++iter) {
+        const RbtCoord& pivot = iter->coords[step.proximalAtom];
+        RbtVector axis = iter->coords[step.distalAtom] - pivot;
+        // Random phase, so that each pose samples different dihedral values
+        RbtDouble phase = dihedralStep * m_rand.GetRandom01();
+        for (RbtInt iDihedral = 0; iDihedral < nDihedrals; iDihedral++) {
+            RbtQuat q(axis, phase + iDihedral * dihedralStep);
+            PartialPose child;
+            child.coords = iter->coords;
+            for (RbtUIntListConstIter aIter = step.movedAtoms.begin(); aIter != step.movedAtoms.end(); ++aIter) {
+                child.coords[*aIter] = q.Rotate(child.coords[*aIter] - pivot) + pivot;
+            }
+            child.score = iter->score + pVdwSF->RawScore(child.coords, step.placedAtoms)
+                          + ClashScore(child.coords, step.placedAtoms, placed);
+            children.push_back(child);
+        }
+    }
+    RbtUInt nKeep = std::min(RbtUInt(config.grow_beam_width), RbtUInt(children.size()));
+    std::partial_sort(children.begin(), children.begin() + nKeep, children.end());
+    children.resize(nKeep);
+    beam.swap(children);
+}
+
+RbtDouble RbtRandPopTransform::ClashScore(
+    const RbtCoordList& coords, const RbtUIntList& newAtoms, const vector<RbtBool>& placed
+) const {
+    RbtDouble clashDist2 = config.grow_clash_dist * config.grow_clash_dist;
+    RbtDouble penalty = 0.0;
+    for (RbtUIntListConstIter iter = newAtoms.begin(); iter != newAtoms.end(); ++iter) {
+        if (!m_isHeavy[*iter]) {
+            continue;
+        }
+        for (RbtUInt j = 0; j < coords.size(); j++) {
+            if (!placed[j] || !m_isHeavy[j] || m_isNear[*iter][j]) {
+                continue;
+            }
+            RbtDouble r2 = Rbt::Length2(coords[*iter], coords[j]);
+            if (r2 < clashDist2) {
+                RbtDouble overlap = config.grow_clash_dist - sqrt(r2);
+                penalty += overlap * overlap;
+            }
+        }
+    }
+    return config.grow_clash_weight * penalty;
+}
+
+RbtGenome* RbtRandPopTransform::CreateLigandPoseGenome(
+    RbtChromElement* pChrom, RbtAtomList& ligAtomList, const RbtCoordList& coords
+) {
+    // Randomise everything else, then place the ligand
+    pChrom->Randomise();
+    pChrom->SyncToModel();
+    for (RbtUInt i = 0; i < ligAtomList.size(); i++) {
+        ligAtomList[i]->SetCoords(coords[i]);
+    }
+    GetLigand()->UpdatePseudoAtoms();
+    pChrom->SyncFromModel();
+    return new RbtGenome(pChrom);
+}
+
+void RbtRandPopTransform::UpdateRunArchive(RbtBaseSF* pSF, RbtInt nSeeds) {
+    if (m_spLastPop.Null()) {
+        return;
+    }
+    // The models still hold the final (refined) pose of the previous run
+    RbtGenomeList candidates(m_runArchive);
+    m_chrom->SyncFromModel();
+    candidates.push_back(new RbtGenome(m_chrom.Ptr()));
+    // The final population is already sorted by score, so only its best diverse members need be considered
+    const RbtGenomeList& lastPop = m_spLastPop->GetGenomeList();
+    RbtInt nAdded = 0;
+    for (RbtGenomeListConstIter iter = lastPop.begin(); (iter != lastPop.end()) && (nAdded < nSeeds); ++iter) {
+        if (!ContainsGenome(candidates, *iter, config.run_seed_threshold)) {
+            candidates.push_back(*iter);
+            nAdded++;
+        }
+    }
+    m_spLastPop.SetNull();
+    // Scoring function weights may differ between the end and start of a run, so rescore everything
+    for (RbtGenomeListIter iter = candidates.begin(); iter != candidates.end(); ++iter) {
+        (*iter)->SetScore(pSF);
+    }
+    std::stable_sort(candidates.begin(), candidates.end(), Rbt::GenomeCmp_Score());
+    m_runArchive.clear();
+    for (RbtGenomeListConstIter iter = candidates.begin();
+         (iter != candidates.end()) && (RbtInt(m_runArchive.size()) < nSeeds);
+         ++iter) {
+        if (!ContainsGenome(m_runArchive, *iter, config.run_seed_threshold)) {
+            m_runArchive.push_back(*iter);
+        }
+    }
+}
+
+void RbtRandPopTransform::MatchTemplate() {
+    if (m_bTemplateMatched) {
+        return;
+    }
+    m_bTemplateMatched = true;
+    if (m_spTemplate.Null()) {
+        RbtString strTemplateFile = Rbt::GetRbtFileName("", config.template_file);
+        RbtMolecularFileSourcePtr spTemplateSource(new RbtMdlFileSource(strTemplateFile, false, false, true));
+        m_spTemplate = new RbtModel(spTemplateSource);
+    }
+    RbtAtomList templateAtomList =
+        Rbt::GetAtomList(m_spTemplate->GetAtomList(), std::not1(Rbt::isAtomicNo_eq(1)));
+    RbtAtomList ligAtomList = Rbt::GetAtomList(GetLigand()->GetAtomList(), std::not1(Rbt::isAtomicNo_eq(1)));
+    RbtAtomList matchedTemplateAtoms;
+    RbtUInt nMatched =
+        Rbt::FindMaxCommonSubstructure(templateAtomList, ligAtomList, matchedTemplateAtoms, m_templateAtoms);
+    if (GetTrace() > 3) {
+        cout << _CT << ": " << nMatched << " ligand atoms matched to " << m_spTemplate->GetName() << endl;
+    }
+    if (RbtInt(nMatched) < config.template_min_matched) {
+        m_templateAtoms.clear();
+        return;
+    }
+    Rbt::GetCoordList(matchedTemplateAtoms, m_templateCoords);
+
+    // Find the rotatable bonds in the ligand chromosome (as created by RbtChromFactory) whose dihedrals
+    // are defined by matched atoms
+    RbtFlexData* pFlexData = GetLigand()->GetFlexData();
+    if (pFlexData == NULL) {
+        return;
+    }
+    RbtString strDihedralMode = pFlexData->GetParameter(RbtLigandFlexData::_DIHEDRAL_MODE);
+    if (RbtChromElement::StrToMode(strDihedralMode) != RbtChromElement::FREE) {
+        return;
+    }
+    RbtBondList rotBondList = Rbt::GetBondList(GetLigand()->GetBondList(), Rbt::isBondRotatable());
+    RbtBool bPruneSymRotors = pFlexData->GetParameter(RbtLigandFlexData::_PRUNE_SYM_ROTORS);
+    if (bPruneSymRotors) {
+        RbtBondListIter end = std::remove_if(rotBondList.begin(), rotBondList.end(), Rbt::isBondSymmetricRotor());
+        rotBondList.erase(end, rotBondList.end());
+    }
+    for (RbtBondListConstIter iter = rotBondList.begin(); iter != rotBondList.end(); ++iter) {
+        RbtAtomPtr spAtom2 = (*iter)->GetAtom1Ptr();
+        RbtAtomPtr spAtom3 = (*iter)->GetAtom2Ptr();
+        RbtInt i2 = FindTemplateAtom(spAtom2);
+        RbtInt i3 = FindTemplateAtom(spAtom3);
+        if ((i2 < 0) || (i3 < 0)) {
+            continue;
+        }
+        RbtInt i1 = FindTemplateNeighbour(spAtom2, spAtom3);
+        RbtInt i4 = FindTemplateNeighbour(spAtom3, spAtom2);
+        if ((i1 < 0) || (i4 < 0)) {
+            continue;
+        }
+        TemplateTorsion torsion;
+        torsion.spBond = *iter;
+        torsion.spAtom1 = m_templateAtoms[i1];
+        torsion.spAtom4 = m_templateAtoms[i4];
+        torsion.dihedral = Rbt::BondDihedral(
+            matchedTemplateAtoms[i1], matchedTemplateAtoms[i2], matchedTemplateAtoms[i3], matchedTemplateAtoms[i4]
+        );
+        m_templateTorsions.push_back(torsion);
+    }
+    if (GetTrace() > 3) {
+        cout << _CT << ": " << m_templateTorsions.size() << " of " << rotBondList.size()
+             << " rotatable bonds matched to " << m_spTemplate->GetName() << endl;
+    }
+}
+
+RbtInt RbtRandPopTransform::FindTemplateAtom(RbtAtom* pAtom) const {
+    for (RbtUInt i = 0; i < m_templateAtoms.size(); i++) {
+        if (m_templateAtoms[i].Ptr() == pAtom) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+RbtInt RbtRandPopTransform::FindTemplateNeighbour(RbtAtom* pAtom, RbtAtom* pExcludedAtom) const {
+    RbtAtomList bondedAtoms = Rbt::GetBondedAtomList(pAtom);
+    for (RbtAtomListConstIter iter = bondedAtoms.begin(); iter != bondedAtoms.end(); ++iter) {
+        RbtInt i = ((*iter).Ptr() != pExcludedAtom) ? FindTemplateAtom(*iter) : -1;
+        if (i >= 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void RbtRandPopTransform::SetTemplateTorsions() {
+    RbtModelPtr spLigand = GetLigand();
+    for (vector<TemplateTorsion>::const_iterator iter = m_templateTorsions.begin(); iter != m_templateTorsions.end();
+         ++iter) {
+        RbtAtom* pAtom2 = iter->spBond->GetAtom1Ptr();
+        RbtAtom* pAtom3 = iter->spBond->GetAtom2Ptr();
+        RbtDouble delta = iter->dihedral - Rbt::BondDihedral(iter->spAtom1, pAtom2, pAtom3, iter->spAtom4);
+        // Rotating either end of the bond about the bond vector (pAtom2 to pAtom3) changes the dihedral by delta
+        spLigand->RotateBond(iter->spBond, delta, false);
+    }
+}
+
+void RbtRandPopTransform::CreateTemplateSeeds(RbtInt nSeeds, RbtGenomeList& seeds) {
+    if (m_templateAtoms.empty()) {
+        return;
+    }
+    RbtModelPtr spLigand = GetLigand();
+    RbtAtomList ligAtomList = spLigand->GetAtomList();
+    RbtCoord toCOM = Rbt::GetCenterOfMass(m_templateCoords);
+    RbtCoordList toList(m_templateCoords);
+    for (RbtCoordListIter iter = toList.begin(); iter != toList.end(); ++iter) {
+        *iter -= toCOM;
+    }
+    RbtChromElementPtr chrom = m_chrom->clone();
+    RbtDoubleList bestVector;
+    for (RbtInt iSeed = 0; iSeed < nSeeds; iSeed++) {
+        // The random conformation whose matched atoms best fit the reference coords is kept
+        RbtDouble bestRMSD = 0.0;
+        RbtQuat bestQ;
+        RbtCoord bestFromCOM;
+        for (RbtInt iTrial = 0; iTrial < N_SEED_TRIALS; iTrial++) {
+            chrom->Randomise();
+            chrom->SyncToModel();
+            // Only the unmatched rotatable bonds keep their random dihedrals
+            if (!m_templateTorsions.empty()) {
+                SetTemplateTorsions();
+                chrom->SyncFromModel();
+            }
+            RbtCoordList fromList;
+            Rbt::GetCoordList(m_templateAtoms, fromList);
+            RbtCoord fromCOM = Rbt::GetCenterOfMass(fromList);
+            for (RbtCoordListIter iter = fromList.begin(); iter != fromList.end(); ++iter) {
+                *iter -= fromCOM;
+            }
+            RbtQuat q;
+            RbtDouble rmsd = FitCoords(fromList, toList, q);
+            if ((iTrial == 0) || (rmsd < bestRMSD)) {
+                bestRMSD = rmsd;
+                bestQ = q;
+                bestFromCOM = fromCOM;
+                bestVector.clear();
+                chrom->GetVector(bestVector);
+            }
+        }
+        chrom->SetVector(bestVector);
+        chrom->SyncToModel();
+        spLigand->Translate(-bestFromCOM);
+        std::for_each(ligAtomList.begin(), ligAtomList.end(), Rbt::RotateAtomUsingQuat(bestQ));
+        spLigand->Translate(toCOM);
+        chrom->SyncFromModel();
+        seeds.push_back(new RbtGenome(chrom.Ptr()));
+        if (GetTrace() > 4) cout << _CT << ": template seed " << iSeed << " fit rmsd=" << bestRMSD << endl;
+    }
 }
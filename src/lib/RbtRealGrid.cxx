@@ -11,6 +11,7 @@
  ***********************************************************************/
 
 #include <algorithm>  //for min, max, count
+#include <cstdint>
 #include <cstring>
 #include <iomanip>
 using std::setw;
@@ -21,6 +22,55 @@ using std::setw;
 // Static data members
 RbtString RbtRealGrid::_CT("RbtRealGrid");
 
+// Bricks are 4x4x4 grid points, so that each 4x4 plane of a brick fills a 64 byte cache line
+static const RbtUInt BRICK_BITS = 2;
+static const RbtUInt BRICK_SIZE = 1 << BRICK_BITS;
+static const RbtUInt BRICK_MASK = BRICK_SIZE - 1;
+static const std::uintptr_t CACHE_LINE_BYTES = 64;
+
+// Squared distance value for grid points that are not near any grid point of interest
+static const RbtDouble FAR_DIST2 = 1.0e20;
+
+// 1-D squared distance transform of the n values starting at data and spaced by stride, i.e. replaces each value
+// with min over j of (data[j] + (i - j)^2). f, v and z are workspace arrays of size n, n and n + 1.
+// P.F. Felzenszwalb and D.P. Huttenlocher, Theory of Computing (2012) 8, 415.
+static void DistanceTransform1D(
+    RbtDouble* data, RbtUInt stride, RbtUInt n, RbtDoubleList& f, RbtUIntList& v, RbtDoubleList& z
+) {
+    // Lower envelope of the parabolas rooted at each finite value
+    RbtInt k = -1;
+    for (RbtUInt q = 0; q < n; q++) {
+        f[q] = data[q * stride];
+        if (f[q] >= FAR_DIST2) {
+            continue;
+        }
+        RbtDouble s = -FAR_DIST2;
+        while (k >= 0) {
+            RbtDouble vk = v[k];
+            s = ((f[q] + RbtDouble(q) * q) - (f[v[k]] + vk * vk)) / (2.0 * (RbtDouble(q) - vk));
+            if (s > z[k]) {
+                break;
+            }
+            k--;
+        }
+        k++;
+        v[k] = q;
+        z[k] = (k == 0) ? -FAR_DIST2 : s;
+        z[k + 1] = FAR_DIST2;
+    }
+    if (k < 0) {
+        return;  // Nothing to measure the distance to
+    }
+    k = 0;
+    for (RbtUInt q = 0; q < n; q++) {
+        while (z[k + 1] < q) {
+            k++;
+        }
+        RbtDouble d = RbtDouble(q) - v[k];
+        data[q * stride] = d * d + f[v[k]];
+    }
+}
+
 ////////////////////////////////////////
 // Constructors/destructors
 // Construct a NXxNYxNZ grid running from gridMin at gridStep resolution
@@ -28,8 +78,10 @@ RbtRealGrid::RbtRealGrid(
     const RbtCoord& gridMin, const RbtCoord& gridStep, RbtUInt NX, RbtUInt NY, RbtUInt NZ, RbtUInt NPad
 ):
     RbtBaseGrid(gridMin, gridStep, NX, NY, NZ, NPad),
-    m_grid(NULL),
+    m_layout(LINEAR),
+    m_store(NULL),
     m_data(NULL),
+    m_size(0),
     m_tol(0.001) {
     CreateArrays();
     // Initialise the grid to zero
@@ -39,7 +91,12 @@ RbtRealGrid::RbtRealGrid(
 }
 
 // Constructor reading params from binary stream
-RbtRealGrid::RbtRealGrid(istream& istr): RbtBaseGrid(istr), m_grid(NULL), m_data(NULL) {
+RbtRealGrid::RbtRealGrid(istream& istr, eLayout layout):
+    RbtBaseGrid(istr),
+    m_layout(layout),
+    m_store(NULL),
+    m_data(NULL),
+    m_size(0) {
     // Base class constructor has already read the grid dimensions
     // etc, so all we have to do here is created the array
     // and read in the grid values
@@ -55,7 +112,12 @@ RbtRealGrid::~RbtRealGrid() {
 }
 
 // Copy constructor
-RbtRealGrid::RbtRealGrid(const RbtRealGrid& grid): RbtBaseGrid(grid), m_grid(NULL), m_data(NULL) {
+RbtRealGrid::RbtRealGrid(const RbtRealGrid& grid):
+    RbtBaseGrid(grid),
+    m_layout(grid.m_layout),
+    m_store(NULL),
+    m_data(NULL),
+    m_size(0) {
     // Base class constructor has already been called
     // so we just need to create the array and copy the array values
     CreateArrays();
@@ -65,7 +127,13 @@ RbtRealGrid::RbtRealGrid(const RbtRealGrid& grid): RbtBaseGrid(grid), m_grid(NUL
 
 // Copy constructor taking a base class argument
 // Sets up the grid dimensions, then creates an empty data array
-RbtRealGrid::RbtRealGrid(const RbtBaseGrid& grid): RbtBaseGrid(grid), m_grid(NULL), m_data(NULL) {
+RbtRealGrid::RbtRealGrid(const RbtBaseGrid& grid):
+    RbtBaseGrid(grid),
+    m_layout(LINEAR),
+    m_store(NULL),
+    m_data(NULL),
+    m_size(0),
+    m_tol(0.001) {
     CreateArrays();
     SetAllValues(0.0);
     _RBTOBJECTCOUNTER_COPYCONSTR_("RbtRealGrid");
@@ -78,6 +146,7 @@ RbtRealGrid& RbtRealGrid::operator=(const RbtRealGrid& grid) {
         ClearArrays();
         // In this case we need to explicitly call the base class operator=
         RbtBaseGrid::operator=(grid);
+        m_layout = grid.m_layout;
         CreateArrays();
         CopyGrid(grid);
     }
@@ -130,6 +199,24 @@ void RbtRealGrid::Read(istream& istr) {
 // Public methods
 ////////////////
 
+// Rearranges the grid values in memory. Grid values are unchanged
+void RbtRealGrid::SetLayout(eLayout layout) {
+    if (layout == m_layout) {
+        return;
+    }
+    RbtRealGrid oldGrid(*this);
+    ClearArrays();
+    m_layout = layout;
+    CreateArrays();
+    for (RbtUInt iX = 1; iX <= GetNX(); iX++) {
+        for (RbtUInt iY = 1; iY <= GetNY(); iY++) {
+            for (RbtUInt iZ = 1; iZ <= GetNZ(); iZ++) {
+                m_data[DataIndex(iX, iY, iZ)] = oldGrid.m_data[oldGrid.DataIndex(iX, iY, iZ)];
+            }
+        }
+    }
+}
+
 /////////////////////////
 // Get/Set value functions
 /////////////////////////
@@ -187,18 +274,24 @@ RbtDouble RbtRealGrid::GetSmoothedValue(const RbtCoord& c) const {
     RbtDouble bx0by1 = bx0 * by1;
     RbtDouble bx1by0 = bx1 * by0;
     RbtDouble bx1by1 = bx1 * by1;
-    val += m_grid[iX][iY][iZ] * bx0by0 * bz0;
-    val += m_grid[iX][iY][iZ + 1] * bx0by0 * bz1;
-    val += m_grid[iX][iY + 1][iZ] * bx0by1 * bz0;
-    val += m_grid[iX][iY + 1][iZ + 1] * bx0by1 * bz1;
-    val += m_grid[iX + 1][iY][iZ] * bx1by0 * bz0;
-    val += m_grid[iX + 1][iY][iZ + 1] * bx1by0 * bz1;
-    val += m_grid[iX + 1][iY + 1][iZ] * bx1by1 * bz0;
-    val += m_grid[iX + 1][iY + 1][iZ + 1] * bx1by1 * bz1;
+    RbtUInt x0 = m_xOffset[iX];
+    RbtUInt x1 = m_xOffset[iX + 1];
+    RbtUInt y0 = m_yOffset[iY];
+    RbtUInt y1 = m_yOffset[iY + 1];
+    RbtUInt z0 = m_zOffset[iZ];
+    RbtUInt z1 = m_zOffset[iZ + 1];
+    val += m_data[x0 + y0 + z0] * bx0by0 * bz0;
+    val += m_data[x0 + y0 + z1] * bx0by0 * bz1;
+    val += m_data[x0 + y1 + z0] * bx0by1 * bz0;
+    val += m_data[x0 + y1 + z1] * bx0by1 * bz1;
+    val += m_data[x1 + y0 + z0] * bx1by0 * bz0;
+    val += m_data[x1 + y0 + z1] * bx1by0 * bz1;
+    val += m_data[x1 + y1 + z0] * bx1by1 * bz0;
+    val += m_data[x1 + y1 + z1] * bx1by1 * bz1;
     // for (RbtUInt i = 0; i < 2; i++) {
     //   for (RbtUInt j = 0; j < 2; j++) {
     //     for (RbtUInt k = 0; k < 2; k++) {
-    //       val += m_grid[iX+i][iY+j][iZ+k]*bx[i]*by[j]*bz[k];
+    //       val += m_data[DataIndex(iX+i, iY+j, iZ+k)]*bx[i]*by[j]*bz[k];
     //     }
     //   }
     // }
@@ -207,7 +300,7 @@ RbtDouble RbtRealGrid::GetSmoothedValue(const RbtCoord& c) const {
 
 // Set all grid points to the given value
 void RbtRealGrid::SetAllValues(RbtDouble val) {
-    for (RbtUInt i = 0; i < GetN(); i++) {
+    for (RbtUInt i = 0; i < m_size; i++) {
         m_data[i] = val;
     }
 }
@@ -215,8 +308,8 @@ void RbtRealGrid::SetAllValues(RbtDouble val) {
 // Replaces all grid points between oldValMin and oldValMax with newVal
 void RbtRealGrid::ReplaceValueRange(RbtDouble oldValMin, RbtDouble oldValMax, RbtDouble newVal) {
     for (RbtUInt i = 0; i < GetN(); i++) {
-        float d = m_data[i];
-        if ((d >= oldValMin) && (d < oldValMax)) m_data[i] = newVal;
+        float& d = m_data[DataIndex(i)];
+        if ((d >= oldValMin) && (d < oldValMax)) d = newVal;
     }
 }
 
@@ -263,15 +356,15 @@ void RbtRealGrid::CreateSurface(RbtDouble oldVal, RbtDouble adjVal, RbtDouble ne
         for (RbtUInt iY = iMinY; iY <= iMaxY; iY++) {
             for (RbtUInt iZ = iMinZ; iZ <= iMaxZ; iZ++) {
                 // We have a match with oldVal
-                if (fabs(m_grid[iX][iY][iZ] - oldVal) < m_tol) {
+                if (fabs(m_data[DataIndex(iX, iY, iZ)] - oldVal) < m_tol) {
                     // Check the six adjacent points for a match with adjVal
-                    if (((iX > iMinX) && (fabs(m_grid[iX - 1][iY][iZ] - adjVal) < m_tol))
-                        || ((iX < iMaxX) && (fabs(m_grid[iX + 1][iY][iZ] - adjVal) < m_tol))
-                        || ((iY > iMinY) && (fabs(m_grid[iX][iY - 1][iZ] - adjVal) < m_tol))
-                        || ((iY < iMaxY) && (fabs(m_grid[iX][iY + 1][iZ] - adjVal) < m_tol))
-                        || ((iZ > iMinZ) && (fabs(m_grid[iX][iY][iZ - 1] - adjVal) < m_tol))
-                        || ((iZ < iMaxZ) && (fabs(m_grid[iX][iY][iZ + 1] - adjVal) < m_tol)))
-                        m_grid[iX][iY][iZ] = newVal;
+                    if (((iX > iMinX) && (fabs(m_data[DataIndex(iX - 1, iY, iZ)] - adjVal) < m_tol))
+                        || ((iX < iMaxX) && (fabs(m_data[DataIndex(iX + 1, iY, iZ)] - adjVal) < m_tol))
+                        || ((iY > iMinY) && (fabs(m_data[DataIndex(iX, iY - 1, iZ)] - adjVal) < m_tol))
+                        || ((iY < iMaxY) && (fabs(m_data[DataIndex(iX, iY + 1, iZ)] - adjVal) < m_tol))
+                        || ((iZ > iMinZ) && (fabs(m_data[DataIndex(iX, iY, iZ - 1)] - adjVal) < m_tol))
+                        || ((iZ < iMaxZ) && (fabs(m_data[DataIndex(iX, iY, iZ + 1)] - adjVal) < m_tol)))
+                        m_data[DataIndex(iX, iY, iZ)] = newVal;
                 }
             }
         }
@@ -300,6 +393,18 @@ void RbtRealGrid::SetAccessible(
     RbtUInt iMaxY = GetNY() - GetPad();
     RbtUInt iMaxZ = GetNZ() - GetPad();
 
+    // If the new value differs from adjVal, the adjVal grid points do not change as the grid points are processed,
+    // so the test for adjVal grid points within each sphere can be replaced by a single distance transform.
+    // Restricted to cubic grids, so that distances in grid steps can be converted to real distances.
+    const RbtVector& step = GetGridStep();
+    RbtBool bDistances = (step.x == step.y) && (step.x == step.z) && (fabs(newVal - adjVal) >= m_tol);
+    RbtDoubleList dist2;
+    if (bDistances) {
+        GetSquaredDistances(adjVal, dist2);
+    }
+    RbtDouble step2 = step.x * step.x;
+    RbtDouble rad2 = radius * radius;
+
     // Work out the maximum no. of grid points in the sphere and reserve enough space in the indices vector.
     // Actually, this is a considerable overestimate (no. of points in the enclosing cube)
     RbtUIntList sphereIndices;
@@ -310,13 +415,22 @@ void RbtRealGrid::SetAccessible(
         for (RbtUInt iY = iMinY; iY <= iMaxY; iY++) {
             for (RbtUInt iZ = iMinZ; iZ <= iMaxZ; iZ++) {
                 // We have a match with oldVal
-                if (fabs(m_grid[iX][iY][iZ] - oldVal) < m_tol) {
+                if (fabs(m_data[DataIndex(iX, iY, iZ)] - oldVal) < m_tol) {
                     RbtCoord c = GetCoord(iX, iY, iZ);
                     // Check the sphere around this grid point
-                    GetSphereIndices(c, radius, sphereIndices);
-                    if (!isValueWithinList(sphereIndices, adjVal)) {
+                    RbtBool bAccessible;
+                    if (bDistances) {
+                        bAccessible = (dist2[GetIXYZ(iX, iY, iZ)] * step2 > rad2);
+                        if (bAccessible && !bCenterOnly) {
+                            GetSphereIndices(c, radius, sphereIndices);
+                        }
+                    } else {
+                        GetSphereIndices(c, radius, sphereIndices);
+                        bAccessible = !isValueWithinList(sphereIndices, adjVal);
+                    }
+                    if (bAccessible) {
                         if (bCenterOnly)
-                            m_grid[iX][iY][iZ] = newVal;  // Set just the center grid point
+                            m_data[DataIndex(iX, iY, iZ)] = newVal;  // Set just the center grid point
                         else
                             // SetValues(sphereIndices,newVal,false);//Set all grid points in the sphere
                             SetValues(
@@ -339,7 +453,7 @@ void RbtRealGrid::SetAccessible(
 RbtUInt RbtRealGrid::CountRange(RbtDouble valMin, RbtDouble valMax) const {
     RbtUInt n(0);
     for (RbtUInt i = 0; i < GetN(); i++) {
-        float d = m_data[i];
+        float d = m_data[DataIndex(i)];
         if ((d >= valMin) && (d < valMax)) n++;
     }
     return n;
@@ -347,17 +461,19 @@ RbtUInt RbtRealGrid::CountRange(RbtDouble valMin, RbtDouble valMax) const {
 
 // Min/max values
 RbtDouble RbtRealGrid::MinValue() const {
-    float fMin = m_data[0];
+    float fMin = m_data[DataIndex(0)];
     for (RbtUInt i = 0; i < GetN(); i++) {
-        if (m_data[i] < fMin) fMin = m_data[i];
+        float d = m_data[DataIndex(i)];
+        if (d < fMin) fMin = d;
     }
     return fMin;
 }
 
 RbtDouble RbtRealGrid::MaxValue() const {
-    float fMax = m_data[0];
+    float fMax = m_data[DataIndex(0)];
     for (RbtUInt i = 0; i < GetN(); i++) {
-        if (m_data[i] > fMax) fMax = m_data[i];
+        float d = m_data[DataIndex(i)];
+        if (d > fMax) fMax = d;
     }
     return fMax;
 }
@@ -366,7 +482,7 @@ RbtDouble RbtRealGrid::MaxValue() const {
 RbtUInt RbtRealGrid::FindMinValue() const {
     RbtUInt iMin = 0;
     for (RbtUInt i = 0; i < GetN(); i++) {
-        if (m_data[i] < m_data[iMin]) iMin = i;
+        if (m_data[DataIndex(i)] < m_data[DataIndex(iMin)]) iMin = i;
     }
     return iMin;
 }
@@ -375,11 +491,58 @@ RbtUInt RbtRealGrid::FindMinValue() const {
 RbtUInt RbtRealGrid::FindMaxValue() const {
     RbtUInt iMax = 0;
     for (RbtUInt i = 0; i < GetN(); i++) {
-        if (m_data[i] > m_data[iMax]) iMax = i;
+        if (m_data[DataIndex(i)] > m_data[DataIndex(iMax)]) iMax = i;
     }
     return iMax;
 }
 
+RbtRealGrid* RbtRealGrid::CreateCoarseGrid(RbtUInt factor) const {
+    // The coarse grid points must coincide with grid points of this grid, i.e. their integral coords
+    // (in multiples of the grid step from the origin) must be divisible by factor.
+    // Find the offset (i0) of the first such grid point along each axis
+    RbtInt f = std::max(RbtUInt(1), factor);
+    RbtInt i0X = ((-GetnXMin()) % f + f) % f;
+    RbtInt i0Y = ((-GetnYMin()) % f + f) % f;
+    RbtInt i0Z = ((-GetnZMin()) % f + f) % f;
+    if ((GetNX() <= RbtUInt(i0X)) || (GetNY() <= RbtUInt(i0Y)) || (GetNZ() <= RbtUInt(i0Z))) {
+        throw RbtBadArgument(_WHERE_, "Grid is too small to coarsen");
+    }
+    RbtUInt NX = (GetNX() - 1 - i0X) / f + 1;
+    RbtUInt NY = (GetNY() - 1 - i0Y) / f + 1;
+    RbtUInt NZ = (GetNZ() - 1 - i0Z) / f + 1;
+    const RbtVector& step = GetGridStep();
+    RbtCoord coarseMin((GetnXMin() + i0X) * step.x, (GetnYMin() + i0Y) * step.y, (GetnZMin() + i0Z) * step.z);
+    RbtRealGrid* pGrid = new RbtRealGrid(coarseMin, step * f, NX, NY, NZ, (GetPad() + f - 1) / f);
+    pGrid->SetTolerance(GetTolerance());
+    for (RbtUInt iX = 1; iX <= NX; iX++) {
+        // Range of grid points (jMin to jMax) within f - 1 grid steps of the coarse grid point along each axis
+        RbtInt jX = i0X + (iX - 1) * f + 1;
+        RbtInt jXMin = std::max(1, jX - f + 1);
+        RbtInt jXMax = std::min(RbtInt(GetNX()), jX + f - 1);
+        for (RbtUInt iY = 1; iY <= NY; iY++) {
+            RbtInt jY = i0Y + (iY - 1) * f + 1;
+            RbtInt jYMin = std::max(1, jY - f + 1);
+            RbtInt jYMax = std::min(RbtInt(GetNY()), jY + f - 1);
+            for (RbtUInt iZ = 1; iZ <= NZ; iZ++) {
+                RbtInt jZ = i0Z + (iZ - 1) * f + 1;
+                RbtInt jZMin = std::max(1, jZ - f + 1);
+                RbtInt jZMax = std::min(RbtInt(GetNZ()), jZ + f - 1);
+                float value = m_data[DataIndex(jX, jY, jZ)];
+                for (RbtInt kX = jXMin; kX <= jXMax; kX++) {
+                    for (RbtInt kY = jYMin; kY <= jYMax; kY++) {
+                        for (RbtInt kZ = jZMin; kZ <= jZMax; kZ++) {
+                            value = std::min(value, m_data[DataIndex(kX, kY, kZ)]);
+                        }
+                    }
+                }
+                pGrid->m_data[pGrid->DataIndex(iX, iY, iZ)] = value;
+            }
+        }
+    }
+    pGrid->SetLayout(m_layout);
+    return pGrid;
+}
+
 /////////////////////////
 // Output functions
 /////////////////////////
@@ -404,7 +567,7 @@ void RbtRealGrid::PrintInsightGrid(ostream& s) const {
     for (RbtUInt iZ = 1; iZ <= GetNZ(); iZ++) {
         for (RbtUInt iY = 1; iY <= GetNY(); iY++) {
             for (RbtUInt iX = 1; iX <= GetNX(); iX++) {
-                s << setw(15) << m_grid[iX][iY][iZ] << endl;
+                s << setw(15) << m_data[DataIndex(iX, iY, iZ)] << endl;
             }
         }
     }
@@ -422,7 +585,7 @@ void RbtRealGrid::OwnPrint(ostream& ostr) const {
         ostr << endl << endl << "Plane iX=" << iX << endl;
         for (RbtUInt iY = 1; iY <= GetNY(); iY++) {
             for (RbtUInt iZ = 1; iZ <= GetNZ(); iZ++) {
-                float f = m_grid[iX][iY][iZ];
+                float f = m_data[DataIndex(iX, iY, iZ)];
                 ostr << ((f < -tol) ? '-' : (f > tol) ? '+' : '.');
             }
             ostr << endl;
@@ -443,7 +606,7 @@ void RbtRealGrid::OwnWrite(ostream& ostr) const {
     // Write all the data members
     Rbt::WriteWithThrow(ostr, (const char*)&m_tol, sizeof(m_tol));
     for (RbtUInt i = 0; i < GetN(); i++) {
-        Rbt::WriteWithThrow(ostr, (const char*)&m_data[i], sizeof(m_data[i]));
+        Rbt::WriteWithThrow(ostr, (const char*)&m_data[DataIndex(i)], sizeof(float));
     }
 }
 
@@ -468,7 +631,7 @@ void RbtRealGrid::OwnRead(istream& istr) {
     // Read all the data members
     Rbt::ReadWithThrow(istr, (char*)&m_tol, sizeof(m_tol));
     for (RbtUInt i = 0; i < GetN(); i++) {
-        Rbt::ReadWithThrow(istr, (char*)&m_data[i], sizeof(m_data[i]));
+        Rbt::ReadWithThrow(istr, (char*)&m_data[DataIndex(i)], sizeof(float));
     }
 }
 
@@ -479,7 +642,7 @@ void RbtRealGrid::OwnRead(istream& istr) {
 // of IXYZ indices. Private method as there is no error checking on iXYZ values out of bounds
 RbtBool RbtRealGrid::isValueWithinList(const RbtUIntList& iXYZList, RbtDouble val) {
     for (RbtUIntListConstIter iter = iXYZList.begin(); iter != iXYZList.end(); iter++) {
-        if (fabs(m_data[*iter] - val) < m_tol) {
+        if (fabs(m_data[DataIndex(*iter)] - val) < m_tol) {
             return true;
         }
     }
@@ -492,42 +655,120 @@ RbtBool RbtRealGrid::isValueWithinList(const RbtUIntList& iXYZList, RbtDouble va
 // If bOverwrite is true, all grid points are set the new value
 void RbtRealGrid::SetValues(const RbtUIntList& iXYZList, RbtDouble val, RbtBool bOverwrite) {
     for (RbtUIntListConstIter iter = iXYZList.begin(); iter != iXYZList.end(); iter++) {
-        if (bOverwrite || (fabs(m_data[*iter]) < m_tol)) {
-            m_data[*iter] = val;
+        float& d = m_data[DataIndex(*iter)];
+        if (bOverwrite || (fabs(d) < m_tol)) {
+            d = val;
+        }
+    }
+}
+
+void RbtRealGrid::GetSquaredDistances(RbtDouble val, RbtDoubleList& dist2) const {
+    RbtUInt nX = GetNX();
+    RbtUInt nY = GetNY();
+    RbtUInt nZ = GetNZ();
+    dist2.assign(GetN(), FAR_DIST2);
+    for (RbtUInt iX = 1; iX <= nX; iX++) {
+        for (RbtUInt iY = 1; iY <= nY; iY++) {
+            for (RbtUInt iZ = 1; iZ <= nZ; iZ++) {
+                if (isValid(iX, iY, iZ) && (fabs(m_data[DataIndex(iX, iY, iZ)] - val) < m_tol)) {
+                    dist2[GetIXYZ(iX, iY, iZ)] = 0.0;
+                }
+            }
+        }
+    }
+    TransformSquaredDistances(dist2);
+}
+
+void RbtRealGrid::GetSquaredDistances(const RbtUIntList& iXYZList, RbtDoubleList& dist2) const {
+    dist2.assign(GetN(), FAR_DIST2);
+    for (RbtUIntListConstIter iter = iXYZList.begin(); iter != iXYZList.end(); iter++) {
+        if (isValid(*iter)) {
+            dist2[*iter] = 0.0;
+        }
+    }
+    TransformSquaredDistances(dist2);
+}
+
+void RbtRealGrid::TransformSquaredDistances(RbtDoubleList& dist2) const {
+    RbtUInt nX = GetNX();
+    RbtUInt nY = GetNY();
+    RbtUInt nZ = GetNZ();
+    // The transform is separable, so can be applied along each axis in turn
+    RbtUInt nMax = std::max(nX, std::max(nY, nZ));
+    RbtDoubleList f(nMax);
+    RbtUIntList v(nMax);
+    RbtDoubleList z(nMax + 1);
+    for (RbtUInt iX = 1; iX <= nX; iX++) {
+        for (RbtUInt iY = 1; iY <= nY; iY++) {
+            DistanceTransform1D(&dist2[GetIXYZ(iX, iY, 1)], 1, nZ, f, v, z);
+        }
+    }
+    for (RbtUInt iX = 1; iX <= nX; iX++) {
+        for (RbtUInt iZ = 1; iZ <= nZ; iZ++) {
+            DistanceTransform1D(&dist2[GetIXYZ(iX, 1, iZ)], nZ, nY, f, v, z);
+        }
+    }
+    for (RbtUInt iY = 1; iY <= nY; iY++) {
+        for (RbtUInt iZ = 1; iZ <= nZ; iZ++) {
+            DistanceTransform1D(&dist2[GetIXYZ(1, iY, iZ)], nY * nZ, nX, f, v, z);
         }
     }
 }
 
 void RbtRealGrid::CreateArrays() {
-    if (m_grid != NULL) {  // Clear existing grid
+    if (m_store != NULL) {  // Clear existing grid
         ClearArrays();
     }
-    int nX = GetNX();
-    int nY = GetNY();
-    int nZ = GetNZ();
-    m_grid = new float**[nX + 1];
-    m_grid[1] = new float*[nX * nY + 1];
-    m_grid[1][1] = new float[nX * nY * nZ + 1];
-
-    for (int iY = 2; iY <= nY; iY++) {
-        m_grid[1][iY] = m_grid[1][iY - 1] + nZ;
-    }
-    for (int iX = 2; iX <= nX; iX++) {
-        m_grid[iX] = m_grid[iX - 1] + nY;
-        m_grid[iX][1] = m_grid[iX - 1][1] + nY * nZ;
-        for (int iY = 2; iY <= nY; iY++) {
-            m_grid[iX][iY] = m_grid[iX][iY - 1] + nZ;
+    RbtUInt nX = GetNX();
+    RbtUInt nY = GetNY();
+    RbtUInt nZ = GetNZ();
+    m_xOffset = RbtUIntList(nX + 2, 0);
+    m_yOffset = RbtUIntList(nY + 2, 0);
+    m_zOffset = RbtUIntList(nZ + 2, 0);
+    // The offset of a grid point is the sum of the offsets for each of its indices, for both layouts.
+    // The extra element at the end of each list is only there so that GetSmoothedValue can read the offset
+    // of the next grid point without a bounds check
+    if (m_layout == BRICKED) {
+        // Bricks are stored in x-major order, as are the grid points within each brick
+        RbtUInt nBY = (nY + BRICK_MASK) >> BRICK_BITS;
+        RbtUInt nBZ = (nZ + BRICK_MASK) >> BRICK_BITS;
+        RbtUInt nBX = (nX + BRICK_MASK) >> BRICK_BITS;
+        RbtUInt planeLength = BRICK_SIZE * BRICK_SIZE;
+        RbtUInt brickLength = BRICK_SIZE * planeLength;
+        for (RbtUInt i = 0; i <= nX; i++) {
+            m_xOffset[i + 1] = (i >> BRICK_BITS) * nBY * nBZ * brickLength + (i & BRICK_MASK) * planeLength;
         }
+        for (RbtUInt i = 0; i <= nY; i++) {
+            m_yOffset[i + 1] = (i >> BRICK_BITS) * nBZ * brickLength + (i & BRICK_MASK) * BRICK_SIZE;
+        }
+        for (RbtUInt i = 0; i <= nZ; i++) {
+            m_zOffset[i + 1] = (i >> BRICK_BITS) * brickLength + (i & BRICK_MASK);
+        }
+        m_size = nBX * nBY * nBZ * brickLength;
+    } else {
+        for (RbtUInt i = 0; i <= nX; i++) {
+            m_xOffset[i + 1] = i * nY * nZ;
+        }
+        for (RbtUInt i = 0; i <= nY; i++) {
+            m_yOffset[i + 1] = i * nZ;
+        }
+        for (RbtUInt i = 0; i <= nZ; i++) {
+            m_zOffset[i + 1] = i;
+        }
+        m_size = GetN();
     }
-    m_data = &m_grid[1][1][1];
+    // Align the data to a cache line boundary, so that bricks do not straddle cache lines
+    m_store = new float[m_size + CACHE_LINE_BYTES / sizeof(float)];
+    std::uintptr_t address = reinterpret_cast<std::uintptr_t>(m_store);
+    m_data = reinterpret_cast<float*>((address + CACHE_LINE_BYTES - 1) & ~(CACHE_LINE_BYTES - 1));
+    std::fill(m_data, m_data + m_size, 0.0f);
 }
 
 void RbtRealGrid::ClearArrays() {
-    delete m_grid[1][1];
-    delete m_grid[1];
-    delete m_grid;
-    m_grid = NULL;
+    delete[] m_store;
+    m_store = NULL;
     m_data = NULL;
+    m_size = 0;
 }
 
 // Helper function called by copy constructor and assignment operator
@@ -535,8 +776,6 @@ void RbtRealGrid::ClearArrays() {
 // Gets called after array has been created, and base class copy has been done
 void RbtRealGrid::CopyGrid(const RbtRealGrid& grid) {
     m_tol = grid.m_tol;
-    float* gridData = grid.GetGridData();
-    for (RbtUInt i = 0; i < GetN(); i++) {
-        m_data[i] = gridData[i];
-    }
+    // Both grids have the same dimensions and layout
+    std::copy(grid.m_data, grid.m_data + m_size, m_data);
 }
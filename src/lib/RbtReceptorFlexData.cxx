@@ -14,8 +14,10 @@
 
 const RbtString& RbtReceptorFlexData::_FLEX_DISTANCE = "FLEX_DISTANCE";
 const RbtString& RbtReceptorFlexData::_DIHEDRAL_STEP = "DIHEDRAL_STEP";
+const RbtString& RbtReceptorFlexData::_ROTAMER_STEP = "ROTAMER_STEP";
 
 RbtReceptorFlexData::RbtReceptorFlexData(RbtDockingSite* pDockSite): RbtFlexData(pDockSite) {
     AddParameter(_FLEX_DISTANCE, 3.0);
     AddParameter(_DIHEDRAL_STEP, 30.0);
+    AddParameter(_ROTAMER_STEP, 0.0);
 }
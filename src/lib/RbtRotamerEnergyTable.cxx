@@ -0,0 +1,117 @@
+/***********************************************************************
+ * The rDock program was developed from 1998 - 2006 by the software team
+ * at RiboTargets (subsequently Vernalis (R&D) Ltd).
+ * In 2006, the software was licensed to the University of York for
+ * maintenance and distribution.
+ * In 2012, Vernalis and the University of York agreed to release the
+ * program as Open Source software.
+ * This version is licensed under GNU-LGPL version 3.0 with support from
+ * the University of Barcelona.
+ * http://rdock.sourceforge.net/
+ ***********************************************************************/
+
+#include "RbtRotamerEnergyTable.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Static data members
+RbtString RbtRotamerEnergyTable::_CT("RbtRotamerEnergyTable");
+
+// Max deviation (deg) of a dihedral from the nearest rotamer for the table to be used
+const RbtDouble MAX_ROTAMER_ERROR = 1.0;
+
+RbtRotamerEnergyTable::RbtRotamerEnergyTable(RbtModel* pModel, RbtDouble rotamerStep): m_pModel(pModel) {
+    _RBTOBJECTCOUNTER_CONSTR_(_CT);
+    m_atomGroups = RbtIntList(m_pModel->GetNumAtoms(), -1);
+    RbtBondList flexBonds = m_pModel->GetFlexBonds();
+    RbtAtomList noTetheredAtoms;
+    for (RbtBondListConstIter iter = flexBonds.begin(); iter != flexBonds.end(); ++iter) {
+        RbtChromDihedralRefDataPtr spGroup(
+            new RbtChromDihedralRefData(*iter, noTetheredAtoms, 0.0, RbtChromElement::FIXED, 0.0, rotamerStep)
+        );
+        RbtInt iGroup = m_groups.size();
+        m_groups.push_back(spGroup);
+        m_selfEnergies.push_back(RbtDoubleList(spGroup->GetNumRotamers(), 0.0));
+        const RbtAtomRList& rotAtoms = spGroup->GetRotAtoms();
+        for (RbtAtomRListConstIter aIter = rotAtoms.begin(); aIter != rotAtoms.end(); ++aIter) {
+            m_atomGroups[(*aIter)->GetAtomId() - 1] = iGroup;
+            m_initialCoords.push_back((*aIter)->GetCoords());
+        }
+    }
+    m_currentRotamers = RbtIntList(m_groups.size(), 0);
+}
+
+RbtRotamerEnergyTable::~RbtRotamerEnergyTable() { _RBTOBJECTCOUNTER_DESTR_(_CT); }
+
+RbtInt RbtRotamerEnergyTable::GetGroup(RbtAtom* pAtom) const {
+    if (pAtom->GetModelPtr() != m_pModel) {
+        return -1;
+    }
+    return m_atomGroups[pAtom->GetAtomId() - 1];
+}
+
+void RbtRotamerEnergyTable::PlaceRotamer(RbtUInt iGroup, RbtInt iRot) {
+    m_groups[iGroup]->SetModelValue(m_groups[iGroup]->GetRotamerValue(iRot));
+}
+
+void RbtRotamerEnergyTable::SetSelfEnergy(RbtUInt iGroup, RbtInt iRot, RbtDouble val) {
+    m_selfEnergies[iGroup][iRot] = val;
+}
+
+RbtUInt RbtRotamerEnergyTable::GetPairIndex(RbtUInt iGroup, RbtUInt jGroup) {
+    std::pair<RbtUInt, RbtUInt> key(std::min(iGroup, jGroup), std::max(iGroup, jGroup));
+    std::map<std::pair<RbtUInt, RbtUInt>, RbtUInt>::const_iterator iter = m_pairIndex.find(key);
+    if (iter != m_pairIndex.end()) {
+        return iter->second;
+    }
+    RbtRotamerPair pair;
+    pair.iGroup = key.first;
+    pair.jGroup = key.second;
+    pair.energies = RbtDoubleList(GetNumRotamers(key.first) * GetNumRotamers(key.second), 0.0);
+    m_pairs.push_back(pair);
+    m_pairIndex[key] = m_pairs.size() - 1;
+    return m_pairs.size() - 1;
+}
+
+void RbtRotamerEnergyTable::GetPair(RbtUInt iPair, RbtUInt& iGroup, RbtUInt& jGroup) const {
+    iGroup = m_pairs[iPair].iGroup;
+    jGroup = m_pairs[iPair].jGroup;
+}
+
+void RbtRotamerEnergyTable::SetPairEnergy(RbtUInt iPair, RbtInt iRot, RbtInt jRot, RbtDouble val) {
+    RbtRotamerPair& pair = m_pairs[iPair];
+    pair.energies[iRot * GetNumRotamers(pair.jGroup) + jRot] = val;
+}
+
+void RbtRotamerEnergyTable::RestoreModel() {
+    RbtCoordListConstIter cIter = m_initialCoords.begin();
+    for (vector<RbtChromDihedralRefDataPtr>::const_iterator iter = m_groups.begin(); iter != m_groups.end();
+         ++iter) {
+        const RbtAtomRList& rotAtoms = (*iter)->GetRotAtoms();
+        for (RbtAtomRListConstIter aIter = rotAtoms.begin(); aIter != rotAtoms.end(); ++aIter, ++cIter) {
+            (*aIter)->SetCoords(*cIter);
+        }
+    }
+}
+
+RbtBool RbtRotamerEnergyTable::GetEnergy(RbtDouble& energy) const {
+    RbtDouble e = 0.0;
+    for (RbtUInt i = 0; i < m_groups.size(); i++) {
+        const RbtChromDihedralRefDataPtr& spGroup = m_groups[i];
+        RbtDouble dihedralAngle = spGroup->GetModelValue();
+        RbtInt iRot = spGroup->GetNearestRotamer(dihedralAngle);
+        RbtDouble delta = fabs(fmod(dihedralAngle - spGroup->GetRotamerValue(iRot) + 540.0, 360.0) - 180.0);
+        if (delta > MAX_ROTAMER_ERROR) {
+            return false;
+        }
+        m_currentRotamers[i] = iRot;
+        e += m_selfEnergies[i][iRot];
+    }
+    for (vector<RbtRotamerPair>::const_iterator iter = m_pairs.begin(); iter != m_pairs.end(); ++iter) {
+        e += iter->energies[m_currentRotamers[iter->iGroup] * GetNumRotamers(iter->jGroup)
+                            + m_currentRotamers[iter->jGroup]];
+    }
+    energy = e;
+    return true;
+}
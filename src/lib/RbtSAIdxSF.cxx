@@ -257,22 +257,23 @@ void RbtSAIdxSF::SetupSolvent() {
     RbtInt iTrace = GetTrace();
     // Process the solvent models individually in order to build up each intra-solvent interaction map
     // correctly.
+    // The variable distances between different solvent models are no longer stored here.
+    // Instead they are retrieved from the solvent cell index in RawScore, so that the cost
+    // scales with the number of near neighbours rather than the square of the number of solvent atoms
+    RbtDouble maxR = 0.0;
     for (RbtModelListConstIter iter = solventModelList.begin(); iter != solventModelList.end(); ++iter) {
         HHS_SolvationRList intnList = CreateInteractionCenters((*iter)->GetAtomList());
         BuildIntraMap(intnList);
         // Store the per-atom invariant free areas for later retrieval
         std::for_each(intnList.begin(), intnList.end(), Rbt::SaveHHS());
-        // Variable distances to previous solvent models already processed
-        // These are strictly intermolecular distances, but as we consider the total set of solvent models
-        // as a single entity for the purposes of partitioning the total score, it makes to store them here.
-        for (HHS_SolvationRListConstIter iIter = theSolventList.begin(); iIter != theSolventList.end(); ++iIter) {
-            for (HHS_SolvationRListConstIter jIter = intnList.begin(); jIter != intnList.end(); ++jIter) {
-                (*iIter)->AddVariable(*jIter);
-            }
+        for (HHS_SolvationRListConstIter jIter = intnList.begin(); jIter != intnList.end(); ++jIter) {
+            maxR = std::max(maxR, (*jIter)->GetR_i());
         }
         // Concatenate all the interaction centers from each solvent model into a single list
         std::copy(intnList.begin(), intnList.end(), std::back_inserter(theSolventList));
     }
+    // As for the indexing grid, an interaction center is in range if it lies within (R_i + INCR)
+    m_solventIndex.SetCellSize(maxR + GetParameter(_INCR).Double());
     // Calculate the initial solvation score for the entire set of solvent models
     // DM 9 June 2006 - don't include the intra-solvent interactions in the zero-point calculation
     // as we don't know whether the individual solvent models will be enabled or not.
@@ -306,9 +307,26 @@ RbtDouble RbtSAIdxSF::RawScore(void) const {
     }
 
     // INTRA-SOLVENT interactions (take account of solvent enabled state)
+    // Intra-model variable interactions
     for (HHS_SolvationRListConstIter iter = theSolventList.begin(); iter != theSolventList.end(); ++iter) {
         (*iter)->OverlapVariableEnabledOnly();
     }
+    // Inter-model interactions from the solvent cell index (only enabled centers are indexed)
+    // Each pair is updated once, from the center which occurs first in theSolventList
+    IndexSolvent();
+    for (RbtUInt i = 0; i < theSolventList.size(); i++) {
+        RbtAtom* pSolventAtom = theSolventList[i]->GetAtom();
+        if (!pSolventAtom->GetEnabled()) continue;
+        RbtModel* pModel = pSolventAtom->GetModelPtr();
+        m_nbrIds.clear();
+        m_solventIndex.GetNeighbours(pSolventAtom->GetCoords(), m_nbrIds);
+        for (RbtIntListConstIter nIter = m_nbrIds.begin(); nIter != m_nbrIds.end(); ++nIter) {
+            HHS_Solvation* pNbr = theSolventList[*nIter];
+            if ((RbtUInt(*nIter) > i) && (pNbr->GetAtom()->GetModelPtr() != pModel)) {
+                theSolventList[i]->Overlap(pNbr, HHS_Solvation::Pij_14);
+            }
+        }
+    }
 
     // INTRA-SITE interactions (if receptor is flexible)
     if (m_bFlexRec) {
@@ -358,13 +376,14 @@ RbtDouble RbtSAIdxSF::RawScore(void) const {
             (*iIter)->Overlap(*jIter, HHS_Solvation::Pij_14);
     }
 
-    // LIGAND-SOLVENT (VERY SLOW) (take account of solvent enabled state)
-    // TODO: index the solvent intn centers on a grid, providing solvent position is tethered
-    for (HHS_SolvationRListConstIter iIter = theLSPList.begin(); iIter != theLSPList.end(); iIter++) {
-        for (HHS_SolvationRListConstIter jIter = theSolventList.begin(); jIter != theSolventList.end(); ++jIter) {
-            RbtAtom* pSolventAtom = (*jIter)->GetAtom();
-            if (pSolventAtom->GetEnabled()) {
-                (*iIter)->Overlap(*jIter, HHS_Solvation::Pij_14);
+    // LIGAND-SOLVENT (take account of solvent enabled state)
+    // Retrieve the enabled solvent near-neighbours from the solvent cell index
+    if (!theSolventList.empty()) {
+        for (HHS_SolvationRListConstIter iIter = theLSPList.begin(); iIter != theLSPList.end(); iIter++) {
+            m_nbrIds.clear();
+            m_solventIndex.GetNeighbours((*iIter)->GetAtom()->GetCoords(), m_nbrIds);
+            for (RbtIntListConstIter nIter = m_nbrIds.begin(); nIter != m_nbrIds.end(); ++nIter) {
+                (*iIter)->Overlap(theSolventList[*nIter], HHS_Solvation::Pij_14);
             }
         }
     }
@@ -605,6 +624,17 @@ void RbtSAIdxSF::HandleRequest(RbtRequestPtr spRequest) {
             break;
     }
 }
+void RbtSAIdxSF::IndexSolvent() const {
+    m_solventIndex.Clear();
+    for (RbtUInt i = 0; i < theSolventList.size(); i++) {
+        RbtAtom* pSolventAtom = theSolventList[i]->GetAtom();
+        if (pSolventAtom->GetEnabled()) {
+            m_solventIndex.Add(pSolventAtom->GetCoords(), i);
+        }
+    }
+    m_solventIndex.Build();
+}
+
 void RbtSAIdxSF::Partition(HHS_SolvationRList& intnCenters, RbtDouble dist) {
     // Rbt::PartitionHHS partition(dist);
     // std::for_each(intnCenters.begin(),intnCenters.end(),partition);
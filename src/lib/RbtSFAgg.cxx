@@ -198,3 +198,56 @@ RbtDouble RbtSFAgg::RawScore() const {
     }
     return score;
 }
+
+RbtDouble RbtSFAgg::BoundedRawScore(RbtDouble maxRawScore) const {
+    // The unbounded terms are evaluated first, so that evaluation can be abandoned before any of the
+    // bounded terms, wherever they are in the list
+    RbtInt nSF = m_sf.size();
+    m_termScores.resize(nSF);
+    m_boundedTerms.clear();
+    m_remainingBounds.clear();
+    RbtDouble score(0.0);
+    for (RbtInt i = 0; i < nSF; i++) {
+        RbtDouble lowerBound;
+        if (m_sf[i]->ScoreLowerBound(lowerBound)) {
+            m_boundedTerms.push_back(i);
+            m_remainingBounds.push_back(lowerBound);
+        } else {
+            m_termScores[i] = m_sf[i]->Score();
+            score += m_termScores[i];
+        }
+    }
+    // m_remainingBounds[j] is the lower bound on the summed scores of bounded terms j..n-1
+    RbtInt nBounded = m_boundedTerms.size();
+    m_remainingBounds.push_back(0.0);
+    for (RbtInt j = nBounded - 1; j >= 0; j--) {
+        m_remainingBounds[j] += m_remainingBounds[j + 1];
+    }
+    for (RbtInt j = 0; j < nBounded; j++) {
+        if (score + m_remainingBounds[j] > maxRawScore) {
+            return score + m_remainingBounds[j];
+        }
+        RbtInt i = m_boundedTerms[j];
+        m_termScores[i] = m_sf[i]->BoundedScore(maxRawScore - score - m_remainingBounds[j + 1]);
+        score += m_termScores[i];
+    }
+    // Sum the term scores in the same order as RawScore, so that the result is identical
+    // if evaluation is not abandoned
+    score = 0.0;
+    for (RbtInt i = 0; i < nSF; i++) {
+        score += m_termScores[i];
+    }
+    return score;
+}
+
+RbtBool RbtSFAgg::RawScoreLowerBound(RbtDouble& lowerBound) const {
+    lowerBound = 0.0;
+    for (RbtBaseSFListConstIter iter = m_sf.begin(); iter != m_sf.end(); iter++) {
+        RbtDouble childBound;
+        if (!(*iter)->ScoreLowerBound(childBound)) {
+            return false;
+        }
+        lowerBound += childBound;
+    }
+    return true;
+}
@@ -14,6 +14,7 @@
 // Precalculated-grid scoring functions
 #include "RbtCavityFillSF.h"
 #include "RbtCavityGridSF.h"
+#include "RbtPolarGridSF.h"
 #include "RbtVdwGridSF.h"
 
 // Indexed-grid scoring functions
@@ -68,6 +69,7 @@ RbtBaseSF* RbtSFFactory::Create(const RbtString& strSFClass, const RbtString& st
     if (strSFClass == RbtVdwGridSF::_CT) return new RbtVdwGridSF(strName);
     if (strSFClass == RbtCavityGridSF::_CT) return new RbtCavityGridSF(strName);
     if (strSFClass == RbtCavityFillSF::_CT) return new RbtCavityFillSF(strName);
+    if (strSFClass == RbtPolarGridSF::_CT) return new RbtPolarGridSF(strName);
 
     // Indexed-grid scoring functions
     if (strSFClass == RbtAromIdxSF::_CT) return new RbtAromIdxSF(strName);
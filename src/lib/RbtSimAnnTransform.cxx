@@ -65,6 +65,18 @@ RbtString RbtSimAnnTransform::_MIN_ACC_RATE("MIN_ACC_RATE");
 RbtString RbtSimAnnTransform::_PARTITION_DIST("PARTITION_DIST");
 RbtString RbtSimAnnTransform::_PARTITION_FREQ("PARTITION_FREQ");
 RbtString RbtSimAnnTransform::_HISTORY_FREQ("HISTORY_FREQ");
+RbtString RbtSimAnnTransform::_ADAPTIVE_MOVES("ADAPTIVE_MOVES");
+RbtString RbtSimAnnTransform::_TARGET_ACC_RATE("TARGET_ACC_RATE");
+RbtString RbtSimAnnTransform::_EARLY_STOPPING("EARLY_STOPPING");
+
+// Adaptive move parameters
+// Decay factor for the running average acceptance rate of each move
+const RbtDouble MOVE_WEIGHT_DECAY = 0.9;
+// Minimum selection weight, so that no move is starved completely
+const RbtDouble MIN_MOVE_WEIGHT = 0.05;
+// Limits on the adapted relative step sizes, relative to STEP_SIZE
+const RbtDouble MIN_MOVE_STEP = 0.001;
+const RbtDouble MAX_MOVE_STEP = 2.0;
 
 const RbtSimAnnTransform::Config
     RbtSimAnnTransform::DEFAULT_CONFIG{};  // Empty initializer to fall back to default values
@@ -100,12 +112,24 @@ void RbtSimAnnTransform::SetupTransform() {
     m_chrom.SetNull();
     m_lastGoodVector.clear();
     m_minVector.clear();
+    m_moves.clear();
     RbtWorkSpace* pWorkSpace = GetWorkSpace();
     if (pWorkSpace) {
         m_chrom = new RbtChrom(pWorkSpace->GetModels());
         RbtInt chromLength = m_chrom->GetLength();
         m_lastGoodVector.reserve(chromLength);
         m_minVector.reserve(chromLength);
+        // Compile the list of single-gene moves
+        RbtChromElementList leafList;
+        m_chrom->GetLeafElements(leafList);
+        for (RbtChromElementListIter iter = leafList.begin(); iter != leafList.end(); ++iter) {
+            for (RbtInt iMoveType = 0; iMoveType < (*iter)->GetNumMoveTypes(); iMoveType++) {
+                RbtMCMove move;
+                move.pElement = *iter;
+                move.iMoveType = iMoveType;
+                m_moves.push_back(move);
+            }
+        }
     }
 }
 
@@ -161,6 +185,13 @@ void RbtSimAnnTransform::Execute() {
 
     RbtDouble initial_temp = config.initial_temp;
     RbtDouble step_size = config.step_size;
+    RbtBool bAdaptive = config.adaptive_moves && !m_moves.empty();
+    for (RbtMCMoveList::iterator iter = m_moves.begin(); iter != m_moves.end(); ++iter) {
+        iter->stepSize = step_size;
+        iter->weight = 1.0;
+        iter->nTrials = 0;
+        iter->nAccepted = 0;
+    }
 
     // DM 15 Feb 1999 - don't initialise the Monte Carlo stats each block
     // if we are doing a constant temperature run
@@ -180,9 +211,12 @@ void RbtSimAnnTransform::Execute() {
                  << setw(10) << m_spStats->_blockMax << endl;
         }
 
+        if (bAdaptive) {
+            AdaptMoves();
+        }
         // Halve the maximum step sizes for all enabled modes
         // if the acceptance rate is less than the threshold
-        if (m_spStats->AccRate() < config.min_accuracy_rate) {
+        else if (m_spStats->AccRate() < config.min_accuracy_rate) {
             step_size *= 0.5;
             // Reinitialise the stats (only need to do it here if bInitBlock is false
             // otherwise it will be done at the beginning of the next block)
@@ -210,12 +244,31 @@ void RbtSimAnnTransform::MC(RbtDouble t, RbtInt blockLen, RbtDouble stepSize) {
     m_lastGoodVector.clear();
     m_chrom->GetVector(m_lastGoodVector);
     // Main loop over number of MC steps
+    RbtBool bAdaptive = config.adaptive_moves && !m_moves.empty();
     for (RbtInt iStep = 1; iStep <= blockLen; iStep++) {
-        m_chrom->Mutate(stepSize);
+        RbtMCMove* pMove = NULL;
+        if (bAdaptive) {
+            pMove = &SelectMove();
+            pMove->pElement->MutateMoveType(pMove->iMoveType, pMove->stepSize);
+        } else {
+            m_chrom->Mutate(stepSize);
+        }
         m_chrom->SyncToModel();
-        RbtDouble newScore = pSF->Score();
+        // The Metropolis test exp(-1000.0 * delta / (8.314 * t)) > rand is equivalent to delta < maxDelta,
+        // so look at the random number first and let the scoring function abandon the evaluation
+        // as soon as it is certain that the score change exceeds maxDelta (the bounded score is then
+        // a lower bound, which fails the test). The test is made on delta < maxDelta in both cases, so that
+        // early stopping can not change the acceptance. As before, the random number is only drawn for uphill
+        // moves, and rand == 0 accepts any move.
+        RbtDouble rand = m_rand.PeekRandom01();
+        RbtDouble maxDelta = (rand > 0.0) ? -8.314 * t * log(rand) / 1000.0 : 0.0;
+        RbtDouble newScore =
+            (config.early_stopping && (rand > 0.0)) ? pSF->BoundedScore(score + maxDelta) : pSF->Score();
         RbtDouble delta = newScore - score;
-        RbtBool bMetrop = ((delta < 0.0) || (exp(-1000.0 * delta / (8.314 * t)) > m_rand.GetRandom01()));
+        if (delta >= 0.0) {
+            m_rand.GetRandom01();
+        }
+        RbtBool bMetrop = (delta < maxDelta) || (rand == 0.0);
         // PASSED
         if (bMetrop) {
             score = newScore;
@@ -236,6 +289,11 @@ void RbtSimAnnTransform::MC(RbtDouble t, RbtInt blockLen, RbtDouble stepSize) {
         }
         // Gather the statistics
         m_spStats->Accumulate(score, bMetrop);
+        if (pMove) {
+            pMove->nTrials++;
+            if (bMetrop) pMove->nAccepted++;
+            pMove->weight = MOVE_WEIGHT_DECAY * pMove->weight + (1.0 - MOVE_WEIGHT_DECAY) * (bMetrop ? 1.0 : 0.0);
+        }
         // Render to the history file if appropriate (true = with component scores)
         if ((config.history_frequency > 0) && (iStep % config.history_frequency) == 0) {
             GetWorkSpace()->SaveHistory(true);
@@ -256,3 +314,37 @@ void RbtSimAnnTransform::MC(RbtDouble t, RbtInt blockLen, RbtDouble stepSize) {
     // This would not be the case if the last Metropolis test were failed
     m_chrom->SyncToModel();
 }
+
+RbtMCMove& RbtSimAnnTransform::SelectMove() {
+    RbtDouble total(0.0);
+    for (RbtMCMoveList::const_iterator iter = m_moves.begin(); iter != m_moves.end(); ++iter) {
+        total += std::max(iter->weight, MIN_MOVE_WEIGHT);
+    }
+    RbtDouble cutoff = total * m_rand.GetRandom01();
+    for (RbtMCMoveList::iterator iter = m_moves.begin(); iter != m_moves.end(); ++iter) {
+        cutoff -= std::max(iter->weight, MIN_MOVE_WEIGHT);
+        if (cutoff < 0.0) {
+            return *iter;
+        }
+    }
+    return m_moves.back();
+}
+
+void RbtSimAnnTransform::AdaptMoves() {
+    RbtInt iTrace = GetTrace();
+    for (RbtMCMoveList::iterator iter = m_moves.begin(); iter != m_moves.end(); ++iter) {
+        if (iter->nTrials > 0) {
+            // Grow the step if accepting too often, shrink it if too rarely
+            RbtDouble accRate = RbtDouble(iter->nAccepted) / RbtDouble(iter->nTrials);
+            iter->stepSize *= exp(2.0 * (accRate - config.target_acceptance_rate));
+            iter->stepSize = std::min(iter->stepSize, MAX_MOVE_STEP * config.step_size);
+            iter->stepSize = std::max(iter->stepSize, MIN_MOVE_STEP * config.step_size);
+            if (iTrace > 2) {
+                cout << _CT << ": move " << iter - m_moves.begin() << " trials=" << iter->nTrials
+                     << " acc.rate=" << accRate << " step=" << iter->stepSize << " weight=" << iter->weight << endl;
+            }
+        }
+        iter->nTrials = 0;
+        iter->nAccepted = 0;
+    }
+}
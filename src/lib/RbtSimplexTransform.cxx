@@ -13,8 +13,6 @@
 #include <iomanip>
 using std::setw;
 
-#include "NMSearch.h"
-
 #include "RbtChrom.h"
 #include "RbtSFRequest.h"
 #include "RbtSimplexTransform.h"
@@ -36,6 +34,8 @@ const RbtSimplexTransform::Config
 RbtSimplexTransform::RbtSimplexTransform(const RbtString& strName, const Config& config):
     RbtBaseBiMolTransform(_CT, strName),
     config{config} {
+    m_simplex.SetMaxCalls(config.max_calls);
+    m_simplex.SetStoppingLength(config.stopping_step_length);
 #ifdef _DEBUG
     cout << _CT << " parameterised constructor" << endl;
 #endif  //_DEBUG
@@ -89,23 +89,17 @@ void RbtSimplexTransform::Execute() {
 
     m_chrom->SyncFromModel();
     // If we are minimising all degrees of freedom simultaneuously
-    // we have to compile a vector of variable step sizes for the NMSearch
-    RbtDoubleList sv;
-    m_chrom->GetStepVector(sv);
-    RbtInt nsv = sv.size();
-    RbtDouble* steps = new RbtDouble[nsv];
-    for (RbtInt i = 0; i < nsv; ++i) {
-        steps[i] = sv[i] * config.step_size;
+    // we have to compile a vector of variable step sizes for the simplex
+    m_steps.clear();
+    m_chrom->GetStepVector(m_steps);
+    for (RbtDoubleListIter iter = m_steps.begin(); iter != m_steps.end(); ++iter) {
+        *iter *= config.step_size;
     }
 
-    // Set up the Simplex search object
-    NMSearch* ssearch;
-    NMSearch::SetMaxCalls(config.max_calls);
-    NMSearch::SetStoppingLength(config.stopping_step_length);
+    RbtChromSFObjective objective(m_chrom.Ptr(), pSF);
     RbtInt calls = 0;
     RbtDouble initScore = pSF->Score();  // Current score
     RbtDouble min = initScore;
-    RbtDoubleList vc;  // Vector representation of chromosome
     // Energy change between cycles - initialise so as not to terminate loop immediately
     RbtDouble delta = -config.convergence_threshold - 1.0;
 
@@ -131,31 +125,28 @@ void RbtSimplexTransform::Execute() {
             pSF->HandleRequest(spPartReq);
         }
         // Use a variable length simplex
-        vc.clear();
-        m_chrom->GetVector(vc);
-        ssearch = new NMSearch(m_chrom, pSF);
-        ssearch->InitVariableLengthRightSimplex(&vc, steps);
+        m_startPoint.clear();
+        m_chrom->GetVector(m_startPoint);
+        m_simplex.InitRightSimplex(m_startPoint, m_steps, objective);
         if (iTrace > 0) {
-            cout << setw(5) << i << setw(5) << "ALL" << setw(5) << vc.size();
+            cout << setw(5) << i << setw(5) << "ALL" << setw(5) << m_startPoint.size();
         }
         // Do the simplex search and retrieve the minimum
-        ssearch->ExploratoryMoves();
-        RbtDouble newmin = ssearch->GetMinVal();
+        m_simplex.Minimise(objective);
+        RbtDouble newmin = m_simplex.GetMinVal();
         delta = newmin - min;
-        calls += ssearch->GetFunctionCalls();
-        m_chrom->SetVector(ssearch->GetMinPoint());
+        calls += m_simplex.GetFunctionCalls();
+        m_chrom->SetVector(m_simplex.GetMinPoint());
         if (iTrace > 0) {
             cout << setw(10) << calls << setw(10) << newmin << setw(10) << delta << endl;
             if (iTrace > 1) {
                 cout << *m_chrom << endl;
             }
         }
-        delete ssearch;  // DM 27 Jun 2002 - garbage collection
         min = newmin;
     }
     m_chrom->SyncToModel();
     pSF->HandleRequest(spClearPartReq);  // Clear any partitioning
-    delete[] steps;
     if (iTrace > 0) {
         min = pSF->Score();
         delta = min - initScore;
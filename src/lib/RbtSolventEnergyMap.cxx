@@ -0,0 +1,264 @@
+/***********************************************************************
+ * The rDock program was developed from 1998 - 2006 by the software team
+ * at RiboTargets (subsequently Vernalis (R&D) Ltd).
+ * In 2006, the software was licensed to the University of York for
+ * maintenance and distribution.
+ * In 2012, Vernalis and the University of York agreed to release the
+ * program as Open Source software.
+ * This version is licensed under GNU-LGPL version 3.0 with support from
+ * the University of Barcelona.
+ * http://rdock.sourceforge.net/
+ ***********************************************************************/
+
+#include "RbtSolventEnergyMap.h"
+
+#include "RbtLigandFlexData.h"
+#include "RbtSolventFlexData.h"
+
+#include <cmath>
+
+// Static data members
+RbtString RbtSolventEnergyMap::_CT("RbtSolventEnergyMap");
+
+// Minimum angular tolerance (radians) for matching the current orientation to a tabulated orientation
+const RbtDouble MIN_ORIENT_ERROR = 0.01;
+
+// Returns the i'th element of the Halton low-discrepancy sequence in the given (prime) base
+// Used to give a deterministic, evenly spread set of orientations
+static RbtDouble Halton(RbtInt i, RbtInt base) {
+    RbtDouble f = 1.0;
+    RbtDouble r = 0.0;
+    while (i > 0) {
+        f /= base;
+        r += f * (i % base);
+        i /= base;
+    }
+    return r;
+}
+
+RbtSolventEnergyMap::RbtSolventEnergyMap(RbtModel* pModel, RbtDouble gridStep, RbtInt nOrientations):
+    m_pModel(pModel),
+    m_totalMass(0.0),
+    m_savedOccupancy(pModel->GetOccupancy()),
+    m_bInitialEnabled(pModel->GetEnabled()),
+    m_bValid(true),
+    m_transMode(RbtChromElement::FIXED),
+    m_rotMode(RbtChromElement::FIXED),
+    m_maxTrans(0.0),
+    m_maxRot(0.0),
+    m_bFixedTrans(true),
+    m_cosMaxOrientError(1.0) {
+    _RBTOBJECTCOUNTER_CONSTR_(_CT);
+    RbtAtomList atomList = m_pModel->GetAtomList();
+    for (RbtAtomListConstIter iter = atomList.begin(); iter != atomList.end(); ++iter) {
+        m_atomList.push_back(*iter);
+        m_masses.push_back((*iter)->GetAtomicMass());
+        m_totalMass += (*iter)->GetAtomicMass();
+        m_savedCoords.push_back((*iter)->GetCoords());
+    }
+    if (m_pModel->GetFlexData() != NULL) {
+        m_pModel->GetFlexData()->Accept(*this);
+    }
+    RbtVector ax, ay, az;
+    // Internal flexibility is not supported, and free translation would require grids covering the entire docking
+    // site
+    if (!GetFrame(ax, ay, az) || (m_totalMass <= 0.0) || (m_transMode == RbtChromElement::FREE)
+        || !Rbt::GetBondList(m_pModel->GetBondList(), Rbt::isBondRotatable()).empty()) {
+        m_bValid = false;
+        return;
+    }
+    // The map may be built in the middle of a run (e.g. after a change of SF parameters), when the model
+    // is no longer in its reference pose, so the reference coords and orientation frames are taken
+    // with the model temporarily reset
+    ResetModel();
+    for (RbtAtomRListConstIter iter = m_atomList.begin(); iter != m_atomList.end(); ++iter) {
+        m_initialCoords.push_back((*iter)->GetCoords());
+    }
+    m_initialCOM = GetCenterOfMass();
+    CreateOrientations(nOrientations);
+    RestoreModel();
+
+    m_bFixedTrans = (m_transMode == RbtChromElement::FIXED);
+    if (m_bFixedTrans) {
+        m_fixedValues = RbtDoubleList(m_orientations.size(), 0.0);
+    } else {
+        // Grid covers the tethered range plus one grid step, so that all points within range can be interpolated
+        RbtInt n = RbtInt(ceil(m_maxTrans / gridStep)) + 1;
+        RbtUInt nXYZ = 2 * n + 1;
+        RbtCoord gridMin = m_initialCOM - (n * gridStep);
+        RbtVector step(gridStep, gridStep, gridStep);
+        for (RbtUInt i = 0; i < m_orientations.size(); i++) {
+            m_grids.push_back(new RbtRealGrid(gridMin, step, nXYZ, nXYZ, nXYZ));
+        }
+        m_minCoord = m_grids.front()->GetCoord(1, 1, 1);
+        m_maxCoord = m_grids.front()->GetCoord(nXYZ, nXYZ, nXYZ);
+    }
+}
+
+RbtSolventEnergyMap::~RbtSolventEnergyMap() { _RBTOBJECTCOUNTER_DESTR_(_CT); }
+
+RbtUInt RbtSolventEnergyMap::GetNumPositions() const {
+    if (!m_bValid) {
+        return 0;
+    }
+    return (m_bFixedTrans) ? 1 : m_grids.front()->GetN();
+}
+
+void RbtSolventEnergyMap::PlaceModel(RbtUInt iOrient, RbtUInt iXYZ) {
+    RbtCoord com = (m_bFixedTrans) ? m_initialCOM : m_grids[iOrient]->GetCoord(iXYZ);
+    const RbtQuat& q = m_orientations[iOrient];
+    for (RbtUInt i = 0; i < m_atomList.size(); i++) {
+        m_atomList[i]->SetCoords(com + q.Rotate(m_initialCoords[i] - m_initialCOM));
+    }
+    m_pModel->UpdatePseudoAtoms();
+    // Occupancy is never negative, so a zero threshold enables the model without changing the occupancy
+    m_pModel->SetOccupancy(m_pModel->GetOccupancy(), 0.0);
+}
+
+void RbtSolventEnergyMap::SetValue(RbtUInt iOrient, RbtUInt iXYZ, RbtDouble val) {
+    if (m_bFixedTrans) {
+        m_fixedValues[iOrient] = val;
+    } else {
+        m_grids[iOrient]->SetValue(iXYZ, val);
+    }
+}
+
+void RbtSolventEnergyMap::RestoreModel() {
+    for (RbtUInt i = 0; i < m_atomList.size(); i++) {
+        m_atomList[i]->SetCoords(m_savedCoords[i]);
+    }
+    m_pModel->UpdatePseudoAtoms();
+    // Occupancy is never greater than one, so a threshold of 2 disables the model
+    m_pModel->SetOccupancy(m_savedOccupancy, (m_bInitialEnabled) ? 0.0 : 2.0);
+}
+
+void RbtSolventEnergyMap::ResetModel() {
+    RbtChromElement* pChrom = m_pModel->GetChrom();
+    if (pChrom != NULL) {
+        pChrom->Reset();
+        pChrom->SyncToModel();
+        delete pChrom;
+    }
+}
+
+RbtBool RbtSolventEnergyMap::GetEnergy(RbtDouble& energy) const {
+    if (!m_bValid) {
+        return false;
+    }
+    RbtCoord com = GetCenterOfMass();
+    if (!m_bFixedTrans && !((com >= m_minCoord) && (com <= m_maxCoord))) {
+        return false;
+    }
+    RbtVector ax, ay, az;
+    if (!GetFrame(ax, ay, az)) {
+        return false;
+    }
+    // Nearest orientation has the maximum trace of the relative rotation matrix
+    // (= sum of the dot products of the corresponding frame axes)
+    RbtUInt iBest = 0;
+    RbtDouble bestTrace = -1.0;
+    for (RbtUInt i = 0, j = 0; i < m_orientations.size(); i++, j += 3) {
+        RbtDouble trace = ax.Dot(m_orientFrames[j]) + ay.Dot(m_orientFrames[j + 1]) + az.Dot(m_orientFrames[j + 2]);
+        if (trace > bestTrace) {
+            bestTrace = trace;
+            iBest = i;
+        }
+    }
+    // cos(theta) = (trace - 1) / 2 for a rotation through theta
+    if (0.5 * (bestTrace - 1.0) < m_cosMaxOrientError) {
+        return false;
+    }
+    energy = (m_bFixedTrans) ? m_fixedValues[iBest] : m_grids[iBest]->GetSmoothedValue(com);
+    return true;
+}
+
+void RbtSolventEnergyMap::VisitReceptorFlexData(RbtReceptorFlexData* pFlexData) {
+    // Flexible receptors can not be mapped
+    m_bValid = false;
+}
+
+void RbtSolventEnergyMap::VisitLigandFlexData(RbtLigandFlexData* pFlexData) {
+    RbtString transModeStr = pFlexData->GetParameter(RbtLigandFlexData::_TRANS_MODE);
+    RbtString rotModeStr = pFlexData->GetParameter(RbtLigandFlexData::_ROT_MODE);
+    m_transMode = RbtChromElement::StrToMode(transModeStr);
+    m_rotMode = RbtChromElement::StrToMode(rotModeStr);
+    m_maxTrans = pFlexData->GetParameter(RbtLigandFlexData::_MAX_TRANS);
+    // Tethered rotation range is in degrees
+    m_maxRot = pFlexData->GetParameter(RbtLigandFlexData::_MAX_ROT).Double() * M_PI / 180.0;
+}
+
+void RbtSolventEnergyMap::VisitSolventFlexData(RbtSolventFlexData* pFlexData) { VisitLigandFlexData(pFlexData); }
+
+RbtCoord RbtSolventEnergyMap::GetCenterOfMass() const {
+    RbtCoord com;
+    for (RbtUInt i = 0; i < m_atomList.size(); i++) {
+        com += m_masses[i] * m_atomList[i]->GetCoords();
+    }
+    return com / m_totalMass;
+}
+
+RbtBool RbtSolventEnergyMap::GetFrame(RbtVector& ax, RbtVector& ay, RbtVector& az) const {
+    if (m_atomList.size() < 3) {
+        return false;
+    }
+    const RbtCoord& c0 = m_atomList[0]->GetCoords();
+    RbtVector v1 = m_atomList[1]->GetCoords() - c0;
+    RbtVector v2 = m_atomList[2]->GetCoords() - c0;
+    RbtVector n = v1.Cross(v2);
+    if ((v1.Length2() < 1.0e-6) || (n.Length2() < 1.0e-6)) {
+        return false;
+    }
+    ax = v1.Unit();
+    az = n.Unit();
+    ay = az.Cross(ax);
+    return true;
+}
+
+// The first orientation is always the initial orientation.
+// Tethered rotation: rotations of up to m_maxRot about evenly spread axes
+// Free rotation: evenly spread quaternions over the whole of orientation space (Shoemake's method)
+void RbtSolventEnergyMap::CreateOrientations(RbtInt nOrientations) {
+    m_orientations.clear();
+    m_orientations.push_back(RbtQuat());
+    if (m_rotMode != RbtChromElement::FIXED) {
+        for (RbtInt i = 1; i < nOrientations; i++) {
+            RbtDouble u1 = Halton(i, 2);
+            RbtDouble u2 = Halton(i, 3);
+            RbtDouble u3 = Halton(i, 5);
+            if (m_rotMode == RbtChromElement::TETHERED) {
+                RbtDouble z = 2.0 * u2 - 1.0;
+                RbtDouble r = sqrt(std::max(0.0, 1.0 - z * z));
+                RbtVector axis(r * cos(2.0 * M_PI * u3), r * sin(2.0 * M_PI * u3), z);
+                m_orientations.push_back(RbtQuat(axis, m_maxRot * cbrt(u1)));
+            } else {
+                m_orientations.push_back(RbtRand::GetUniformQuat(u1, u2, u3));
+            }
+        }
+    }
+    // Store the frame axes for each orientation, for matching against the current orientation
+    RbtVector ax, ay, az;
+    GetFrame(ax, ay, az);
+    m_orientFrames.clear();
+    for (RbtQuatListConstIter iter = m_orientations.begin(); iter != m_orientations.end(); ++iter) {
+        m_orientFrames.push_back(iter->Rotate(ax));
+        m_orientFrames.push_back(iter->Rotate(ay));
+        m_orientFrames.push_back(iter->Rotate(az));
+    }
+    // The matching tolerance is the largest nearest-neighbour angle between tabulated orientations
+    RbtDouble minCosNN = cos(MIN_ORIENT_ERROR);
+    for (RbtUInt i = 0; i < m_orientations.size(); i++) {
+        RbtDouble maxTrace = -1.0;
+        for (RbtUInt j = 0; j < m_orientations.size(); j++) {
+            if (i != j) {
+                RbtDouble trace = m_orientFrames[3 * i].Dot(m_orientFrames[3 * j])
+                                  + m_orientFrames[3 * i + 1].Dot(m_orientFrames[3 * j + 1])
+                                  + m_orientFrames[3 * i + 2].Dot(m_orientFrames[3 * j + 2]);
+                maxTrace = std::max(maxTrace, trace);
+            }
+        }
+        if (m_orientations.size() > 1) {
+            minCosNN = std::min(minCosNN, 0.5 * (maxTrace - 1.0));
+        }
+    }
+    m_cosMaxOrientError = minCosNN;
+}
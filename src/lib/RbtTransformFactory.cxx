@@ -146,6 +146,13 @@ static RbtSimAnnTransform* MakeSimmulatedAnnealingTransformFromFile(
             paramsPtr->GetParamOrDefault(RbtSimAnnTransform::_PARTITION_FREQ, default_config.partition_frequency),
         .history_frequency =
             paramsPtr->GetParamOrDefault(RbtSimAnnTransform::_HISTORY_FREQ, default_config.history_frequency),
+        .adaptive_moves =
+            paramsPtr->GetParamOrDefault(RbtSimAnnTransform::_ADAPTIVE_MOVES, default_config.adaptive_moves),
+        .target_acceptance_rate = paramsPtr->GetParamOrDefault(
+            RbtSimAnnTransform::_TARGET_ACC_RATE, default_config.target_acceptance_rate
+        ),
+        .early_stopping =
+            paramsPtr->GetParamOrDefault(RbtSimAnnTransform::_EARLY_STOPPING, default_config.early_stopping),
     };
     return new RbtSimAnnTransform(name, config);
 }
@@ -174,6 +181,9 @@ static RbtGATransform* MakeGeneticAlgorithmTransformFromFile(
             paramsPtr->GetParamOrDefault(RbtGATransform::_NCONVERGENCE, default_config.num_convergence_cycles),
         .history_frequency =
             paramsPtr->GetParamOrDefault(RbtGATransform::_HISTORY_FREQ, default_config.history_frequency),
+        .surrogate_sf = paramsPtr->GetParamOrDefault(RbtGATransform::_SURROGATE_SF, default_config.surrogate_sf),
+        .surrogate_fraction =
+            paramsPtr->GetParamOrDefault(RbtGATransform::_SURROGATE_FRACTION, default_config.surrogate_fraction),
     };
     return new RbtGATransform(name, config);
 }
@@ -213,7 +223,42 @@ static RbtRandPopTransform* MakeRandomizePopulationTransformFromFile(
         .scale_chromosome_length = paramsPtr->GetParamOrDefault(
             RbtRandPopTransform::_SCALE_CHROM_LENGTH, default_config.scale_chromosome_length
         ),
+        .pharma_seed_fraction = paramsPtr->GetParamOrDefault(
+            RbtRandPopTransform::_PHARMA_SEED_FRACTION, default_config.pharma_seed_fraction
+        ),
+        .scan_seed_fraction =
+            paramsPtr->GetParamOrDefault(RbtRandPopTransform::_SCAN_SEED_FRACTION, default_config.scan_seed_fraction),
+        .scan_num_rotations =
+            paramsPtr->GetParamOrDefault(RbtRandPopTransform::_SCAN_NROT, default_config.scan_num_rotations),
+        .grow_seed_fraction =
+            paramsPtr->GetParamOrDefault(RbtRandPopTransform::_GROW_SEED_FRACTION, default_config.grow_seed_fraction),
+        .grow_beam_width =
+            paramsPtr->GetParamOrDefault(RbtRandPopTransform::_GROW_BEAM_WIDTH, default_config.grow_beam_width),
+        .grow_dihedral_step =
+            paramsPtr->GetParamOrDefault(RbtRandPopTransform::_GROW_DIHEDRAL_STEP, default_config.grow_dihedral_step),
+        .grow_clash_dist =
+            paramsPtr->GetParamOrDefault(RbtRandPopTransform::_GROW_CLASH_DIST, default_config.grow_clash_dist),
+        .grow_clash_weight =
+            paramsPtr->GetParamOrDefault(RbtRandPopTransform::_GROW_CLASH_WEIGHT, default_config.grow_clash_weight),
+        .run_seed_fraction =
+            paramsPtr->GetParamOrDefault(RbtRandPopTransform::_RUN_SEED_FRACTION, default_config.run_seed_fraction),
+        .run_seed_threshold = paramsPtr->GetParamOrDefault(
+            RbtRandPopTransform::_RUN_SEED_THRESHOLD, default_config.run_seed_threshold
+        ),
+        .template_seed_fraction = paramsPtr->GetParamOrDefault(
+            RbtRandPopTransform::_TEMPLATE_SEED_FRACTION, default_config.template_seed_fraction
+        ),
+        .template_file =
+            paramsPtr->GetParamOrDefault(RbtRandPopTransform::_TEMPLATE_FILE, default_config.template_file),
+        .template_min_matched = paramsPtr->GetParamOrDefault(
+            RbtRandPopTransform::_TEMPLATE_MIN_MATCHED, default_config.template_min_matched
+        ),
     };
+    if (!(config.grow_dihedral_step > 0.0)) {
+        throw RbtBadArgument(
+            _WHERE_, RbtRandPopTransform::_GROW_DIHEDRAL_STEP + " must be positive in transform " + name
+        );
+    }
     return new RbtRandPopTransform(name, config);
 }
 
@@ -12,20 +12,46 @@
 
 #include "RbtVdwGridSF.h"
 
+#include <sys/stat.h>  // For POSIX umask, fchmod
+#include <unistd.h>    // For POSIX close
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "RbtBiMolWorkSpace.h"
 #include "RbtFileError.h"
-#include "RbtWorkSpace.h"
+#include "RbtParameterFileSource.h"
+#include "RbtSFFactory.h"
 
 // Static data members
 RbtString RbtVdwGridSF::_CT("RbtVdwGridSF");
 RbtString RbtVdwGridSF::_GRID("GRID");
 RbtString RbtVdwGridSF::_SMOOTHED("SMOOTHED");
+RbtString RbtVdwGridSF::_GRID_SF("GRID_SF");
+RbtString RbtVdwGridSF::_SAVE_GRIDS("SAVE_GRIDS");
+RbtString RbtVdwGridSF::_GRID_STEP("GRID_STEP");
+RbtString RbtVdwGridSF::_GRID_BORDER("GRID_BORDER");
+RbtString RbtVdwGridSF::_GRID_LEVEL("GRID_LEVEL");
+RbtString RbtVdwGridSF::_BRICKED_GRIDS("BRICKED_GRIDS");
 
 // NB - Virtual base class constructor (RbtBaseSF) gets called first,
 // implicit constructor for RbtBaseInterSF is called second
-RbtVdwGridSF::RbtVdwGridSF(const RbtString& strName): RbtBaseSF(_CT, strName), m_bSmoothed(true) {
+RbtVdwGridSF::RbtVdwGridSF(const RbtString& strName):
+    RbtBaseSF(_CT, strName),
+    m_gridLevel(0),
+    m_lowerBound(0.0),
+    m_bSmoothed(true) {
     // Add parameters
     AddParameter(_GRID, ".grd");
     AddParameter(_SMOOTHED, m_bSmoothed);
+    AddParameter(_GRID_SF, RbtString());
+    AddParameter(_SAVE_GRIDS, false);
+    AddParameter(_GRID_STEP, 0.5);
+    AddParameter(_GRID_BORDER, 1.0);
+    AddParameter(_GRID_LEVEL, m_gridLevel);
+    AddParameter(_BRICKED_GRIDS, false);
 #ifdef _DEBUG
     cout << _CT << " parameterised constructor" << endl;
 #endif  //_DEBUG
@@ -41,6 +67,8 @@ RbtVdwGridSF::~RbtVdwGridSF() {
 
 void RbtVdwGridSF::SetupReceptor() {
     m_grids.clear();
+    m_coarseGrids.clear();
+    m_activeGrids.clear();
     if (GetReceptor().Null()) return;
 
     // Trap multiple receptor conformations and flexible OH/NH3 here: this SF does not support them yet
@@ -59,16 +87,30 @@ void RbtVdwGridSF::SetupReceptor() {
     RbtString strWSName = GetWorkSpace()->GetName();
 
     RbtString strSuffix = GetParameter(_GRID);
-    RbtString strFile = Rbt::GetRbtFileName("data/grids", strWSName + strSuffix);
+    m_strGridFile = Rbt::GetRbtFileName("data/grids", strWSName + strSuffix);
     // DM 26 Sep 2000 - ios_base::binary qualifier doesn't appear to be valid
     // with IRIX CC
 #ifdef __sgi
-    ifstream istr(strFile.c_str(), ios_base::in);
+    ifstream istr(m_strGridFile.c_str(), ios_base::in);
 #else
-    ifstream istr(strFile.c_str(), ios_base::in | ios_base::binary);
+    ifstream istr(m_strGridFile.c_str(), ios_base::in | ios_base::binary);
 #endif
+    RbtString strGridSF = GetParameter(_GRID_SF);
+    if (!istr && !strGridSF.empty()) {
+        // No grid file: all grids will be calculated as required (and saved to the current directory)
+        if (GetTrace() > 0) {
+            cout << _CT << ": " << m_strGridFile << " not found, grids will be calculated with " << strGridSF
+                 << endl;
+        }
+        m_strGridFile = strWSName + strSuffix;
+        m_grids = RbtRealGridList(RbtTriposAtomType::MAXTYPES);
+        m_gridMinValues = RbtDoubleList(RbtTriposAtomType::MAXTYPES, 0.0);
+        SelectGridLevel();
+        return;
+    }
     ReadGrids(istr);
     istr.close();
+    SelectGridLevel();
 }
 
 void RbtVdwGridSF::SetupLigand() {
@@ -93,9 +135,31 @@ void RbtVdwGridSF::SetupScore() {
     // Determine probe grid type for each atom, based on comparing Tripos atom type with probe atom types
     // This needs to be in SetupScore as it is dependent on both the ligand and receptor grid data
     m_ligAtomTypes.clear();
+    m_lowerBound = 0.0;
     if (m_ligAtomList.empty()) return;
 
     RbtInt iTrace = GetTrace();
+
+    // Calculate any missing grids first, if enabled
+    if (!RbtString(GetParameter(_GRID_SF)).empty()) {
+        RbtTriposAtomTypeList missingTypes;
+        for (RbtAtomRListConstIter iter = m_ligAtomList.begin(); iter != m_ligAtomList.end(); iter++) {
+            RbtTriposAtomType::eType aType = (*iter)->GetTriposType();
+            if (m_grids[aType].Null()
+                && (std::find(missingTypes.begin(), missingTypes.end(), aType) == missingTypes.end())) {
+                missingTypes.push_back(aType);
+            }
+        }
+        if (!missingTypes.empty()) {
+            CalculateGrids(missingTypes);
+            SelectGridLevel();
+            RbtBool bSaveGrids = GetParameter(_SAVE_GRIDS);
+            if (bSaveGrids) {
+                SaveGrids();
+            }
+        }
+    }
+
     m_ligAtomTypes.reserve(m_ligAtomList.size());
     // Check if we have a grid for the UNDEFINED type:
     // If so, we can use it if a particular atom type grid is missing
@@ -132,6 +196,7 @@ void RbtVdwGridSF::SetupScore() {
         }
 
         m_ligAtomTypes.push_back(aType);
+        m_lowerBound += m_gridMinValues[aType];
         if (iTrace > 1) {
             cout << "Using grid #" << aType << " for " << (*iter)->GetFullAtomName() << endl;
         }
@@ -142,23 +207,50 @@ RbtDouble RbtVdwGridSF::RawScore() const {
     RbtDouble score = 0.0;
 
     // Check grids are defined
-    if (m_grids.empty()) return score;
+    if (m_activeGrids.empty()) return score;
 
     // Loop over all ligand atoms
     RbtAtomRListConstIter aIter = m_ligAtomList.begin();
     RbtTriposAtomTypeListConstIter tIter = m_ligAtomTypes.begin();
     if (m_bSmoothed) {
         for (; aIter != m_ligAtomList.end(); aIter++, tIter++) {
-            score += m_grids[*tIter]->GetSmoothedValue((*aIter)->GetCoords());
+            score += m_activeGrids[*tIter]->GetSmoothedValue((*aIter)->GetCoords());
         }
     } else {
         for (; aIter != m_ligAtomList.end(); aIter++, tIter++) {
-            score += m_grids[*tIter]->GetValue((*aIter)->GetCoords());
+            score += m_activeGrids[*tIter]->GetValue((*aIter)->GetCoords());
+        }
+    }
+    return score;
+}
+
+RbtDouble RbtVdwGridSF::RawScore(const RbtCoordList& ligCoords) const {
+    RbtDouble score = 0.0;
+    if (m_activeGrids.empty() || (ligCoords.size() != m_ligAtomTypes.size())) return score;
+    RbtCoordListConstIter cIter = ligCoords.begin();
+    RbtTriposAtomTypeListConstIter tIter = m_ligAtomTypes.begin();
+    if (m_bSmoothed) {
+        for (; cIter != ligCoords.end(); cIter++, tIter++) {
+            score += m_activeGrids[*tIter]->GetSmoothedValue(*cIter);
+        }
+    } else {
+        for (; cIter != ligCoords.end(); cIter++, tIter++) {
+            score += m_activeGrids[*tIter]->GetValue(*cIter);
         }
     }
     return score;
 }
 
+RbtDouble RbtVdwGridSF::RawScore(const RbtCoordList& ligCoords, const RbtUIntList& atomIndices) const {
+    RbtDouble score = 0.0;
+    if (m_activeGrids.empty() || (ligCoords.size() != m_ligAtomTypes.size())) return score;
+    for (RbtUIntListConstIter iter = atomIndices.begin(); iter != atomIndices.end(); iter++) {
+        const RbtRealGridPtr& spGrid = m_activeGrids[m_ligAtomTypes[*iter]];
+        score += m_bSmoothed ? spGrid->GetSmoothedValue(ligCoords[*iter]) : spGrid->GetValue(ligCoords[*iter]);
+    }
+    return score;
+}
+
 // Read grids from input stream, checking that header string matches RbtVdwGridSF
 void RbtVdwGridSF::ReadGrids(istream& istr) {
     m_grids.clear();
@@ -193,6 +285,9 @@ void RbtVdwGridSF::ReadGrids(istream& istr) {
     // type enums change (as long as the atom type string stay the same)
     // It also means we do not have to have a grid for each and every atom type if we don't want to
     m_grids = RbtRealGridList(RbtTriposAtomType::MAXTYPES);
+    // Off-grid atoms score zero, so the lower bound for each atom can not be more than zero
+    m_gridMinValues = RbtDoubleList(RbtTriposAtomType::MAXTYPES, 0.0);
+    RbtRealGrid::eLayout layout = GetGridLayout();
     for (RbtInt i = 0; i < nGrids; i++) {
         // Read the atom type string
         Rbt::ReadWithThrow(istr, (char*)&length, sizeof(length));
@@ -209,8 +304,189 @@ void RbtVdwGridSF::ReadGrids(istream& istr) {
                  << "atom type=" << strType << " (type #" << aType << ")" << endl;
         }
         // Now we can read the grid
-        RbtRealGridPtr spGrid(new RbtRealGrid(istr));
+        RbtRealGridPtr spGrid(new RbtRealGrid(istr, layout));
         m_grids[aType] = spGrid;
+        m_gridMinValues[aType] = std::min(0.0, spGrid->MinValue());
+    }
+}
+
+// Write grids to output stream, in the format read by ReadGrids
+void RbtVdwGridSF::WriteGrids(ostream& ostr) const {
+    // Write header string (RbtVdwGridSF)
+    RbtInt length = _CT.size();
+    Rbt::WriteWithThrow(ostr, (const char*)&length, sizeof(length));
+    Rbt::WriteWithThrow(ostr, _CT.c_str(), length);
+    // Write number of grids
+    RbtInt nGrids = 0;
+    for (RbtRealGridListConstIter iter = m_grids.begin(); iter != m_grids.end(); iter++) {
+        if (!iter->Null()) nGrids++;
+    }
+    Rbt::WriteWithThrow(ostr, (const char*)&nGrids, sizeof(nGrids));
+    // Write each grid, prefixed by the atom type string
+    RbtTriposAtomType triposType;
+    for (RbtUInt i = 0; i < m_grids.size(); i++) {
+        if (m_grids[i].Null()) {
+            continue;
+        }
+        RbtString strType = triposType.Type2Str(RbtTriposAtomType::eType(i));
+        RbtInt l = strType.size();
+        Rbt::WriteWithThrow(ostr, (const char*)&l, sizeof(l));
+        Rbt::WriteWithThrow(ostr, strType.c_str(), l);
+        m_grids[i]->Write(ostr);
+    }
+}
+
+void RbtVdwGridSF::CalculateGrids(const RbtTriposAtomTypeList& atomTypes) {
+    RbtInt iTrace = GetTrace();
+    // Set up a separate workspace containing the receptor and the grid scoring function, as in rbcalcgrid
+    RbtString strGridSF = GetParameter(_GRID_SF);
+    RbtParameterFileSourcePtr spSFSource(new RbtParameterFileSource(Rbt::GetRbtFileName("data/sf", strGridSF)));
+    RbtSFFactoryPtr spSFFactory(new RbtSFFactory());
+    RbtSFAggPtr spSF(spSFFactory->CreateAggFromFile(spSFSource, "SCORE"));
+    RbtBiMolWorkSpacePtr spWS(new RbtBiMolWorkSpace());
+    spWS->SetSF(spSF);
+    spWS->SetDockingSite(GetWorkSpace()->GetDockingSite());
+    spWS->SetReceptor(GetReceptor());
+
+    RbtTriposAtomType triposType;
+    for (RbtTriposAtomTypeListConstIter iter = atomTypes.begin(); iter != atomTypes.end(); iter++) {
+        RbtRealGridPtr spGrid = CreateEmptyGrid();
+        if (iTrace > 0) {
+            cout << _CT << ": calculating grid for atom type " << triposType.Type2Str(*iter) << " ("
+                 << spGrid->GetN() << " points)" << endl;
+        }
+        CalculateProbeGrid(spWS, CreateProbe(*iter), spGrid);
+        spGrid->SetLayout(GetGridLayout());
+        m_grids[*iter] = spGrid;
+        m_gridMinValues[*iter] = std::min(0.0, spGrid->MinValue());
+    }
+}
+
+void RbtVdwGridSF::SaveGrids() const {
+    // The grid file may be in a shared, read-only directory (e.g. $RBT_ROOT/data/grids).
+    // Grids saved in the current directory are found first by Rbt::GetRbtFileName on the next run
+    RbtString strFile = m_strGridFile;
+    if (!WriteGridFile(strFile)) {
+        RbtString strLocalFile = GetWorkSpace()->GetName() + RbtString(GetParameter(_GRID));
+        if ((strLocalFile == strFile) || !WriteGridFile(strLocalFile)) {
+            throw RbtFileWriteError(_WHERE_, "Unable to save grids to " + strFile);
+        }
+        strFile = strLocalFile;
+    }
+    if (GetTrace() > 0) {
+        cout << _CT << ": grids saved to " << strFile << endl;
+    }
+}
+
+RbtBool RbtVdwGridSF::WriteGridFile(const RbtString& strFile) const {
+    // Write to a temporary file first, so that other processes never see a partially written grid file.
+    // The temporary file name is unique, so concurrent processes saving the same grid file do not collide
+    RbtString strTemplate = strFile + ".XXXXXX";
+    vector<char> tmpName(strTemplate.begin(), strTemplate.end());
+    tmpName.push_back('\0');
+    int fd = mkstemp(&tmpName[0]);
+    if (fd < 0) {
+        return false;
+    }
+    // mkstemp creates the file readable by the owner only; use the same permissions as any other new file
+    mode_t mask = umask(0);
+    umask(mask);
+    fchmod(fd, 0666 & ~mask);
+    close(fd);
+    RbtString strTmpFile(&tmpName[0]);
+#ifdef __sgi
+    ofstream ostr(strTmpFile.c_str(), ios_base::out | ios_base::trunc);
+#else
+    ofstream ostr(strTmpFile.c_str(), ios_base::out | ios_base::binary | ios_base::trunc);
+#endif
+    if (!ostr) {
+        std::remove(strTmpFile.c_str());
+        return false;
+    }
+    try {
+        WriteGrids(ostr);
+        ostr.close();
+    } catch (RbtError&) {
+        std::remove(strTmpFile.c_str());
+        throw;
+    }
+    if (std::rename(strTmpFile.c_str(), strFile.c_str()) != 0) {
+        std::remove(strTmpFile.c_str());
+        return false;
+    }
+    return true;
+}
+
+RbtRealGridPtr RbtVdwGridSF::CreateEmptyGrid() const {
+    // All grids in the file share the same dimensions
+    for (RbtRealGridListConstIter iter = m_grids.begin(); iter != m_grids.end(); iter++) {
+        if (!iter->Null()) {
+            RbtRealGridPtr spGrid(new RbtRealGrid(**iter));
+            spGrid->SetAllValues(0.0);
+            return spGrid;
+        }
+    }
+    // Otherwise cover the docking site plus border, as in rbcalcgrid
+    RbtDockingSitePtr spDS = GetWorkSpace()->GetDockingSite();
+    if (spDS.Null()) {
+        throw RbtInvalidRequest(_WHERE_, _CT + ": a docking site is required to calculate grids");
+    }
+    RbtDouble gs = GetParameter(_GRID_STEP);
+    RbtDouble border = GetParameter(_GRID_BORDER);
+    RbtCoord minCoord = spDS->GetMinCoord() - border;
+    RbtCoord maxCoord = spDS->GetMaxCoord() + border;
+    RbtVector recepExtent = maxCoord - minCoord;
+    RbtVector gridStep(gs, gs, gs);
+    RbtUInt nX = int(recepExtent.x / gridStep.x) + 1;
+    RbtUInt nY = int(recepExtent.y / gridStep.y) + 1;
+    RbtUInt nZ = int(recepExtent.z / gridStep.z) + 1;
+    return new RbtRealGrid(minCoord, gridStep, nX, nY, nZ);
+}
+
+void RbtVdwGridSF::SelectGridLevel() {
+    if ((m_gridLevel <= 0) || m_grids.empty()) {
+        m_activeGrids = m_grids;
+        return;
+    }
+    if (m_coarseGrids.size() < RbtUInt(m_gridLevel)) {
+        m_coarseGrids.resize(m_gridLevel, RbtRealGridList(m_grids.size()));
+    }
+    RbtRealGridList& coarseGrids = m_coarseGrids[m_gridLevel - 1];
+    for (RbtUInt i = 0; i < m_grids.size(); i++) {
+        if (!m_grids[i].Null() && coarseGrids[i].Null()) {
+            coarseGrids[i] = m_grids[i]->CreateCoarseGrid(1 << m_gridLevel);
+        }
+    }
+    m_activeGrids = coarseGrids;
+    if (GetTrace() > 1) {
+        cout << _CT << ": using grid level " << m_gridLevel << " (grid step x " << (1 << m_gridLevel) << ")" << endl;
+    }
+}
+
+RbtRealGrid::eLayout RbtVdwGridSF::GetGridLayout() const {
+    RbtBool bBricked = GetParameter(_BRICKED_GRIDS);
+    return bBricked ? RbtRealGrid::BRICKED : RbtRealGrid::LINEAR;
+}
+
+RbtModelPtr RbtVdwGridSF::CreateProbe(RbtTriposAtomType::eType aType) {
+    RbtAtomList atomList;
+    RbtBondList bondList;
+    RbtAtomPtr spAtom(new RbtAtom(1));
+    spAtom->SetTriposType(aType);
+    spAtom->SetAtomicMass(12.0);  // Mass is irrelevant as we are not rotating models around COM
+    atomList.push_back(spAtom);
+    return new RbtModel(atomList, bondList);
+}
+
+void RbtVdwGridSF::CalculateProbeGrid(RbtBiMolWorkSpace* pWorkSpace, RbtModelPtr spProbe, RbtRealGrid* pGrid) {
+    pWorkSpace->SetLigand(spProbe);
+    RbtBaseSF* pSF = pWorkSpace->GetSF();
+    RbtAtom* pAtom = spProbe->GetAtomList().front();
+    pGrid->SetAllValues(0.0);
+    // Loop over all grid coords and calculate the score at each position
+    for (RbtUInt i = 0; i < pGrid->GetN(); i++) {
+        pAtom->SetCoords(pGrid->GetCoord(i));
+        pGrid->SetValue(i, pSF->Score());
     }
 }
 
@@ -220,6 +496,17 @@ void RbtVdwGridSF::ParameterUpdated(const RbtString& strName) {
     // DM 25 Oct 2000 - heavily used params
     if (strName == _SMOOTHED) {
         m_bSmoothed = GetParameter(_SMOOTHED);
+    } else if (strName == _GRID_LEVEL) {
+        m_gridLevel = GetParameter(_GRID_LEVEL);
+        SelectGridLevel();
+    } else if (strName == _BRICKED_GRIDS) {
+        // Rearrange any grids already loaded (the coarse grids are rearranged as they are created)
+        RbtRealGrid::eLayout layout = GetGridLayout();
+        for (RbtRealGridListIter iter = m_grids.begin(); iter != m_grids.end(); iter++) {
+            if (!iter->Null()) (*iter)->SetLayout(layout);
+        }
+        m_coarseGrids.clear();
+        SelectGridLevel();
     } else {
         RbtBaseSF::ParameterUpdated(strName);
     }
@@ -13,6 +13,7 @@
 #include "RbtVdwIdxSF.h"
 
 #include "RbtFlexAtomFactory.h"
+#include "RbtReceptorFlexData.h"
 #include "RbtWorkSpace.h"
 
 // Static data members
@@ -27,6 +28,8 @@ RbtString RbtVdwIdxSF::_FAST_SOLVENT("FAST_SOLVENT");
 // implicit constructor for RbtBaseInterSF is called second
 RbtVdwIdxSF::RbtVdwIdxSF(const RbtString& strName):
     RbtBaseSF(_CT, strName),
+    m_bSolventMapsDirty(false),
+    m_bRotamerTableDirty(false),
     m_nAttr(0),
     m_nRep(0),
     m_attrThreshold(-0.5),
@@ -105,6 +108,9 @@ void RbtVdwIdxSF::SetupReceptor() {
     m_bFlexRec = false;
     m_recFlexIntns.clear();
     m_recFlexPrtIntns.clear();
+    m_solventMaps.clear();
+    ClearSolventEnergyMapCache();
+    m_spRotamerTable.SetNull();
     if (GetReceptor().Null()) return;
     m_bFlexRec = GetReceptor()->isFlexible();
 
@@ -153,6 +159,7 @@ void RbtVdwIdxSF::SetupReceptor() {
             // For grosser receptor flexibility we would have to partition periodically during docking
             RbtDouble partitionDist = MaxVdwRange(RbtTriposAtomType::H_P) + (2.0 * flexDist);
             Partition(m_recFlexAtomList, m_recFlexIntns, m_recFlexPrtIntns, partitionDist);
+            m_bRotamerTableDirty = true;
 
             // Index the flexible atoms over a larger radius
             // NOTE: WE ASSUME ONLY -OH and -NH3 rotation here (protons can't move more than 2.0A at most)
@@ -173,6 +180,7 @@ void RbtVdwIdxSF::SetupReceptor() {
             m_spGrid->SetAtomLists(*iter, range + maxError);
         }
     }
+    m_bSolventMapsDirty = true;
 }
 
 void RbtVdwIdxSF::SetupLigand() {
@@ -199,11 +207,13 @@ void RbtVdwIdxSF::SetupLigand() {
 //    b) Solvent (fix/teth) - solvent (fix/teth). Partitioned intn map.
 //       We can not use the solvent indexing grid here, due to self interactions.
 //    c) Solvent (free) - solvent (fix/teth). Solvent indexing grid.
-//    d) Solvent (free) - solvent (free). Unpartitioned intn map.
+//    d) Solvent (free) - solvent (free). Intra-model intns from the intn map, inter-model intns
+//       from a cell index of the free solvent atoms, rebuilt on each score call.
 //    e) Ligand - solvent(fix/teth). Solvent indexing grid.
-//    f) Ligand - solvent(free). Brute force loop.
-// Note: 5d and 5f are still inefficient, but free solvent is unlikely to be used very often
-// in practice.
+//    f) Ligand - solvent(free). Cell index of the ligand atoms, rebuilt on each score call.
+// The free solvent and ligand cell indexes are cheap to rebuild (O(N log N) in the number of atoms)
+// so 5d and 5f now scale with the number of near neighbours, rather than with N*M.
+// With FAST_SOLVENT disabled, 5d uses the unpartitioned intn map and 5f a brute force loop.
 void RbtVdwIdxSF::SetupSolvent() {
     m_spSolventGrid = RbtNonBondedGridPtr();
     m_solventAtomList.clear();
@@ -212,6 +222,9 @@ void RbtVdwIdxSF::SetupSolvent() {
     m_solventFixTethIntns.clear();
     m_solventFixTethPrtIntns.clear();
     m_solventFreeIntns.clear();
+    m_solventModelAtomLists.clear();
+    m_solventMaps.clear();
+    ClearSolventEnergyMapCache();
     RbtModelList solventList = GetSolvent();
     if (solventList.empty()) {
         return;
@@ -219,6 +232,9 @@ void RbtVdwIdxSF::SetupSolvent() {
     for (RbtModelListConstIter iter = solventList.begin(); iter != solventList.end(); ++iter) {
         RbtAtomList atomList = (*iter)->GetAtomList();
         std::copy(atomList.begin(), atomList.end(), std::back_inserter(m_solventAtomList));
+        RbtAtomRList modelAtomList;
+        std::copy(atomList.begin(), atomList.end(), std::back_inserter(modelAtomList));
+        m_solventModelAtomLists.push_back(modelAtomList);
         // For faster score calculations, divide the solvent atoms into fixed/tethered and free atom lists
         if (m_bFastSolvent) {
             RbtFlexAtomFactory flexAtomFactory(*iter);
@@ -267,18 +283,44 @@ void RbtVdwIdxSF::SetupSolvent() {
     if (!m_solventFreeAtomList.empty()) {
         m_solventFreeIntns = RbtAtomRListList(m_solventAtomList.size(), RbtAtomRList());
         BuildIntraMap(m_solventFreeAtomList, m_solventFreeIntns);
+        // The cell size of the dynamic indexes is the maximum vdW range of any free solvent atom,
+        // as every interaction scored via the indexes involves at least one free solvent atom
+        RbtDouble maxRange = 0.0;
+        for (RbtAtomRListConstIter iter = m_solventFreeAtomList.begin(); iter != m_solventFreeAtomList.end();
+             iter++) {
+            maxRange = std::max(maxRange, MaxVdwRange(*iter));
+        }
+        m_ligIndex.SetCellSize(maxRange);
+        m_solventFreeIndex.SetCellSize(maxRange);
+        // With the free solvent cell index, the intn map need only retain the intra-model interactions
+        // (inter-model interactions between free solvent atoms are all included by BuildIntraMap)
+        if (m_bFastSolvent) {
+            for (RbtAtomRListConstIter iter = m_solventFreeAtomList.begin(); iter != m_solventFreeAtomList.end();
+                 iter++) {
+                RbtModel* pModel = (*iter)->GetModelPtr();
+                RbtAtomRList& intns = m_solventFreeIntns[(*iter)->GetAtomId() - 1];
+                RbtAtomRList intraIntns;
+                for (RbtAtomRListConstIter jIter = intns.begin(); jIter != intns.end(); jIter++) {
+                    if ((*jIter)->GetModelPtr() == pModel) {
+                        intraIntns.push_back(*jIter);
+                    }
+                }
+                intns.swap(intraIntns);
+            }
+        }
         if (GetTrace() > 0) {
             if (m_bFastSolvent) {
-                cout << endl
-                     << "Calculation of vdW scores involving freely translating solvent can not be optimised..."
+                cout << endl << "Faster calculation of vdW scores involving freely translating solvent is enabled..."
                      << endl;
                 cout << "#Free solvent atoms = " << m_solventFreeAtomList.size() << endl;
+                cout << "Free solvent indexing cell size = " << maxRange << "A" << endl;
             } else {
                 cout << endl
                      << "Faster calculation of vdW scores involving fixed/tethered solvent is disabled..." << endl;
             }
         }
     }
+    m_bSolventMapsDirty = true;
 }
 
 void RbtVdwIdxSF::SetupScore() {
@@ -306,9 +348,19 @@ void RbtVdwIdxSF::ParameterUpdated(const RbtString& strName) {
         RbtVdwSF::OwnParameterUpdated(strName);
         RbtBaseIdxSF::OwnParameterUpdated(strName);
         RbtBaseSF::ParameterUpdated(strName);
+        // The receptor-solvent energy maps and the rotamer energy table depend on the energy parameters
+        if (isSolventMapParameter(strName)) {
+            m_bSolventMapsDirty = true;
+            m_bRotamerTableDirty = m_bFlexRec;
+        }
     }
 }
 
+RbtBool RbtVdwIdxSF::isSolventMapParameter(const RbtString& strName) const {
+    return RbtBaseIdxSF::isSolventMapParameter(strName) || (strName == _USE_4_8) || (strName == _USE_TRIPOS)
+           || (strName == _RMAX) || (strName == _ECUT) || (strName == _E0);
+}
+
 // DM 06 Feb 2003
 // This method processes the raw vdw annotation list (all non-zero pair-wise scores)
 // and outputs three subsets
@@ -417,6 +469,13 @@ RbtDouble RbtVdwIdxSF::InterScore() const {
 RbtDouble RbtVdwIdxSF::ReceptorScore() const {
     if (!m_bFlexRec) return 0.0;
     RbtDouble score = 0.0;  // Total score
+    if (m_bRotamerTableDirty) {
+        BuildRotamerTable();
+    }
+    // Use the precomputed rotamer energies if all flexible groups are at a tabulated rotamer
+    if (!m_spRotamerTable.Null() && m_spRotamerTable->GetEnergy(score)) {
+        return score;
+    }
     // Loop over all flexible site atoms
     for (RbtAtomRListConstIter iter = m_recFlexAtomList.begin(); iter != m_recFlexAtomList.end(); iter++) {
         RbtInt id = (*iter)->GetAtomId() - 1;
@@ -446,10 +505,33 @@ RbtDouble RbtVdwIdxSF::SolventScore() const {
             score += VdwScoreEnabledOnly(*iter, atomList);
         }
     }
-    // Use the intn map for free - free intns (this is still inefficient, but unlikely to be used in practice)
-    for (RbtAtomRListConstIter iter = m_solventFreeAtomList.begin(); iter != m_solventFreeAtomList.end(); iter++) {
-        RbtInt id = (*iter)->GetAtomId() - 1;
-        score += VdwScoreEnabledOnly(*iter, m_solventFreeIntns[id]);
+    if (m_bFastSolvent) {
+        // Use the free solvent cell index for inter-model free - free intns,
+        // plus the intn map for intra-model free - free intns.
+        // Each inter-model pair is scored once, from the atom which occurs first in m_solventFreeAtomList
+        IndexFreeSolvent();
+        for (RbtUInt i = 0; i < m_solventFreeAtomList.size(); i++) {
+            RbtAtom* pAtom = m_solventFreeAtomList[i];
+            if (!pAtom->GetEnabled()) continue;
+            RbtModel* pModel = pAtom->GetModelPtr();
+            RbtInt id = pAtom->GetAtomId() - 1;
+            m_nbrAtoms = m_solventFreeIntns[id];
+            m_nbrIds.clear();
+            m_solventFreeIndex.GetNeighbours(pAtom->GetCoords(), m_nbrIds);
+            for (RbtIntListConstIter nIter = m_nbrIds.begin(); nIter != m_nbrIds.end(); nIter++) {
+                RbtAtom* pNbr = m_solventFreeAtomList[*nIter];
+                if ((RbtUInt(*nIter) > i) && (pNbr->GetModelPtr() != pModel)) {
+                    m_nbrAtoms.push_back(pNbr);
+                }
+            }
+            score += VdwScoreEnabledOnly(pAtom, m_nbrAtoms);
+        }
+    } else {
+        // Use the intn map for free - free intns (unoptimised, for testing comparisons)
+        for (RbtAtomRListConstIter iter = m_solventFreeAtomList.begin(); iter != m_solventFreeAtomList.end(); iter++) {
+            RbtInt id = (*iter)->GetAtomId() - 1;
+            score += VdwScoreEnabledOnly(*iter, m_solventFreeIntns[id]);
+        }
     }
     return score;
 }
@@ -458,6 +540,22 @@ RbtDouble RbtVdwIdxSF::SolventScore() const {
 RbtDouble RbtVdwIdxSF::ReceptorSolventScore() const {
     RbtDouble score = 0.0;
     if (m_spGrid.Null()) return score;
+    if (m_bSolventMapsDirty) {
+        BuildSolventMaps();
+    }
+    if (!m_solventMaps.empty()) {
+        // Use the precomputed energy map for each solvent model where possible, otherwise score explicitly
+        for (RbtUInt i = 0; i < m_solventMaps.size(); i++) {
+            const RbtAtomRList& atomList = m_solventModelAtomLists[i];
+            if (atomList.empty() || !atomList.front()->GetEnabled()) continue;
+            RbtDouble s;
+            if (m_solventMaps[i].Null() || !m_solventMaps[i]->GetEnergy(s)) {
+                s = ReceptorSolventScore(atomList);
+            }
+            score += s;
+        }
+        return score;
+    }
     for (RbtAtomRListConstIter iter = m_solventAtomList.begin(); iter != m_solventAtomList.end(); iter++) {
         // DM 7 June 2006 - take into account the enabled state of each solvent atom
         if ((*iter)->GetEnabled()) {
@@ -472,6 +570,137 @@ RbtDouble RbtVdwIdxSF::ReceptorSolventScore() const {
     return score;
 }
 
+RbtDouble RbtVdwIdxSF::ReceptorSolventScore(const RbtAtomRList& atomList) const {
+    RbtDouble score = 0.0;
+    for (RbtAtomRListConstIter iter = atomList.begin(); iter != atomList.end(); iter++) {
+        const RbtCoord& c = (*iter)->GetCoords();
+        score += VdwScore(*iter, m_spGrid->GetAtomList(c));
+    }
+    return score;
+}
+
+// Tabulates the intra-receptor score for each rotamer of each flexible group (vs rigid receptor),
+// and for each rotamer combination of each pair of interacting flexible groups.
+// The sum of the table entries reproduces the partitioned flexible interaction score of ReceptorScore()
+void RbtVdwIdxSF::BuildRotamerTable() const {
+    m_spRotamerTable.SetNull();
+    m_bRotamerTableDirty = false;
+    RbtFlexData* pFlexData = GetReceptor()->GetFlexData();
+    if (!m_bFlexRec || (pFlexData == NULL) || !pFlexData->isParameterValid(RbtReceptorFlexData::_ROTAMER_STEP)) {
+        return;
+    }
+    RbtDouble rotamerStep = pFlexData->GetParameter(RbtReceptorFlexData::_ROTAMER_STEP);
+    if (rotamerStep <= 0.0) return;
+    m_spRotamerTable = new RbtRotamerEnergyTable(GetReceptor(), rotamerStep);
+    RbtUInt nGroups = m_spRotamerTable->GetNumGroups();
+
+    // Divide the partitioned interactions of each flexible atom into self (group-rigid and intra-group)
+    // and pairwise (group-group) terms
+    RbtAtomRListList selfAtoms(nGroups, RbtAtomRList());
+    vector<RbtAtomRListList> selfIntns(nGroups, RbtAtomRListList());
+    RbtAtomRListList pairAtoms;
+    vector<RbtAtomRListList> pairIntns;
+    for (RbtAtomRListConstIter iter = m_recFlexAtomList.begin(); iter != m_recFlexAtomList.end(); iter++) {
+        RbtInt iGroup = m_spRotamerTable->GetGroup(*iter);
+        if (iGroup < 0) {
+            // Should not happen, but play safe and fall back to the explicit score
+            m_spRotamerTable.SetNull();
+            return;
+        }
+        const RbtAtomRList& intns = m_recFlexPrtIntns[(*iter)->GetAtomId() - 1];
+        RbtAtomRList selfList;
+        std::map<RbtUInt, RbtAtomRList> pairLists;
+        for (RbtAtomRListConstIter jIter = intns.begin(); jIter != intns.end(); jIter++) {
+            RbtInt jGroup = m_spRotamerTable->GetGroup(*jIter);
+            if ((jGroup < 0) || (jGroup == iGroup)) {
+                selfList.push_back(*jIter);
+            } else {
+                pairLists[jGroup].push_back(*jIter);
+            }
+        }
+        selfAtoms[iGroup].push_back(*iter);
+        selfIntns[iGroup].push_back(selfList);
+        for (std::map<RbtUInt, RbtAtomRList>::const_iterator pIter = pairLists.begin(); pIter != pairLists.end();
+             ++pIter) {
+            RbtUInt iPair = m_spRotamerTable->GetPairIndex(iGroup, pIter->first);
+            if (iPair == pairAtoms.size()) {
+                pairAtoms.push_back(RbtAtomRList());
+                pairIntns.push_back(RbtAtomRListList());
+            }
+            pairAtoms[iPair].push_back(*iter);
+            pairIntns[iPair].push_back(pIter->second);
+        }
+    }
+
+    for (RbtUInt i = 0; i < nGroups; i++) {
+        for (RbtInt iRot = 0; iRot < m_spRotamerTable->GetNumRotamers(i); iRot++) {
+            m_spRotamerTable->PlaceRotamer(i, iRot);
+            RbtDouble score = 0.0;
+            for (RbtUInt k = 0; k < selfAtoms[i].size(); k++) {
+                score += VdwScore(selfAtoms[i][k], selfIntns[i][k]);
+            }
+            m_spRotamerTable->SetSelfEnergy(i, iRot, score);
+        }
+    }
+    for (RbtUInt iPair = 0; iPair < m_spRotamerTable->GetNumPairs(); iPair++) {
+        RbtUInt i, j;
+        m_spRotamerTable->GetPair(iPair, i, j);
+        for (RbtInt iRot = 0; iRot < m_spRotamerTable->GetNumRotamers(i); iRot++) {
+            m_spRotamerTable->PlaceRotamer(i, iRot);
+            for (RbtInt jRot = 0; jRot < m_spRotamerTable->GetNumRotamers(j); jRot++) {
+                m_spRotamerTable->PlaceRotamer(j, jRot);
+                RbtDouble score = 0.0;
+                for (RbtUInt k = 0; k < pairAtoms[iPair].size(); k++) {
+                    score += VdwScore(pairAtoms[iPair][k], pairIntns[iPair][k]);
+                }
+                m_spRotamerTable->SetPairEnergy(iPair, iRot, jRot, score);
+            }
+        }
+    }
+    m_spRotamerTable->RestoreModel();
+    if (GetTrace() > 0) {
+        cout << GetFullName() << ": Rotamer energy table created for " << nGroups << " flexible groups and "
+             << m_spRotamerTable->GetNumPairs() << " interacting group pairs" << endl;
+    }
+}
+
+// Tabulates the receptor-solvent score of each fixed/tethered solvent model over its allowed
+// range of positions and orientations. Only possible for a rigid receptor with a single set of coords,
+// as the score must depend only on the solvent coords.
+void RbtVdwIdxSF::BuildSolventMaps() const {
+    m_solventMaps.clear();
+    m_bSolventMapsDirty = false;
+    if (!isSolventMapEnabled() || m_spGrid.Null() || m_solventModelAtomLists.empty()) return;
+    if (m_bFlexRec || (GetReceptor()->GetNumSavedCoords() > 1)) {
+        if (GetTrace() > 0) {
+            cout << GetFullName() << ": Solvent energy maps disabled for flexible receptor" << endl;
+        }
+        return;
+    }
+    if (GetCachedSolventEnergyMaps(m_solventMaps)) {
+        return;
+    }
+    m_solventMaps = CreateSolventEnergyMaps(GetSolvent());
+    RbtInt nMapped = 0;
+    for (RbtUInt i = 0; i < m_solventMaps.size(); i++) {
+        RbtSolventEnergyMapPtr spMap = m_solventMaps[i];
+        if (spMap.Null()) continue;
+        for (RbtUInt iOrient = 0; iOrient < spMap->GetNumOrientations(); iOrient++) {
+            for (RbtUInt iXYZ = 0; iXYZ < spMap->GetNumPositions(); iXYZ++) {
+                spMap->PlaceModel(iOrient, iXYZ);
+                spMap->SetValue(iOrient, iXYZ, ReceptorSolventScore(m_solventModelAtomLists[i]));
+            }
+        }
+        spMap->RestoreModel();
+        nMapped++;
+    }
+    CacheSolventEnergyMaps(m_solventMaps);
+    if (GetTrace() > 0) {
+        cout << GetFullName() << ": Receptor-solvent energy maps created for " << nMapped << " of "
+             << m_solventMaps.size() << " solvent models" << endl;
+    }
+}
+
 // Ligand-solvent
 RbtDouble RbtVdwIdxSF::LigandSolventScore() const {
     RbtDouble score = 0.0;
@@ -483,12 +712,51 @@ RbtDouble RbtVdwIdxSF::LigandSolventScore() const {
             score += VdwScoreEnabledOnly(*iter, atomList);
         }
     }
-    // Use inefficient brute force for ligand - free solvent intns
-    for (RbtAtomRListConstIter iter = m_solventFreeAtomList.begin(); iter != m_solventFreeAtomList.end(); iter++) {
-        // DM 7 June 2006 - take into account the enabled state of each solvent atom
-        if ((*iter)->GetEnabled()) {
-            score += VdwScore(*iter, m_ligAtomList);
+    if (m_solventFreeAtomList.empty()) {
+        return score;
+    }
+    if (m_bFastSolvent) {
+        // Use the ligand cell index for ligand - free solvent intns
+        IndexLigand();
+        for (RbtAtomRListConstIter iter = m_solventFreeAtomList.begin(); iter != m_solventFreeAtomList.end(); iter++) {
+            if ((*iter)->GetEnabled()) {
+                m_nbrIds.clear();
+                m_ligIndex.GetNeighbours((*iter)->GetCoords(), m_nbrIds);
+                m_nbrAtoms.clear();
+                for (RbtIntListConstIter nIter = m_nbrIds.begin(); nIter != m_nbrIds.end(); nIter++) {
+                    m_nbrAtoms.push_back(m_ligAtomList[*nIter]);
+                }
+                score += VdwScore(*iter, m_nbrAtoms);
+            }
+        }
+    } else {
+        // Use brute force for ligand - free solvent intns (unoptimised, for testing comparisons)
+        for (RbtAtomRListConstIter iter = m_solventFreeAtomList.begin(); iter != m_solventFreeAtomList.end(); iter++) {
+            // DM 7 June 2006 - take into account the enabled state of each solvent atom
+            if ((*iter)->GetEnabled()) {
+                score += VdwScore(*iter, m_ligAtomList);
+            }
         }
     }
     return score;
 }
+
+// Rebuilds the cell index of the ligand atoms from the current coordinates
+void RbtVdwIdxSF::IndexLigand() const {
+    m_ligIndex.Clear();
+    for (RbtUInt i = 0; i < m_ligAtomList.size(); i++) {
+        m_ligIndex.Add(m_ligAtomList[i]->GetCoords(), i);
+    }
+    m_ligIndex.Build();
+}
+
+// Rebuilds the cell index of the enabled free solvent atoms from the current coordinates
+void RbtVdwIdxSF::IndexFreeSolvent() const {
+    m_solventFreeIndex.Clear();
+    for (RbtUInt i = 0; i < m_solventFreeAtomList.size(); i++) {
+        if (m_solventFreeAtomList[i]->GetEnabled()) {
+            m_solventFreeIndex.Add(m_solventFreeAtomList[i]->GetCoords(), i);
+        }
+    }
+    m_solventFreeIndex.Build();
+}
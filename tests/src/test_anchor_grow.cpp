@@ -0,0 +1,77 @@
+#include "catch2/catch_amalgamated.hpp"
+
+#include <cmath>
+
+#include "RbtBiMolWorkSpace.h"
+#include "RbtMOL2FileSource.h"
+#include "RbtPopulation.h"
+#include "RbtRand.h"
+#include "RbtRandPopTransform.h"
+#include "RbtSFAgg.h"
+#include "RbtVdwGridSF.h"
+#include "test_fixtures.h"
+
+// 1YET receptor and flexible ligand, in a docking site made of the ligand atom coords
+class AnchorGrowFixture: public LigandSiteFixture {
+ public:
+    AnchorGrowFixture() {
+        m_spLigand->SetFlexData(new RbtLigandFlexData(m_spDS));
+        RbtMolecularFileSourcePtr spMol2(new RbtMOL2FileSource("tests/data/R_1YET_protein.mol2"));
+        m_spReceptor = new RbtModel(spMol2);
+    }
+
+    RbtModelPtr m_spReceptor;
+};
+
+TEST_CASE_METHOD(AnchorGrowFixture, "RbtRandPopTransform - grown poses are valid ligand poses", "[anchorgrow]") {
+    RbtBiMolWorkSpacePtr spWS(new RbtBiMolWorkSpace());
+    // There is no grid file, so coarse vdW grids for the ligand atom types are calculated on first use
+    spWS->SetName("rbt_test_anchor_grow");
+    RbtSFAggPtr spSF(new RbtSFAgg("SCORE"));
+    RbtVdwGridSF* pVdwSF = new RbtVdwGridSF("VDW");
+    pVdwSF->SetParameter(RbtVdwGridSF::_GRID_SF, RbtString("calcgrid_vdw1.prm"));
+    pVdwSF->SetParameter(RbtVdwGridSF::_SAVE_GRIDS, false);
+    pVdwSF->SetParameter(RbtVdwGridSF::_GRID_STEP, 1.0);
+    spSF->Add(pVdwSF);
+    spWS->SetSF(spSF);
+    spWS->SetDockingSite(m_spDS);
+    spWS->SetReceptor(m_spReceptor);
+    spWS->SetLigand(m_spLigand);
+
+    // Bond lengths of the input conformation, which the growth must not change
+    RbtBondList bondList = m_spLigand->GetBondList();
+    RbtDoubleList bondLengths;
+    for (RbtBondListConstIter iter = bondList.begin(); iter != bondList.end(); ++iter) {
+        bondLengths.push_back((*iter)->Length());
+    }
+
+    RbtRandPopTransform::Config config;
+    config.population_size = 10;
+    config.scale_chromosome_length = false;
+    config.scan_num_rotations = 50;
+    config.grow_seed_fraction = 1.0;
+    config.grow_beam_width = 10;
+    Rbt::GetRbtRand().Seed(69);
+    spWS->SetTransform(new RbtRandPopTransform("RANDOM_POP", config));
+    spWS->Run();
+
+    RbtPopulationPtr spPop = spWS->GetPopulation();
+    REQUIRE(spPop.Ptr() != NULL);
+    REQUIRE(spPop->GetActualSize() == RbtUInt(config.population_size));
+    // The centre of mass can lie on the edge of the docking site, so allow for rounding
+    RbtCoord tolerance(1e-6, 1e-6, 1e-6);
+    RbtCoord minCoord = m_spDS->GetMinCoord() - tolerance;
+    RbtCoord maxCoord = m_spDS->GetMaxCoord() + tolerance;
+    const RbtGenomeList& genomes = spPop->GetGenomeList();
+    for (RbtUInt i = 0; i < genomes.size(); i++) {
+        INFO("genome " << i);
+        genomes[i]->SyncToModel();
+        for (RbtUInt j = 0; j < bondList.size(); j++) {
+            REQUIRE(bondList[j]->Length() == Catch::Approx(bondLengths[j]).margin(1e-3));
+        }
+        RbtCoord com = m_spLigand->GetCenterOfMass();
+        REQUIRE(com >= minCoord);
+        REQUIRE(com <= maxCoord);
+        REQUIRE(std::isfinite(genomes[i]->GetScore()));
+    }
+}
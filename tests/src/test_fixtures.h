@@ -0,0 +1,76 @@
+#ifndef _TEST_FIXTURES_H_
+#define _TEST_FIXTURES_H_
+
+#include "RbtBaseSF.h"
+#include "RbtCavity.h"
+#include "RbtDockingSite.h"
+#include "RbtGeneLayout.h"
+#include "RbtLigandFlexData.h"
+#include "RbtMdlFileSource.h"
+#include "RbtModel.h"
+
+// 1YET ligand, in a docking site made of the ligand atom coords
+class LigandSiteFixture {
+ public:
+    LigandSiteFixture() {
+        RbtMolecularFileSourcePtr spMdl(new RbtMdlFileSource("tests/data/1YET_c.sd", true, true, true));
+        m_spLigand = new RbtModel(spMdl);
+        SetDockingSite(Rbt::GetCoordList(m_spLigand->GetAtomList()), 0.5);
+    }
+
+    // Replaces the docking site by a single cavity made of the given grid points
+    void SetDockingSite(const RbtCoordList& coords, RbtDouble gridStep) {
+        RbtCavityList cavityList;
+        cavityList.push_back(new RbtCavity(coords, RbtVector(gridStep, gridStep, gridStep)));
+        m_spDS = new RbtDockingSite(cavityList, 8.0);
+    }
+
+    // Gene layout of the ligand chromosome, with the default ligand flexibility
+    RbtGeneLayoutPtr CreateLayout() { return CreateLayout(new RbtLigandFlexData(m_spDS)); }
+
+    // Gene layout of the ligand chromosome, with one ligand flexibility parameter changed
+    RbtGeneLayoutPtr CreateLayout(const RbtString& strName, const RbtVariant& value) {
+        RbtFlexData* pFlexData = new RbtLigandFlexData(m_spDS);
+        pFlexData->SetParameter(strName, value);
+        return CreateLayout(pFlexData);
+    }
+
+    RbtModelPtr m_spLigand;
+    RbtDockingSitePtr m_spDS;
+
+ private:
+    RbtGeneLayoutPtr CreateLayout(RbtFlexData* pFlexData) {
+        m_spLigand->SetFlexData(pFlexData);
+        RbtChromElement* pChrom = m_spLigand->GetChrom();
+        RbtGeneLayoutPtr spLayout(new RbtGeneLayout(pChrom));
+        delete pChrom;
+        return spLayout;
+    }
+};
+
+// Sum of squared distances of the atoms from their coords when the scoring function was created
+class TargetPoseSF: public RbtBaseSF {
+ public:
+    TargetPoseSF(const RbtAtomList& atomList, const RbtString& strName = "TARGET"):
+        RbtBaseSF("TargetPoseSF", strName),
+        m_atomList(atomList),
+        m_targetCoords(Rbt::GetCoordList(atomList)) {}
+
+    // The atom list is fixed when the scoring function is created, so there is nothing to update
+    virtual void Update(RbtSubject* theChangedSubject) {}
+
+ protected:
+    virtual RbtDouble RawScore() const {
+        RbtDouble score(0.0);
+        for (RbtUInt i = 0; i < m_atomList.size(); i++) {
+            score += Rbt::Length2(m_atomList[i]->GetCoords(), m_targetCoords[i]);
+        }
+        return score;
+    }
+
+ private:
+    RbtAtomList m_atomList;
+    RbtCoordList m_targetCoords;
+};
+
+#endif  //_TEST_FIXTURES_H_
@@ -0,0 +1,65 @@
+#include "catch2/catch_amalgamated.hpp"
+
+#include "RbtGenome.h"
+#include "RbtRand.h"
+#include "test_fixtures.h"
+
+TEST_CASE_METHOD(LigandSiteFixture, "RbtGenome - genes round trip through the decoder chromosome", "[genome]") {
+    RbtString strRotRepr = GENERATE(as<RbtString>(), "EULER", "QUAT");
+    RbtGeneLayoutPtr spLayout = CreateLayout(RbtLigandFlexData::_ROT_REPR, strRotRepr);
+    Rbt::GetRbtRand().Seed(61);
+    for (RbtInt i = 0; i < 20; ++i) {
+        RbtGenome genome(spLayout);
+        genome.Randomise();
+        RbtDoubleList genes = genome.GetGenes();
+        INFO("ROT_REPR " << strRotRepr << ", genome " << i);
+        REQUIRE(genes.size() == spLayout->GetLength());
+        // Decoding loads the chromosome with the stored genes (quaternions are renormalised, so allow for rounding)
+        RbtDoubleList decoded;
+        spLayout->Decode(genes)->GetVector(decoded);
+        REQUIRE_THAT(decoded, Catch::Matchers::Approx(genes).margin(1e-12));
+        // Encoding the decoded chromosome gives the genes back
+        RbtDoubleList encoded;
+        spLayout->Encode(encoded);
+        REQUIRE_THAT(encoded, Catch::Matchers::Approx(genes).margin(1e-12));
+        // Syncing to and from the model does not change the genes beyond the comparison threshold
+        RbtChromElement* pChrom = spLayout->Decode(genes);
+        pChrom->SyncToModel();
+        pChrom->SyncFromModel();
+        spLayout->Encode(encoded);
+        REQUIRE(spLayout->Compare(&encoded[0], &genes[0]) < RbtChromElement::_THRESHOLD);
+    }
+}
+
+TEST_CASE_METHOD(LigandSiteFixture, "RbtGenome - flat gene operations match the chromosome operations", "[genome]") {
+    RbtString strRotRepr = GENERATE(as<RbtString>(), "EULER", "QUAT");
+    RbtGeneLayoutPtr spLayout = CreateLayout(RbtLigandFlexData::_ROT_REPR, strRotRepr);
+    Rbt::GetRbtRand().Seed(62);
+    for (RbtInt i = 0; i < 20; ++i) {
+        INFO("ROT_REPR " << strRotRepr << ", trial " << i);
+        RbtGenome g1(spLayout);
+        RbtGenome g2(spLayout);
+        g1.Randomise();
+        g2.Randomise();
+        RbtChromElementPtr spChr1 = g1.Decode()->clone();
+        RbtChromElementPtr spChr2 = g2.Decode()->clone();
+        REQUIRE(
+            spLayout->Compare(&g1.GetGenes()[0], &g2.GetGenes()[0]) == Catch::Approx(spChr1->Compare(*spChr2))
+        );
+
+        // The same random numbers must select the same crossover points
+        RbtGenome g3(g1);
+        RbtGenome g4(g2);
+        RbtChromElementPtr spChr3 = spChr1->clone();
+        RbtChromElementPtr spChr4 = spChr2->clone();
+        Rbt::GetRbtRand().Seed(1000 + i);
+        Rbt::Crossover(&g1, &g2, &g3, &g4);
+        Rbt::GetRbtRand().Seed(1000 + i);
+        Rbt::Crossover(spChr1.Ptr(), spChr2.Ptr(), spChr3.Ptr(), spChr4.Ptr());
+        RbtDoubleList v3, v4;
+        spChr3->GetVector(v3);
+        spChr4->GetVector(v4);
+        REQUIRE_THAT(g3.GetGenes(), Catch::Matchers::Approx(v3).margin(1e-12));
+        REQUIRE_THAT(g4.GetGenes(), Catch::Matchers::Approx(v4).margin(1e-12));
+    }
+}
@@ -0,0 +1,55 @@
+#include "catch2/catch_amalgamated.hpp"
+
+#include "NMSearch.h"
+#include "RbtNelderMead.h"
+#include "RbtRand.h"
+#include "test_fixtures.h"
+
+// Flexible ligand, moved away from the pose scored as zero by the scoring function
+class NelderMeadFixture: public LigandSiteFixture {
+ public:
+    NelderMeadFixture() {
+        m_spLigand->SetFlexData(new RbtLigandFlexData(m_spDS));
+        m_spSF = new TargetPoseSF(m_spLigand->GetAtomList());
+        m_spChrom = m_spLigand->GetChrom();
+        Rbt::GetRbtRand().Seed(70);
+        m_spChrom->Mutate(2.0);
+        m_spChrom->SyncToModel();
+        m_spChrom->GetVector(m_start);
+        m_spChrom->GetStepVector(m_steps);
+        m_startScore = m_spSF->Score();
+    }
+
+    SmartPtr<RbtBaseSF> m_spSF;
+    RbtChromElementPtr m_spChrom;
+    RbtDoubleList m_start;  // Start point of the searches
+    RbtDoubleList m_steps;  // Simplex edge lengths
+    RbtDouble m_startScore;
+};
+
+TEST_CASE_METHOD(NelderMeadFixture, "RbtNelderMead - same search as NMSearch", "[simplex]") {
+    RbtInt maxCalls = GENERATE(50, 200, -1);
+    RbtDouble stoppingLength = 1e-3;
+    INFO("MAX_CALLS " << maxCalls);
+
+    NMSearch::SetMaxCalls(maxCalls);
+    NMSearch::SetStoppingLength(stoppingLength);
+    m_spChrom->SetVector(m_start);
+    NMSearch search(m_spChrom.Ptr(), m_spSF.Ptr());
+    search.InitVariableLengthRightSimplex(&m_start, &m_steps[0]);
+    search.ExploratoryMoves();
+
+    m_spChrom->SetVector(m_start);
+    RbtChromSFObjective objective(m_spChrom.Ptr(), m_spSF.Ptr());
+    RbtNelderMead nm;
+    nm.SetMaxCalls(maxCalls);
+    nm.SetStoppingLength(stoppingLength);
+    nm.InitRightSimplex(m_start, m_steps, objective);
+    nm.Minimise(objective);
+
+    REQUIRE(nm.GetMinVal() < m_startScore);
+    REQUIRE(nm.GetFunctionCalls() == search.GetFunctionCalls());
+    // The same steps are taken, but the arithmetic is not ordered identically
+    REQUIRE(nm.GetMinVal() == Catch::Approx(search.GetMinVal()).epsilon(1e-10));
+    REQUIRE_THAT(nm.GetMinPoint(), Catch::Matchers::Approx(search.GetMinPoint()).margin(1e-9));
+}
@@ -0,0 +1,96 @@
+#include "catch2/catch_amalgamated.hpp"
+
+#include "RbtBiMolWorkSpace.h"
+#include "RbtMOL2FileSource.h"
+#include "RbtParameterFileSource.h"
+#include "RbtPolarGridSF.h"
+#include "RbtPolarIdxSF.h"
+#include "RbtSFAgg.h"
+#include "RbtSFFactory.h"
+#include "test_fixtures.h"
+
+// 1YET receptor and ligand, scored with the RbtPolarIdxSF terms used by rbcalcgrid to calculate the polar grids
+class PolarGridFixture: public LigandSiteFixture {
+ public:
+    PolarGridFixture() {
+        m_spWS = new RbtBiMolWorkSpace();
+        m_spWS->SetDockingSite(m_spDS);
+        RbtSFFactory sfFactory;
+        RbtParameterFileSourcePtr spSFSource(
+            new RbtParameterFileSource(Rbt::GetRbtFileName("data/sf", "calcgrid_polar.prm"))
+        );
+        m_spSF = sfFactory.CreateAggFromFile(spSFSource, "SCORE");
+        for (RbtUInt i = 0; i < m_spSF->GetNumSF(); i++) {
+            RbtPolarIdxSF* pPolarSF = dynamic_cast<RbtPolarIdxSF*>(m_spSF->GetSF(i));
+            if (pPolarSF != NULL) {
+                m_polarSFs.push_back(pPolarSF);
+            }
+        }
+        m_spWS->SetSF(m_spSF);
+        RbtMolecularFileSourcePtr spMol2(new RbtMOL2FileSource("tests/data/R_1YET_protein.mol2"));
+        m_spWS->SetReceptor(new RbtModel(spMol2));
+        // Sets the ligand atom user1 values (charge and neighbour density scaling)
+        m_spWS->SetLigand(m_spLigand);
+    }
+
+    // Weighted RbtPolarIdxSF score of a ligand donor or acceptor, pointing at pParent, with the atoms moved
+    // by offset
+    RbtDouble IndexedScore(RbtAtom* pAtom, RbtAtom* pParent, RbtBool bAcceptor, const RbtVector& offset) {
+        RbtAtom atom(*pAtom);
+        RbtAtom parent(*pParent);
+        atom.SetCoords(pAtom->GetCoords() + offset);
+        parent.SetCoords(pParent->GetCoords() + offset);
+        RbtInteractionCenter ic(&atom, &parent);
+        RbtInteractionCenterList probeList(1, &ic);
+        RbtInteractionCenterList emptyList;
+        RbtDouble score = 0.0;
+        for (vector<RbtPolarIdxSF*>::const_iterator iter = m_polarSFs.begin(); iter != m_polarSFs.end(); iter++) {
+            RbtDouble s = (bAcceptor) ? (*iter)->ProbeScore(emptyList, probeList)
+                                      : (*iter)->ProbeScore(probeList, emptyList);
+            score += (*iter)->GetWeight() * s;
+        }
+        return score;
+    }
+
+    RbtBiMolWorkSpacePtr m_spWS;
+    RbtSFAggPtr m_spSF;
+    vector<RbtPolarIdxSF*> m_polarSFs;
+};
+
+TEST_CASE_METHOD(PolarGridFixture, "RbtPolarGridSF - probe grids match RbtPolarIdxSF at grid points", "[polar]") {
+    REQUIRE(m_polarSFs.size() == 2);
+    RbtInt nCenters = 0;
+    RbtInt nNonZero = 0;
+    RbtAtomList atomList = m_spLigand->GetAtomList();
+    for (RbtAtomListIter iter = atomList.begin(); iter != atomList.end(); iter++) {
+        RbtAtom* pAtom = iter->Ptr();
+        RbtAtomList bondedList = Rbt::GetBondedAtomList(pAtom);
+        RbtBool bDonor = Rbt::isAtomHBondDonor()(pAtom);
+        // Acceptors with more than one bonded atom point at a pseudo atom; skip them here
+        RbtBool bAcceptor = Rbt::isAtomHBondAcceptor()(pAtom) && (bondedList.size() == 1);
+        if (!bDonor && !bAcceptor) continue;
+        nCenters++;
+        RbtAtom* pParent = bondedList.front().Ptr();
+        RbtPolarGridSF::eProbeClass probeClass = (bDonor) ? RbtPolarGridSF::HBD : RbtPolarGridSF::HBA;
+        RbtString strProbe = RbtPolarGridSF::GetProbeName(probeClass, pAtom->GetVdwRadius());
+        RbtVector direction = pParent->GetCoords() - pAtom->GetCoords();
+
+        // 3x3x3 grid points around the ligand atom, with the probe pointing in the ligand direction
+        RbtVector gridStep(0.5, 0.5, 0.5);
+        RbtRealGrid grid(pAtom->GetCoords() - gridStep, gridStep, 3, 3, 3);
+        RbtPolarGridSF::CalculateProbeGrid(m_spWS, strProbe, direction, &grid);
+        for (RbtUInt iXYZ = 0; iXYZ < grid.GetN(); iXYZ++) {
+            INFO(pAtom->GetFullAtomName() << " (" << strProbe << "), grid point " << iXYZ);
+            RbtVector offset = grid.GetCoord(iXYZ) - pAtom->GetCoords();
+            // As in RbtPolarGridSF::RawScore, the grid value is scaled by the ligand atom user1 value
+            RbtDouble gridScore = grid.GetValue(iXYZ) * pAtom->GetUser1Value();
+            RbtDouble idxScore = IndexedScore(pAtom, pParent, !bDonor, offset);
+            REQUIRE(gridScore == Catch::Approx(idxScore).margin(1e-4));
+            if (idxScore != 0.0) {
+                nNonZero++;
+            }
+        }
+    }
+    REQUIRE(nCenters > 0);
+    REQUIRE(nNonZero > 0);
+}
@@ -0,0 +1,82 @@
+#include "catch2/catch_amalgamated.hpp"
+
+#include "RbtPopulation.h"
+#include "RbtRand.h"
+#include "test_fixtures.h"
+
+// Ligand in a docking site made of the grid points in a box around the ligand
+class PopulationFixture: public LigandSiteFixture {
+ public:
+    PopulationFixture() {
+        RbtCoordList coords;
+        RbtAtomList atomList = m_spLigand->GetAtomList();
+        RbtCoord minCoord = Rbt::Min(Rbt::GetCoordList(atomList));
+        RbtCoord maxCoord = Rbt::Max(Rbt::GetCoordList(atomList));
+        for (RbtDouble x = std::floor(minCoord.x) - 2.0; x <= maxCoord.x + 2.0; x += 1.0) {
+            for (RbtDouble y = std::floor(minCoord.y) - 2.0; y <= maxCoord.y + 2.0; y += 1.0) {
+                for (RbtDouble z = std::floor(minCoord.z) - 2.0; z <= maxCoord.z + 2.0; z += 1.0) {
+                    coords.push_back(RbtCoord(x, y, z));
+                }
+            }
+        }
+        SetDockingSite(coords, 1.0);
+    }
+};
+
+// Reference duplicate removal: compare each genome with every genome kept so far
+static void RemoveDuplicatesByScan(
+    const RbtGenomeList& sortedPop, RbtDouble equalityThreshold, RbtUInt maxSize, RbtGenomeList& uniquePop
+) {
+    uniquePop.clear();
+    for (RbtGenomeListConstIter iter = sortedPop.begin(); (iter != sortedPop.end()) && (uniquePop.size() < maxSize);
+         ++iter) {
+        RbtBool isDuplicate(false);
+        for (RbtGenomeListConstIter uIter = uniquePop.begin(); (uIter != uniquePop.end()) && !isDuplicate; ++uIter) {
+            isDuplicate = (*uIter)->Equals(**iter, equalityThreshold);
+        }
+        if (!isDuplicate) {
+            uniquePop.push_back(*iter);
+        }
+    }
+}
+
+TEST_CASE_METHOD(PopulationFixture, "RbtPopulation - hashed duplicate removal matches a full scan", "[population]") {
+    RbtString strTransMode = GENERATE(as<RbtString>(), "FREE", "FIXED");
+    // With fixed translation there is no centre of mass gene, so genomes are hashed by dihedral
+    RbtGeneLayoutPtr spLayout = CreateLayout(RbtLigandFlexData::_TRANS_MODE, strTransMode);
+    Rbt::GetRbtRand().Seed(20061);
+    // Clusters of near-duplicates, so that many duplicates fall in a neighbouring hash cell of the genome they equal
+    RbtGenomeList pop;
+    for (RbtInt i = 0; i < 40; ++i) {
+        RbtGenomePtr spCentre = new RbtGenome(spLayout);
+        spCentre->Randomise();
+        pop.push_back(spCentre);
+        for (RbtInt j = 0; j < 10; ++j) {
+            RbtGenomePtr spNeighbour = spCentre->clone();
+            spNeighbour->Mutate(0.02 * (j + 1));
+            pop.push_back(spNeighbour);
+        }
+    }
+    for (RbtInt i = pop.size() - 1; i > 0; --i) {
+        std::swap(pop[i], pop[Rbt::GetRbtRand().GetRandomInt(i + 1)]);
+    }
+
+    const RbtDouble thresholds[] = {0.0, 0.05, 0.1, 0.2, 0.5};
+    for (RbtDouble threshold : thresholds) {
+        for (RbtUInt maxSize : {RbtUInt(50), RbtUInt(pop.size())}) {
+            RbtGenomeList hashed;
+            RbtGenomeList scanned;
+            RbtPopulation::RemoveDuplicates(pop, threshold, maxSize, hashed);
+            RemoveDuplicatesByScan(pop, threshold, maxSize, scanned);
+            INFO("TRANS_MODE " << strTransMode << ", threshold " << threshold << ", maxSize " << maxSize);
+            REQUIRE(hashed.size() == scanned.size());
+            for (RbtUInt k = 0; k < hashed.size(); ++k) {
+                REQUIRE(hashed[k].Ptr() == scanned[k].Ptr());
+            }
+        }
+    }
+    // The test population must contain duplicates at the GA's default threshold for the test to be meaningful
+    RbtGenomeList unique;
+    RbtPopulation::RemoveDuplicates(pop, 0.1, pop.size(), unique);
+    REQUIRE(unique.size() < pop.size());
+}
@@ -0,0 +1,185 @@
+#include "catch2/catch_amalgamated.hpp"
+
+#include <cmath>
+#include <sstream>
+
+#include "RbtRand.h"
+#include "RbtRealGrid.h"
+
+// Grid of random values, with dimensions that are not multiples of the brick size
+static RbtRealGridPtr CreateRandomGrid(RbtUInt NX, RbtUInt NY, RbtUInt NZ, RbtUInt NPad) {
+    RbtCoord gridMin(-3.0, 1.5, 7.25);
+    RbtCoord gridStep(0.375, 0.375, 0.375);
+    RbtRealGridPtr spGrid(new RbtRealGrid(gridMin, gridStep, NX, NY, NZ, NPad));
+    RbtRand& rand = Rbt::GetRbtRand();
+    for (RbtUInt i = 0; i < spGrid->GetN(); i++) {
+        spGrid->SetValue(i, 20.0 * rand.GetRandom01() - 10.0);
+    }
+    return spGrid;
+}
+
+// Random coords in the region covered by the grid and its border
+static RbtCoordList CreateRandomCoords(const RbtRealGrid& grid, RbtUInt nCoords) {
+    RbtRand& rand = Rbt::GetRbtRand();
+    RbtCoord border(1.0, 1.0, 1.0);
+    RbtCoord minCoord = grid.GetGridMin() - border;
+    RbtCoord size = grid.GetGridSize() + border * 2.0;
+    RbtCoordList coords;
+    coords.reserve(nCoords);
+    for (RbtUInt i = 0; i < nCoords; i++) {
+        RbtDouble x = minCoord.x + rand.GetRandom01() * size.x;
+        RbtDouble y = minCoord.y + rand.GetRandom01() * size.y;
+        RbtDouble z = minCoord.z + rand.GetRandom01() * size.z;
+        coords.push_back(RbtCoord(x, y, z));
+    }
+    return coords;
+}
+
+TEST_CASE("RbtRealGrid - LINEAR and BRICKED layouts give identical values", "[grid]") {
+    Rbt::GetRbtRand().Seed(73);
+    RbtRealGridPtr spLinear = CreateRandomGrid(37, 22, 9, 2);
+    RbtRealGridPtr spBricked(new RbtRealGrid(*spLinear));
+    spBricked->SetLayout(RbtRealGrid::BRICKED);
+    REQUIRE(spLinear->GetLayout() == RbtRealGrid::LINEAR);
+    REQUIRE(spBricked->GetLayout() == RbtRealGrid::BRICKED);
+
+    for (RbtUInt i = 0; i < spLinear->GetN(); i++) {
+        REQUIRE(spBricked->GetValue(i) == spLinear->GetValue(i));
+    }
+    RbtCoordList coords = CreateRandomCoords(*spLinear, 10000);
+    for (RbtCoordListConstIter iter = coords.begin(); iter != coords.end(); ++iter) {
+        REQUIRE(spBricked->GetValue(*iter) == spLinear->GetValue(*iter));
+        REQUIRE(spBricked->GetSmoothedValue(*iter) == spLinear->GetSmoothedValue(*iter));
+    }
+    REQUIRE(spBricked->MinValue() == spLinear->MinValue());
+    REQUIRE(spBricked->MaxValue() == spLinear->MaxValue());
+    REQUIRE(spBricked->FindMinValue() == spLinear->FindMinValue());
+    REQUIRE(spBricked->FindMaxValue() == spLinear->FindMaxValue());
+    REQUIRE(spBricked->CountRange(-1.0, 1.0) == spLinear->CountRange(-1.0, 1.0));
+
+    SECTION("Grid files do not depend on the layout") {
+        std::ostringstream linearStr;
+        std::ostringstream brickedStr;
+        spLinear->Write(linearStr);
+        spBricked->Write(brickedStr);
+        REQUIRE(brickedStr.str() == linearStr.str());
+        std::istringstream istr(brickedStr.str());
+        RbtRealGrid readGrid(istr, RbtRealGrid::BRICKED);
+        REQUIRE(readGrid.GetLayout() == RbtRealGrid::BRICKED);
+        for (RbtUInt i = 0; i < spLinear->GetN(); i++) {
+            REQUIRE(readGrid.GetValue(i) == spLinear->GetValue(i));
+        }
+    }
+
+    SECTION("Coarse grids do not depend on the layout") {
+        RbtRealGridPtr spLinearCoarse(spLinear->CreateCoarseGrid(4));
+        RbtRealGridPtr spBrickedCoarse(spBricked->CreateCoarseGrid(4));
+        REQUIRE(spBrickedCoarse->GetLayout() == RbtRealGrid::BRICKED);
+        REQUIRE(spBrickedCoarse->GetN() == spLinearCoarse->GetN());
+        for (RbtUInt i = 0; i < spLinearCoarse->GetN(); i++) {
+            REQUIRE(spBrickedCoarse->GetValue(i) == spLinearCoarse->GetValue(i));
+        }
+    }
+
+    SECTION("Changing the layout back restores the linear order") {
+        spBricked->SetLayout(RbtRealGrid::LINEAR);
+        for (RbtUInt i = 0; i < spLinear->GetN(); i++) {
+            REQUIRE(spBricked->GetGridData()[i] == spLinear->GetGridData()[i]);
+        }
+    }
+}
+
+TEST_CASE("RbtRealGrid - coarse grids keep wells next to walls", "[grid]") {
+    // Repulsive wall across the plane iX = 9, with a narrow well next to it at (8, 9, 9)
+    RbtRealGrid grid(RbtCoord(0.0, 0.0, 0.0), RbtVector(0.5, 0.5, 0.5), 17, 17, 17);
+    grid.SetAllValues(0.0);
+    for (RbtUInt iY = 1; iY <= grid.GetNY(); iY++) {
+        for (RbtUInt iZ = 1; iZ <= grid.GetNZ(); iZ++) {
+            grid.SetValue(9, iY, iZ, 10.0);
+        }
+    }
+    grid.SetValue(8, 9, 9, -5.0);
+    RbtRealGridPtr spCoarse(grid.CreateCoarseGrid(4));
+    REQUIRE(spCoarse->GetNX() == 5);
+    // The coarse grid point (3, 3, 3) coincides with (9, 9, 9) on the wall, and is the nearest to the well
+    REQUIRE(spCoarse->GetCoord(3, 3, 3) == grid.GetCoord(9, 9, 9));
+    REQUIRE(spCoarse->GetValue(3, 3, 3) == -5.0);
+    // Coarse grid points away from the well are not raised by the wall
+    REQUIRE(spCoarse->GetValue(3, 1, 1) == 0.0);
+    REQUIRE(spCoarse->MaxValue() == 0.0);
+
+    SECTION("Coarse values are lower bounds of the values at the coinciding grid points") {
+        Rbt::GetRbtRand().Seed(72);
+        RbtRealGridPtr spRandom = CreateRandomGrid(37, 22, 9, 2);
+        RbtRealGridPtr spRandomCoarse(spRandom->CreateCoarseGrid(4));
+        for (RbtUInt i = 0; i < spRandomCoarse->GetN(); i++) {
+            RbtCoord c = spRandomCoarse->GetCoord(i);
+            RbtCoord d = (c - spRandom->GetCoord(1, 1, 1)) / spRandom->GetGridStep().x;
+            RbtUInt iXYZ = spRandom->GetIXYZ(std::lround(d.x) + 1, std::lround(d.y) + 1, std::lround(d.z) + 1);
+            REQUIRE(Rbt::Length2(spRandom->GetCoord(iXYZ), c) < 1e-12);
+            REQUIRE(spRandomCoarse->GetValue(i) <= spRandom->GetValue(iXYZ));
+        }
+    }
+}
+
+TEST_CASE("RbtRealGrid - grid points on the lattice of another grid", "[grid]") {
+    RbtVector step(0.375, 0.375, 0.375);
+    RbtRealGrid refGrid(RbtCoord(-3.0, 1.5, 7.25), step, 20, 20, 20);
+    REQUIRE(refGrid.isOnLattice(refGrid));
+
+    SECTION("Same grid step, with the origin moved by whole grid steps") {
+        RbtRealGrid grid(RbtCoord(-3.0, 1.5, 7.25) + step * 4.0, step, 30, 10, 20);
+        REQUIRE(refGrid.isOnLattice(grid));
+        REQUIRE(grid.isOnLattice(refGrid));
+    }
+
+    SECTION("Coarse grids lie on the lattice of the fine grid, but not vice versa") {
+        RbtRealGridPtr spCoarse(refGrid.CreateCoarseGrid(4));
+        REQUIRE(refGrid.isOnLattice(*spCoarse));
+        REQUIRE(!spCoarse->isOnLattice(refGrid));
+    }
+
+    SECTION("Different grid steps") {
+        RbtRealGrid grid(RbtCoord(-3.0, 1.5, 7.25), RbtVector(0.5, 0.5, 0.5), 20, 20, 20);
+        REQUIRE(!refGrid.isOnLattice(grid));
+        REQUIRE(!grid.isOnLattice(refGrid));
+    }
+
+    SECTION("Grid steps that differ slightly drift off the lattice across the grid") {
+        // Close enough to the lattice over a few grid steps, but not over 20
+        RbtVector nearStep(0.375 + 1e-4, 0.375, 0.375);
+        RbtRealGrid smallGrid(RbtCoord(0.0, 0.0, 0.0), nearStep, 2, 2, 2);
+        RbtRealGrid grid(RbtCoord(0.0, 0.0, 0.0), nearStep, 20, 20, 20);
+        REQUIRE(refGrid.isOnLattice(smallGrid));
+        REQUIRE(!refGrid.isOnLattice(grid));
+    }
+}
+
+// Smoothed lookups for ligand-sized clusters of 40 atoms at random positions in the grid, as when scoring poses.
+// Not run by default: test_suite "[benchmark]"
+TEST_CASE("RbtRealGrid - LINEAR and BRICKED lookup speed", "[.][benchmark]") {
+    RbtUInt N = GENERATE(64, 200, 320);
+    Rbt::GetRbtRand().Seed(73);
+    RbtRealGridPtr spLinear = CreateRandomGrid(N, N, N, 0);
+    RbtRealGridPtr spBricked(new RbtRealGrid(*spLinear));
+    spBricked->SetLayout(RbtRealGrid::BRICKED);
+    RbtCoordList centres = CreateRandomCoords(*spLinear, 20000);
+    RbtCoordList offsets;
+    RbtRand& rand = Rbt::GetRbtRand();
+    for (RbtInt i = 0; i < 40; i++) {
+        RbtVector direction = rand.GetRandomUnitVector();
+        offsets.push_back(direction * (6.0 * rand.GetRandom01()));
+    }
+    auto lookups = [&](const RbtRealGrid& grid) {
+        RbtDouble sum(0.0);
+        for (RbtCoordListConstIter cIter = centres.begin(); cIter != centres.end(); ++cIter) {
+            for (RbtCoordListConstIter oIter = offsets.begin(); oIter != offsets.end(); ++oIter) {
+                sum += grid.GetSmoothedValue(*cIter + *oIter);
+            }
+        }
+        return sum;
+    };
+    REQUIRE(lookups(*spBricked) == lookups(*spLinear));
+    BENCHMARK("LINEAR " + std::to_string(N) + "^3") { return lookups(*spLinear); };
+    BENCHMARK("BRICKED " + std::to_string(N) + "^3") { return lookups(*spBricked); };
+}
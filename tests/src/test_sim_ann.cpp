@@ -0,0 +1,111 @@
+#include "catch2/catch_amalgamated.hpp"
+
+#include "RbtBiMolWorkSpace.h"
+#include "RbtMOL2FileSource.h"
+#include "RbtRand.h"
+#include "RbtSFAgg.h"
+#include "RbtSimAnnTransform.h"
+#include "test_fixtures.h"
+
+// Records the score of each pose, so that two runs can be compared pose by pose
+class RecordingTargetPoseSF: public TargetPoseSF {
+ public:
+    RecordingTargetPoseSF(const RbtAtomList& atomList): TargetPoseSF(atomList, "RECORDING") {}
+
+    mutable RbtDoubleList m_scores;
+
+ protected:
+    virtual RbtDouble RawScore() const {
+        RbtDouble score = TargetPoseSF::RawScore();
+        m_scores.push_back(score);
+        return score;
+    }
+};
+
+// Declares a lower bound, so that its evaluation can be skipped by RbtSFAgg::BoundedRawScore
+class BoundedTargetPoseSF: public TargetPoseSF {
+ public:
+    BoundedTargetPoseSF(const RbtAtomList& atomList): TargetPoseSF(atomList, "BOUNDED"), m_nCalls(0) {}
+
+    mutable RbtInt m_nCalls;
+
+ protected:
+    virtual RbtDouble RawScore() const {
+        m_nCalls++;
+        return TargetPoseSF::RawScore();
+    }
+    virtual RbtBool RawScoreLowerBound(RbtDouble& lowerBound) const {
+        lowerBound = 0.0;
+        return true;
+    }
+};
+
+// Flexible ligand and rigid receptor, with the ligand moved away from the pose scored as zero
+class SimAnnFixture: public LigandSiteFixture {
+ public:
+    SimAnnFixture() {
+        m_spLigand->SetFlexData(new RbtLigandFlexData(m_spDS));
+        m_spWS = new RbtBiMolWorkSpace();
+        m_spSF = new RbtSFAgg("SCORE");
+        m_pRecordingSF = new RecordingTargetPoseSF(m_spLigand->GetAtomList());
+        m_pBoundedSF = new BoundedTargetPoseSF(m_spLigand->GetAtomList());
+        m_spSF->Add(m_pRecordingSF);
+        m_spSF->Add(m_pBoundedSF);
+        m_spWS->SetSF(m_spSF);
+        m_spWS->SetDockingSite(m_spDS);
+        // The receptor is not scored, but the workspace chromosome needs a receptor model
+        RbtMolecularFileSourcePtr spMol2(new RbtMOL2FileSource("tests/data/R_1YET_protein.mol2"));
+        m_spWS->SetReceptor(new RbtModel(spMol2));
+        m_spWS->SetLigand(m_spLigand);
+        RbtChromElementPtr spChrom(m_spLigand->GetChrom());
+        Rbt::GetRbtRand().Seed(57);
+        spChrom->Mutate(2.0);
+        spChrom->SyncToModel();
+        m_spLigand->SaveCoords("START");
+    }
+
+    // Runs a short simulated annealing search from the start pose
+    void Run(RbtBool bEarlyStopping) {
+        m_spLigand->RevertCoords("START");
+        m_pRecordingSF->m_scores.clear();
+        m_pBoundedSF->m_nCalls = 0;
+        RbtSimAnnTransform::Config config;
+        config.initial_temp = 3000.0;
+        config.final_temp = 300.0;
+        config.num_blocks = 10;
+        config.block_length = 50;
+        config.scale_chromosome_length = false;
+        config.early_stopping = bEarlyStopping;
+        Rbt::GetRbtRand().Seed(5757);
+        m_spWS->SetTransform(new RbtSimAnnTransform("SIMANN", config));
+        m_spWS->Run();
+    }
+
+    RbtSFAggPtr m_spSF;
+    RbtBiMolWorkSpacePtr m_spWS;
+    RecordingTargetPoseSF* m_pRecordingSF;  // Owned by m_spSF
+    BoundedTargetPoseSF* m_pBoundedSF;      // Owned by m_spSF
+};
+
+TEST_CASE_METHOD(SimAnnFixture, "RbtSimAnnTransform - early stopping does not change the acceptance", "[simann]") {
+    Run(false);
+    RbtDoubleList scores = m_pRecordingSF->m_scores;
+    RbtInt nCalls = m_pBoundedSF->m_nCalls;
+    RbtCoordList coords = Rbt::GetCoordList(m_spLigand->GetAtomList());
+
+    Run(true);
+    // Each trial pose depends on the acceptance of all the previous trials, so the same sequence of poses
+    // means that every trial was accepted or rejected in the same way
+    REQUIRE(m_pRecordingSF->m_scores.size() == scores.size());
+    for (RbtUInt i = 0; i < scores.size(); i++) {
+        INFO("score " << i);
+        REQUIRE(m_pRecordingSF->m_scores[i] == scores[i]);
+    }
+    RbtCoordList earlyStoppingCoords = Rbt::GetCoordList(m_spLigand->GetAtomList());
+    for (RbtUInt i = 0; i < coords.size(); i++) {
+        REQUIRE(earlyStoppingCoords[i] == coords[i]);
+    }
+    // The test is only meaningful if the search improved the score, and some evaluations were abandoned
+    REQUIRE(scores.back() < scores.front());
+    REQUIRE(m_pBoundedSF->m_nCalls < nCalls);
+}